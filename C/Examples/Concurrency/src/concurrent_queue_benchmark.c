@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "concurrent_queue.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures the throughput and the latency of ConcurrentQueue with an increasing
+// number of producer/consumer pairs. Each producer enqueues items_per_producer
+// items recording the time at which each item is enqueued; consumers measure
+// how long each item waited in the queue.
+
+#define QUEUE_CAPACITY 1024
+
+typedef struct {
+  ConcurrentQueue* queue;
+  uint64_t* enqueue_times;
+  size_t first_item;
+  size_t num_items;
+  size_t batch_size;
+
+  uint64_t total_latency;
+  uint64_t max_latency;
+  size_t consumed;
+} ThreadInfo;
+
+static uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+static void* producer(void* arg) {
+  ThreadInfo* info = (ThreadInfo*) arg;
+  void* batch[64];
+
+  for(size_t i = 0; i < info->num_items; i += info->batch_size) {
+    size_t count = info->batch_size;
+    if(i + count > info->num_items) {
+      count = info->num_items - i;
+    }
+
+    uint64_t now = now_ns();
+    for(size_t j = 0; j < count; ++j) {
+      size_t item = info->first_item + i + j;
+      info->enqueue_times[item] = now;
+      batch[j] = (void*) item;
+    }
+
+    ConcurrentQueue_enqueue_many(info->queue, batch, count);
+  }
+
+  return NULL;
+}
+
+static void* consumer(void* arg) {
+  ThreadInfo* info = (ThreadInfo*) arg;
+  void* batch[64];
+  size_t count;
+
+  while((count = ConcurrentQueue_dequeue_many(info->queue, batch, info->batch_size)) > 0) {
+    uint64_t now = now_ns();
+    for(size_t j = 0; j < count; ++j) {
+      uint64_t latency = now - info->enqueue_times[(size_t) batch[j]];
+      info->total_latency += latency;
+      if(latency > info->max_latency) {
+        info->max_latency = latency;
+      }
+    }
+    info->consumed += count;
+  }
+
+  return NULL;
+}
+
+static void run_experiment(PrintTime* pt, size_t num_pairs, size_t items_per_producer, size_t batch_size) {
+  char label[128];
+  snprintf(label, 128, "pairs: %ld batch: %ld", num_pairs, batch_size);
+
+  size_t num_items = num_pairs * items_per_producer;
+  uint64_t* enqueue_times = (uint64_t*) Mem_alloc(sizeof(uint64_t) * num_items);
+  ConcurrentQueue* queue = ConcurrentQueue_new(QUEUE_CAPACITY);
+  pthread_t* producers = (pthread_t*) Mem_alloc(sizeof(pthread_t) * num_pairs);
+  pthread_t* consumers = (pthread_t*) Mem_alloc(sizeof(pthread_t) * num_pairs);
+  ThreadInfo* producers_info = (ThreadInfo*) Mem_calloc(num_pairs, sizeof(ThreadInfo));
+  ThreadInfo* consumers_info = (ThreadInfo*) Mem_calloc(num_pairs, sizeof(ThreadInfo));
+
+  double elapsed = PrintTime_print(pt, label, ^{
+    for(size_t i = 0; i < num_pairs; ++i) {
+      producers_info[i].queue = queue;
+      producers_info[i].enqueue_times = enqueue_times;
+      producers_info[i].first_item = i * items_per_producer;
+      producers_info[i].num_items = items_per_producer;
+      producers_info[i].batch_size = batch_size;
+      consumers_info[i] = producers_info[i];
+
+      pthread_create(&producers[i], NULL, producer, &producers_info[i]);
+      pthread_create(&consumers[i], NULL, consumer, &consumers_info[i]);
+    }
+
+    for(size_t i = 0; i < num_pairs; ++i) {
+      pthread_join(producers[i], NULL);
+    }
+    ConcurrentQueue_close(queue);
+
+    for(size_t i = 0; i < num_pairs; ++i) {
+      pthread_join(consumers[i], NULL);
+    }
+  });
+
+  uint64_t total_latency = 0;
+  uint64_t max_latency = 0;
+  size_t consumed = 0;
+  for(size_t i = 0; i < num_pairs; ++i) {
+    total_latency += consumers_info[i].total_latency;
+    consumed += consumers_info[i].consumed;
+    if(consumers_info[i].max_latency > max_latency) {
+      max_latency = consumers_info[i].max_latency;
+    }
+  }
+
+  if(consumed != num_items) {
+    Error_raise(Error_new(ERROR_GENERIC, "Consumed %ld items out of %ld", consumed, num_items));
+  }
+
+  printf("throughput: " GRN "%.2lf Mitems/sec" reset "  avg latency: " GRN "%.0lf ns" reset "  max latency: " GRN "%.0lf ns\n\n" reset,
+    (double) num_items / elapsed / 1e6, (double) total_latency / (double) num_items, (double) max_latency);
+
+  Mem_free(consumers_info);
+  Mem_free(producers_info);
+  Mem_free(consumers);
+  Mem_free(producers);
+  ConcurrentQueue_free(queue);
+  Mem_free(enqueue_times);
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 3) {
+    printf("Usage: concurrent_queue_benchmark <items per producer> <max producer/consumer pairs>\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t items_per_producer = (size_t) atol(argv[1]);
+  size_t max_pairs = (size_t) atol(argv[2]);
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "concurrent_queue");
+  PrintTime_add_header(pt, "items_per_producer", argv[1]);
+
+  for(size_t pairs = 1; pairs <= max_pairs; pairs *= 2) {
+    run_experiment(pt, pairs, items_per_producer, 1);
+    run_experiment(pt, pairs, items_per_producer, 64);
+  }
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "parallel_iterator_functions.h"
+#include "iterator_functions.h"
+#include "basic_iterators.h"
+#include "array.h"
+#include "array_alt.h"
+#include "dictionary.h"
+#include "keys.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures the scaling of par_map and par_reduce over Array_it, ArrayAlt_it and Number_it
+// when the blocks are CPU bound, comparing them with the sequential map and reduce. par_count
+// is measured over Dictionary_key_it too, which is split instead of being accessed randomly.
+
+typedef Iterator (^IteratorMaker)(void);
+
+// CPU bound computation on the given number
+static double work(double x) {
+  double result = 0;
+  for(int i = 1; i <= 32; ++i) {
+    result += sqrt(x + i) * sin(x * i);
+  }
+
+  return result;
+}
+
+static void run_experiment(PrintTime* pt, const char* container, IteratorMaker make_it, double (^value)(void*), size_t max_workers) {
+  char label[128];
+
+  snprintf(label, 128, "%s: sequential map", container);
+  double sequential = PrintTime_print(pt, label, ^{
+    Array_free(map(make_it(), ^void*(void* elem) {
+      return work(value(elem)) > 0 ? elem : NULL;
+    }));
+  });
+
+  for(size_t workers = 1; workers <= max_workers; workers *= 2) {
+    TaskPool* pool = TaskPool_new(workers);
+
+    snprintf(label, 128, "%s: par_map workers: %ld", container, workers);
+    double parallel = PrintTime_print(pt, label, ^{
+      Array_free(par_map(pool, make_it(), 0, ^void*(void* elem) {
+        return work(value(elem)) > 0 ? elem : NULL;
+      }));
+    });
+    printf("speedup: " GRN "%.2lf\n\n" reset, sequential / parallel);
+
+    TaskPool_free(pool);
+  }
+
+  __block size_t sequential_count = 0;
+  snprintf(label, 128, "%s: sequential reduce", container);
+  sequential = PrintTime_print(pt, label, ^{
+    void* count = reduce(make_it(), (void*) 0l, ^void*(void* partial_count, void* elem) {
+      return (void*) ((size_t) partial_count + (work(value(elem)) > 0 ? 1 : 0));
+    });
+    sequential_count = (size_t) count;
+  });
+
+  for(size_t workers = 1; workers <= max_workers; workers *= 2) {
+    TaskPool* pool = TaskPool_new(workers);
+    __block size_t parallel_count = 0;
+
+    snprintf(label, 128, "%s: par_count workers: %ld", container, workers);
+    double parallel = PrintTime_print(pt, label, ^{
+      parallel_count = par_count(pool, make_it(), 0, ^int(void* elem) {
+        return work(value(elem)) > 0;
+      });
+    });
+    printf("speedup: " GRN "%.2lf\n\n" reset, sequential / parallel);
+
+    if(parallel_count != sequential_count) {
+      Error_raise(Error_new(ERROR_GENERIC, "par_count returned %ld instead of %ld", parallel_count, sequential_count));
+    }
+
+    TaskPool_free(pool);
+  }
+}
+
+static void run_split_experiment(PrintTime* pt, const char* container, IteratorMaker make_it, double (^value)(void*), size_t max_workers) {
+  char label[128];
+  __block size_t sequential_count = 0;
+
+  snprintf(label, 128, "%s: sequential count", container);
+  double sequential = PrintTime_print(pt, label, ^{
+    for_each(make_it(), ^(void* elem) {
+      sequential_count += work(value(elem)) > 0 ? 1 : 0;
+    });
+  });
+
+  for(size_t workers = 1; workers <= max_workers; workers *= 2) {
+    TaskPool* pool = TaskPool_new(workers);
+    __block size_t parallel_count = 0;
+
+    snprintf(label, 128, "%s: par_count (split) workers: %ld", container, workers);
+    double parallel = PrintTime_print(pt, label, ^{
+      parallel_count = par_count(pool, make_it(), 0, ^int(void* elem) {
+        return work(value(elem)) > 0;
+      });
+    });
+    printf("speedup: " GRN "%.2lf\n\n" reset, sequential / parallel);
+
+    if(parallel_count != sequential_count) {
+      Error_raise(Error_new(ERROR_GENERIC, "par_count returned %ld instead of %ld", parallel_count, sequential_count));
+    }
+
+    TaskPool_free(pool);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 3) {
+    printf("Usage: parallel_iterator_benchmark <number of elements> <max number of workers>\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t size = (size_t) atol(argv[1]);
+  size_t max_workers = (size_t) atol(argv[2]);
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "parallel_iterator_functions");
+  PrintTime_add_header(pt, "elements", argv[1]);
+
+  Array* array = Array_new(size > 0 ? size : 1);
+  ArrayAlt* array_alt = ArrayAlt_new(size > 0 ? size : 1, sizeof(double));
+  KeyInfo* key_info = KeyInfo_new(Key_double_compare, Key_double_hash);
+  Dictionary* dictionary = Dictionary_new(key_info);
+  for(size_t i = 0; i < size; ++i) {
+    double x = (double) i;
+    Array_add(array, (void*) i);
+    ArrayAlt_add(array_alt, &x);
+  }
+
+  // the keys are stored by the array, which is not resized anymore
+  for(size_t i = 0; i < size; ++i) {
+    Dictionary_set(dictionary, ArrayAlt_at(array_alt, i), NULL);
+  }
+
+  run_experiment(pt, "Array_it", ^{ return Array_it(array); }, ^double(void* elem) {
+    return (double) (size_t) elem;
+  }, max_workers);
+
+  run_experiment(pt, "ArrayAlt_it", ^{ return ArrayAlt_it(array_alt); }, ^double(void* elem) {
+    return *(double*) elem;
+  }, max_workers);
+
+  run_experiment(pt, "Number_it", ^{ return Number_it(size); }, ^double(void* elem) {
+    return (double) UNUM(elem);
+  }, max_workers);
+
+  run_split_experiment(pt, "Dictionary_key_it", ^{ return Dictionary_key_it(dictionary); }, ^double(void* elem) {
+    return *(double*) elem;
+  }, max_workers);
+
+  Dictionary_free(dictionary);
+  KeyInfo_free(key_info);
+  Array_free(array);
+  ArrayAlt_free(array_alt);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
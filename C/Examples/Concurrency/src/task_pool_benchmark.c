@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <math.h>
+
+#include "task_pool.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures the scheduling overhead of TaskPool: the cost of spawning and running
+// empty tasks from outside the pool (shared queue) and from inside the pool (worker
+// deques), the cost of parallel_for ranges with an empty body, and the speedup of
+// parallel_for over a sequential loop on a small computation per element.
+
+static void print_per_item(double elapsed, size_t count, const char* unit) {
+  printf("per %s: " GRN "%.1lf ns\n\n" reset, unit, elapsed * 1e9 / (double) count);
+}
+
+static void run_experiment(PrintTime* pt, size_t num_workers, size_t num_tasks) {
+  char label[128];
+  TaskPool* pool = TaskPool_new(num_workers);
+  _Atomic size_t count = 0;
+  _Atomic size_t* count_ptr = &count;
+
+  snprintf(label, 128, "workers: %ld external spawn", num_workers);
+  double elapsed = PrintTime_print(pt, label, ^{
+    for(size_t i = 0; i < num_tasks; ++i) {
+      TaskPool_spawn(pool, ^{
+        atomic_fetch_add_explicit(count_ptr, 1, memory_order_relaxed);
+      });
+    }
+    TaskPool_wait(pool);
+  });
+  print_per_item(elapsed, num_tasks, "task");
+
+  // a single task spawns all the others on its worker deque, idle workers steal them
+  snprintf(label, 128, "workers: %ld internal spawn", num_workers);
+  elapsed = PrintTime_print(pt, label, ^{
+    TaskPool_spawn(pool, ^{
+      for(size_t i = 0; i < num_tasks; ++i) {
+        TaskPool_spawn(pool, ^{
+          atomic_fetch_add_explicit(count_ptr, 1, memory_order_relaxed);
+        });
+      }
+    });
+    TaskPool_wait(pool);
+  });
+  print_per_item(elapsed, num_tasks, "task");
+
+  snprintf(label, 128, "workers: %ld parallel_for empty ranges", num_workers);
+  elapsed = PrintTime_print(pt, label, ^{
+    parallel_for(pool, num_tasks, 1, ^(size_t from, size_t to) {
+      atomic_fetch_add_explicit(count_ptr, to - from, memory_order_relaxed);
+    });
+  });
+  print_per_item(elapsed, num_tasks, "range");
+
+  if(atomic_load(&count) != 3 * num_tasks) {
+    Error_raise(Error_new(ERROR_GENERIC, "Run %ld tasks out of %ld", atomic_load(&count), 3 * num_tasks));
+  }
+
+  double* values = (double*) Mem_alloc(sizeof(double) * num_tasks);
+
+  snprintf(label, 128, "workers: %ld sequential loop", num_workers);
+  double sequential = PrintTime_print(pt, label, ^{
+    for(size_t i = 0; i < num_tasks; ++i) {
+      values[i] = sqrt((double) i) * sin((double) i);
+    }
+  });
+
+  snprintf(label, 128, "workers: %ld parallel_for loop", num_workers);
+  double parallel = PrintTime_print(pt, label, ^{
+    parallel_for(pool, num_tasks, 0, ^(size_t from, size_t to) {
+      for(size_t i = from; i < to; ++i) {
+        values[i] = sqrt((double) i) * sin((double) i);
+      }
+    });
+  });
+  printf("speedup: " GRN "%.2lf\n\n" reset, sequential / parallel);
+
+  Mem_free(values);
+  TaskPool_free(pool);
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 3) {
+    printf("Usage: task_pool_benchmark <number of tasks> <max number of workers>\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t num_tasks = (size_t) atol(argv[1]);
+  size_t max_workers = (size_t) atol(argv[2]);
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "task_pool");
+  PrintTime_add_header(pt, "tasks", argv[1]);
+
+  for(size_t workers = 1; workers <= max_workers; workers *= 2) {
+    run_experiment(pt, workers, num_tasks);
+  }
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
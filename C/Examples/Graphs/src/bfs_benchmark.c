@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "graph_visiting.h"
+#include "queue.h"
+#include "list.h"
+#include "keys.h"
+#include "mem.h"
+#include "macros.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+#include "errors.h"
+
+// Measures breadth first visits on a generated grid graph (side x side vertices,
+// each vertex connected to its 4 neighbours) and compares the ring buffer based
+// Queue with the List based queue it replaced.
+
+static Graph* build_grid_graph(int* vertices, size_t side) {
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+  Graph* graph = Graph_new(key_info);
+
+  for(size_t i = 0; i < side * side; ++i) {
+    vertices[i] = (int) i;
+    Graph_add_vertex(graph, &vertices[i]);
+  }
+
+  for(size_t row = 0; row < side; ++row) {
+    for(size_t col = 0; col < side; ++col) {
+      size_t v = row * side + col;
+      if(col + 1 < side) {
+        Graph_add_edge(graph, &vertices[v], &vertices[v + 1], NULL);
+        Graph_add_edge(graph, &vertices[v + 1], &vertices[v], NULL);
+      }
+      if(row + 1 < side) {
+        Graph_add_edge(graph, &vertices[v], &vertices[v + side], NULL);
+        Graph_add_edge(graph, &vertices[v + side], &vertices[v], NULL);
+      }
+    }
+  }
+
+  return graph;
+}
+
+// Same access pattern of the List based Queue implementation
+static void list_queue_round_trips(size_t n) {
+  List* list = List_new();
+  for(size_t i = 0; i < n; ++i) {
+    List_insert(list, (void*) i);
+    if(i % 2 == 0) {
+      List_delete_node(list, List_tail(list));
+    }
+  }
+  while(!List_empty(list)) {
+    List_delete_node(list, List_tail(list));
+  }
+  List_free(list, NULL);
+}
+
+static void queue_round_trips(size_t n) {
+  Queue* queue = Queue_new();
+  for(size_t i = 0; i < n; ++i) {
+    Queue_enqueue(queue, (void*) i);
+    if(i % 2 == 0) {
+      Queue_dequeue(queue);
+    }
+  }
+  while(!Queue_empty(queue)) {
+    Queue_dequeue(queue);
+  }
+  Queue_free(queue);
+}
+
+static void queue_batch_round_trips(size_t n) {
+  void* batch[64];
+  Queue* queue = Queue_new();
+  for(size_t i = 0; i < n; i += 64) {
+    for(size_t j = 0; j < 64; ++j) {
+      batch[j] = (void*) (i + j);
+    }
+    Queue_enqueue_many(queue, batch, 64);
+    Queue_dequeue_many(queue, batch, 32);
+  }
+  while(Queue_dequeue_many(queue, batch, 64) > 0);
+  Queue_free(queue);
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 2) {
+    printf("Usage: bfs_benchmark <grid side>\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t side = (size_t) atol(argv[1]);
+  size_t num_vertices = side * side;
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "bfs");
+  PrintTime_add_header(pt, "grid_side", argv[1]);
+
+  int* vertices = (int*) Mem_alloc(sizeof(int) * num_vertices);
+  __block Graph* graph = NULL;
+
+  PrintTime_print(pt, "Graph_build", ^{
+    graph = build_grid_graph(vertices, side);
+    printf("Graph size: " GRN "%ld\n" reset, Graph_size(graph));
+  });
+
+  PrintTime_print(pt, "BFS", ^{
+    VisitingInfo* info = VisitingInfo_new(graph);
+    __block size_t visited = 0;
+    Graph_breadth_first_visit(info, &vertices[0], ^(void* UNUSED(vertex)) {
+      visited += 1;
+    });
+    VisitingInfo_free(info);
+    printf("Visited vertices: " GRN "%ld\n" reset, visited);
+  });
+
+  PrintTime_print(pt, "List_queue_round_trips", ^{
+    list_queue_round_trips(num_vertices);
+  });
+
+  PrintTime_print(pt, "Queue_round_trips", ^{
+    queue_round_trips(num_vertices);
+  });
+
+  PrintTime_print(pt, "Queue_batch_round_trips", ^{
+    queue_batch_round_trips(num_vertices);
+  });
+
+  KeyInfo* key_info = Graph_keyInfo(graph);
+  Graph_free(graph);
+  KeyInfo_free(key_info);
+  Mem_free(vertices);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
@@ -225,6 +225,27 @@ static void execute_print_graphviz(Graph* graph) {
   fclose(file);
 }
 
+static void execute_edge_traversal(Graph* graph, size_t graph_memory) {
+  size_t num_vertices = Graph_size(graph);
+  if(graph_memory > 0) {
+    printf("Memory per vertex: " GRN "%.1lf bytes\n" reset, (double) graph_memory / (double) num_vertices);
+  } else {
+    printf("Memory per vertex: compile with -DDEBUG to collect memory statistics\n");
+  }
+
+  __block double total_len = 0.0;
+  __block size_t num_edges = 0;
+  for(int i = 0; i < 10; ++i) {
+    for_each(Edge_it(graph), ^(void* obj) {
+      EdgeInfo* ei = (EdgeInfo*) obj;
+      total_len += DoubleContainer_get(ei->info);
+      num_edges += 1;
+    });
+  }
+
+  printf("Traversed edges: " GRN "%ld" reset " (total length: %f)\n", num_edges, total_len / 1000.0);
+}
+
 static void print_usage(const char* msg) {
   printf("%s\n\n",msg);
   printf("Usage: measure_times <op specifier> <graph file name> <source> <dest>\n");
@@ -235,7 +256,8 @@ static void print_usage(const char* msg) {
   printf("  -b: to find connected components using bfs\n");
   printf("  -k: to invoke kruskal\n");
   printf("  -p: to invoke prim\n");
-  printf("  -P: to print the graph in graphviz format");
+  printf("  -P: to print the graph in graphviz format\n");
+  printf("  -m: to report memory per vertex and to traverse all edges 10 times");
 }
 
 static void check_arguments(int argc, char* argv[]) {
@@ -249,8 +271,8 @@ static void check_arguments(int argc, char* argv[]) {
     exit(ERROR_ARGUMENT_PARSING);
   }
   char op = argv[1][1];
-  if(op!='d' && op!='e' && op!='c' && op!='b' && op!='k' && op!='p' && op!='P') {
-    print_usage("Op specifier needs to be one of {-d,-e,-c,-b,-k,-p,-P}");
+  if(op!='d' && op!='e' && op!='c' && op!='b' && op!='k' && op!='p' && op!='P' && op!='m') {
+    print_usage("Op specifier needs to be one of {-d,-e,-c,-b,-k,-p,-P,-m}");
     exit(ERROR_ARGUMENT_PARSING);
   }
 
@@ -260,6 +282,7 @@ static void check_arguments(int argc, char* argv[]) {
     case 'k':
     case 'p':
     case 'P':
+    case 'm':
       if(argc != 3) {
         print_usage("Wrong number of arguments - expected 3");
         exit(ERROR_ARGUMENT_PARSING);
@@ -286,6 +309,7 @@ static char* flag_to_task_name(char ch) {
     case 'k': return "kruskal";
     case 'p': return "prim";
     case 'P': return "print graph in graphviz format";
+    case 'm': return "edge_traversal";
     default:
       printf("Unknown flag");
       exit(ERROR_ARGUMENT_PARSING);
@@ -336,12 +360,17 @@ int main(int argc, char *argv[]) {
 
 
   __block Graph* graph;
+  MemStats mem_before_load = Mem_stats();
   PrintTime_print(pt, "Graph_load", ^{
     printf("Loading graph...\n");
     graph = load_graph(argv[2]);
     printf("Graph size: " GRN "%ld\n" reset, Graph_size(graph));
   });
 
+  MemStats mem_after_load = Mem_stats();
+  size_t graph_memory = (mem_after_load.alloced_memory - mem_after_load.freed_memory) -
+                        (mem_before_load.alloced_memory - mem_before_load.freed_memory);
+
   PrintTime_print(pt, "Algorithm_execution", ^{
     switch(argv[1][1]) {
       case 'd':
@@ -372,6 +401,10 @@ int main(int argc, char *argv[]) {
         printf("Executing prim...\n");
         execute_prim(graph);
         break;
+      case 'm':
+        printf("Traversing edges...\n");
+        execute_edge_traversal(graph, graph_memory);
+        break;
     }
   });
 
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "array_alt.h"
+#include "deque.h"
+#include "list.h"
+#include "basic_iterators.h"
+#include "iterator_functions.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures the throughput (elements per second) of for_each and find_first over each container
+// when the iteration functions use the spans/batches returned by the iterator and when they are
+// forced to fall back to the end/get/next protocol.
+
+// Iterators are built anew for each measure since some of them (e.g., CArray_it) are one-shot.
+typedef Iterator (^IteratorMaker)(void);
+
+// Returns a copy of it not providing spans and batches
+static Iterator without_spans(Iterator it) {
+  it.next_span = NULL;
+  it.next_batch = NULL;
+
+  return it;
+}
+
+static double measure(PrintTime* pt, const char* container, const char* function, const char* protocol, size_t size, void (^fun)(void)) {
+  char label[128];
+  snprintf(label, 128, "%s: %s (%s)", container, function, protocol);
+
+  double elapsed = PrintTime_print(pt, label, fun);
+  printf("elements per second: " GRN "%.2lf M\n\n" reset, (double) size / elapsed / 1e6);
+
+  return elapsed;
+}
+
+static void run_experiment(PrintTime* pt, const char* container, IteratorMaker make_it, size_t (^value)(void*), size_t size) {
+  __block size_t sum = 0;
+  __block size_t sum_fallback = 0;
+
+  double fast = measure(pt, container, "for_each", "spans/batches", size, ^{
+    for_each(make_it(), ^(void* elem) {
+      sum += value(elem);
+    });
+  });
+
+  double slow = measure(pt, container, "for_each", "end/get/next", size, ^{
+    for_each(without_spans(make_it()), ^(void* elem) {
+      sum_fallback += value(elem);
+    });
+  });
+
+  if(sum != sum_fallback) {
+    Error_raise(Error_new(ERROR_GENERIC, "Different results using spans and not using spans"));
+  }
+  printf("%s for_each gain: " GRN "%.2lfx\n\n" reset, container, slow / fast);
+
+  // no element is equal to size: find_first scans the whole container
+  fast = measure(pt, container, "find_first", "spans/batches", size, ^{
+    find_first(make_it(), ^int(void* elem) {
+      return value(elem) == size;
+    });
+  });
+
+  slow = measure(pt, container, "find_first", "end/get/next", size, ^{
+    find_first(without_spans(make_it()), ^int(void* elem) {
+      return value(elem) == size;
+    });
+  });
+  printf("%s find_first gain: " GRN "%.2lfx\n\n" reset, container, slow / fast);
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 2) {
+    printf("Usage: batch_benchmark <number of elements>\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t size = (size_t) atol(argv[1]);
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "batch_iteration");
+  PrintTime_add_header(pt, "size", argv[1]);
+
+  Array* array = Array_new(size > 0 ? size : 1);
+  ArrayAlt* array_alt = ArrayAlt_new(size > 0 ? size : 1, sizeof(size_t));
+  Deque* deque = Deque_new(size > 0 ? size : 1);
+  List* list = List_new();
+
+  for(size_t i = 0; i < size; ++i) {
+    Array_add(array, (void*) i);
+    ArrayAlt_add(array_alt, &i);
+    Deque_push_back(deque, (void*) i);
+    List_append(list, (void*) i);
+  }
+
+  size_t (^pointer_value)(void*) = ^size_t(void* elem) {
+    return (size_t) elem;
+  };
+  size_t (^stored_value)(void*) = ^size_t(void* elem) {
+    return *(size_t*) elem;
+  };
+
+  run_experiment(pt, "Array", ^{ return Array_it(array); }, pointer_value, size);
+  run_experiment(pt, "ArrayAlt", ^{ return ArrayAlt_it(array_alt); }, stored_value, size);
+  run_experiment(pt, "CArray", ^{ return CArray_it(ArrayAlt_carray(array_alt), size, sizeof(size_t)); }, stored_value, size);
+  run_experiment(pt, "Deque", ^{ return Deque_it(deque); }, pointer_value, size);
+  run_experiment(pt, "List", ^{ return List_it(list); }, pointer_value, size);
+
+  Array_free(array);
+  ArrayAlt_free(array_alt);
+  Deque_free(deque);
+  List_free(list, NULL);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
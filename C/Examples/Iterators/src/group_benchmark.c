@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "group_aggregate.h"
+#include "parallel_iterator_functions.h"
+#include "iterator_functions.h"
+#include "exsorting_dataset.h"
+#include "dictionary.h"
+#include "keys.h"
+#include "errors.h"
+#include "macros.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures the count and the average of field3 grouped by field1 over records.csv, using a loop
+// of Dictionary_get and Dictionary_set, group_aggregate and par_group_aggregate.
+
+typedef struct {
+  long count;
+  double sum;
+} Average;
+
+static void* record_field1(void* record) {
+  return ((Record*) record)->field1;
+}
+
+static void* new_average(UNUSED(void* key)) {
+  return Mem_calloc(1, sizeof(Average));
+}
+
+static void* add_to_average(void* aggregate, void* record) {
+  Average* average = (Average*) aggregate;
+  average->count += 1;
+  average->sum += ((Record*) record)->field3;
+
+  return average;
+}
+
+static void* merge_averages(void* aggregate, void* partial) {
+  Average* average = (Average*) aggregate;
+  average->count += ((Average*) partial)->count;
+  average->sum += ((Average*) partial)->sum;
+  Mem_free(partial);
+
+  return average;
+}
+
+static void free_averages(Dictionary* averages) {
+  for_each(Dictionary_it(averages), ^(void* elem) {
+    Mem_free(((KeyValue*) elem)->value);
+  });
+  Dictionary_free(averages);
+}
+
+// Returns the sum of the counts, which needs to be the number of records
+static long total_count(Dictionary* averages) {
+  __block long total = 0;
+  for_each(Dictionary_it(averages), ^(void* elem) {
+    total += ((Average*) ((KeyValue*) elem)->value)->count;
+  });
+
+  return total;
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 2) {
+    printf("Usage: group_benchmark <path to records.csv>\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "group_aggregate");
+
+  __block Array* records = NULL;
+  PrintTime_print(pt, "loading records", ^{
+    records = ExSortingDataset_load(argv[1]);
+  });
+
+  KeyInfo* key_info = KeyInfo_new(Key_string_compare, Key_string_hash);
+  TaskPool* pool = TaskPool_new(0);
+  __block Dictionary* by_hand = NULL;
+  __block Dictionary* sequential = NULL;
+  __block Dictionary* parallel = NULL;
+
+  double hand_time = PrintTime_print(pt, "Dictionary_get/Dictionary_set loop", ^{
+    by_hand = Dictionary_new(key_info);
+    for_each(Array_it(records), ^(void* record) {
+      void* average;
+      if(!Dictionary_get(by_hand, record_field1(record), &average)) {
+        average = new_average(NULL);
+        Dictionary_set(by_hand, record_field1(record), average);
+      }
+      add_to_average(average, record);
+    });
+  });
+
+  double sequential_time = PrintTime_print(pt, "group_aggregate", ^{
+    sequential = group_aggregate(Array_it(records), ^void*(void* record) {
+      return record_field1(record);
+    }, key_info, ^void*(void* key) {
+      return new_average(key);
+    }, ^void*(void* aggregate, void* record) {
+      return add_to_average(aggregate, record);
+    });
+  });
+
+  double parallel_time = PrintTime_print(pt, "par_group_aggregate", ^{
+    parallel = par_group_aggregate(pool, Array_it(records), 0, ^void*(void* record) {
+      return record_field1(record);
+    }, key_info, ^void*(void* key) {
+      return new_average(key);
+    }, ^void*(void* aggregate, void* record) {
+      return add_to_average(aggregate, record);
+    }, ^void*(void* aggregate, void* partial) {
+      return merge_averages(aggregate, partial);
+    });
+  });
+
+  long num_records = (long) Array_size(records);
+  if(Dictionary_size(by_hand) != Dictionary_size(sequential) || Dictionary_size(by_hand) != Dictionary_size(parallel) ||
+      total_count(sequential) != num_records || total_count(parallel) != num_records) {
+    Error_raise(Error_new(ERROR_GENERIC, "The aggregations returned different groups"));
+  }
+
+  printf("%ld groups, speedup of group_aggregate: " GRN "%.2lfx" reset " par_group_aggregate: " GRN "%.2lfx\n" reset, (long) Dictionary_size(sequential), hand_time / sequential_time, hand_time / parallel_time);
+
+  free_averages(by_hand);
+  free_averages(sequential);
+  free_averages(parallel);
+  TaskPool_free(pool);
+  KeyInfo_free(key_info);
+  ExSortingDataset_free(records);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "basic_iterators.h"
+#include "iterator_functions.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures the cost of many short iterations (as the duplicate checks of Graph_add_edge do)
+// when the iteration functions place the iterator instances on their stack and when they
+// allocate them on the heap.
+
+typedef Iterator (^IteratorMaker)(void);
+
+// Returns a copy of it whose instances are allocated by new_iterator
+static Iterator on_heap(Iterator it) {
+  it.init_iterator = NULL;
+  it.deinit_iterator = NULL;
+
+  return it;
+}
+
+static void run_experiment(PrintTime* pt, const char* container, IteratorMaker make_it, size_t repetitions) {
+  char label[128];
+  __block size_t found = 0;
+  __block size_t found_on_heap = 0;
+
+  snprintf(label, 128, "%s: find_first (inline instances)", container);
+  double fast = PrintTime_print(pt, label, ^{
+    for(size_t i = 0; i < repetitions; ++i) {
+      found += find_first(make_it(), ^int(void* elem) { return elem == NULL; }) == NULL;
+    }
+  });
+
+  snprintf(label, 128, "%s: find_first (heap instances)", container);
+  double slow = PrintTime_print(pt, label, ^{
+    for(size_t i = 0; i < repetitions; ++i) {
+      found_on_heap += find_first(on_heap(make_it()), ^int(void* elem) { return elem == NULL; }) == NULL;
+    }
+  });
+
+  if(found != found_on_heap) {
+    Error_raise(Error_new(ERROR_GENERIC, "Different results using inline and heap instances"));
+  }
+
+  printf("%s gain: " GRN "%.2lfx\n\n" reset, container, slow / fast);
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 3) {
+    printf("Usage: inline_benchmark <number of elements> <number of repetitions>\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t size = (size_t) atol(argv[1]);
+  size_t repetitions = (size_t) atol(argv[2]);
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "inline_iterators");
+  PrintTime_add_header(pt, "size", argv[1]);
+
+  Array* array = Array_new(size > 0 ? size : 1);
+  for(size_t i = 1; i <= size; ++i) {
+    Array_add(array, (void*) i);
+  }
+
+  run_experiment(pt, "Array", ^{ return Array_it(array); }, repetitions);
+  run_experiment(pt, "Number", ^{ return Number_it(size); }, repetitions);
+
+  Array_free(array);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hash_join.h"
+#include "parallel_iterator_functions.h"
+#include "iterator_functions.h"
+#include "array.h"
+#include "keys.h"
+#include "errors.h"
+#include "macros.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures the join of a generated lookup table with a larger table referencing it using nested
+// find_first calls (on a sample of the probe side, the time is then scaled), hash_join,
+// radix_hash_join and par_hash_join.
+
+// Number of probe elements joined by the nested loops
+#define NESTED_SAMPLE 1000
+
+typedef struct {
+  int id;
+  // number of rows of the other table joined with this one
+  int matches;
+} Row;
+
+static void* row_id(void* row) {
+  return &((Row*) row)->id;
+}
+
+// Rows with the given ids in random order, each one repeated size / num_ids times
+static Row* build_rows(size_t size, size_t num_ids) {
+  Row* rows = (Row*) Mem_alloc(sizeof(Row) * (size > 0 ? size : 1));
+  for(size_t i = 0; i < size; ++i) {
+    rows[i].id = (int) (i % num_ids);
+    rows[i].matches = 0;
+  }
+
+  for(size_t i = size; i > 1; --i) {
+    size_t j = (size_t) rand() % i;
+    Row tmp = rows[i - 1];
+    rows[i - 1] = rows[j];
+    rows[j] = tmp;
+  }
+
+  return rows;
+}
+
+static Array* rows_array(Row* rows, size_t size) {
+  Array* array = Array_new(size > 0 ? size : 1);
+  for(size_t i = 0; i < size; ++i) {
+    Array_add(array, &rows[i]);
+  }
+
+  return array;
+}
+
+// Checks that each probe row has been joined with exactly one lookup row, then resets the counts
+static void check_matches(const char* join, Row* rows, size_t size) {
+  for(size_t i = 0; i < size; ++i) {
+    if(rows[i].matches != 1) {
+      Error_raise(Error_new(ERROR_GENERIC, "%s: row %ld has been joined with %d rows", join, i, rows[i].matches));
+    }
+    rows[i].matches = 0;
+  }
+}
+
+// Each probe row is joined with a single lookup row, so that the callbacks of par_hash_join never
+// update the same row concurrently
+static void (^count_match)(void*, void*) = ^(UNUSED(void* build_row), void* probe_row) {
+  ((Row*) probe_row)->matches += 1;
+};
+
+int main(int argc, char* argv[]) {
+  if(argc != 3) {
+    printf("Usage: join_benchmark <number of lookup rows> <number of probe rows> (e.g., 1000000 10000000)\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t build_size = (size_t) atol(argv[1]);
+  size_t probe_size = (size_t) atol(argv[2]);
+  if(build_size == 0) {
+    printf("The lookup table needs at least one row\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "hash_join");
+  PrintTime_add_header(pt, "build", argv[1]);
+  PrintTime_add_header(pt, "probe", argv[2]);
+
+  // each probe row matches exactly one lookup row
+  Row* build_rows_ = build_rows(build_size, build_size);
+  Row* probe_rows = build_rows(probe_size, build_size);
+  Array* build = rows_array(build_rows_, build_size);
+  Array* probe = rows_array(probe_rows, probe_size);
+  Array* sample = rows_array(probe_rows, probe_size < NESTED_SAMPLE ? probe_size : NESTED_SAMPLE);
+
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+  TaskPool* pool = TaskPool_new(0);
+
+  double nested = PrintTime_print(pt, "nested find_first (sample)", ^{
+    for_each(Array_it(sample), ^(void* probe_row) {
+      int id = ((Row*) probe_row)->id;
+      void* build_row = find_first(Array_it(build), ^int(void* row) {
+        return ((Row*) row)->id == id;
+      });
+      count_match(build_row, probe_row);
+    });
+  });
+  size_t sample_size = Array_size(sample);
+  nested *= (double) probe_size / (double) sample_size;
+  check_matches("nested find_first", probe_rows, sample_size);
+
+  double hash = PrintTime_print(pt, "hash_join", ^{
+    hash_join(Array_it(build), Array_it(probe), key_info, ^void*(void* row) {
+      return row_id(row);
+    }, ^void*(void* row) {
+      return row_id(row);
+    }, count_match);
+  });
+  check_matches("hash_join", probe_rows, probe_size);
+
+  double radix = PrintTime_print(pt, "radix_hash_join", ^{
+    radix_hash_join(Array_it(build), Array_it(probe), key_info, ^void*(void* row) {
+      return row_id(row);
+    }, ^void*(void* row) {
+      return row_id(row);
+    }, count_match);
+  });
+  check_matches("radix_hash_join", probe_rows, probe_size);
+
+  double parallel = PrintTime_print(pt, "par_hash_join", ^{
+    par_hash_join(pool, Array_it(build), Array_it(probe), 0, key_info, ^void*(void* row) {
+      return row_id(row);
+    }, ^void*(void* row) {
+      return row_id(row);
+    }, count_match);
+  });
+  check_matches("par_hash_join", probe_rows, probe_size);
+
+  printf("speedup over nested find_first (estimated %.2lfs): hash_join " GRN "%.2lfx" reset " radix_hash_join " GRN "%.2lfx" reset " par_hash_join " GRN "%.2lfx\n" reset, nested, nested / hash, nested / radix, nested / parallel);
+
+  TaskPool_free(pool);
+  KeyInfo_free(key_info);
+  Array_free(sample);
+  Array_free(build);
+  Array_free(probe);
+  Mem_free(build_rows_);
+  Mem_free(probe_rows);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
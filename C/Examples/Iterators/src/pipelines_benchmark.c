@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "array.h"
+#include "basic_iterators.h"
+#include "iterator_functions.h"
+#include "iterator_adapters.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Compares multi-stage pipelines built using the eager iterator functions (filter and map
+// store their results into new Arrays) against the same pipelines built using the lazy
+// adapters of iterator_adapters.h (a single pass, no intermediate storage):
+//
+//  - Array_it: keeps the odd numbers, multiplies them by 3, sums them up;
+//  - TextFile_it: keeps the non empty lines, computes their lengths, sums them up. The eager
+//    version needs to copy the lines first since TextFile_it reuses its line buffer.
+
+static void check_results(size_t eager, size_t lazy) {
+  if(eager != lazy) {
+    Error_raise(Error_new(ERROR_GENERIC, "Eager and lazy results differ: %ld != %ld", eager, lazy));
+  }
+
+  printf("result: " GRN "%ld\n\n" reset, lazy);
+}
+
+static void run_array_experiment(PrintTime* pt, size_t size) {
+  Array* array = Array_new(size);
+  for(size_t i = 0; i < size; ++i) {
+    Array_add(array, (void*) i);
+  }
+
+  __block size_t eager_sum = 0;
+  PrintTime_print(pt, "array: eager filter/map/for_each", ^{
+    Array* odds = filter(Array_it(array), ^int(void* elem) {
+      return (size_t) elem % 2 == 1;
+    });
+    Array* tripled = map(Array_it(odds), ^void*(void* elem) {
+      return (void*) ((size_t) elem * 3);
+    });
+    for_each(Array_it(tripled), ^(void* elem) {
+      eager_sum += (size_t) elem;
+    });
+
+    Array_free(odds);
+    Array_free(tripled);
+  });
+
+  __block size_t lazy_sum = 0;
+  PrintTime_print(pt, "array: lazy filter_it/map_it/for_each", ^{
+    Iterator odds = filter_it(Array_it(array), ^int(void* elem) {
+      return (size_t) elem % 2 == 1;
+    });
+    for_each(map_it(odds, ^void*(void* elem) {
+      return (void*) ((size_t) elem * 3);
+    }), ^(void* elem) {
+      lazy_sum += (size_t) elem;
+    });
+  });
+
+  check_results(eager_sum, lazy_sum);
+  Array_free(array);
+}
+
+static void run_text_file_experiment(PrintTime* pt, const char* filename) {
+  __block size_t eager_total = 0;
+  PrintTime_print(pt, "text file: eager map/filter/map/for_each", ^{
+    Array* lines = map(TextFile_it(filename, '\n'), ^void*(void* line) {
+      return Mem_strdup((char*) line);
+    });
+    Array* non_empty = filter(Array_it(lines), ^int(void* line) {
+      return ((char*) line)[0] != '\0';
+    });
+    Array* lengths = map(Array_it(non_empty), ^void*(void* line) {
+      size_t length = strlen((char*) line);
+      return (void*) length;
+    });
+    for_each(Array_it(lengths), ^(void* length) {
+      eager_total += (size_t) length;
+    });
+
+    for_each(Array_it(lines), ^(void* line) {
+      Mem_free(line);
+    });
+    Array_free(lines);
+    Array_free(non_empty);
+    Array_free(lengths);
+  });
+
+  __block size_t lazy_total = 0;
+  PrintTime_print(pt, "text file: lazy filter_it/map_it/for_each", ^{
+    Iterator non_empty = filter_it(TextFile_it(filename, '\n'), ^int(void* line) {
+      return ((char*) line)[0] != '\0';
+    });
+    for_each(map_it(non_empty, ^void*(void* line) {
+      size_t length = strlen((char*) line);
+      return (void*) length;
+    }), ^(void* length) {
+      lazy_total += (size_t) length;
+    });
+  });
+
+  check_results(eager_total, lazy_total);
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 3) {
+    printf("Usage: pipelines_benchmark <array size> <text file>\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t size = (size_t) atol(argv[1]);
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "pipelines");
+  PrintTime_add_header(pt, "size", argv[1]);
+  PrintTime_add_header(pt, "file", argv[2]);
+
+  run_array_experiment(pt, size);
+  run_text_file_experiment(pt, argv[2]);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iterator_instrumentation.h"
+#include "iterator_adapters.h"
+#include "iterator_functions.h"
+#include "basic_iterators.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Profiles a pipeline summing the third field of the lines of a csv file (e.g., records.csv) whose
+// second field starts with the given prefix. Each stage is instrumented: the report tells the
+// time spent reading the file, filtering and parsing the lines and in the block given to for_each
+// (the time inside each stage includes the time of the stages it reads from). The pipeline is run
+// with and without instrumentation to measure its overhead.
+
+// Returns the pointer to the given field of a line (fields are separated by commas)
+static const char* field(const char* line, size_t index) {
+  for(; index > 0 && line != NULL; --index) {
+    line = strchr(line, ',');
+    line = line != NULL ? line + 1 : NULL;
+  }
+
+  return line != NULL ? line : "";
+}
+
+static double run_pipeline(const char* file_name, const char* prefix, int instrumented) {
+  Iterator lines = TextFile_it(file_name, '\n');
+  Iterator selected = filter_it(instrumented ? instrument_it(lines, "read") : lines, ^int(void* line) {
+    return strncmp(field((char*) line, 1), prefix, strlen(prefix)) == 0;
+  });
+  Iterator values = map_it(instrumented ? instrument_it(selected, "filter") : selected, ^void*(void* line) {
+    double* value = (double*) Mem_alloc(sizeof(double));
+    *value = strtod(field((char*) line, 3), NULL);
+    return value;
+  });
+
+  __block double sum = 0.0;
+  for_each(instrumented ? instrument_it(values, "parse") : values, ^(void* value) {
+    sum += *(double*) value;
+    Mem_free(value);
+  });
+
+  return sum;
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 3) {
+    printf("Usage: profile_pipeline <path to records.csv> <prefix of field1> (e.g., records.csv a)\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "profile_pipeline");
+  __block double plain_sum = 0.0;
+  __block double instrumented_sum = 0.0;
+
+  double plain = PrintTime_print(pt, "pipeline", ^{
+    plain_sum = run_pipeline(argv[1], argv[2], 0);
+  });
+
+  double instrumented = PrintTime_print(pt, "instrumented pipeline", ^{
+    instrumented_sum = run_pipeline(argv[1], argv[2], 1);
+  });
+
+  if(plain_sum > instrumented_sum || plain_sum < instrumented_sum) {
+    Error_raise(Error_new(ERROR_GENERIC, "The pipelines computed different sums"));
+  }
+
+  Instrumentation_print_report();
+  Instrumentation_save_report(pt);
+  printf("\nsum: %lf, instrumentation overhead: " GRN "%.1lf%%\n" reset, plain_sum, (instrumented / plain - 1.0) * 100.0);
+
+  Instrumentation_reset();
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
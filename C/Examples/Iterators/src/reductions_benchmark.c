@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "numeric_reductions.h"
+#include "basic_iterators.h"
+#include "iterator_functions.h"
+#include "array_alt.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures the numeric kernels of numeric_reductions.h against for_each with a block
+// accumulating the same result, over CArray_it and ArrayAlt_it. Compile the library with
+// -mavx2 (see Makefile.vars) to measure the AVX2 kernels instead of the SSE2 ones.
+
+typedef double (^Computation)(void);
+
+static void run_experiment(PrintTime* pt, const char* name, Computation for_each_version, Computation kernel_version) {
+  char label[128];
+  __block double expected = 0;
+  __block double result = 0;
+
+  snprintf(label, 128, "%s: for_each", name);
+  double slow = PrintTime_print(pt, label, ^{
+    expected = for_each_version();
+  });
+
+  snprintf(label, 128, "%s: kernel", name);
+  double fast = PrintTime_print(pt, label, ^{
+    result = kernel_version();
+  });
+
+  // floating point sums are reordered by the kernels
+  if(fabs(result - expected) > 1e-6 * fabs(expected)) {
+    Error_raise(Error_new(ERROR_GENERIC, "%s: the kernel returned %lf instead of %lf", name, result, expected));
+  }
+
+  printf("%s speedup: " GRN "%.2lfx\n\n" reset, name, slow / fast);
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 2) {
+    printf("Usage: reductions_benchmark <number of elements> (e.g., 100000000)\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t size = (size_t) atol(argv[1]);
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "numeric_reductions");
+  PrintTime_add_header(pt, "elements", argv[1]);
+
+  int32_t* ints = (int32_t*) Mem_alloc(sizeof(int32_t) * size);
+  int64_t* longs = (int64_t*) Mem_alloc(sizeof(int64_t) * size);
+  float* floats = (float*) Mem_alloc(sizeof(float) * size);
+  ArrayAlt* doubles = ArrayAlt_new(size > 0 ? size : 1, sizeof(double));
+  for(size_t i = 0; i < size; ++i) {
+    double x = (double) (rand() % 2000 - 1000) / 16;
+    ints[i] = (int32_t) rand() - RAND_MAX / 2;
+    longs[i] = ((int64_t) rand() - RAND_MAX / 2) * 4096;
+    floats[i] = (float) x;
+    ArrayAlt_add(doubles, &x);
+  }
+
+  run_experiment(pt, "int32 sum", ^double{
+    __block int64_t sum = 0;
+    for_each(CArray_it(ints, size, sizeof(int32_t)), ^(void* elem) {
+      sum += *(int32_t*) elem;
+    });
+    return (double) sum;
+  }, ^double{
+    int64_t sum = iterator_sum_int32(CArray_it(ints, size, sizeof(int32_t)));
+    return (double) sum;
+  });
+
+  run_experiment(pt, "int32 max", ^double{
+    __block int32_t max = INT32_MIN;
+    for_each(CArray_it(ints, size, sizeof(int32_t)), ^(void* elem) {
+      max = *(int32_t*) elem > max ? *(int32_t*) elem : max;
+    });
+    return (double) max;
+  }, ^double{
+    int32_t max = iterator_max_int32(CArray_it(ints, size, sizeof(int32_t)));
+    return (double) max;
+  });
+
+  run_experiment(pt, "int64 sum", ^double{
+    __block int64_t sum = 0;
+    for_each(CArray_it(longs, size, sizeof(int64_t)), ^(void* elem) {
+      sum += *(int64_t*) elem;
+    });
+    return (double) sum;
+  }, ^double{
+    int64_t sum = iterator_sum_int64(CArray_it(longs, size, sizeof(int64_t)));
+    return (double) sum;
+  });
+
+  run_experiment(pt, "int64 min", ^double{
+    __block int64_t min = INT64_MAX;
+    for_each(CArray_it(longs, size, sizeof(int64_t)), ^(void* elem) {
+      min = *(int64_t*) elem < min ? *(int64_t*) elem : min;
+    });
+    return (double) min;
+  }, ^double{
+    int64_t min = iterator_min_int64(CArray_it(longs, size, sizeof(int64_t)));
+    return (double) min;
+  });
+
+  run_experiment(pt, "float sum", ^double{
+    __block double sum = 0;
+    for_each(CArray_it(floats, size, sizeof(float)), ^(void* elem) {
+      sum += (double) *(float*) elem;
+    });
+    return sum;
+  }, ^double{
+    return iterator_sum_float(CArray_it(floats, size, sizeof(float)));
+  });
+
+  run_experiment(pt, "double sum", ^double{
+    __block double sum = 0;
+    for_each(ArrayAlt_it(doubles), ^(void* elem) {
+      sum += *(double*) elem;
+    });
+    return sum;
+  }, ^double{
+    return iterator_sum_double(ArrayAlt_it(doubles));
+  });
+
+  run_experiment(pt, "double argmin", ^double{
+    __block double min = HUGE_VAL;
+    __block size_t index = 0;
+    __block size_t argmin = 0;
+    for_each(ArrayAlt_it(doubles), ^(void* elem) {
+      if(*(double*) elem < min) {
+        min = *(double*) elem;
+        argmin = index;
+      }
+      index += 1;
+    });
+    return (double) argmin;
+  }, ^double{
+    size_t argmin = iterator_argmin_double(ArrayAlt_it(doubles));
+    return (double) argmin;
+  });
+
+  double* prefix_sums = (double*) Mem_alloc(sizeof(double) * (size > 0 ? size : 1));
+  run_experiment(pt, "double prefix sum", ^double{
+    __block double running = 0;
+    __block double* destination = prefix_sums;
+    for_each(ArrayAlt_it(doubles), ^(void* elem) {
+      running += *(double*) elem;
+      *destination++ = running;
+    });
+    return size > 0 ? prefix_sums[size - 1] : 0;
+  }, ^double{
+    iterator_prefix_sum_double(ArrayAlt_it(doubles), prefix_sums);
+    return size > 0 ? prefix_sums[size - 1] : 0;
+  });
+
+  Mem_free(prefix_sums);
+  Mem_free(ints);
+  Mem_free(longs);
+  Mem_free(floats);
+  ArrayAlt_free(doubles);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
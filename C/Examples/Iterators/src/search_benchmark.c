@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "search_index.h"
+#include "iterator_functions.h"
+#include "array.h"
+#include "array_alt.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures random searches over sorted containers using binsearch through move_to and get,
+// binsearch reading the span of the container directly and a SearchIndex.
+
+typedef Iterator (^IteratorMaker)(void);
+
+// Returns a copy of it that does not provide spans, so that binsearch calls move_to and get
+static Iterator without_spans(Iterator it) {
+  it.next_span = NULL;
+
+  return it;
+}
+
+static void run_experiment(PrintTime* pt, const char* container, IteratorMaker make_it, const void* (^key)(size_t i), size_t searches, KIBlkComparator compare) {
+  char label[128];
+  __block size_t found_dispatch = 0;
+  __block size_t found_span = 0;
+  __block size_t found_index = 0;
+
+  snprintf(label, 128, "%s: binsearch (move_to/get)", container);
+  double dispatch = PrintTime_print(pt, label, ^{
+    for(size_t i = 0; i < searches; ++i) {
+      found_dispatch += binsearch(without_spans(make_it()), key(i), compare) != (size_t) -1;
+    }
+  });
+
+  snprintf(label, 128, "%s: binsearch (span)", container);
+  double span = PrintTime_print(pt, label, ^{
+    for(size_t i = 0; i < searches; ++i) {
+      found_span += binsearch(make_it(), key(i), compare) != (size_t) -1;
+    }
+  });
+
+  __block SearchIndex* index = NULL;
+  snprintf(label, 128, "%s: SearchIndex construction", container);
+  PrintTime_print(pt, label, ^{
+    index = SearchIndex_new(make_it(), compare);
+  });
+
+  snprintf(label, 128, "%s: SearchIndex_search", container);
+  double indexed = PrintTime_print(pt, label, ^{
+    for(size_t i = 0; i < searches; ++i) {
+      found_index += SearchIndex_search(index, key(i)) != (size_t) -1;
+    }
+  });
+
+  SearchIndex_free(index);
+
+  if(found_dispatch != found_span || found_span != found_index) {
+    Error_raise(Error_new(ERROR_GENERIC, "%s: the searches found a different number of elements", container));
+  }
+
+  printf("%s span speedup: " GRN "%.2lfx" reset " index speedup: " GRN "%.2lfx\n\n" reset, container, dispatch / span, dispatch / indexed);
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 3) {
+    printf("Usage: search_benchmark <number of elements> <number of searches> (e.g., 10000000 10000000)\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t size = (size_t) atol(argv[1]);
+  size_t searches = (size_t) atol(argv[2]);
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "search_index");
+  PrintTime_add_header(pt, "elements", argv[1]);
+
+  // even numbers, about half of the searched keys are found
+  Array* array = Array_new(size > 0 ? size : 1);
+  ArrayAlt* array_alt = ArrayAlt_new(size > 0 ? size : 1, sizeof(long));
+  for(size_t i = 0; i < size; ++i) {
+    long value = (long) i * 2;
+    Array_add(array, (void*) value);
+    ArrayAlt_add(array_alt, &value);
+  }
+
+  long* keys = (long*) Mem_alloc(sizeof(long) * (searches > 0 ? searches : 1));
+  for(size_t i = 0; i < searches; ++i) {
+    keys[i] = (long) ((size_t) rand() * (size_t) rand() % (2 * size + 1));
+  }
+
+  run_experiment(pt, "Array_it", ^{ return Array_it(array); }, ^const void*(size_t i) {
+    return (const void*) keys[i];
+  }, searches, ^(const void* lhs, const void* rhs) {
+    return ((long) lhs > (long) rhs) - ((long) lhs < (long) rhs);
+  });
+
+  run_experiment(pt, "ArrayAlt_it", ^{ return ArrayAlt_it(array_alt); }, ^const void*(size_t i) {
+    return &keys[i];
+  }, searches, ^(const void* lhs, const void* rhs) {
+    return (*(const long*) lhs > *(const long*) rhs) - (*(const long*) lhs < *(const long*) rhs);
+  });
+
+  Mem_free(keys);
+  Array_free(array);
+  ArrayAlt_free(array_alt);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "basic_iterators.h"
+#include "iterator_functions.h"
+#include "exsorting_dataset.h"
+#include "string_utils.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures the wall-clock time needed to load records.csv with a cold page cache, reading the
+// file with TextFile_it and with TextFileAsync_it (i.e., overlapping parsing and I/O).
+
+#define NUM_FIELDS 4
+#define MAX_FIELD_LEN 1024
+
+// Evicts the pages of the file from the page cache, so that the next run reads it from disk
+static void drop_cache(const char* filename) {
+  int fd = open(filename, O_RDONLY);
+  if(fd < 0) {
+    Error_raise(Error_new(ERROR_FILE_OPENING, "Error opening file %s, reason: %s", filename, strerror(errno)));
+  }
+
+#if defined(POSIX_FADV_DONTNEED)
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#else
+  printf("Cannot drop the page cache on this platform, the times are measured with a warm cache\n");
+#endif
+
+  close(fd);
+}
+
+// Parses the records as ExSortingDataset_load does
+static Array* load(Iterator it) {
+  Array* result = Array_new(1000);
+  Array* fields = Array_new(NUM_FIELDS);
+  for(size_t i = 0; i < NUM_FIELDS; ++i) {
+    Array_add(fields, Mem_alloc(MAX_FIELD_LEN));
+  }
+
+  for_each(it, ^(void* line) {
+    String_fast_split((char*) line, ',', fields, MAX_FIELD_LEN);
+    Array_add(result, new_record(fields));
+  });
+
+  free_contents(Array_it(fields));
+  Array_free(fields);
+
+  return result;
+}
+
+static double run_experiment(PrintTime* pt, char* label, const char* filename, Iterator it, size_t* num_records) {
+  drop_cache(filename);
+
+  __block Array* records = NULL;
+  double seconds = PrintTime_print(pt, label, ^{
+    records = load(it);
+  });
+
+  *num_records = Array_size(records);
+  ExSortingDataset_free(records);
+
+  return seconds;
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 2 && argc != 3) {
+    printf("Usage: textfile_benchmark <path to records.csv> [<buffer bytes>] (e.g., records.csv 1048576)\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  const char* filename = argv[1];
+  size_t buffer_bytes = argc == 3 ? (size_t) atol(argv[2]) : 0;
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "textfile");
+  PrintTime_add_header(pt, "buffer bytes", argc == 3 ? argv[2] : "default");
+
+  size_t sync_records = 0;
+  size_t async_records = 0;
+  double sync_time = run_experiment(pt, "TextFile_it (cold cache)", filename,
+    TextFile_it(filename, '\n'), &sync_records);
+  double async_time = run_experiment(pt, "TextFileAsync_it (cold cache)", filename,
+    TextFileAsync_it(filename, '\n', buffer_bytes), &async_records);
+
+  if(sync_records != async_records) {
+    Error_raise(Error_new(ERROR_GENERIC, "The iterators loaded a different number of records (%ld vs %ld)",
+      (long) sync_records, (long) async_records));
+  }
+
+  printf("records: %ld speedup: " GRN "%.2lfx\n" reset, (long) sync_records, sync_time / async_time);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
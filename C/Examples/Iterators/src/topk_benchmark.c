@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "iterator_functions.h"
+#include "array.h"
+#include "errors.h"
+#include "mem.h"
+#include "print_time.h"
+#include "ansi_colors.h"
+
+// Measures the selection of the k smallest elements of an array of random numbers using a full
+// sort, partial_sort, nth_element followed by a sort of the first k elements and top_k.
+
+static int (^compare_longs)(const void*, const void*) = ^(const void* lhs, const void* rhs) {
+  return ((long) lhs > (long) rhs) - ((long) lhs < (long) rhs);
+};
+
+static Array* build_array(long* values, size_t size) {
+  Array* array = Array_new(size > 0 ? size : 1);
+  for(size_t i = 0; i < size; ++i) {
+    Array_add(array, (void*) values[i]);
+  }
+
+  return array;
+}
+
+// Checks that the first k elements of array are the k smallest values in sorted order
+static void check_prefix(const char* label, Array* array, Array* expected, size_t k) {
+  for(size_t i = 0; i < k; ++i) {
+    if(Array_at(array, i) != Array_at(expected, i)) {
+      Error_raise(Error_new(ERROR_GENERIC, "%s: wrong element at position %ld", label, i));
+    }
+  }
+}
+
+static void run_experiment(PrintTime* pt, long* values, size_t size, size_t k) {
+  char label[128];
+  Array* sorted = build_array(values, size);
+  Array* partially_sorted = build_array(values, size);
+  Array* selected = build_array(values, size);
+  __block Array* heap = NULL;
+
+  snprintf(label, 128, "k=%ld: sort", k);
+  double full = PrintTime_print(pt, label, ^{
+    sort(Array_it(sorted), compare_longs);
+  });
+
+  snprintf(label, 128, "k=%ld: partial_sort", k);
+  double partial = PrintTime_print(pt, label, ^{
+    partial_sort(Array_it(partially_sorted), k, compare_longs);
+  });
+
+  snprintf(label, 128, "k=%ld: nth_element + sort", k);
+  double nth = PrintTime_print(pt, label, ^{
+    nth_element(Array_it(selected), k - 1, compare_longs);
+    Array* smallest = Array_new_by_copying_carray(Array_carray(selected), k);
+    sort(Array_it(smallest), compare_longs);
+    Array_free(smallest);
+  });
+
+  snprintf(label, 128, "k=%ld: top_k", k);
+  double heap_time = PrintTime_print(pt, label, ^{
+    heap = top_k(Array_it(selected), k, compare_longs);
+  });
+
+  check_prefix("partial_sort", partially_sorted, sorted, k);
+  check_prefix("top_k", heap, sorted, k);
+
+  printf("k=%ld speedup over sort: partial_sort " GRN "%.2lfx" reset " nth_element " GRN "%.2lfx" reset " top_k " GRN "%.2lfx\n\n" reset, k, full / partial, full / nth, full / heap_time);
+
+  Array_free(heap);
+  Array_free(sorted);
+  Array_free(partially_sorted);
+  Array_free(selected);
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 2) {
+    printf("Usage: topk_benchmark <number of elements> (e.g., 10000000)\n");
+    exit(ERROR_ARGUMENT_PARSING);
+  }
+
+  size_t size = (size_t) atol(argv[1]);
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "benchmark", "top_k");
+  PrintTime_add_header(pt, "elements", argv[1]);
+
+  long* values = (long*) Mem_alloc(sizeof(long) * (size > 0 ? size : 1));
+  for(size_t i = 0; i < size; ++i) {
+    values[i] = (long) ((size_t) rand() * (size_t) rand());
+  }
+
+  size_t ks[] = { 10, 100, 1000, 10000 };
+  for(size_t i = 0; i < 4; ++i) {
+    if(ks[i] <= size) {
+      run_experiment(pt, values, size, ks[i]);
+    }
+  }
+
+  Mem_free(values);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list.h"
+#include "dictionary.h"
+#include "keys.h"
+#include "mem.h"
+#include "print_time.h"
+#include "iterator_functions.h"
+
+// This program is compiled once for each List implementation (see the Makefile),
+// LIST_BACKEND names the implementation the binary has been linked against.
+#ifndef LIST_BACKEND
+#define LIST_BACKEND "unknown"
+#endif
+
+static void print_usage() {
+  printf("Usage: measure_times <number of elements>\n");
+}
+
+int main(int argc, char const *argv[]) {
+  if(argc != 2) {
+    print_usage();
+    return 1;
+  }
+
+  size_t n = (size_t) atol(argv[1]);
+  if(n == 0) {
+    print_usage();
+    return 1;
+  }
+
+  PrintTime* pt = PrintTime_new(NULL);
+  PrintTime_add_header(pt, "list_backend", LIST_BACKEND);
+  PrintTime_add_header(pt, "size", argv[1]);
+
+  List* list = List_new();
+
+  PrintTime_print(pt, "insert front", ^{
+    for(size_t i = 0; i < n; ++i) {
+      List_insert(list, (void*) i);
+    }
+  });
+
+  PrintTime_print(pt, "append", ^{
+    for(size_t i = 0; i < n; ++i) {
+      List_append(list, (void*) i);
+    }
+  });
+
+  PrintTime_print(pt, "iterate", ^{
+    __block size_t sum = 0;
+    for_each(List_it(list), ^(void* elem) {
+      sum += (size_t) elem;
+    });
+    printf("sum: %ld\n", sum);
+  });
+
+  PrintTime_print(pt, "insert/delete head", ^{
+    for(size_t i = 0; i < n; ++i) {
+      List_insert(list, (void*) i);
+      List_delete_node(list, List_head(list));
+    }
+  });
+
+  PrintTime_print(pt, "queue (insert front/delete tail)", ^{
+    for(size_t i = 0; i < n; ++i) {
+      List_insert(list, (void*) i);
+      List_delete_node(list, List_tail(list));
+    }
+  });
+
+  // mid-list work: nodes are found anew before each deletion since list_array
+  // nodes are invalidated by deletions
+  PrintTime_print(pt, "find/delete middle", ^{
+    for(size_t i = 0; i < 100 && i < n; ++i) {
+      size_t target = n / 2 + i;
+      ListNode* node = List_find_wb(list, ^int(const void* elem) {
+        return (size_t) elem != target;
+      });
+
+      if(node != NULL) {
+        List_delete_node(list, node);
+      }
+    }
+  });
+
+  PrintTime_print(pt, "delete head", ^{
+    while(!List_empty(list)) {
+      List_delete_node(list, List_head(list));
+    }
+  });
+
+  PrintTime_print(pt, "refill", ^{
+    for(size_t i = 0; i < n; ++i) {
+      List_append(list, (void*) i);
+    }
+  });
+
+  PrintTime_print(pt, "free", ^{
+    List_free(list, NULL);
+  });
+
+  // hash tables based dictionaries store their buckets into lists
+  int* keys = (int*) Mem_alloc(sizeof(int) * n);
+  for(size_t i = 0; i < n; ++i) {
+    keys[i] = rand();
+  }
+
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+  Dictionary* dictionary = Dictionary_new(key_info);
+
+  PrintTime_print(pt, "dictionary set", ^{
+    for(size_t i = 0; i < n; ++i) {
+      Dictionary_set(dictionary, &keys[i], &keys[i]);
+    }
+  });
+
+  PrintTime_print(pt, "dictionary get", ^{
+    size_t found = 0;
+    for(size_t i = 0; i < n; ++i) {
+      void* value;
+      found += (size_t) Dictionary_get(dictionary, &keys[i], &value);
+    }
+    printf("found: %ld\n", found);
+  });
+
+  Dictionary_free(dictionary);
+  KeyInfo_free(key_info);
+  Mem_free(keys);
+
+  PrintTime_save(pt);
+  PrintTime_free(pt);
+
+  return 0;
+}
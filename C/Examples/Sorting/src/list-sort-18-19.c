@@ -62,76 +62,6 @@ static Options parse_options(int argc, char const **argv) {
 
 
 
-static void list_split(List* src, List* lhs, List* rhs) {
-    __block int index = 0;
-    for_each(List_it(src), ^(void* elem) {
-        if(index++ % 2 == 0) {
-            List_append(lhs, elem);
-        } else {
-            List_append(rhs, elem);
-        }
-    });
-}
-
-static void list_merge(List *dest, List *lhs, List *rhs, int (^comp)(void *, void *)) {
-    ListNode* lhs_it = List_head(lhs);
-    ListNode* rhs_it = List_head(rhs);
-    ListNode* dest_it = List_head(dest);
-
-    while(lhs_it != NULL && rhs_it != NULL) {
-        assert(dest_it != NULL);
-
-        void* lhs_elem = ListNode_get(lhs, lhs_it);
-        void* rhs_elem = ListNode_get(rhs, rhs_it);
-        if(comp(lhs_elem, rhs_elem) < 0) {
-            ListNode_set(dest, dest_it, lhs_elem);
-            lhs_it = List_next(lhs, lhs_it);
-        } else {
-            ListNode_set(dest, dest_it, rhs_elem);
-            rhs_it = List_next(rhs, rhs_it);
-        }
-
-        dest_it = List_next(dest, dest_it);
-    }
-
-    while(lhs_it!=NULL) {
-        assert(dest_it != NULL);
-        void *lhs_elem = ListNode_get(lhs, lhs_it);
-        ListNode_set(dest, dest_it, lhs_elem);
-        lhs_it = List_next(lhs, lhs_it);
-        dest_it = List_next(dest, dest_it);
-    }
-
-    while (rhs_it != NULL) {
-        assert(dest_it != NULL);
-        void *rhs_elem = ListNode_get(rhs, rhs_it);
-        ListNode_set(dest, dest_it, rhs_elem);
-        rhs_it = List_next(rhs, rhs_it);
-        dest_it = List_next(dest, dest_it);
-    }
-}
-
-static void list_sort(List* list, int(^comp)(void*, void*)) {
-    if(List_size(list) < 2) {
-        return;
-    }
-
-    if(List_size(list) > 1000000) {
-        printf("Sorting list of size: %ld\n", List_size(list));
-    }
-
-    List* lhs = List_new();
-    List* rhs = List_new();
-
-    list_split(list, lhs, rhs);
-    list_sort(lhs, comp);
-    list_sort(rhs, comp);
-    list_merge(list, lhs, rhs, comp);
-
-    List_free(lhs, NULL);
-    List_free(rhs, NULL);
-}
-
 static List *load_dataset(PrintTime* pt, const char* filename)
 {
     __block List *result = List_new();
@@ -168,9 +98,9 @@ static void do_sort(Options options) {
   List *list = load_dataset(pt, options.file_name1);
 
   PrintTime_print(pt, "Sorting...", ^{
-    list_sort(list, ^(void *lhs, void *rhs) {
-      long int lhs_val = *(long int *)lhs;
-      long int rhs_val = *(long int *)rhs;
+    List_sort(list, ^(const void *lhs, const void *rhs) {
+      long int lhs_val = *(const long int *)lhs;
+      long int rhs_val = *(const long int *)rhs;
 
       if (lhs_val < rhs_val) {
         return -1;
@@ -205,15 +135,10 @@ static void do_merge(Options options) {
   PrintTime_print(pt, "Merging...", ^{
     printf("Merging...\n");
     __block List *dest = List_new();
-    size_t len1 = List_size(list1);
-    size_t len2 = List_size(list2);
-    for_each(Number_it(len1+len2), ^(UNUSED(void* number)) {
-        List_append(dest, NULL);
-    });
 
-    list_merge(dest, list1, list2, ^(void *lhs, void *rhs) {
-      long int lhs_val = *(long int *)lhs;
-      long int rhs_val = *(long int *)rhs;
+    List_merge(dest, list1, list2, ^(const void *lhs, const void *rhs) {
+      long int lhs_val = *(const long int *)lhs;
+      long int rhs_val = *(const long int *)rhs;
 
       if (lhs_val < rhs_val) {
         return -1;
@@ -231,7 +156,7 @@ static void do_merge(Options options) {
         it = List_next(dest, it);
     });
 
-    List_free(dest, NULL);
+    List_free(dest, mem_free);
   });
 
   PrintTime_free(pt);
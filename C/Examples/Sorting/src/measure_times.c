@@ -35,6 +35,17 @@ static int qsort_compare_field3(const void* e1, const void* e2) {
   return ExSortingDataset_compare_field3( *(void* const*)e1, *(void* const*)e2 );
 }
 
+// The parallel algorithms are run on a pool with a worker for each core
+static TaskPool* pool = NULL;
+
+static void par_quick_sort_all_cores(void** array, size_t count, KIComparator compare) {
+  par_quick_sort(pool, array, count, compare);
+}
+
+static void par_quick_sort_g_all_cores(void* array, size_t count, size_t size, KIComparator compare) {
+  par_quick_sort_g(pool, array, count, size, compare);
+}
+
 static void exec_and_print_with_dup_storage(Array* dataset, void (^callback)(Array*)) {
   Array* array = Array_dup(dataset);
   callback(array);
@@ -126,6 +137,8 @@ static void print_usage() {
   printf("Usage: measure_time <opt> <file name>\n");
   printf(" opts: -q use quick_sort algorithm\n");
   printf("       -Q use quick_sort_g algorithm\n");
+  printf("       -p use par_quick_sort algorithm (all cores)\n");
+  printf("       -P use par_quick_sort_g algorithm (all cores)\n");
   printf("       -i use insertion_sort algorithm\n");
   printf("       -s use system qsort algorithm\n");
   printf("       -m use merge_sort algorithm\n");
@@ -149,7 +162,7 @@ static void check_arguments(int argc, char** argv) {
     exit(ERROR_ARGUMENT_PARSING);
   }
 
-  if(strlen(argv[1])!=2 || argv[1][0] != '-' || !char_included(argv[1][1], (char[]){'q','Q','m','M','h','s', 'H', 'i'}, 8)) {
+  if(strlen(argv[1])!=2 || argv[1][0] != '-' || !char_included(argv[1][1], (char[]){'q','Q','p','P','m','M','h','s', 'H', 'i'}, 10)) {
     printf("Option %s not recognized\n", argv[1]);
     print_usage();
     exit(ERROR_ARGUMENT_PARSING);
@@ -166,6 +179,8 @@ static char* flag_to_algorithm_name(char ch) {
     case 'i': return "insertion_sort";
     case 'q': return "quick_sort";
     case 'Q': return "quick_sort_g";
+    case 'p': return "par_quick_sort";
+    case 'P': return "par_quick_sort_g";
     case 's': return "system_quick_sort";
     case 'M': return "merge_sort_g";
     case 'm': return "merge_sort";
@@ -238,6 +253,16 @@ int main(int argc, char* argv[]) {
     case 'Q':
       test_algorithm_g(dataset, pt, quick_sort_g);
       break;
+    case 'p':
+      pool = TaskPool_new(0);
+      test_algorithm(dataset, pt, par_quick_sort_all_cores);
+      TaskPool_free(pool);
+      break;
+    case 'P':
+      pool = TaskPool_new(0);
+      test_algorithm_g(dataset, pt, par_quick_sort_g_all_cores);
+      TaskPool_free(pool);
+      break;
     case 'i':
       test_algorithm(dataset, pt, insertion_sort);
       break;
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include "iterator.h"
 #include "keys.h"
+#include "array_view.h"
 
 /**
  * @file Array
@@ -52,6 +53,14 @@ typedef struct _ArrayIterator ArrayIterator;
 /// @return A pointer to the newly created array.
 Array* Array_new(size_t capacity);
 
+/// @brief Creates a new array able to store up to inline_capacity elements in the same
+/// allocation as the array itself. When more elements are added, they are moved to a heap
+/// buffer as in any other array. Use it for the many tiny arrays (e.g., adjacency lists) to save
+/// one allocation and one pointer indirection per array.
+/// @param inline_capacity The number of elements stored inline.
+/// @return A pointer to the newly created array.
+Array* Array_new_small(size_t inline_capacity);
+
 /// @brief Creates a new array from an existing C array.
 /// @param array the C array to copy.
 /// @param size the size of the C array.
@@ -144,9 +153,18 @@ void Array_remove(Array* array, size_t index);
 /// +1 means that the first is larger than the second).
 void Array_sort(Array* array, KIBlkComparator compare);
 
+/// @brief Returns a view over the elements [from, to) of the array. No element is copied.
+/// The view is invalidated by any operation that reallocates the array (e.g., Array_add).
+/// @warning It raises an ERROR_INDEX_OUT_OF_BOUND if from > to or to > Array_size(array)
+ArrayView Array_slice(Array* array, size_t from, size_t to);
+
 /// @brief Returns a new iterator over the array.
 ArrayIterator* ArrayIterator_new(Array*);
 
+/// @brief Initializes an iterator over the array in the given storage (of at least
+/// ITERATOR_STORAGE_SIZE bytes) and returns it. It needs not to be freed.
+ArrayIterator* ArrayIterator_init(Array*, void* storage);
+
 /// @brief Frees the memory allocated by the iterator.
 void ArrayIterator_free(ArrayIterator*);
 
@@ -184,9 +202,13 @@ void ArrayIterator_set(ArrayIterator* it, void* value);
 /// @brief Returns 1 if it1 and it2 points to the same element in the array, 0 otherwise.
 int ArrayIterator_same(ArrayIterator* it1, ArrayIterator* it2);
 
+/// @brief Sets span to the elements from the current one to the end of the array and moves the
+/// iterator past them. It returns the number of elements in the span.
+size_t ArrayIterator_next_span(ArrayIterator* it, ArrayView* span);
+
 
 // Iterator maker
-// It returns a mutable bidirectional random iterator.
+// It returns a mutable bidirectional random iterator. Instances are inline.
 
 /// @brief Creates a new Iterator interface to the iterators supported by the Array.
 /// @param array 
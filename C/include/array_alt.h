@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include "keys.h"
 #include "iterator.h"
+#include "array_view.h"
 
 // ArrayAlt implements a slightly modified interface of the Array
 // library. ArrayAlt is almost never a better choice than Array.
@@ -19,14 +20,47 @@
 typedef struct _ArrayAlt ArrayAlt;
 typedef struct _ArrayAltIterator ArrayAltIterator;
 
+// Access pattern hints for file backed arrays (see ArrayAlt_advise).
+typedef enum {
+  ARRAY_ALT_ADVICE_NORMAL,
+  ARRAY_ALT_ADVICE_SEQUENTIAL,
+  ARRAY_ALT_ADVICE_RANDOM
+} ArrayAltAdvice;
+
 // Constructors
 ArrayAlt* ArrayAlt_new(size_t capacity, size_t elem_size);
 ArrayAlt* ArrayAlt_new_by_copying_carray(void* array, size_t size, size_t elem_size );
 ArrayAlt* ArrayAlt_dup(ArrayAlt*);
 
-// Destructor
+// Creates a new array whose elements are stored in the file at the given path
+// (the file is created if it does not exist and truncated otherwise). The file
+// is memory mapped, so the array can be larger than the available memory and
+// its contents survive the program. Growing the array grows the file.
+// It raises an ERROR_FILE_OPENING if the file cannot be created or mapped.
+ArrayAlt* ArrayAlt_new_mmap(const char* path, size_t elem_size, size_t capacity);
+
+// Reopens an array previously created with ArrayAlt_new_mmap. Elements are
+// not copied nor parsed: they are available as soon as the file is mapped.
+// It raises an ERROR_FILE_OPENING if the file cannot be opened or mapped and
+// an ERROR_FILE_READING if the file does not contain a valid array.
+ArrayAlt* ArrayAlt_open_mmap(const char* path);
+
+// Destructor. If the array is file backed, the array size is saved into the
+// file and the file is unmapped and closed.
 void ArrayAlt_free(ArrayAlt*);
 
+// Returns 1 if the array is backed by a memory mapped file, 0 otherwise.
+int ArrayAlt_mapped(ArrayAlt* array);
+
+// Tells the kernel how the elements of a file backed array will be accessed
+// so that it can tune read-ahead accordingly. The advice survives the growth
+// of the array. It does nothing on heap backed arrays.
+void ArrayAlt_advise(ArrayAlt* array, ArrayAltAdvice advice);
+
+// Flushes the contents of a file backed array (elements and size) to disk.
+// It does nothing on heap backed arrays.
+void ArrayAlt_sync(ArrayAlt* array);
+
 //
 // Accessors
 //
@@ -99,11 +133,21 @@ void ArrayAlt_remove(ArrayAlt* array, size_t index);
 void ArrayAlt_sort(ArrayAlt* array, KIComparator compare);
 // void ArrayAlt_sort_f(ArrayAlt* array, void (*compare)(void*,void*));
 
+// Returns a view over the elements [from, to) of the array. No element is copied
+// and the view yields pointers to the stored objects (as ArrayAlt_at does).
+// The view is invalidated by any operation that reallocates the array.
+// It raises an ERROR_INDEX_OUT_OF_BOUND if from > to or to > ArrayAlt_size(array)
+ArrayView ArrayAlt_slice(ArrayAlt* array, size_t from, size_t to);
+
 
 // Iterator
 ArrayAltIterator* ArrayAltIterator_new(ArrayAlt*);
 void ArrayAltIterator_free(ArrayAltIterator*);
 
+// Initializes an iterator over the array in the given storage (of at least ITERATOR_STORAGE_SIZE
+// bytes) and returns it. It needs not to be freed.
+ArrayAltIterator* ArrayAltIterator_init(ArrayAlt*, void* storage);
+
 // Move the iterator to the next element. Do nothing if it is already past the
 // end of the container.
 void ArrayAltIterator_next(ArrayAltIterator* it);
@@ -118,6 +162,12 @@ void* ArrayAltIterator_get(ArrayAltIterator* it);
 // Resets the iterator to the first element
 void ArrayAltIterator_to_begin(ArrayAltIterator* it);
 
+// Moves the iterator to the given index
+void ArrayAltIterator_move_to(ArrayAltIterator* it, size_t index);
+
+// Returns the size of the array subject to iteration
+size_t ArrayAltIterator_size(ArrayAltIterator* it);
+
 // Returns 1 if it1 and it2 points to the same element.
 int ArrayAltIterator_same(ArrayAltIterator* it1, ArrayAltIterator* it2);
 
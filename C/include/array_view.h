@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdlib.h>
+#include "iterator.h"
+
+/**
+ * @file ArrayView
+ * @brief An ArrayView is a non-owning reference to a contiguous range of elements of an Array,
+ * of an ArrayAlt, or of a plain C array.
+ *
+ * Views are small value types: they are built by the _make and _slice functions, they do not
+ * allocate memory and they need not to be freed. A view is valid as long as the referenced storage
+ * is not freed or reallocated (e.g., adding elements to an Array may invalidate its views).
+ *
+ * Views over Array objects (and over C arrays of pointers) yield the stored pointers, views over
+ * ArrayAlt objects (and over C arrays of values) yield pointers to the stored values, exactly as
+ * Array_it and ArrayAlt_it do.
+ *
+ * ArrayView_it returns a random access, bidirectional, mutable, cloning iterator, so that the
+ * iterator functions (sort, binsearch, reverse_contents, ...) work in place on sub-ranges.
+ *
+ * **Example**
+ *
+ * ```c
+ * // sorting the second half of an array in place
+ * ArrayView view = Array_slice(array, Array_size(array) / 2, Array_size(array));
+ * sort(ArrayView_it(&view), compare);
+ * ```
+ */
+
+typedef struct _ArrayView {
+  // pointer to the first element in the view
+  unsigned char* carray;
+  // number of elements in the view
+  size_t size;
+  // size in bytes of each element
+  size_t elem_size;
+  // 1 if the elements are stored by value (ArrayAlt), 0 if they are pointers (Array)
+  int by_value;
+} ArrayView;
+
+/// @brief Builds a view over the first size pointers of the given C array.
+ArrayView ArrayView_make(void** carray, size_t size);
+
+/// @brief Builds a view over the first size elements of the given C array, each element
+/// being elem_size bytes long.
+ArrayView ArrayView_make_by_value(void* carray, size_t size, size_t elem_size);
+
+/// @brief Returns the view over the elements [from, to) of the given view.
+/// @warning It raises an ERROR_INDEX_OUT_OF_BOUND if from > to or to > ArrayView_size(view)
+ArrayView ArrayView_slice(ArrayView* view, size_t from, size_t to);
+
+/// @brief Returns the number of elements in the view.
+size_t ArrayView_size(ArrayView* view);
+
+/// @brief Returns the element at the given index (a pointer to it if the view is by value).
+/// @warning It raises an ERROR_INDEX_OUT_OF_BOUND if index is not in [0, ArrayView_size(view)-1]
+void* ArrayView_at(ArrayView* view, size_t index);
+
+/// @brief Stores elem at the given index. If the view is by value, elem needs to be a pointer
+/// to the value to be copied.
+/// @warning It raises an ERROR_INDEX_OUT_OF_BOUND if index is not in [0, ArrayView_size(view)-1]
+void ArrayView_set(ArrayView* view, size_t index, void* elem);
+
+/// @brief Returns an Iterator over the elements of the view. The view must outlive the
+/// iterations performed using the returned Iterator.
+/// It returns a random access, bidirectional, mutable, cloning iterator.
+Iterator ArrayView_it(ArrayView* view);
+
+/// @brief Returns 1 if the given iterator has been built using ArrayView_it, 0 otherwise.
+int is_array_view_iterator(Iterator it);
@@ -19,6 +19,12 @@
 //        printf("%s\n", (char*) buf);
 //      });
 //    ```
+//  - TextFileAsync_it: as TextFile_it, but the file is read ahead by a background thread, e.g.:
+//    ```
+//      for_each(TextFileAsync_it("myfile.txt", '\n', 0), ^(void* obj){
+//        printf("%s\n", (char*) obj);
+//      });
+//    ```
 //
 //   - Char_it: can be used to iterate over a string, e.g.:
 //    ```
@@ -46,12 +52,21 @@
 #define UNUM(a) (*(unsigned long*) (a))
 
 // Creates a number iterator. The iterator will iterate from 0 to the given integer.
+// It returns a random access iterator. Neither the iterator nor its instances allocate memory
+// when used by the iteration functions.
 Iterator Number_it(unsigned long);
 
 // Creates a file iterator. The iterator will iterate over all lines of the file (one lines
-// per iteration step) up to the end of the file.
+// per iteration step) up to the end of the file. It returns a splittable iterator: parts are
+// ranges of bytes whose boundaries are moved to the next delimiter.
 Iterator TextFile_it(const char* filename, char delimiter);
 
+// Creates a file iterator returning the same records as TextFile_it. A background thread reads
+// the file ahead of the consumer, filling two buffers of buffer_bytes chars in turn (0 selects
+// 1MB), so that parsing the records overlaps with the I/O. Records are valid up to the next
+// call to next. It returns a basic iterator (one reader thread per instance).
+Iterator TextFileAsync_it(const char* filename, char delimiter, size_t buffer_bytes);
+
 
 #define CH(a) (*(char*) (a))
 
@@ -60,5 +75,5 @@ Iterator TextFile_it(const char* filename, char delimiter);
 Iterator Char_it(char* string);
 
 // Creates an iterator over a standard C array. The resulting iterator will be
-// a bidirectional, mutable, random access, cloning iterator.
+// a bidirectional, mutable, random access, cloning, inline iterator.
 Iterator CArray_it(void* carray, size_t count, size_t width);
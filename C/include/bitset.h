@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdlib.h>
+#include "iterator.h"
+
+/**
+ * @file Bitset
+ * @brief The Bitset structure implements a fixed size set of integers in [0, size-1] using one bit
+ * per element.
+ *
+ * Bits are stored in 64 bits words, so that bulk operations (and, or, andnot, xor) process 64
+ * elements at a time and loops over the words can be auto-vectorized by the compiler. It is
+ * a much lighter alternative to Set (or to a Dictionary) when the universe is a dense range of
+ * integers, e.g., vertex indices in visited sets or frontier bitmaps.
+ *
+ * **Example**
+ *
+ * ```c
+ * Bitset* visited = Bitset_new(100);
+ * Bitset_set(visited, 3);
+ * Bitset_set(visited, 42);
+ *
+ * for_each(Bitset_it(visited), ^(void* obj) {
+ *     printf("%ld ", UNUM(obj));  // prints "3 42"
+ * });
+ *
+ * Bitset_free(visited);
+ * ```
+ */
+
+typedef struct _Bitset Bitset;
+
+// Constructors
+
+/// @brief Creates a new bitset able to contain integers in [0, size-1]. All bits are cleared.
+Bitset* Bitset_new(size_t size);
+
+/// @brief Creates a new bitset containing the same bits of the given one.
+Bitset* Bitset_dup(Bitset* bitset);
+
+// Destructor
+
+/// @brief Frees the memory allocated by the bitset.
+void Bitset_free(Bitset* bitset);
+
+//
+// Accessors
+//
+
+/// @brief Returns the number of bits in the bitset (i.e., the size given to Bitset_new).
+size_t Bitset_size(Bitset* bitset);
+
+/// @brief Returns 1 if the given bit is set, 0 otherwise.
+/// @warning It raises an ERROR_INDEX_OUT_OF_BOUND if index is not in [0, Bitset_size(bitset)-1]
+int Bitset_test(Bitset* bitset, size_t index);
+
+/// @brief Returns the number of bits set in the bitset.
+size_t Bitset_count(Bitset* bitset);
+
+/// @brief Returns 1 if no bit is set in the bitset, 0 otherwise.
+int Bitset_empty(Bitset* bitset);
+
+/// @brief Returns the index of the first set bit whose index is greater than or equal to from.
+/// Returns (size_t) -1 if there is no such bit.
+size_t Bitset_next_set(Bitset* bitset, size_t from);
+
+//
+// Setters
+//
+
+/// @brief Sets the given bit.
+/// @warning It raises an ERROR_INDEX_OUT_OF_BOUND if index is not in [0, Bitset_size(bitset)-1]
+void Bitset_set(Bitset* bitset, size_t index);
+
+/// @brief Clears the given bit.
+/// @warning It raises an ERROR_INDEX_OUT_OF_BOUND if index is not in [0, Bitset_size(bitset)-1]
+void Bitset_clear(Bitset* bitset, size_t index);
+
+/// @brief Sets all bits of the bitset.
+void Bitset_set_all(Bitset* bitset);
+
+/// @brief Clears all bits of the bitset.
+void Bitset_clear_all(Bitset* bitset);
+
+//
+// Bulk operations. The two bitsets must have the same size, the result is stored into dst.
+// They raise an ERROR_GENERIC if the sizes of the bitsets differ.
+//
+
+/// @brief dst = dst & src
+void Bitset_and(Bitset* dst, Bitset* src);
+
+/// @brief dst = dst | src
+void Bitset_or(Bitset* dst, Bitset* src);
+
+/// @brief dst = dst & ~src (i.e., removes from dst the bits set in src)
+void Bitset_andnot(Bitset* dst, Bitset* src);
+
+/// @brief dst = dst ^ src
+void Bitset_xor(Bitset* dst, Bitset* src);
+
+//
+// Iterator
+//
+
+/// @brief Creates a new Iterator over the indices of the set bits (in increasing order).
+/// Objects returned by the iterator are pointers to size_t values (use UNUM to dereference them).
+/// Modifying the bitset while iterating over it yields undefined results.
+Iterator Bitset_it(Bitset* bitset);
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdlib.h>
+
+/**
+ * @file ConcurrentQueue
+ * @brief The ConcurrentQueue structure implements a bounded, lock-free, multi-producer
+ * multi-consumer FIFO queue of pointers.
+ *
+ * The queue is a ring buffer in which each cell carries a sequence number telling producers
+ * and consumers whether the cell is ready to be written or read (D. Vyukov's bounded MPMC
+ * queue). Enqueuing and dequeuing cost a single compare-and-swap in the uncontended case and
+ * never allocate memory. The enqueue and dequeue positions are kept on different cache lines
+ * to avoid false sharing between producers and consumers.
+ *
+ * try_ functions never wait: they return immediately when the queue is full (enqueue) or empty
+ * (dequeue). The other functions wait until they can proceed: they spin, then yield the
+ * processor and finally park on a condition variable, so that threads blocked on an idle queue
+ * do not consume processor time. The _many functions claim a range of cells with a single
+ * compare-and-swap. In order to let consumers know that no more objects will be produced, producers can
+ * close the queue: after ConcurrentQueue_close, blocking dequeues return 0 as soon as the queue
+ * is empty.
+ *
+ * **Example**
+ *
+ * ```c
+ * // consumer thread
+ * void* obj;
+ * while(ConcurrentQueue_dequeue(queue, &obj)) {
+ *     process(obj);
+ * }
+ * ```
+ */
+
+typedef struct _ConcurrentQueue ConcurrentQueue;
+
+/// @brief Creates a new queue able to hold capacity objects (capacity is rounded up to the next
+/// power of two).
+ConcurrentQueue* ConcurrentQueue_new(size_t capacity);
+
+/// @brief Frees the queue. User objects are left untouched. No thread must be using the queue.
+void ConcurrentQueue_free(ConcurrentQueue* queue);
+
+/// @brief Returns the capacity of the queue.
+size_t ConcurrentQueue_capacity(ConcurrentQueue* queue);
+
+/// @brief Returns the number of objects in the queue. The result is approximate if other threads
+/// are concurrently using the queue.
+size_t ConcurrentQueue_size(ConcurrentQueue* queue);
+
+/// @brief Enqueues elem if the queue is not full. Returns 1 on success, 0 if the queue is full.
+int ConcurrentQueue_try_enqueue(ConcurrentQueue* queue, void* elem);
+
+/// @brief Dequeues an object storing it into *result. Returns 1 on success, 0 if the queue is empty.
+int ConcurrentQueue_try_dequeue(ConcurrentQueue* queue, void** result);
+
+/// @brief Enqueues elem waiting for the queue to have room for it.
+void ConcurrentQueue_enqueue(ConcurrentQueue* queue, void* elem);
+
+/// @brief Dequeues an object storing it into *result, waiting for an object to be available.
+/// Returns 1 on success, 0 if the queue has been closed and it is empty.
+int ConcurrentQueue_dequeue(ConcurrentQueue* queue, void** result);
+
+/// @brief Enqueues up to count objects (in order) without waiting. Returns the number of
+/// enqueued objects.
+size_t ConcurrentQueue_try_enqueue_many(ConcurrentQueue* queue, void** elems, size_t count);
+
+/// @brief Dequeues up to max_count objects into result without waiting. Returns the number of
+/// dequeued objects.
+size_t ConcurrentQueue_try_dequeue_many(ConcurrentQueue* queue, void** result, size_t max_count);
+
+/// @brief Enqueues count objects (in order) waiting for room when the queue is full. Objects
+/// enqueued by other producers may be interleaved with the given ones.
+void ConcurrentQueue_enqueue_many(ConcurrentQueue* queue, void** elems, size_t count);
+
+/// @brief Dequeues up to max_count objects into result, waiting for at least one object to be
+/// available. Returns the number of dequeued objects, 0 if the queue has been closed and it is empty.
+size_t ConcurrentQueue_dequeue_many(ConcurrentQueue* queue, void** result, size_t max_count);
+
+/// @brief Signals that no more objects will be enqueued. Waiting consumers return as soon as the
+/// queue is empty.
+void ConcurrentQueue_close(ConcurrentQueue* queue);
+
+/// @brief Returns 1 if the queue has been closed, 0 otherwise.
+int ConcurrentQueue_closed(ConcurrentQueue* queue);
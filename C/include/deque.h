@@ -0,0 +1,154 @@
+#pragma once
+
+#include <stdlib.h>
+#include "iterator.h"
+#include "array_view.h"
+
+/**
+ * @file Deque
+ * @brief The Deque structure implements a double ended queue on top of a growable ring buffer.
+ *
+ * Just like Array, the deque contains pointers to data and it does not free the data when the
+ * deque is freed. Differently from Array, adding or removing elements at the front of the deque
+ * is O(1) (amortized), since no element needs to be moved. Elements can be accessed by index in
+ * O(1) and inserting/removing in the middle moves the elements on the shortest side only.
+ *
+ * **Example**
+ *
+ * ```c
+ * Deque* deque = Deque_new(16);
+ * Deque_push_back(deque, "b");
+ * Deque_push_front(deque, "a");
+ *
+ * for_each(Deque_it(deque), ^(void* element) {
+ *     printf("%s ", (char*) element);  // prints "a b"
+ * });
+ *
+ * Deque_free(deque);
+ * ```
+ */
+
+typedef struct _Deque Deque;
+typedef struct _DequeIterator DequeIterator;
+
+// Constructors
+
+/// @brief Creates a new deque.
+/// @param capacity The initial capacity of the deque (rounded up to the next power of two).
+Deque* Deque_new(size_t capacity);
+
+// Destructor
+
+/// @brief Frees the memory allocated by the deque. User objects are left untouched.
+void Deque_free(Deque* deque);
+
+//
+// Accessors
+//
+
+/// @brief Returns the number of elements in the deque
+size_t Deque_size(Deque* deque);
+
+/// @brief Returns true iff Deque_size(deque)==0
+int Deque_empty(Deque* deque);
+
+/// @brief Returns the number of elements the deque can accomodate without reallocating
+size_t Deque_capacity(Deque* deque);
+
+/// @brief Returns the object at the given index (0 is the front of the deque).
+/// @warning It raises an ERROR_INDEX_OUT_OF_BOUND if index is not in [0, Deque_size(deque)-1]
+void* Deque_at(Deque* deque, size_t index);
+
+/// @brief Returns the object at the front of the deque or NULL if the deque is empty.
+void* Deque_front(Deque* deque);
+
+/// @brief Returns the object at the back of the deque or NULL if the deque is empty.
+void* Deque_back(Deque* deque);
+
+//
+// Setters
+//
+
+/// @brief semantically equivalent to deque[index] = elem. Returns elem.
+/// @warning It raises an ERROR_INDEX_OUT_OF_BOUND if index is not in [0, Deque_size(deque)-1]
+void* Deque_set(Deque* deque, size_t index, void* elem);
+
+/// @brief Adds elem in front of the deque. O(1) amortized.
+void Deque_push_front(Deque* deque, void* elem);
+
+/// @brief Adds elem at the back of the deque. O(1) amortized.
+void Deque_push_back(Deque* deque, void* elem);
+
+/// @brief Removes and returns the object at the front of the deque. Returns NULL if the deque is empty.
+void* Deque_pop_front(Deque* deque);
+
+/// @brief Removes and returns the object at the back of the deque. Returns NULL if the deque is empty.
+void* Deque_pop_back(Deque* deque);
+
+/// @brief Adds count elements (taken from elems) at the back of the deque, in the given order.
+/// The elements are copied with at most two memory block copies.
+void Deque_push_back_many(Deque* deque, void** elems, size_t count);
+
+/// @brief Removes up to max_count elements from the front of the deque storing them into result
+/// (in front to back order). Returns the number of removed elements.
+size_t Deque_pop_front_many(Deque* deque, void** result, size_t max_count);
+
+/// @brief Inserts elem at the given index shifting the elements on the shortest side
+/// of the deque. Index can range in [0, Deque_size(deque)].
+void Deque_insert(Deque* deque, size_t index, void* elem);
+
+/// @brief Removes the element at the given index shifting the elements on the shortest
+/// side of the deque.
+void Deque_remove(Deque* deque, size_t index);
+
+//
+// Iterators
+//
+
+/// @brief Returns a new iterator over the deque.
+DequeIterator* DequeIterator_new(Deque* deque);
+
+/// @brief Frees the memory allocated by the iterator.
+void DequeIterator_free(DequeIterator* it);
+
+/// @brief Returns the size of the deque subject to iteration.
+size_t DequeIterator_size(DequeIterator* it);
+
+/// @brief Move the iterator to the next element.
+void DequeIterator_next(DequeIterator* it);
+
+/// @brief Move the iterator to the previous element.
+void DequeIterator_prev(DequeIterator* it);
+
+/// @brief Move the iterator to the specified index.
+void DequeIterator_move_to(DequeIterator* it, size_t index);
+
+/// @brief Moves the iterator to the front of the deque
+void DequeIterator_to_begin(DequeIterator* it);
+
+/// @brief Moves the iterator to the back of the deque (i.e., on the last element)
+void DequeIterator_to_end(DequeIterator* it);
+
+/// @brief Returns 1 if the iterator is past either end of the deque, 0 otherwise.
+int DequeIterator_end(DequeIterator* it);
+
+/// @brief Returns the element currently pointed by the iterator
+void* DequeIterator_get(DequeIterator* it);
+
+/// @brief Sets the current pointed element to the given value
+void DequeIterator_set(DequeIterator* it, void* value);
+
+/// @brief Returns 1 if it1 and it2 points to the same element in the deque, 0 otherwise.
+int DequeIterator_same(DequeIterator* it1, DequeIterator* it2);
+
+/// @brief Returns the index of the element currently pointed by the iterator
+size_t DequeIterator_index(DequeIterator* it);
+
+/// @brief Sets span to the elements from the current one up to either the end of the deque or
+/// the end of the ring buffer (whichever comes first) and moves the iterator past them.
+/// It returns the number of elements in the span (0 if the iterator is past the end).
+size_t DequeIterator_next_span(DequeIterator* it, ArrayView* span);
+
+/// @brief Creates a new Iterator interface to the deque.
+/// It returns a mutable bidirectional random access iterator.
+Iterator Deque_it(Deque* deque);
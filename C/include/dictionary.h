@@ -70,6 +70,11 @@ void DictionaryIterator_to_begin(DictionaryIterator* it);
 // Returns 1 if it1 and it2 points to the same place in the container, retunrs 0 otherwise.
 int DictionaryIterator_same(DictionaryIterator* it1, DictionaryIterator* it2);
 
+// Hands off about half of the elements not yet visited by the iterator to a new iterator
+// (a range of buckets for hash tables, a set of subtrees for trees). Returns NULL if the
+// remaining elements cannot be split (see the Splittable Iterators section in iterator.h).
+DictionaryIterator* DictionaryIterator_split(DictionaryIterator* it);
+
 
 // Returns the key of the element currently pointed by the iterator
 void* DictionaryIterator_key_get(DictionaryIterator* it);
@@ -96,6 +96,11 @@ void EdgeIterator_to_begin(EdgeIterator* it);
 // Returns 1 iff it1 and it2 represent the same iterator
 int  EdgeIterator_same(EdgeIterator* it1, EdgeIterator* it2);
 
+// Hands off the edges of the second half of the vertices following the current one to a new
+// iterator. Returns NULL if the iterator cannot be split (e.g., it has been returned by
+// Graph_adjacents).
+EdgeIterator* EdgeIterator_split(EdgeIterator* it);
+
 
 //
 // VERTEX ITERATOR
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdlib.h>
+#include "iterator.h"
+#include "dictionary.h"
+#include "keys.h"
+
+/**
+ * @file GroupAggregator
+ * @brief Hash based group-by and aggregation of the elements returned by an iterator.
+ *
+ * Each element is mapped to a key by key_fn, the aggregate of its group is created by init_fn the
+ * first time the key is seen and it is replaced by accumulate_fn(aggregate, elem) for each element
+ * of the group. Aggregates are either pointers to memory owned by the caller (e.g., a struct with
+ * a count and a sum) or values stored directly in the pointer (e.g., a count).
+ *
+ * The aggregates of recently seen keys are kept in a small direct mapped table that fits in the
+ * L1 cache: while the same keys keep coming (few groups, or elements sorted by key), elements
+ * are accumulated without looking up the dictionary. Aggregates are written to the dictionary
+ * when their slot is needed by another key and when the aggregator is freed.
+ *
+ * Keys are the ones returned by key_fn and need to stay valid as long as the dictionary is used.
+ *
+ * **Example**
+ *
+ * ```c
+ * // counts the records with the same field1
+ * Dictionary* counts = group_aggregate(Array_it(records), ^void*(void* record) {
+ *   return ((Record*) record)->field1;
+ * }, key_info, ^void*(void* key) {
+ *   return (void*) 0l;
+ * }, ^void*(void* count, void* record) {
+ *   return (void*) ((long) count + 1);
+ * });
+ * ```
+ */
+
+typedef struct _GroupAggregator GroupAggregator;
+
+// Constructor
+
+/// @brief Creates an aggregator that adds the elements it is given to the aggregates in groups
+/// (which may already contain some). The keys are compared and hashed by the KeyInfo of groups.
+GroupAggregator* GroupAggregator_new(Dictionary* groups, void* (^key_fn)(void* elem), void* (^init_fn)(void* key), void* (^accumulate_fn)(void* aggregate, void* elem));
+
+// Destructor
+
+/// @brief Writes the aggregates still in the table of recent keys to the dictionary and frees the
+/// aggregator. The dictionary is not freed.
+void GroupAggregator_free(GroupAggregator* aggregator);
+
+// Aggregation
+
+/// @brief Accumulates elem into the aggregate of its group.
+void GroupAggregator_add(GroupAggregator* aggregator, void* elem);
+
+/// @brief Returns a new dictionary mapping the key of each group of elements returned by it to
+/// its aggregate. The dictionary uses key_info, which is not freed together with it.
+Dictionary* group_aggregate(Iterator it, void* (^key_fn)(void* elem), KeyInfo* key_info, void* (^init_fn)(void* key), void* (^accumulate_fn)(void* aggregate, void* elem));
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdlib.h>
+#include "iterator.h"
+#include "keys.h"
+
+/**
+ * @file HashJoinTable
+ * @brief Equi-joins of the elements returned by two iterators.
+ *
+ * A hash join reads the elements of the build side into a HashJoinTable indexed by the hash of
+ * their keys, then streams the elements of the probe side looking up their keys in the table:
+ * it takes O(n + m) time instead of the O(n * m) of a nested loop. For each pair of elements
+ * whose keys compare as equal (according to the given KeyInfo), the callback is called with the
+ * element of the build side and the one of the probe side, in this order.
+ *
+ * The table stores the entries of each bucket contiguously, so that a lookup reads consecutive
+ * memory. When the table is larger than the processor caches, almost every lookup is a cache
+ * miss: radix_hash_join first splits both sides into partitions by the hash of their keys, then
+ * joins each pair of partitions with a table that fits in the cache.
+ *
+ * The elements of the build side (and the keys returned for them) need to stay valid during the
+ * join, so iterators that reuse the memory of the returned elements (e.g., TextFile_it) can only
+ * be used on the probe side of hash_join.
+ *
+ * **Example**
+ *
+ * ```c
+ * hash_join(Array_it(departments), Array_it(employees), key_info, ^void*(void* department) {
+ *   return &((Department*) department)->id;
+ * }, ^void*(void* employee) {
+ *   return &((Employee*) employee)->department_id;
+ * }, ^(void* department, void* employee) {
+ *   printf("%s works in %s\n", ((Employee*) employee)->name, ((Department*) department)->name);
+ * });
+ * ```
+ */
+
+typedef struct _HashJoinTable HashJoinTable;
+
+// Constructor
+
+/// @brief Builds a table indexing the elements returned by it by the keys returned by key_fn.
+/// Elements with equal keys are all kept.
+HashJoinTable* HashJoinTable_new(Iterator it, KeyInfo* key_info, void* (^key_fn)(void* elem));
+
+// Destructor
+
+/// @brief Frees the memory allocated by the table (the indexed elements are not freed).
+void HashJoinTable_free(HashJoinTable* table);
+
+// Accessors
+
+/// @brief Returns the number of indexed elements.
+size_t HashJoinTable_size(HashJoinTable* table);
+
+// Lookups
+
+/// @brief Calls callback(build_elem, probe_elem) for each indexed element whose key is equal to
+/// key, returns the number of such elements. The table is not modified, so lookups can be run
+/// concurrently.
+size_t HashJoinTable_probe(HashJoinTable* table, const void* key, void* probe_elem, void (^callback)(void* build_elem, void* probe_elem));
+
+// Joins
+
+/// @brief Joins the elements returned by build and probe. The table is built on the smaller
+/// side when both iterators are random access (the arguments of callback are not swapped),
+/// otherwise on build. Callbacks are called in the order of the side that is not indexed: the
+/// probe order, unless both iterators are random access and build is the larger side.
+void hash_join(Iterator build, Iterator probe, KeyInfo* key_info, void* (^build_key_fn)(void* elem), void* (^probe_key_fn)(void* elem), void (^callback)(void* build_elem, void* probe_elem));
+
+/// @brief Joins the elements returned by build and probe as hash_join does, splitting both sides
+/// into partitions whose tables fit in the cache. Both sides are read before the join (so the
+/// elements of both need to stay valid) and callbacks are called in no particular order. It is
+/// faster than hash_join when the build side has more than a few tens of thousands of elements.
+void radix_hash_join(Iterator build, Iterator probe, KeyInfo* key_info, void* (^build_key_fn)(void* elem), void* (^probe_key_fn)(void* elem), void (^callback)(void* build_elem, void* probe_elem));
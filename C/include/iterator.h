@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdlib.h>
+#include <stddef.h>
 
 /// @file iterator.h
 /// @brief The Iterator type is the basis for the cross-container support for iteration functions.
@@ -88,9 +89,72 @@
 /// the result of the cloning operation into a pointer. Since that storage is sufficient to actually
 /// hold the data (i.e., the pointer in the container) it is not necessary to alloc memory just to
 /// hold the pointer.
+///
+/// ### Batch and Span Iterators
+/// Iteration functions (for_each, map, find_first, count, reduce, ...) pay at least three
+/// indirect calls per element (end, get, next). Iterators can optionally provide one of the
+/// following function pointers, allowing those functions to run tight loops over many elements
+/// at a time:
+///
+/// - next_span: a function that returns the longest run of elements stored contiguously in memory
+///       starting at the current one, and moves the iterator past them;
+///       input: an instance of the iterator and the view to be filled with the run of elements
+///       output: the number of elements in the run (0 if the iterator is at the end)
+/// - next_batch: a function that copies the elements starting at the current one into the
+///       given buffer (as get would return them), and moves the iterator past them;
+///       input: an instance of the iterator, the buffer, and its capacity
+///       output: the number of elements copied (0 if the iterator is at the end)
+///
+/// Containers storing their elements in arrays should provide next_span, other containers
+/// can provide next_batch. The elements of a span are to be accessed as ArrayView_at would do
+/// (see array_view.h).
+/// Since spans and batches are fetched ahead of the callbacks, the container must not be
+/// modified while it is iterated by those functions.
+///
+/// ### Splittable Iterators
+/// Iterators over containers that are not random access can still be processed in parallel if
+/// they provide the following function pointer (the same idea as Java's Spliterator):
+///
+/// - split: a function that hands off (roughly) half of the elements not yet visited by an
+///       iterator instance to a new instance. The given instance keeps the current element
+///       and iterates only the elements it has not handed off.
+///       input: an instance of the iterator
+///       output: a new instance iterating the handed off elements, or NULL if the remaining
+///       elements cannot be split (the new instance is to be released using free)
+///
+/// Each element is visited by exactly one of the instances obtained by repeatedly splitting an
+/// instance. After a split, to_begin moves an instance to the first element of its own part.
+/// The order in which the parts visit the elements is not related to the iteration order of
+/// the unsplit instance. Instances can be split and iterated concurrently as long as the
+/// container is not modified.
+///
+/// ### Inline Iterators
+/// new_iterator allocates instances on the heap, which dominates the cost of short iterations.
+/// Iterators whose instances fit in ITERATOR_STORAGE_SIZE bytes can provide the following
+/// function pointers, so that the iteration functions place their instances on the stack:
+///
+/// - init_iterator: a function that initializes an iterator instance in the given storage
+///       input: the container and the storage (an IteratorStorage)
+///       output: the iterator instance (i.e., the given storage)
+/// - deinit_iterator: a function that releases the resources held by an instance initialized
+///       by init_iterator, without freeing its storage (NULL if there is nothing to release)
+///
+/// Iterator_new_instance and Iterator_free_instance use them when available and fall back to
+/// new_iterator and free otherwise.
+
+/// Size of the storage reserved for the instances of inline iterators
+#define ITERATOR_STORAGE_SIZE 64
+
+/// @brief Storage for an iterator instance, usually placed on the stack of the caller.
+typedef union {
+  max_align_t align;
+  unsigned char bytes[ITERATOR_STORAGE_SIZE];
+} IteratorStorage;
 
 typedef struct _Iterator Iterator;
 
+struct _ArrayView;
+
 struct _Iterator {
   // all iterators
   void* container;
@@ -117,6 +181,17 @@ struct _Iterator {
   void* (*alloc_obj)(void*);
   void* (*copy_obj)(void*, void*);
   void  (*free_obj)(void*);
+
+  // batch and span iterators
+  size_t (*next_batch)(void*, void** out, size_t max);
+  size_t (*next_span)(void*, struct _ArrayView* span);
+
+  // splittable iterators
+  void* (*split)(void*);
+
+  // inline iterators
+  void* (*init_iterator)(void*, void*);
+  void  (*deinit_iterator)(void*);
 };
 
 
@@ -135,6 +210,18 @@ int is_mutable_iterator(Iterator it);
 /// @brief Returns 1 if the iterator is a cloning iterator and 0 otherwise.
 int is_cloning_iterator(Iterator it);
 
+/// @brief Returns 1 if the iterator is a batch iterator and 0 otherwise.
+int is_batch_iterator(Iterator it);
+
+/// @brief Returns 1 if the iterator is a span iterator and 0 otherwise.
+int is_span_iterator(Iterator it);
+
+/// @brief Returns 1 if the iterator is a splittable iterator and 0 otherwise.
+int is_splittable_iterator(Iterator it);
+
+/// @brief Returns 1 if the iterator is an inline iterator and 0 otherwise.
+int is_inline_iterator(Iterator it);
+
 // The following functions can be used to generate an error and halt the program if an iterator
 // does not satisfy a given piece of the Iterator interface.
 
@@ -150,6 +237,9 @@ void require_mutable_iterator(Iterator it);
 /// @brief If the iterator is not a cloning iterator, it will generate an error and halt the program.
 void require_cloning_iterator(Iterator it);
 
+/// @brief If the iterator is not a splittable iterator, it will generate an error and halt the program.
+void require_splittable_iterator(Iterator it);
+
 
 
 
@@ -251,3 +341,76 @@ Iterator CloningIterator_make(
   void* (*copy_obj)(void* iterator, void* to_mem),
   void (*free_obj)(void* obj)
 );
+
+
+/// @brief BatchIterator APIs
+/// A batch iterator returns many elements at a time, so that the iteration functions can
+/// amortize the cost of the indirect calls (see the description of the Iterator struct).
+///
+/// Example:
+/// ```C
+///  Iterator it = Iterator_make(...);
+///  it = BatchIterator_make(it, _my_next_batch_fun);
+/// ```
+
+Iterator BatchIterator_make(
+  Iterator iterator,
+  size_t (*next_batch)(void* iterator, void** out, size_t max)
+);
+
+
+/// @brief SpanIterator APIs
+/// A span iterator returns the runs of elements stored contiguously in the container, so that
+/// the iteration functions can loop over them directly (see the description of the Iterator struct).
+///
+/// Example:
+/// ```C
+///  Iterator it = Iterator_make(...);
+///  it = SpanIterator_make(it, _my_next_span_fun);
+/// ```
+
+Iterator SpanIterator_make(
+  Iterator iterator,
+  size_t (*next_span)(void* iterator, struct _ArrayView* span)
+);
+
+
+/// @brief SplittableIterator APIs
+/// A splittable iterator can hand off part of its elements to a new iterator instance, so that
+/// the parts can be processed concurrently (see the description of the Iterator struct).
+///
+/// Example:
+/// ```C
+///  Iterator it = Iterator_make(...);
+///  it = SplittableIterator_make(it, _my_split_fun);
+/// ```
+
+Iterator SplittableIterator_make(
+  Iterator iterator,
+  void* (*split)(void* iterator)
+);
+
+
+/// @brief InlineIterator APIs
+/// An inline iterator can initialize its instances in a storage provided by the caller (see the
+/// description of the Iterator struct). deinit_iterator can be NULL.
+///
+/// Example:
+/// ```C
+///  Iterator it = Iterator_make(...);
+///  it = InlineIterator_make(it, _my_init_fun, NULL);
+/// ```
+
+Iterator InlineIterator_make(
+  Iterator iterator,
+  void* (*init_iterator)(void* container, void* storage),
+  void  (*deinit_iterator)(void* iterator)
+);
+
+/// @brief Creates a new instance of the given iterator. If the iterator is an inline iterator,
+/// the instance is initialized in the given storage, otherwise it is allocated by new_iterator.
+/// The instance is to be freed using Iterator_free_instance.
+void* Iterator_new_instance(Iterator it, IteratorStorage* storage);
+
+/// @brief Frees an instance created by Iterator_new_instance.
+void Iterator_free_instance(Iterator it, void* iterator);
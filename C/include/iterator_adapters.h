@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdlib.h>
+#include "iterator.h"
+#include "array_view.h"
+#include "keys.h"
+
+/// @file iterator_adapters.h
+/// # Iterator Adapters
+/// Iterator adapters build new Iterators out of existing ones. Differently from map() and
+/// filter() (see iterator_functions.h), which store their results into a new Array, adapters
+/// compute their elements on demand while they are iterated, so that a pipeline of adapters
+/// runs in a single pass over the source and uses O(1) extra memory (O(size) for chunk_it and
+/// window_it):
+///
+/// ```c
+/// // sums the lengths of the non empty lines of a file without storing them
+/// __block size_t total = 0;
+/// for_each(map_it(filter_it(TextFile_it("file.txt", '\n'), ^int(void* line) {
+///     return ((char*) line)[0] != '\0';
+///   }), ^void*(void* line) {
+///     return (void*) strlen(line);
+///   }), ^(void* len) {
+///     total += (size_t) len;
+/// });
+/// ```
+///
+/// Adapters take ownership of the given iterators: as Number_it and TextFile_it, the Iterators
+/// returned by the adapters are meant to be used by a single iteration function (all the
+/// resources, including the source iterators, are released when the iteration ends).
+///
+/// merge_it lazily merges k sorted iterators (e.g., sorted runs of an external sort or the
+/// sorted chunks of a parallel sort) using a loser tree: each element costs O(log k)
+/// comparisons and the merge uses O(k) memory.
+///
+/// Adapters return basic iterators. The objects returned by zip_it, enumerate_it, chunk_it and
+/// window_it are owned by the iterator and are valid until it moves to the next element.
+/// chunk_it and window_it retain the elements of the source iterator: they need the elements
+/// to stay valid while the source moves on (e.g., it is the case for iterators over containers
+/// of pointers, it is not for TextFile_it whose lines need to be copied first, e.g., using map_it).
+
+/// @brief Element of the iterators returned by zip_it.
+typedef struct {
+  void* first;
+  void* second;
+} ZipPair;
+
+/// @brief Element of the iterators returned by enumerate_it.
+typedef struct {
+  size_t index;
+  void* elem;
+} Enumerated;
+
+/// @brief Returns an iterator over the results of calling mapping on the elements of it.
+/// mapping is called at most once per element.
+Iterator map_it(Iterator it, void* (^mapping)(void*));
+
+/// @brief Returns an iterator over the elements of it for which keep returns 1.
+Iterator filter_it(Iterator it, int (^keep)(void*));
+
+/// @brief Returns an iterator over the first n elements of it.
+Iterator take_it(Iterator it, size_t n);
+
+/// @brief Returns an iterator over the elements of it following the first n ones.
+Iterator skip_it(Iterator it, size_t n);
+
+/// @brief Returns an iterator over the pairs (ZipPair*) of corresponding elements of it1 and it2.
+/// The iteration stops when either iterator ends.
+Iterator zip_it(Iterator it1, Iterator it2);
+
+/// @brief Returns an iterator over the elements of it paired with their index (Enumerated*).
+Iterator enumerate_it(Iterator it);
+
+/// @brief Returns an iterator over the elements of it1 followed by the elements of it2.
+Iterator chain_it(Iterator it1, Iterator it2);
+
+/// @brief Returns an iterator over consecutive, non overlapping, chunks (ArrayView*) of size
+/// elements of it. The last chunk may be smaller.
+/// @warning It raises an ERROR_GENERIC if size is 0.
+Iterator chunk_it(Iterator it, size_t size);
+
+/// @brief Returns an iterator over the sliding windows (ArrayView*) of size consecutive elements
+/// of it. If it has less than size elements, the returned iterator is empty.
+/// @warning It raises an ERROR_GENERIC if size is 0.
+Iterator window_it(Iterator it, size_t size);
+
+/// @brief Returns an iterator over the elements of the k given iterators, each sorted according
+/// to compare, in sorted order. Equal elements are returned in the order of the inputs (the merge
+/// is stable). The adapter takes ownership of the iterators, the inputs array is copied.
+Iterator merge_it(Iterator* inputs, size_t k, KIBlkComparator compare);
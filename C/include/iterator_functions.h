@@ -19,7 +19,10 @@
 /// - for_each_with_index();
 /// - find_first();
 /// - map();
+/// - reduce();
 /// - free_contents();
+/// - top_k();
+/// - top_k_copy();
 ///
 /// ## Functions requiring bidirectional iterators
 ///
@@ -41,6 +44,8 @@
 ///
 /// - reverse_contents();
 /// - sort();
+/// - nth_element();
+/// - partial_sort();
 
 // --------------------------------------------------------------------------------
 // Functions requiring basic iterators
@@ -75,9 +80,27 @@ void* find_first(Iterator, int(^condition)(void* elem));
 /// returned Array needs to be freed by the user.
 Array* map(Iterator, void* (^)(void*));
 
+/// Combines the elements of the container iterated by the given iterator into a single value:
+/// the accumulator is initialized with initial_value and it is replaced by the result of
+/// combine(accumulator, elem) for each element. It returns the final value of the accumulator.
+void* reduce(Iterator, void* initial_value, void* (^combine)(void* accumulator, void* elem));
+
 /// Frees the content of the given iterator using Mem_free
 void free_contents(Iterator);
 
+/// Returns a new array with the k smallest elements (according to compare) among the ones returned
+/// by the iterator, in sorted order (fewer if the container has less than k elements). Pass a
+/// reversed comparator to select the k largest ones. The elements are read in a single pass
+/// keeping a heap of k elements, so it runs in O(n log k) time and O(k) space.
+/// Note: The elements are not duplicated, they need to stay valid until the result is used.
+Array* top_k(Iterator it, size_t k, KIBlkComparator compare);
+
+/// As top_k, but the elements entering the heap are duplicated using copy and the ones leaving it
+/// are freed using Mem_free. Use it with iterators that reuse the memory of the returned elements
+/// (e.g., TextFile_it with Mem_strdup). The elements of the result need to be freed using
+/// free_contents.
+Array* top_k_copy(Iterator it, size_t k, KIBlkComparator compare, void* (^copy)(void* elem));
+
 // --------------------------------------------------------------------------------
 // Functions requiring bidirectional iterators
 // --------------------------------------------------------------------------------
@@ -110,6 +133,9 @@ void* last(Iterator it);
 size_t count(Iterator it);
 
 /// Finds an occurrence of the given elem. It returns the index of the found element or (size_t) -1.
+/// Containers storing their elements in a single span (e.g., Array, ArrayAlt) are searched
+/// directly in memory. To search the same container many times, consider a SearchIndex (see
+/// search_index.h).
 ///
 /// @warning it requires a random access iterator
 size_t binsearch(Iterator it, const void *elem, KIBlkComparator compare);
@@ -142,3 +168,18 @@ void reverse_contents(Iterator it);
 /// @warning it requires a mutable and cloning iterator. If "it" is also a random access iterator, 
 ///     the function switches to an implementation that uses less memory and runs faster.
 void sort(Iterator it, KIBlkComparator compare);
+
+/// Rearranges the elements iterated by it so that the element at position n is the one that would
+/// be there if the elements were sorted, no element before it is larger and no element after it is
+/// smaller. It runs in linear time on average (introselect).
+/// @warning it requires a mutable and cloning iterator, Array_it and by reference array views are
+///     rearranged in place. It raises an ERROR_INDEX_OUT_OF_BOUND if n is not smaller than the
+///     number of elements.
+void nth_element(Iterator it, size_t n, KIBlkComparator compare);
+
+/// Rearranges the elements iterated by it so that the first k of them are the k smallest elements
+/// in sorted order, the order of the remaining ones is unspecified. If k is larger than the number
+/// of elements, all of them are sorted.
+/// @warning it requires a mutable and cloning iterator, Array_it and by reference array views are
+///     rearranged in place.
+void partial_sort(Iterator it, size_t k, KIBlkComparator compare);
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdlib.h>
+#include "iterator.h"
+#include "print_time.h"
+
+/**
+ * @file iterator_instrumentation.h
+ * @brief Counters and timings of the calls made to iterators, to find where the time of a
+ * pipeline goes.
+ *
+ * instrument_it(it, label) returns an iterator behaving as it (it provides the same traits, so
+ * that the iteration functions take the same paths) that counts the instances created and the
+ * calls made to each of them, and measures the time spent inside the calls to it (e.g., reading
+ * a file for TextFile_it, or computing the elements for map_it). The time elapsed between the
+ * creation and the release of each instance is measured too: the difference is the time spent
+ * by the caller (e.g., in the block given to for_each).
+ *
+ * Statistics are collected in a global registry, by label: iterators instrumented with the same
+ * label add up. Instances update their own counters, which are added to the registry when they
+ * are freed, so that instances used by different threads do not contend (e.g., in
+ * par_for_each). Timings use the time stamp counter on x86 processors and clock_gettime
+ * otherwise.
+ *
+ * Instrumentation is compiled in only if ITERATOR_INSTRUMENTATION is defined (e.g., adding
+ * -DITERATOR_INSTRUMENTATION to CFLAGS in Makefile.vars), otherwise instrument_it(it, label)
+ * is just it and costs nothing.
+ *
+ * **Example**
+ *
+ * ```c
+ * for_each(map_it(instrument_it(TextFile_it("records.csv", '\n'), "file"), parse), ^(void* record) {
+ *   ...
+ * });
+ * Instrumentation_print_report();
+ * Instrumentation_save_report(pt);  // adds the statistics to the data saved by PrintTime
+ * ```
+ */
+
+/// @brief Statistics of the iterators instrumented with the same label (label is owned by the
+/// registry).
+typedef struct {
+  const char* label;
+  /// number of instances created (by new_iterator, or split from other instances)
+  size_t instances;
+  size_t next_calls;
+  size_t get_calls;
+  /// calls to any other function of the iterator (end, to_begin, move_to, next_span, ...)
+  size_t other_calls;
+  /// elements moved over by next, or returned by next_batch and next_span
+  size_t elements;
+  /// time spent inside the calls to the instrumented iterator
+  double inside_seconds;
+  /// time elapsed between the creation and the release of the instances
+  double lifetime_seconds;
+} IteratorStats;
+
+#ifdef ITERATOR_INSTRUMENTATION
+#define instrument_it(it, label) instrument_it_ext((it), (label))
+#else
+#define instrument_it(it, label) (it)
+#endif
+
+/// @brief Returns an instrumented version of it collecting its statistics under the given label.
+/// Use the instrument_it macro instead, which compiles to it when instrumentation is disabled.
+/// @warning The returned iterator can be used as long as Instrumentation_reset is not called.
+Iterator instrument_it_ext(Iterator it, const char* label);
+
+/// @brief Copies into stats the statistics collected under the given label by the instances freed
+/// so far, returns 0 if no iterator has been instrumented with that label.
+int Instrumentation_stats(const char* label, IteratorStats* stats);
+
+/// @brief Prints a table with the statistics of each label to stdout.
+void Instrumentation_print_report(void);
+
+/// @brief Adds the statistics of each label to the data saved by PrintTime_save (e.g.,
+/// "label.next_calls" and "label.inside_seconds").
+void Instrumentation_save_report(PrintTime* pt);
+
+/// @brief Clears the registry. No instrumented iterator (nor instance) can be used afterwards.
+void Instrumentation_reset(void);
@@ -36,6 +36,11 @@ void List_append(List* list, void* elem);
 // Deletes the given ListNode* from the list
 void List_delete_node(List* list, ListNode* node);
 
+// Packs the elements of the unrolled implementation into as few chunks as possible,
+// releasing the chunks left sparse by deletions. It invalidates all the ListNode
+// pointers to the elements of the list. The other implementations have nothing to pack.
+void List_compact(List* list);
+
 // Returns the list node at the head of the list
 ListNode* List_head(List* list);
 
@@ -60,6 +65,18 @@ ListNode* List_find(List* list, int (*elem_selector)(const void*));
 // Identical to List_find, but accept a block instead of a function.
 ListNode* List_find_wb(List* list, int (^elem_comparator)(const void*));
 
+// Sorts the list in place according to compare. The sort is stable and allocates
+// no memory in the linked list implementation: nodes are relinked (so that each
+// ListNode keeps its element) by a bottom-up merge of the already sorted runs
+// found in the list, so that nearly sorted lists are sorted in nearly linear time.
+// The other implementations fall back to (merge) sorting an array of the elements.
+void List_sort(List* list, KIBlkComparator compare);
+
+// Merges the sorted lists a and b appending the result to dest. Elements comparing
+// equal are taken from a first. a and b are left empty; dest may be a or b, while
+// a and b must be different lists.
+void List_merge(List* dest, List* a, List* b, KIBlkComparator compare);
+
 // Returns the element stored in the given ListNode
 void* ListNode_get(List*, ListNode*);
 
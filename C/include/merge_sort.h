@@ -6,6 +6,10 @@
 // Implements the merge sort algorithm
 void merge_sort(void** array, size_t count, KIComparator compare);
 
+// Implements the merge sort algorithm. It assumes that each element in the array is a pointer
+// and accepts a block instead of a function. As merge_sort, the sort is stable.
+void merge_sort_wb(void** array, size_t count, KIBlkComparator compare);
+
 // Implements the merge sort algorithm. This function allows one to sort arrays of any type
 // whereas `merge_sort` assumes that each element of the array is a pointer.
 void merge_sort_g(void* array, size_t count, size_t size, KIComparator);
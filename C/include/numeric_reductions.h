@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "iterator.h"
+
+/// @file numeric_reductions.h
+/// # Numeric Reductions and Scans
+/// Typed kernels computing aggregates (sum, min, max, argmin, argmax, mean, histogram) and
+/// inclusive prefix sums over int32_t, int64_t, float and double values. The kernels use AVX2
+/// or SSE2 instructions when the library is compiled for a processor supporting them (e.g., by
+/// adding -mavx2 to CFLAGS in Makefile.vars) and scalar loops otherwise. Defining
+/// NUMERIC_REDUCTIONS_NO_SIMD forces the scalar loops.
+///
+/// Each kernel is available over C arrays and over the spans of an Iterator:
+///
+/// ```c
+/// int64_t total = sum_int32(values, n);
+/// int64_t same_total = iterator_sum_int32(CArray_it(values, n, sizeof(int32_t)));
+/// double mean = iterator_mean_double(ArrayAlt_it(doubles));
+/// ```
+///
+/// The iterator versions require a span iterator returning its elements by value (e.g.,
+/// CArray_it, ArrayAlt_it or ArrayView_it over a view made by ArrayView_make_by_value) whose
+/// elements have the size of the given type, otherwise they raise ERROR_ITERATOR_MISUSE.
+/// Indices returned by the iterator versions are positions in the iteration order.
+///
+/// Sums of int32_t and int64_t values are computed in int64_t and wrap around on overflow,
+/// sums of float values are computed in double. SIMD kernels add floating point values in a
+/// different order than a sequential loop does, so that the results may differ in the last
+/// bits. min, max, argmin, argmax and mean raise ERROR_INDEX_OUT_OF_BOUND on empty inputs.
+/// The results of min, max, argmin and argmax are unspecified if the values contain NaNs.
+///
+/// histogram adds to bins[i] the number of values in [min + i * w, min + (i + 1) * w), where
+/// w = (max - min) / num_bins; max is counted in the last bin and values outside [min, max]
+/// are not counted. It raises ERROR_GENERIC if num_bins is 0 or max <= min.
+///
+/// prefix_sum stores in result[i] the sum of values[0..i]; result can be the values array.
+/// The iterator versions store count(it) sums in result.
+
+// int32_t values
+
+int64_t sum_int32(const int32_t* values, size_t n);
+int32_t min_int32(const int32_t* values, size_t n);
+int32_t max_int32(const int32_t* values, size_t n);
+size_t argmin_int32(const int32_t* values, size_t n);
+size_t argmax_int32(const int32_t* values, size_t n);
+double mean_int32(const int32_t* values, size_t n);
+void histogram_int32(const int32_t* values, size_t n, int32_t min, int32_t max, size_t* bins, size_t num_bins);
+void prefix_sum_int32(const int32_t* values, int32_t* result, size_t n);
+
+int64_t iterator_sum_int32(Iterator it);
+int32_t iterator_min_int32(Iterator it);
+int32_t iterator_max_int32(Iterator it);
+size_t iterator_argmin_int32(Iterator it);
+size_t iterator_argmax_int32(Iterator it);
+double iterator_mean_int32(Iterator it);
+void iterator_histogram_int32(Iterator it, int32_t min, int32_t max, size_t* bins, size_t num_bins);
+void iterator_prefix_sum_int32(Iterator it, int32_t* result);
+
+// int64_t values
+
+int64_t sum_int64(const int64_t* values, size_t n);
+int64_t min_int64(const int64_t* values, size_t n);
+int64_t max_int64(const int64_t* values, size_t n);
+size_t argmin_int64(const int64_t* values, size_t n);
+size_t argmax_int64(const int64_t* values, size_t n);
+double mean_int64(const int64_t* values, size_t n);
+void histogram_int64(const int64_t* values, size_t n, int64_t min, int64_t max, size_t* bins, size_t num_bins);
+void prefix_sum_int64(const int64_t* values, int64_t* result, size_t n);
+
+int64_t iterator_sum_int64(Iterator it);
+int64_t iterator_min_int64(Iterator it);
+int64_t iterator_max_int64(Iterator it);
+size_t iterator_argmin_int64(Iterator it);
+size_t iterator_argmax_int64(Iterator it);
+double iterator_mean_int64(Iterator it);
+void iterator_histogram_int64(Iterator it, int64_t min, int64_t max, size_t* bins, size_t num_bins);
+void iterator_prefix_sum_int64(Iterator it, int64_t* result);
+
+// float values
+
+double sum_float(const float* values, size_t n);
+float min_float(const float* values, size_t n);
+float max_float(const float* values, size_t n);
+size_t argmin_float(const float* values, size_t n);
+size_t argmax_float(const float* values, size_t n);
+double mean_float(const float* values, size_t n);
+void histogram_float(const float* values, size_t n, float min, float max, size_t* bins, size_t num_bins);
+void prefix_sum_float(const float* values, float* result, size_t n);
+
+double iterator_sum_float(Iterator it);
+float iterator_min_float(Iterator it);
+float iterator_max_float(Iterator it);
+size_t iterator_argmin_float(Iterator it);
+size_t iterator_argmax_float(Iterator it);
+double iterator_mean_float(Iterator it);
+void iterator_histogram_float(Iterator it, float min, float max, size_t* bins, size_t num_bins);
+void iterator_prefix_sum_float(Iterator it, float* result);
+
+// double values
+
+double sum_double(const double* values, size_t n);
+double min_double(const double* values, size_t n);
+double max_double(const double* values, size_t n);
+size_t argmin_double(const double* values, size_t n);
+size_t argmax_double(const double* values, size_t n);
+double mean_double(const double* values, size_t n);
+void histogram_double(const double* values, size_t n, double min, double max, size_t* bins, size_t num_bins);
+void prefix_sum_double(const double* values, double* result, size_t n);
+
+double iterator_sum_double(Iterator it);
+double iterator_min_double(Iterator it);
+double iterator_max_double(Iterator it);
+size_t iterator_argmin_double(Iterator it);
+size_t iterator_argmax_double(Iterator it);
+double iterator_mean_double(Iterator it);
+void iterator_histogram_double(Iterator it, double min, double max, size_t* bins, size_t num_bins);
+void iterator_prefix_sum_double(Iterator it, double* result);
@@ -9,6 +9,7 @@
 
 #ifdef LINUX
   #define OS_HAVE_MALLOC_H
+  #define OS_HAVE_MREMAP
 #endif
 
 #ifdef MACOS
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdlib.h>
+#include "iterator.h"
+#include "array.h"
+#include "task_pool.h"
+#include "group_aggregate.h"
+#include "hash_join.h"
+
+/// @file parallel_iterator_functions.h
+/// # Parallel Iterator Functions
+/// Parallel versions of the iteration functions declared in iterator_functions.h. The elements
+/// of a random access iterator are partitioned into ranges of (at most) grain consecutive elements
+/// which are processed concurrently by the workers of the given pool (the number of threads is the
+/// one the pool has been created with). Each range is iterated by its own iterator instance,
+/// created by new_iterator and positioned by move_to. If grain is 0, it is chosen so that each
+/// worker gets about 8 ranges.
+///
+/// The given blocks are called concurrently and must be thread safe. Results are returned in the
+/// same order the sequential functions would return them.
+///
+/// ```c
+/// TaskPool* pool = TaskPool_new(0);
+/// Array* lengths = par_map(pool, Array_it(strings), 0, ^void*(void* str) {
+///   return (void*) strlen(str);
+/// });
+/// TaskPool_free(pool);
+/// ```
+///
+/// par_for_each, par_count and par_hash_join (on the probe side) also accept splittable iterators
+/// (e.g., Dictionary_it, Edge_it, TextFile_it): the iterator is split into about 8 parts per
+/// worker (grain is ignored) and each part is processed by a task. The parts are visited in no
+/// particular order.
+///
+/// @warning par_map, par_filter, par_reduce and par_group_aggregate require a random access
+/// iterator, par_for_each, par_count and par_hash_join require either a random access or a
+/// splittable iterator.
+
+/// @brief Calls callback on each element of the container iterated by the given Iterator.
+/// Callbacks are run concurrently in no particular order.
+void par_for_each(TaskPool* pool, Iterator it, size_t grain, void (^callback)(void* elem));
+
+/// @brief Builds a new array containing the results of mapping_function on the elements of
+/// the container iterated by the given Iterator, in iteration order.
+Array* par_map(TaskPool* pool, Iterator it, size_t grain, void* (^mapping_function)(void* elem));
+
+/// @brief Builds a new array containing the elements for which keep returns 1, in iteration order.
+Array* par_filter(TaskPool* pool, Iterator it, size_t grain, int (^keep)(void* elem));
+
+/// @brief Combines the elements of the container iterated by the given Iterator as reduce()
+/// does. The elements of each range are combined starting from identity, then the partial
+/// results are combined in iteration order: combine needs to be associative and identity
+/// needs to be its neutral element (e.g., 0 for sums). The arguments of combine can be either
+/// elements or partial results.
+void* par_reduce(TaskPool* pool, Iterator it, size_t grain, void* identity, void* (^combine)(void* lhs, void* rhs));
+
+/// @brief Returns the number of elements for which condition returns 1.
+size_t par_count(TaskPool* pool, Iterator it, size_t grain, int (^condition)(void* elem));
+
+/// @brief Groups and aggregates the elements as group_aggregate does (see group_aggregate.h).
+/// Each range is aggregated into its own partial dictionary, then the partial aggregates of the
+/// same key are combined by merge_fn(aggregate, partial), which returns the combined aggregate
+/// (and frees partial, if needed). If grain is 0, each worker gets a single range, so that there
+/// is a partial dictionary per worker.
+Dictionary* par_group_aggregate(TaskPool* pool, Iterator it, size_t grain, void* (^key_fn)(void* elem), KeyInfo* key_info, void* (^init_fn)(void* key), void* (^accumulate_fn)(void* aggregate, void* elem), void* (^merge_fn)(void* aggregate, void* partial));
+
+/// @brief Joins the elements returned by build and probe as hash_join does (see hash_join.h). The
+/// table is built on build, then the elements of probe are looked up concurrently: callback is
+/// called concurrently and in no particular order.
+void par_hash_join(TaskPool* pool, Iterator build, Iterator probe, size_t grain, KeyInfo* key_info, void* (^build_key_fn)(void* elem), void* (^probe_key_fn)(void* elem), void (^callback)(void* build_elem, void* probe_elem));
@@ -28,8 +28,12 @@ void PrintTime_free(PrintTime*);
 void PrintTime_add_header(PrintTime* pt, const char* key, const char* value);
 
 // Adds a timing of the given block with a key given by "label". The block can
-// itself print necessary information to stdout.
+// itself print necessary information to stdout. The timing is the elapsed
+// (wall clock) time, so that multithreaded blocks are measured correctly.
 double PrintTime_print(PrintTime* pt, char* label, void(^fun)(void));
 
+// Adds a value measured elsewhere (e.g., a counter) to the data with key given by "label".
+void PrintTime_add_data(PrintTime* pt, const char* label, double value);
+
 // Saves the printing information on disk. The writing is performed atomically.
 void PrintTime_save(PrintTime* pt);
@@ -1,8 +1,11 @@
 #pragma once
 
-#include "list.h"
+#include <stdlib.h>
 
-typedef List Queue;
+// Queue* opaque type. The queue is implemented on top of a growable circular
+// buffer (see deque.h), so enqueuing and dequeuing do not allocate memory
+// except when the buffer needs to grow.
+typedef struct _Queue Queue;
 
 
 // Creates a new queue and returns it
@@ -14,10 +17,19 @@ void Queue_free(Queue*);
 // Enqueues a new object at the back of the queue
 void Queue_enqueue(Queue*,void*);
 
-// Dequeues an object from the front of the queue
+// Dequeues an object from the front of the queue. Returns NULL if the
+// queue is empty.
 void* Queue_dequeue(Queue*);
 
-// Returns the front object (the next one that will be dequeued)
+// Enqueues count objects (taken in order from elems) at the back of the queue
+void Queue_enqueue_many(Queue*, void** elems, size_t count);
+
+// Dequeues up to max_count objects from the front of the queue storing them
+// in result. Returns the number of dequeued objects.
+size_t Queue_dequeue_many(Queue*, void** result, size_t max_count);
+
+// Returns the front object (the next one that will be dequeued) or NULL
+// if the queue is empty.
 void* Queue_front(Queue*);
 
 // Returns the queue size
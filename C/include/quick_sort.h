@@ -1,6 +1,7 @@
 #pragma once
 
 #include "keys.h"
+#include "task_pool.h"
 
 // Implements the quick sort algorithm. It assumes that each element in the array is a pointer
 // type.
@@ -13,3 +14,13 @@ void quick_sort_wb(void** array, size_t count, KIBlkComparator compare);
 // Implements the quick sort algorithm. This function allows one to sort arrays of any type
 // whereas `quick_sort` assumes that each element of the array is a pointer.
 void quick_sort_g(void* array, size_t count, size_t size, KIComparator);
+
+// Parallel versions of the functions above, running on the workers of the given pool. Ranges
+// larger than a cutoff are sorted by separate tasks, while the top levels (the ranges larger
+// than the array size divided by the number of workers) are partitioned in parallel, using a
+// temporary buffer as large as the array. Comparators are called concurrently.
+void par_quick_sort(TaskPool* pool, void** array, size_t count, KIComparator compare);
+
+void par_quick_sort_wb(TaskPool* pool, void** array, size_t count, KIBlkComparator compare);
+
+void par_quick_sort_g(TaskPool* pool, void* array, size_t count, size_t size, KIComparator compare);
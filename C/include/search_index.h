@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdlib.h>
+#include "iterator.h"
+#include "keys.h"
+
+/**
+ * @file SearchIndex
+ * @brief A SearchIndex answers repeated binary searches over a sorted container faster than
+ * binsearch does.
+ *
+ * The elements are stored in Eytzinger (breadth first) order: the root of the implicit search
+ * tree comes first, followed by its two children, and so on, so that the first levels of every
+ * search share a few cache lines. Searches descend the tree computing the next position from the
+ * result of the comparison (with no branch to mispredict) and prefetch the elements four levels
+ * below the current one. Iterators are used only to build the index.
+ *
+ * Elements returned by value by a span iterator (e.g., ArrayAlt_it) are copied into the index,
+ * otherwise the index stores the pointers returned by the iterator (e.g., Array_it), which need
+ * to stay valid until the index is freed. Indices returned by the search functions are the
+ * positions of the elements in the iterated container.
+ *
+ * **Example**
+ *
+ * ```c
+ * Array_sort(words, compare_strings);
+ * SearchIndex* index = SearchIndex_new(Array_it(words), compare_strings);
+ * size_t position = SearchIndex_search(index, "word");  // same result as binsearch
+ * SearchIndex_free(index);
+ * ```
+ */
+
+typedef struct _SearchIndex SearchIndex;
+
+// Constructor
+
+/// @brief Builds an index over the elements iterated by it, which must be sorted according to
+/// compare. Span iterators (e.g., Array_it, ArrayAlt_it) are read a span at a time.
+/// @warning It raises an ERROR_ITERATOR_MISUSE if the spans of it mix elements stored by value
+/// and by reference or elements of different sizes.
+SearchIndex* SearchIndex_new(Iterator it, KIBlkComparator compare);
+
+// Destructor
+
+/// @brief Frees the memory allocated by the index (the indexed elements are not freed).
+void SearchIndex_free(SearchIndex* index);
+
+// Accessors
+
+/// @brief Returns the number of indexed elements.
+size_t SearchIndex_size(SearchIndex* index);
+
+// Searches
+
+/// @brief Returns the position of an element equal to elem or (size_t) -1 if there is none.
+size_t SearchIndex_search(SearchIndex* index, const void* elem);
+
+/// @brief Returns the position of the first element not smaller than elem, or SearchIndex_size(index)
+/// if all elements are smaller.
+size_t SearchIndex_lower_bound(SearchIndex* index, const void* elem);
+
+/// @brief Returns the position of an element nearest to elem, as binsearch_approx does: the first
+/// element not smaller than elem, or the last one if all elements are smaller.
+/// @warning It raises an ERROR_INDEX_OUT_OF_BOUND if the index is empty.
+size_t SearchIndex_search_approx(SearchIndex* index, const void* elem);
@@ -27,5 +27,8 @@ void Stack_push(Stack* stack, void* node);
 // Returns 1 if the stack is empty, 0 otherwise.
 int Stack_empty(Stack* stack);
 
+// Returns the number of objects in the stack.
+size_t Stack_size(Stack* stack);
+
 // Returns 1 if s1 and s2 are the same stack (i.e., they contain the same objects)
 int Stack_same(Stack* s1, Stack* s2);
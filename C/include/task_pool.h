@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdlib.h>
+
+/**
+ * @file TaskPool
+ * @brief The TaskPool structure runs blocks concurrently on a fixed set of worker threads.
+ *
+ * Each worker owns a work-stealing deque (Chase-Lev): tasks spawned by a worker are pushed
+ * on and popped from the bottom of its own deque, with no contention with the other
+ * threads, while idle workers steal the oldest tasks from the top of the other deques.
+ * Tasks spawned by threads not belonging to the pool are placed in a shared
+ * ConcurrentQueue. Workers that find no work park on a condition variable and are woken
+ * up when new tasks are spawned, so that an idle pool does not consume processor time.
+ *
+ * Tasks are tracked by TaskGroup objects: TaskGroup_wait returns when all the tasks spawned
+ * in the group (including the ones spawned by those tasks) have completed. While waiting,
+ * the calling thread runs pending tasks, so that tasks can spawn and wait for subtasks
+ * without exhausting the workers (e.g., recursive divide and conquer algorithms).
+ *
+ * **Example**
+ *
+ * ```c
+ * TaskPool* pool = TaskPool_new(0);
+ * parallel_for(pool, n, 0, ^(size_t from, size_t to) {
+ *     for(size_t i = from; i < to; ++i) {
+ *         result[i] = f(input[i]);
+ *     }
+ * });
+ * TaskPool_free(pool);
+ * ```
+ */
+
+typedef struct _TaskPool TaskPool;
+typedef struct _TaskGroup TaskGroup;
+
+/// @brief Creates a new pool with the given number of worker threads. If num_workers is 0,
+/// the pool has a worker for each online processor.
+TaskPool* TaskPool_new(size_t num_workers);
+
+/// @brief Waits for the tasks spawned by TaskPool_spawn, stops the workers and frees the pool.
+/// All the other groups must have been waited for.
+void TaskPool_free(TaskPool* pool);
+
+/// @brief Returns the number of worker threads of the pool.
+size_t TaskPool_num_workers(TaskPool* pool);
+
+/// @brief Spawns the given task in the default group of the pool. The block is copied, so
+/// that it can be spawned from the stack frame of the caller.
+void TaskPool_spawn(TaskPool* pool, void (^task)(void));
+
+/// @brief Waits for the completion of all the tasks spawned by TaskPool_spawn.
+void TaskPool_wait(TaskPool* pool);
+
+/// @brief Creates a new, empty, group of tasks to be run on the given pool.
+TaskGroup* TaskGroup_new(TaskPool* pool);
+
+/// @brief Frees the group. No task of the group must be pending.
+void TaskGroup_free(TaskGroup* group);
+
+/// @brief Spawns the given task in the given group. The block is copied, so that it can be
+/// spawned from the stack frame of the caller.
+void TaskGroup_spawn(TaskGroup* group, void (^task)(void));
+
+/// @brief Waits for the completion of all the tasks spawned in the group, running pending
+/// tasks in the meanwhile.
+void TaskGroup_wait(TaskGroup* group);
+
+/// @brief Calls body on subranges [from, to) partitioning [0, n), running them in parallel on
+/// the given pool. Ranges are split in halves until they are not larger than grain elements
+/// (if grain is 0, it is chosen so that each worker gets about 8 ranges). It returns when
+/// all the ranges have been processed.
+void parallel_for(TaskPool* pool, size_t n, size_t grain, void (^body)(size_t from, size_t to));
@@ -8,10 +8,15 @@
 #include "limits.h"
 #include "macros.h"
 
+// Arrays created by Array_new_small store their first elements in inline_carray,
+// i.e., in the same allocation as the array header. When the inline storage is
+// exhausted, elements are moved to a heap buffer and inline_carray is unused.
+// Arrays created by the other constructors have no inline storage at all.
 struct _Array {
   void** carray;
   size_t capacity;
   size_t size;
+  void* inline_carray[];
 };
 
 struct _ArrayIterator {
@@ -29,6 +34,14 @@ Array* Array_new(size_t capacity) {
   return array;
 }
 
+Array* Array_new_small(size_t inline_capacity) {
+  Array* array = (Array*) Mem_alloc(sizeof(struct _Array) + sizeof(void*) * inline_capacity);
+  array->carray = array->inline_carray;
+  array->size = 0;
+  array->capacity = inline_capacity;
+  return array;
+}
+
 
 Array* Array_new_by_copying_carray(void* src, size_t size) {
   size_t capacity = size + 100;
@@ -48,7 +61,7 @@ Array* Array_dup(Array* array) {
 // Destructor
 void Array_free(Array* array) {
   if(array) {
-    if(array->carray) {
+    if(array->carray && array->carray != array->inline_carray) {
       Mem_free(array->carray);
     }
 
@@ -90,7 +103,16 @@ size_t Array_capacity(Array* array) {
 // Setters
 
 static void Array_realloc(Array* array) {
-  array->capacity *= 2;
+  array->capacity = array->capacity > 0 ? array->capacity * 2 : 1;
+
+  if(array->carray == array->inline_carray) {
+    // spilling the inline elements to the heap
+    void** carray = Mem_alloc(array->capacity * sizeof(void*));
+    memcpy(carray, array->inline_carray, array->size * sizeof(void*));
+    array->carray = carray;
+    return;
+  }
+
   array->carray = Mem_realloc(array->carray, array->capacity * sizeof(void*));
 }
 
@@ -152,15 +174,26 @@ void Array_sort(Array* array, KIBlkComparator compare) {
   #endif
 }
 
+ArrayView Array_slice(Array* array, size_t from, size_t to) {
+  ArrayView view = ArrayView_make(array->carray, array->size);
+  return ArrayView_slice(&view, from, to);
+}
+
 // Iterator
-ArrayIterator* ArrayIterator_new(Array* array) {
-  ArrayIterator* iterator = (ArrayIterator*) Mem_alloc(sizeof(struct _ArrayIterator*));
+_Static_assert(sizeof(struct _ArrayIterator) <= ITERATOR_STORAGE_SIZE, "ArrayIterator does not fit an IteratorStorage");
+
+ArrayIterator* ArrayIterator_init(Array* array, void* storage) {
+  ArrayIterator* iterator = (ArrayIterator*) storage;
   iterator->array = array;
   iterator->current_index = 0;
 
   return iterator;
 }
 
+ArrayIterator* ArrayIterator_new(Array* array) {
+  return ArrayIterator_init(array, Mem_alloc(sizeof(struct _ArrayIterator)));
+}
+
 void ArrayIterator_free(ArrayIterator* iterator) {
   Mem_free(iterator);
 }
@@ -215,6 +248,17 @@ int ArrayIterator_same(ArrayIterator* it1, ArrayIterator* it2) {
   return it1->array == it2->array && it1->current_index == it2->current_index;
 }
 
+size_t ArrayIterator_next_span(ArrayIterator* it, ArrayView* span) {
+  if(ArrayIterator_end(it)) {
+    return 0;
+  }
+
+  *span = ArrayView_make(it->array->carray + it->current_index, it->array->size - it->current_index);
+  it->current_index = it->array->size;
+
+  return span->size;
+}
+
 static void* ArrayIterator_alloc_obj(ArrayIterator* UNUSED(it)) {
   return NULL;
 }
@@ -264,5 +308,16 @@ Iterator Array_it(Array* array)
    (void  (*)(void*)) ArrayIterator_free_obj
  );
 
+ iterator = SpanIterator_make(
+   iterator,
+   (size_t (*)(void*, ArrayView*)) ArrayIterator_next_span
+ );
+
+ iterator = InlineIterator_make(
+   iterator,
+   (void* (*)(void*, void*)) ArrayIterator_init,
+   NULL
+ );
+
  return iterator;
 }
@@ -1,16 +1,43 @@
 #include "array_alt.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "array_g.h"
 #include "quick_sort.h"
 #include "errors.h"
 #include "mem.h"
-
+#include "os_macros.h"
+
+// File backed arrays start with an header describing the stored elements.
+// The elements follow the header, starting at ARRAY_ALT_MMAP_HEADER_SIZE
+// bytes from the beginning of the file (the padding keeps them aligned).
+#define ARRAY_ALT_MMAP_MAGIC 0x31544c4159415241ull // "ARAYALT1"
+#define ARRAY_ALT_MMAP_HEADER_SIZE 64
+
+typedef struct {
+  uint64_t magic;
+  uint64_t elem_size;
+  uint64_t size;
+  uint64_t capacity;
+} ArrayAltFileHeader;
+
+// fd is -1 for heap backed arrays. For file backed arrays carray points
+// inside mapping, just after the file header.
 struct _ArrayAlt {
   void* carray;
   size_t capacity;
   size_t size;
   size_t elem_size;
+
+  int fd;
+  void* mapping;
+  size_t mapping_len;
+  ArrayAltAdvice advice;
 };
 
 struct _ArrayAltIterator {
@@ -26,6 +53,10 @@ ArrayAlt* ArrayAlt_new(size_t capacity, size_t elem_size) {
   array->size = 0;
   array->capacity = capacity;
   array->elem_size = elem_size;
+  array->fd = -1;
+  array->mapping = NULL;
+  array->mapping_len = 0;
+  array->advice = ARRAY_ALT_ADVICE_NORMAL;
   return array;
 }
 
@@ -37,6 +68,10 @@ ArrayAlt* ArrayAlt_new_by_copying_carray(void* src, size_t size, size_t elem_siz
   array->capacity = capacity;
   array->size = size;
   array->elem_size = elem_size;
+  array->fd = -1;
+  array->mapping = NULL;
+  array->mapping_len = 0;
+  array->advice = ARRAY_ALT_ADVICE_NORMAL;
 
   memcpy(array->carray, src, size * elem_size);
   return array;
@@ -46,10 +81,161 @@ ArrayAlt* ArrayAlt_dup(ArrayAlt* array) {
   return ArrayAlt_new_by_copying_carray(ArrayAlt_carray(array), ArrayAlt_size(array), ArrayAlt_elem_size(array));
 }
 
+// --------------------------------------------------------------------------------
+// File backed arrays
+// --------------------------------------------------------------------------------
+
+static size_t ArrayAlt_mmap_len(size_t capacity, size_t elem_size) {
+  return ARRAY_ALT_MMAP_HEADER_SIZE + capacity * elem_size;
+}
+
+static int ArrayAlt_madvise_flag(ArrayAltAdvice advice) {
+  switch(advice) {
+    case ARRAY_ALT_ADVICE_SEQUENTIAL:
+      return MADV_SEQUENTIAL;
+    case ARRAY_ALT_ADVICE_RANDOM:
+      return MADV_RANDOM;
+    case ARRAY_ALT_ADVICE_NORMAL:
+      return MADV_NORMAL;
+  }
+}
+
+static void ArrayAlt_mmap_write_header(ArrayAlt* array) {
+  ArrayAltFileHeader* header = (ArrayAltFileHeader*) array->mapping;
+  header->magic = ARRAY_ALT_MMAP_MAGIC;
+  header->elem_size = array->elem_size;
+  header->size = array->size;
+  header->capacity = array->capacity;
+}
+
+// Maps mapping_len bytes of the array file and points carray to the first element.
+static void ArrayAlt_mmap_map(ArrayAlt* array, const char* path) {
+  array->mapping = mmap(NULL, array->mapping_len, PROT_READ | PROT_WRITE, MAP_SHARED, array->fd, 0);
+  if(array->mapping == MAP_FAILED) {
+    Error_raise(Error_new(ERROR_FILE_OPENING, "Cannot map file %s, reason: %s", path, strerror(errno)));
+  }
+
+  array->carray = at_g(array->mapping, ARRAY_ALT_MMAP_HEADER_SIZE, 1);
+  madvise(array->mapping, array->mapping_len, ArrayAlt_madvise_flag(array->advice));
+}
+
+static ArrayAlt* ArrayAlt_mmap_alloc(int fd, size_t capacity, size_t size, size_t elem_size) {
+  ArrayAlt* array = (ArrayAlt*) Mem_alloc(sizeof(struct _ArrayAlt));
+  array->capacity = capacity;
+  array->size = size;
+  array->elem_size = elem_size;
+  array->fd = fd;
+  array->mapping_len = ArrayAlt_mmap_len(capacity, elem_size);
+  array->advice = ARRAY_ALT_ADVICE_NORMAL;
+  return array;
+}
+
+ArrayAlt* ArrayAlt_new_mmap(const char* path, size_t elem_size, size_t capacity) {
+  if(capacity == 0) {
+    capacity = 1;
+  }
+
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if(fd < 0) {
+    Error_raise(Error_new(ERROR_FILE_OPENING, "Error opening file %s, reason: %s", path, strerror(errno)));
+  }
+
+  if(ftruncate(fd, (off_t) ArrayAlt_mmap_len(capacity, elem_size)) != 0) {
+    Error_raise(Error_new(ERROR_FILE_WRITING, "Cannot resize file %s, reason: %s", path, strerror(errno)));
+  }
+
+  ArrayAlt* array = ArrayAlt_mmap_alloc(fd, capacity, 0, elem_size);
+  ArrayAlt_mmap_map(array, path);
+  ArrayAlt_mmap_write_header(array);
+
+  return array;
+}
+
+ArrayAlt* ArrayAlt_open_mmap(const char* path) {
+  int fd = open(path, O_RDWR);
+  if(fd < 0) {
+    Error_raise(Error_new(ERROR_FILE_OPENING, "Error opening file %s, reason: %s", path, strerror(errno)));
+  }
+
+  struct stat file_stat;
+  if(fstat(fd, &file_stat) != 0) {
+    Error_raise(Error_new(ERROR_FILE_OPENING, "Cannot stat file %s, reason: %s", path, strerror(errno)));
+  }
+
+  ArrayAltFileHeader header;
+  if((size_t) file_stat.st_size < ARRAY_ALT_MMAP_HEADER_SIZE ||
+     pread(fd, &header, sizeof(ArrayAltFileHeader), 0) != (ssize_t) sizeof(ArrayAltFileHeader) ||
+     header.magic != ARRAY_ALT_MMAP_MAGIC) {
+    Error_raise(Error_new(ERROR_FILE_READING, "File %s does not contain a mapped ArrayAlt", path));
+  }
+
+  if(header.elem_size == 0 || header.size > header.capacity ||
+     ArrayAlt_mmap_len(header.capacity, header.elem_size) > (size_t) file_stat.st_size) {
+    Error_raise(Error_new(ERROR_FILE_READING, "File %s contains a corrupted ArrayAlt header", path));
+  }
+
+  ArrayAlt* array = ArrayAlt_mmap_alloc(fd, header.capacity, header.size, header.elem_size);
+  ArrayAlt_mmap_map(array, path);
+
+  return array;
+}
+
+static void ArrayAlt_mmap_realloc(ArrayAlt* array, size_t new_capacity) {
+  size_t new_len = ArrayAlt_mmap_len(new_capacity, array->elem_size);
+  if(ftruncate(array->fd, (off_t) new_len) != 0) {
+    Error_raise(Error_new(ERROR_FILE_WRITING, "Cannot grow mapped array, reason: %s", strerror(errno)));
+  }
+
+#ifdef OS_HAVE_MREMAP
+  void* mapping = mremap(array->mapping, array->mapping_len, new_len, MREMAP_MAYMOVE);
+#else
+  munmap(array->mapping, array->mapping_len);
+  void* mapping = mmap(NULL, new_len, PROT_READ | PROT_WRITE, MAP_SHARED, array->fd, 0);
+#endif
+
+  if(mapping == MAP_FAILED) {
+    Error_raise(Error_new(ERROR_FILE_OPENING, "Cannot remap mapped array, reason: %s", strerror(errno)));
+  }
+
+  array->mapping = mapping;
+  array->mapping_len = new_len;
+  array->capacity = new_capacity;
+  array->carray = at_g(array->mapping, ARRAY_ALT_MMAP_HEADER_SIZE, 1);
+  madvise(array->mapping, array->mapping_len, ArrayAlt_madvise_flag(array->advice));
+  ArrayAlt_mmap_write_header(array);
+}
+
+int ArrayAlt_mapped(ArrayAlt* array) {
+  return array->fd >= 0;
+}
+
+void ArrayAlt_advise(ArrayAlt* array, ArrayAltAdvice advice) {
+  array->advice = advice;
+
+  if(ArrayAlt_mapped(array)) {
+    madvise(array->mapping, array->mapping_len, ArrayAlt_madvise_flag(advice));
+  }
+}
+
+void ArrayAlt_sync(ArrayAlt* array) {
+  if(!ArrayAlt_mapped(array)) {
+    return;
+  }
+
+  ArrayAlt_mmap_write_header(array);
+  if(msync(array->mapping, array->mapping_len, MS_SYNC) != 0) {
+    Error_raise(Error_new(ERROR_FILE_WRITING, "Cannot sync mapped array, reason: %s", strerror(errno)));
+  }
+}
+
 // Destructor
 void ArrayAlt_free(ArrayAlt* array) {
   if(array) {
-    if(array->carray) {
+    if(ArrayAlt_mapped(array)) {
+      ArrayAlt_mmap_write_header(array);
+      munmap(array->mapping, array->mapping_len);
+      close(array->fd);
+    } else if(array->carray) {
       Mem_free(array->carray);
     }
 
@@ -89,6 +275,11 @@ size_t ArrayAlt_elem_size(ArrayAlt* array) {
 // Setters
 
 static void ArrayAlt_realloc(ArrayAlt* array) {
+  if(ArrayAlt_mapped(array)) {
+    ArrayAlt_mmap_realloc(array, array->capacity * 2);
+    return;
+  }
+
   array->capacity *= 2;
   array->carray =Mem_realloc(array->carray, array->capacity * array->elem_size);
 }
@@ -141,15 +332,26 @@ void ArrayAlt_sort(ArrayAlt* array, KIComparator compare) {
   quick_sort_g(ArrayAlt_carray(array), ArrayAlt_size(array), array->elem_size, compare);
 }
 
+ArrayView ArrayAlt_slice(ArrayAlt* array, size_t from, size_t to) {
+  ArrayView view = ArrayView_make_by_value(array->carray, array->size, array->elem_size);
+  return ArrayView_slice(&view, from, to);
+}
+
 // Iterator
-ArrayAltIterator* ArrayAltIterator_new(ArrayAlt* array) {
-  ArrayAltIterator* iterator = (ArrayAltIterator*) Mem_alloc(sizeof(struct _ArrayAltIterator));
+_Static_assert(sizeof(struct _ArrayAltIterator) <= ITERATOR_STORAGE_SIZE, "ArrayAltIterator does not fit an IteratorStorage");
+
+ArrayAltIterator* ArrayAltIterator_init(ArrayAlt* array, void* storage) {
+  ArrayAltIterator* iterator = (ArrayAltIterator*) storage;
   iterator->array = array;
   iterator->current_index = 0;
 
   return iterator;
 }
 
+ArrayAltIterator* ArrayAltIterator_new(ArrayAlt* array) {
+  return ArrayAltIterator_init(array, Mem_alloc(sizeof(struct _ArrayAltIterator)));
+}
+
 void ArrayAltIterator_free(ArrayAltIterator* iterator) {
   Mem_free(iterator);
 }
@@ -175,13 +377,34 @@ void ArrayAltIterator_to_begin(ArrayAltIterator* it) {
   it->current_index = 0;
 }
 
+void ArrayAltIterator_move_to(ArrayAltIterator* it, size_t index) {
+  it->current_index = index;
+}
+
+size_t ArrayAltIterator_size(ArrayAltIterator* it) {
+  return ArrayAlt_size(it->array);
+}
+
 int ArrayAltIterator_same(ArrayAltIterator* it1, ArrayAltIterator* it2) {
   return  it1->array == it2->array && it1->current_index == it2->current_index;
 }
 
+static size_t ArrayAltIterator_next_span(ArrayAltIterator* it, ArrayView* span) {
+  if(ArrayAltIterator_end(it)) {
+    return 0;
+  }
+
+  ArrayAlt* array = it->array;
+  *span = ArrayView_make_by_value(at_g(array->carray, it->current_index, array->elem_size),
+    array->size - it->current_index, array->elem_size);
+  it->current_index = array->size;
+
+  return span->size;
+}
+
 Iterator ArrayAlt_it(ArrayAlt* array)
 {
- return Iterator_make(
+ Iterator iterator = Iterator_make(
    array,
    (void* (*)(void*)) ArrayAltIterator_new,
    (void (*)(void*))  ArrayAltIterator_next,
@@ -191,6 +414,23 @@ Iterator ArrayAlt_it(ArrayAlt* array)
    (int (*)(void*, void*)) ArrayAltIterator_same,
    (void (*)(void*))  ArrayAltIterator_free
  );
+
+ iterator = RandomAccessIterator_make(
+   iterator,
+   (void (*)(void*, size_t)) ArrayAltIterator_move_to,
+   (size_t (*)(void*)) ArrayAltIterator_size
+ );
+
+ iterator = SpanIterator_make(
+   iterator,
+   (size_t (*)(void*, ArrayView*)) ArrayAltIterator_next_span
+ );
+
+ return InlineIterator_make(
+   iterator,
+   (void* (*)(void*, void*)) ArrayAltIterator_init,
+   NULL
+ );
 }
 //
 // void for_each_with_index( ArrayAlt_it(ArrayAlt* array),  void (^callback)(void*, size_t)) {
@@ -0,0 +1,230 @@
+#include "array_view.h"
+#include <string.h>
+#include "errors.h"
+#include "mem.h"
+
+typedef struct {
+  ArrayView* view;
+  size_t current_index;
+} ArrayViewIterator;
+
+static void ArrayView_check_bounds(ArrayView* view, size_t index) {
+  if(index >= view->size) {
+    Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Index %ld is out of bounds (0,%ld)", index, view->size));
+  }
+}
+
+static void* ArrayView_position(ArrayView* view, size_t index) {
+  return view->carray + index * view->elem_size;
+}
+
+ArrayView ArrayView_make(void** carray, size_t size) {
+  ArrayView view;
+  view.carray = (unsigned char*) carray;
+  view.size = size;
+  view.elem_size = sizeof(void*);
+  view.by_value = 0;
+
+  return view;
+}
+
+ArrayView ArrayView_make_by_value(void* carray, size_t size, size_t elem_size) {
+  ArrayView view;
+  view.carray = (unsigned char*) carray;
+  view.size = size;
+  view.elem_size = elem_size;
+  view.by_value = 1;
+
+  return view;
+}
+
+ArrayView ArrayView_slice(ArrayView* view, size_t from, size_t to) {
+  if(from > to || to > view->size) {
+    Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Slice [%ld,%ld) is out of bounds (0,%ld)", from, to, view->size));
+  }
+
+  ArrayView result = *view;
+  result.carray = view->carray + from * view->elem_size;
+  result.size = to - from;
+
+  return result;
+}
+
+size_t ArrayView_size(ArrayView* view) {
+  return view->size;
+}
+
+void* ArrayView_at(ArrayView* view, size_t index) {
+  ArrayView_check_bounds(view, index);
+
+  if(view->by_value) {
+    return ArrayView_position(view, index);
+  }
+
+  return *(void**) ArrayView_position(view, index);
+}
+
+void ArrayView_set(ArrayView* view, size_t index, void* elem) {
+  ArrayView_check_bounds(view, index);
+
+  if(view->by_value) {
+    memcpy(ArrayView_position(view, index), elem, view->elem_size);
+  } else {
+    *(void**) ArrayView_position(view, index) = elem;
+  }
+}
+
+// Iterator
+
+_Static_assert(sizeof(ArrayViewIterator) <= ITERATOR_STORAGE_SIZE, "ArrayViewIterator does not fit an IteratorStorage");
+
+static ArrayViewIterator* ArrayViewIterator_init(ArrayView* view, void* storage) {
+  ArrayViewIterator* iterator = (ArrayViewIterator*) storage;
+  iterator->view = view;
+  iterator->current_index = 0;
+
+  return iterator;
+}
+
+static ArrayViewIterator* ArrayViewIterator_new(ArrayView* view) {
+  return ArrayViewIterator_init(view, Mem_alloc(sizeof(ArrayViewIterator)));
+}
+
+static void ArrayViewIterator_free(ArrayViewIterator* iterator) {
+  Mem_free(iterator);
+}
+
+static int ArrayViewIterator_end(ArrayViewIterator* it) {
+  return it->current_index >= it->view->size || it->current_index == (size_t) -1;
+}
+
+static void ArrayViewIterator_next(ArrayViewIterator* it) {
+  if(!ArrayViewIterator_end(it)) {
+    it->current_index += 1;
+  }
+}
+
+static void ArrayViewIterator_prev(ArrayViewIterator* it) {
+  if(!ArrayViewIterator_end(it)) {
+    it->current_index -= 1;
+  }
+}
+
+static void ArrayViewIterator_move_to(ArrayViewIterator* it, size_t new_position) {
+  it->current_index = new_position;
+}
+
+static size_t ArrayViewIterator_size(ArrayViewIterator* it) {
+  return it->view->size;
+}
+
+static void ArrayViewIterator_to_begin(ArrayViewIterator* it) {
+  it->current_index = 0;
+}
+
+static void ArrayViewIterator_to_end(ArrayViewIterator* it) {
+  it->current_index = it->view->size - 1;
+}
+
+static void* ArrayViewIterator_get(ArrayViewIterator* it) {
+  return ArrayView_at(it->view, it->current_index);
+}
+
+static void ArrayViewIterator_set(ArrayViewIterator* it, void* value) {
+  ArrayView_set(it->view, it->current_index, value);
+}
+
+static int ArrayViewIterator_same(ArrayViewIterator* it1, ArrayViewIterator* it2) {
+  return it1->view->carray == it2->view->carray && it1->current_index == it2->current_index;
+}
+
+static size_t ArrayViewIterator_next_span(ArrayViewIterator* it, ArrayView* span) {
+  if(ArrayViewIterator_end(it)) {
+    return 0;
+  }
+
+  *span = ArrayView_slice(it->view, it->current_index, it->view->size);
+  it->current_index = it->view->size;
+
+  return span->size;
+}
+
+// Views over pointers degrade cloning to returning the stored pointers (see iterator.h),
+// views over values copy the values into newly alloced memory.
+
+static void* ArrayViewIterator_alloc_obj(ArrayViewIterator* it) {
+  if(!it->view->by_value) {
+    return NULL;
+  }
+
+  return Mem_alloc(it->view->elem_size);
+}
+
+static void* ArrayViewIterator_copy_obj(ArrayViewIterator* it, void* to_mem) {
+  if(!it->view->by_value) {
+    return ArrayViewIterator_get(it);
+  }
+
+  memcpy(to_mem, ArrayViewIterator_get(it), it->view->elem_size);
+  return to_mem;
+}
+
+static void ArrayViewIterator_free_obj(void* obj) {
+  if(obj != NULL) {
+    Mem_free(obj);
+  }
+}
+
+Iterator ArrayView_it(ArrayView* view) {
+  Iterator iterator = Iterator_make(
+    view,
+    (void* (*)(void*)) ArrayViewIterator_new,
+    (void  (*)(void*)) ArrayViewIterator_next,
+    (void* (*)(void*)) ArrayViewIterator_get,
+    (int   (*)(void*)) ArrayViewIterator_end,
+    (void  (*)(void*)) ArrayViewIterator_to_begin,
+    (int   (*)(void*, void*)) ArrayViewIterator_same,
+    (void  (*)(void*)) ArrayViewIterator_free
+  );
+
+  iterator = BidirectionalIterator_make(
+    iterator,
+    (void (*)(void*)) ArrayViewIterator_prev,
+    (void (*)(void*)) ArrayViewIterator_to_end
+  );
+
+  iterator = RandomAccessIterator_make(
+    iterator,
+    (void (*)(void*, size_t)) ArrayViewIterator_move_to,
+    (size_t (*)(void*)) ArrayViewIterator_size
+  );
+
+  iterator = MutableIterator_make(
+    iterator,
+    (void (*)(void*, void*)) ArrayViewIterator_set
+  );
+
+  iterator = CloningIterator_make(
+    iterator,
+    (void* (*)(void*)) ArrayViewIterator_alloc_obj,
+    (void* (*)(void*, void*)) ArrayViewIterator_copy_obj,
+    (void  (*)(void*)) ArrayViewIterator_free_obj
+  );
+
+  iterator = SpanIterator_make(
+    iterator,
+    (size_t (*)(void*, ArrayView*)) ArrayViewIterator_next_span
+  );
+
+  iterator = InlineIterator_make(
+    iterator,
+    (void* (*)(void*, void*)) ArrayViewIterator_init,
+    NULL
+  );
+
+  return iterator;
+}
+
+int is_array_view_iterator(Iterator it) {
+  return it.new_iterator == (void* (*)(void*)) ArrayViewIterator_new;
+}
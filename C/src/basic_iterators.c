@@ -2,35 +2,42 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
 
 #include "mem.h"
 #include "errors.h"
 #include "macros.h"
+#include "array_view.h"
 
 
 // --------------------------------------------------------------------------------
 // NUMBER ITERATOR
 // --------------------------------------------------------------------------------
 
+// The container is the number of iterations itself (stored in the pointer), so that neither
+// the Iterator nor its inline instances need any allocation.
 typedef struct {
-  unsigned long* end;
+  unsigned long end;
   unsigned long current;
 } NumberIterator;
 
-static NumberIterator* NumberIterator_new(void* container) {
-  NumberIterator* result = (NumberIterator*) Mem_alloc(sizeof(NumberIterator));
-  result->end =  (unsigned long*) container;
+_Static_assert(sizeof(NumberIterator) <= ITERATOR_STORAGE_SIZE, "NumberIterator does not fit an IteratorStorage");
+
+static NumberIterator* NumberIterator_init(void* container, void* storage) {
+  NumberIterator* result = (NumberIterator*) storage;
+  result->end = (unsigned long) (uintptr_t) container;
   result->current = 0;
 
   return result;
 }
 
-
-static unsigned long* Number_new(unsigned long n) {
-  unsigned long* it = (unsigned long*) Mem_alloc(sizeof(unsigned long));
-  *it = n;
-
-  return it;
+static NumberIterator* NumberIterator_new(void* container) {
+  return NumberIterator_init(container, Mem_alloc(sizeof(NumberIterator)));
 }
 
 static void NumberIterator_next(NumberIterator* iterator) {
@@ -42,7 +49,7 @@ static void* NumberIterator_get(NumberIterator* iterator) {
 }
 
 static long NumberIterator_end(NumberIterator* iterator) {
-  return iterator->current >= *iterator->end;
+  return iterator->current >= iterator->end;
 }
 
 static void NumberIterator_to_begin(NumberIterator* iterator) {
@@ -50,17 +57,24 @@ static void NumberIterator_to_begin(NumberIterator* iterator) {
 }
 
 static long NumberIterator_same(NumberIterator* lhs, NumberIterator* rhs) {
-  return *lhs->end == *rhs->end && lhs->current == rhs->current;
+  return lhs->end == rhs->end && lhs->current == rhs->current;
+}
+
+static void NumberIterator_move_to(NumberIterator* iterator, size_t new_pos) {
+  iterator->current = new_pos;
+}
+
+static size_t NumberIterator_size(NumberIterator* iterator) {
+  return iterator->end;
 }
 
 static void NumberIterator_free(NumberIterator* iterator) {
-  Mem_free(iterator->end);
   Mem_free(iterator);
 }
 
 Iterator Number_it(unsigned long n) {
-  return Iterator_make(
-    Number_new(n),
+  Iterator result = Iterator_make(
+    (void*) (uintptr_t) n,
     (void* (*)(void*))        NumberIterator_new,
     (void  (*)(void*))        NumberIterator_next,
     (void* (*)(void*))        NumberIterator_get,
@@ -69,6 +83,18 @@ Iterator Number_it(unsigned long n) {
     (int   (*)(void*, void*)) NumberIterator_same,
     (void  (*)(void*))        NumberIterator_free
   );
+
+  result = RandomAccessIterator_make(
+    result,
+    (void (*)(void*, size_t)) NumberIterator_move_to,
+    (size_t (*)(void*)) NumberIterator_size
+  );
+
+  return InlineIterator_make(
+    result,
+    (void* (*)(void*, void*)) NumberIterator_init,
+    NULL
+  );
 }
 
 
@@ -76,16 +102,23 @@ Iterator Number_it(unsigned long n) {
 // TextFile Iterator
 // --------------------------------------------------------------------------------
 
+// The file info is freed when the last iterator instance is freed (split instances share it).
 typedef struct {
   char* filename;
   char delimiter;
+  _Atomic size_t ref_count;
 } TFIFileInfo;  // Text File Iterator file info
 
+// An instance iterates over the records (i.e., the sequences of chars terminated by the
+// delimiter) starting at offsets in [start, end). The last one may end past end.
 typedef struct {
   TFIFileInfo* file_info;
   FILE* file;
   char* buf;
   size_t buf_len;
+  long start;
+  long end;
+  long position;  // offset of the first char not read yet
 } TextFileIterator;
 
 
@@ -93,6 +126,7 @@ static TFIFileInfo* TFIFileInfo_new(const char* filename, char delimiter) {
   TFIFileInfo* result = (TFIFileInfo*) Mem_alloc(sizeof(TFIFileInfo));
   result->filename = (void*) Mem_strdup(filename);
   result->delimiter = delimiter;
+  atomic_init(&result->ref_count, 0);
 
   return result;
 }
@@ -100,7 +134,7 @@ static TFIFileInfo* TFIFileInfo_new(const char* filename, char delimiter) {
 static void TextFileIterator_next(TextFileIterator* iterator) {
   int end_of_file = feof(iterator->file);
 
-  if(end_of_file) {
+  if(end_of_file || iterator->position >= iterator->end) {
     if(iterator->buf != NULL) {
       free(iterator->buf);
       iterator->buf = NULL;
@@ -122,12 +156,14 @@ static void TextFileIterator_next(TextFileIterator* iterator) {
     return;
   }
 
+  iterator->position += nchars_read;
+
   if(iterator->buf[nchars_read-1] == iterator->file_info->delimiter) {
     iterator->buf[nchars_read-1] = '\0';
   }
 }
 
-static TextFileIterator* TextFileIterator_new(TFIFileInfo* file_info) {
+static TextFileIterator* TextFileIterator_open(TFIFileInfo* file_info) {
   TextFileIterator* result = (TextFileIterator*) Mem_alloc(sizeof(TextFileIterator));
 
   result->file_info = file_info;
@@ -138,9 +174,19 @@ static TextFileIterator* TextFileIterator_new(TFIFileInfo* file_info) {
       "Error opening file %s, reason: %s", file_info->filename, strerror(errno)));
   }
 
+  atomic_fetch_add(&file_info->ref_count, 1);
+
   result->buf = NULL;
   result->buf_len = 0;
+  result->start = 0;
+  result->end = LONG_MAX;
+  result->position = 0;
+
+  return result;
+}
 
+static TextFileIterator* TextFileIterator_new(TFIFileInfo* file_info) {
+  TextFileIterator* result = TextFileIterator_open(file_info);
   TextFileIterator_next(result);
 
   return result;
@@ -155,7 +201,8 @@ static int TextFileIterator_end(TextFileIterator* iterator) {
 }
 
 static void TextFileIterator_to_begin(TextFileIterator* it) {
-  fseek(it->file, 0, SEEK_SET);
+  fseek(it->file, it->start, SEEK_SET);
+  it->position = it->start;
   TextFileIterator_next(it);
 }
 
@@ -172,14 +219,57 @@ static void TextFileIterator_free(TextFileIterator* iterator) {
 
   fclose(iterator->file);
 
-  Mem_free(iterator->file_info->filename);
-  Mem_free(iterator->file_info);
+  if(atomic_fetch_sub(&iterator->file_info->ref_count, 1) == 1) {
+    Mem_free(iterator->file_info->filename);
+    Mem_free(iterator->file_info);
+  }
+
   Mem_free(iterator);
 }
 
+// Hands off the records starting in the second half of the bytes not read yet. The new
+// instance seeks the middle byte and skips to the first record starting at or after it.
+static TextFileIterator* TextFileIterator_split(TextFileIterator* it) {
+  if(TextFileIterator_end(it)) {
+    return NULL;
+  }
+
+  TextFileIterator* result = TextFileIterator_open(it->file_info);
+
+  long end = it->end;
+  if(end == LONG_MAX) {
+    fseek(result->file, 0, SEEK_END);
+    end = ftell(result->file);
+  }
+
+  long split_position = it->position + (end - it->position) / 2;
+  if(split_position <= it->position) {
+    TextFileIterator_free(result);
+    return NULL;
+  }
+
+  // the record containing the byte before split_position belongs to it
+  fseek(result->file, split_position - 1, SEEK_SET);
+  long nchars_skipped = getdelim(&result->buf, &result->buf_len, it->file_info->delimiter, result->file);
+  long start = nchars_skipped > 0 ? split_position - 1 + nchars_skipped : end;
+
+  if(start >= end) {
+    TextFileIterator_free(result);
+    return NULL;
+  }
+
+  result->start = start;
+  result->end = end;
+  result->position = start;
+  TextFileIterator_next(result);
+
+  it->end = split_position;
+
+  return result;
+}
 
 Iterator TextFile_it(const char* filename, char delimiter) {
-  return Iterator_make(
+  Iterator result = Iterator_make(
     TFIFileInfo_new(filename, delimiter),
     (void* (*)(void*))        TextFileIterator_new,
     (void  (*)(void*))        TextFileIterator_next,
@@ -189,6 +279,300 @@ Iterator TextFile_it(const char* filename, char delimiter) {
     (int   (*)(void*, void*)) TextFileIterator_same,
     (void  (*)(void*))        TextFileIterator_free
   );
+
+  return SplittableIterator_make(result, (void* (*)(void*)) TextFileIterator_split);
+}
+
+// --------------------------------------------------------------------------------
+// TextFileAsync Iterator
+// --------------------------------------------------------------------------------
+
+#define TEXT_FILE_ASYNC_DEFAULT_BUFFER_BYTES ((size_t) 1 << 20)
+
+// The file info is freed when the last iterator instance is freed.
+typedef struct {
+  char* filename;
+  char delimiter;
+  size_t buffer_bytes;
+  _Atomic size_t ref_count;
+} TFAFileInfo;  // Text File Async iterator file info
+
+// A reader thread fills the two buffers in turn while the consumer scans the records out of the
+// other one. A buffer is full when the reader handed it to the consumer and empty when the
+// consumer gave it back. The first buffer holding less than buffer_bytes chars is the last one.
+// Each buffer has room for one more char, so that the last record can be terminated in place.
+typedef struct {
+  TFAFileInfo* file_info;
+  int fd;
+  pthread_t reader;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  char* buffers[2];
+  size_t sizes[2];
+  int full[2];
+  int error;      // errno of the failed read, if any
+  int stop;       // asks the reader to quit
+  // consumer side
+  size_t current;   // index of the buffer being scanned
+  int has_current;  // 1 if the consumer holds buffers[current]
+  size_t offset;    // offset of the first char not scanned yet in buffers[current]
+  char* line;       // the current record (NULL at the end of the file)
+  char* span_buf;   // records spanning two buffers are copied here
+  size_t span_buf_len;
+  long position;    // offset in the file of the first char not read yet
+} TextFileAsyncIterator;
+
+
+static TFAFileInfo* TFAFileInfo_new(const char* filename, char delimiter, size_t buffer_bytes) {
+  TFAFileInfo* result = (TFAFileInfo*) Mem_alloc(sizeof(TFAFileInfo));
+  result->filename = (void*) Mem_strdup(filename);
+  result->delimiter = delimiter;
+  result->buffer_bytes = buffer_bytes > 0 ? buffer_bytes : TEXT_FILE_ASYNC_DEFAULT_BUFFER_BYTES;
+  atomic_init(&result->ref_count, 0);
+
+  return result;
+}
+
+static void* TextFileAsyncIterator_read(void* arg) {
+  TextFileAsyncIterator* it = (TextFileAsyncIterator*) arg;
+  size_t buffer_bytes = it->file_info->buffer_bytes;
+  size_t k = 0;
+
+  pthread_mutex_lock(&it->mutex);
+  while(!it->stop) {
+    while(it->full[k] && !it->stop) {
+      pthread_cond_wait(&it->cond, &it->mutex);
+    }
+
+    if(it->stop) {
+      break;
+    }
+    pthread_mutex_unlock(&it->mutex);
+
+    size_t size = 0;
+    int error = 0;
+    while(size < buffer_bytes) {
+      ssize_t nchars_read = read(it->fd, it->buffers[k] + size, buffer_bytes - size);
+      if(nchars_read < 0 && errno == EINTR) {
+        continue;
+      }
+
+      if(nchars_read < 0) {
+        error = errno;
+        break;
+      }
+
+      if(nchars_read == 0) {
+        break;
+      }
+
+      size += (size_t) nchars_read;
+    }
+
+    pthread_mutex_lock(&it->mutex);
+    it->sizes[k] = size;
+    it->error = error;
+    it->full[k] = 1;
+    pthread_cond_broadcast(&it->cond);
+
+    if(size < buffer_bytes) {
+      break;
+    }
+
+    k ^= 1;
+  }
+  pthread_mutex_unlock(&it->mutex);
+
+  return NULL;
+}
+
+static void TextFileAsyncIterator_start(TextFileAsyncIterator* it) {
+  it->full[0] = it->full[1] = 0;
+  it->error = 0;
+  it->stop = 0;
+  it->current = 0;
+  it->has_current = 0;
+  it->offset = 0;
+  it->position = 0;
+
+  int error = pthread_create(&it->reader, NULL, TextFileAsyncIterator_read, it);
+  if(error != 0) {
+    Error_raise(Error_new(ERROR_GENERIC, "Cannot start the reader thread (reason: %s)", strerror(error)));
+  }
+}
+
+static void TextFileAsyncIterator_stop(TextFileAsyncIterator* it) {
+  pthread_mutex_lock(&it->mutex);
+  it->stop = 1;
+  pthread_cond_broadcast(&it->cond);
+  pthread_mutex_unlock(&it->mutex);
+
+  pthread_join(it->reader, NULL);
+}
+
+// Waits for the reader to fill buffers[current]
+static void TextFileAsyncIterator_acquire(TextFileAsyncIterator* it) {
+  pthread_mutex_lock(&it->mutex);
+  while(!it->full[it->current]) {
+    pthread_cond_wait(&it->cond, &it->mutex);
+  }
+  int error = it->error;
+  pthread_mutex_unlock(&it->mutex);
+
+  if(error != 0) {
+    Error_raise(Error_new(ERROR_FILE_READING, "Error reading input file (reason:%s)", strerror(error)));
+  }
+
+  it->has_current = 1;
+  it->offset = 0;
+}
+
+// Gives buffers[current] back to the reader and moves to the other one
+static void TextFileAsyncIterator_release(TextFileAsyncIterator* it) {
+  pthread_mutex_lock(&it->mutex);
+  it->full[it->current] = 0;
+  pthread_cond_broadcast(&it->cond);
+  pthread_mutex_unlock(&it->mutex);
+
+  it->has_current = 0;
+  it->current ^= 1;
+}
+
+static void TextFileAsyncIterator_append(TextFileAsyncIterator* it, size_t len, const char* chars, size_t nchars) {
+  if(len + nchars > it->span_buf_len) {
+    it->span_buf_len = (len + nchars) * 2;
+    it->span_buf = (char*) Mem_realloc(it->span_buf, it->span_buf_len);
+  }
+
+  memcpy(it->span_buf + len, chars, nchars);
+}
+
+// Records lying in a single buffer are returned in place (the delimiter is replaced by '\0'),
+// the ones spanning two buffers are copied into span_buf.
+static void TextFileAsyncIterator_next(TextFileAsyncIterator* it) {
+  size_t buffer_bytes = it->file_info->buffer_bytes;
+  size_t span_len = 0;  // chars of the current record copied into span_buf so far
+
+  for(;;) {
+    if(!it->has_current) {
+      TextFileAsyncIterator_acquire(it);
+    }
+
+    char* buffer = it->buffers[it->current];
+    size_t size = it->sizes[it->current];
+    char* record = buffer + it->offset;
+    size_t rest = size - it->offset;
+
+    char* delimiter = (char*) memchr(record, it->file_info->delimiter, rest);
+    if(delimiter == NULL && size == buffer_bytes) {
+      TextFileAsyncIterator_append(it, span_len, record, rest);
+      span_len += rest;
+      it->position += (long) rest;
+      TextFileAsyncIterator_release(it);
+      continue;
+    }
+
+    if(delimiter == NULL && rest == 0 && span_len == 0) {
+      it->line = NULL;
+      return;
+    }
+
+    // either the delimiter has been found or this is the last record of the file
+    size_t len = delimiter != NULL ? (size_t) (delimiter - record) : rest;
+    record[len] = '\0';
+    it->offset += delimiter != NULL ? len + 1 : len;
+    it->position += (long) (delimiter != NULL ? len + 1 : len);
+
+    if(span_len > 0) {
+      TextFileAsyncIterator_append(it, span_len, record, len + 1);
+      record = it->span_buf;
+    }
+
+    it->line = record;
+    return;
+  }
+}
+
+static TextFileAsyncIterator* TextFileAsyncIterator_new(TFAFileInfo* file_info) {
+  TextFileAsyncIterator* result = (TextFileAsyncIterator*) Mem_alloc(sizeof(TextFileAsyncIterator));
+
+  result->file_info = file_info;
+
+  result->fd = open(file_info->filename, O_RDONLY);
+  if(result->fd < 0) {
+    Error_raise(Error_new(ERROR_FILE_OPENING,
+      "Error opening file %s, reason: %s", file_info->filename, strerror(errno)));
+  }
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+  posix_fadvise(result->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#elif defined(F_RDAHEAD)
+  fcntl(result->fd, F_RDAHEAD, 1);
+#endif
+
+  atomic_fetch_add(&file_info->ref_count, 1);
+
+  pthread_mutex_init(&result->mutex, NULL);
+  pthread_cond_init(&result->cond, NULL);
+  result->buffers[0] = (char*) Mem_alloc(file_info->buffer_bytes + 1);
+  result->buffers[1] = (char*) Mem_alloc(file_info->buffer_bytes + 1);
+  result->span_buf_len = 256;
+  result->span_buf = (char*) Mem_alloc(result->span_buf_len);
+
+  TextFileAsyncIterator_start(result);
+  TextFileAsyncIterator_next(result);
+
+  return result;
+}
+
+static void* TextFileAsyncIterator_get(TextFileAsyncIterator* iterator) {
+  return iterator->line;
+}
+
+static int TextFileAsyncIterator_end(TextFileAsyncIterator* iterator) {
+  return iterator->line == NULL;
+}
+
+static void TextFileAsyncIterator_to_begin(TextFileAsyncIterator* it) {
+  TextFileAsyncIterator_stop(it);
+  lseek(it->fd, 0, SEEK_SET);
+  TextFileAsyncIterator_start(it);
+  TextFileAsyncIterator_next(it);
+}
+
+static int TextFileAsyncIterator_same(TextFileAsyncIterator* it1, TextFileAsyncIterator* it2) {
+  return !strcmp(it1->file_info->filename, it2->file_info->filename) && it1->position == it2->position;
+}
+
+static void TextFileAsyncIterator_free(TextFileAsyncIterator* iterator) {
+  TextFileAsyncIterator_stop(iterator);
+  close(iterator->fd);
+
+  pthread_mutex_destroy(&iterator->mutex);
+  pthread_cond_destroy(&iterator->cond);
+  Mem_free(iterator->buffers[0]);
+  Mem_free(iterator->buffers[1]);
+  Mem_free(iterator->span_buf);
+
+  if(atomic_fetch_sub(&iterator->file_info->ref_count, 1) == 1) {
+    Mem_free(iterator->file_info->filename);
+    Mem_free(iterator->file_info);
+  }
+
+  Mem_free(iterator);
+}
+
+Iterator TextFileAsync_it(const char* filename, char delimiter, size_t buffer_bytes) {
+  return Iterator_make(
+    TFAFileInfo_new(filename, delimiter, buffer_bytes),
+    (void* (*)(void*))        TextFileAsyncIterator_new,
+    (void  (*)(void*))        TextFileAsyncIterator_next,
+    (void* (*)(void*))        TextFileAsyncIterator_get,
+    (int   (*)(void*))        TextFileAsyncIterator_end,
+    (void  (*)(void*))        TextFileAsyncIterator_to_begin,
+    (int   (*)(void*, void*)) TextFileAsyncIterator_same,
+    (void  (*)(void*))        TextFileAsyncIterator_free
+  );
 }
 
 // --------------------------------------------------------------------------------
@@ -318,7 +702,7 @@ typedef struct {
   unsigned char* carray;
   size_t count;
   size_t width;
-  size_t ref_count;
+  _Atomic size_t ref_count;
 } CArrayInfo;
 
 typedef struct  {
@@ -331,7 +715,7 @@ static CArrayInfo* CArrayInfo_new(void* carray, size_t count, size_t width) {
   result->carray = (unsigned char*) carray;
   result->count = count;
   result->width = width;
-  result->ref_count = 0;
+  atomic_init(&result->ref_count, 0);
   return result;
 }
 
@@ -340,16 +724,22 @@ static void* cit_pos(CArrayIterator* iterator) {
 }
 
 
-static CArrayIterator* CArrayIterator_new(CArrayInfo* info) {
-  info->ref_count += 1;
+_Static_assert(sizeof(CArrayIterator) <= ITERATOR_STORAGE_SIZE, "CArrayIterator does not fit an IteratorStorage");
+
+static CArrayIterator* CArrayIterator_init(CArrayInfo* info, void* storage) {
+  atomic_fetch_add(&info->ref_count, 1);
 
-  CArrayIterator* result = (CArrayIterator*) Mem_alloc(sizeof(CArrayIterator));
+  CArrayIterator* result = (CArrayIterator*) storage;
   result->info = info;
   result->position = 0;
 
   return result;
 }
 
+static CArrayIterator* CArrayIterator_new(CArrayInfo* info) {
+  return CArrayIterator_init(info, Mem_alloc(sizeof(CArrayIterator)));
+}
+
 static void CArrayIterator_next(CArrayIterator* iterator) {
   iterator->position += 1;
 }
@@ -376,13 +766,14 @@ static int CArrayIterator_same(CArrayIterator* it1, CArrayIterator* it2) {
     it1->position == it2->position;
 }
 
-static void CArrayIterator_free(CArrayIterator* iterator) {
-  iterator->info->ref_count -= 1;
-
-  if(iterator->info->ref_count == 0) {
+static void CArrayIterator_deinit(CArrayIterator* iterator) {
+  if(atomic_fetch_sub(&iterator->info->ref_count, 1) == 1) {
     Mem_free(iterator->info);
   }
+}
 
+static void CArrayIterator_free(CArrayIterator* iterator) {
+  CArrayIterator_deinit(iterator);
   Mem_free(iterator);
 }
 
@@ -415,6 +806,17 @@ static void CArrayIterator_free_obj(void* obj)  {
   Mem_free(obj);
 }
 
+static size_t CArrayIterator_next_span(CArrayIterator* iterator, ArrayView* span) {
+  if(CArrayIterator_end(iterator)) {
+    return 0;
+  }
+
+  *span = ArrayView_make_by_value(cit_pos(iterator), iterator->info->count - iterator->position, iterator->info->width);
+  iterator->position = iterator->info->count;
+
+  return span->size;
+}
+
 Iterator CArray_it(void* carray, size_t count, size_t width) {
   Iterator result = Iterator_make(
     CArrayInfo_new(carray, count, width),
@@ -451,5 +853,16 @@ Iterator CArray_it(void* carray, size_t count, size_t width) {
     (void (*)(void*)) CArrayIterator_free_obj
   );
 
+  result = SpanIterator_make(
+    result,
+    (size_t (*)(void*, ArrayView*)) CArrayIterator_next_span
+  );
+
+  result = InlineIterator_make(
+    result,
+    (void* (*)(void*, void*)) CArrayIterator_init,
+    (void  (*)(void*)) CArrayIterator_deinit
+  );
+
   return result;
 }
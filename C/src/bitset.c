@@ -0,0 +1,216 @@
+#include "bitset.h"
+#include <stdint.h>
+#include <string.h>
+#include "errors.h"
+#include "mem.h"
+
+#define BITSET_WORD_BITS 64
+
+// Bits are stored in num_words 64 bits words, bit i is bit (i % 64) of word i / 64.
+// Bits of the last word past size are always kept cleared, so that counting and
+// searching never need to mask them out.
+struct _Bitset {
+  size_t size;
+  size_t num_words;
+  uint64_t words[];
+};
+
+typedef struct {
+  Bitset* bitset;
+  size_t current;
+} BitsetIterator;
+
+static size_t Bitset_words_for(size_t size) {
+  return (size + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS;
+}
+
+static void Bitset_check_bounds(Bitset* bitset, size_t index) {
+  if(index >= bitset->size) {
+    Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Index %ld is out of bounds (0,%ld)", index, bitset->size));
+  }
+}
+
+static void Bitset_check_sizes(Bitset* dst, Bitset* src) {
+  if(dst->size != src->size) {
+    Error_raise(Error_new(ERROR_GENERIC, "Bitsets sizes differ (%ld != %ld)", dst->size, src->size));
+  }
+}
+
+// Constructors
+
+Bitset* Bitset_new(size_t size) {
+  size_t num_words = Bitset_words_for(size);
+  Bitset* bitset = (Bitset*) Mem_alloc(sizeof(struct _Bitset) + sizeof(uint64_t) * num_words);
+  bitset->size = size;
+  bitset->num_words = num_words;
+  memset(bitset->words, 0, sizeof(uint64_t) * num_words);
+
+  return bitset;
+}
+
+Bitset* Bitset_dup(Bitset* bitset) {
+  Bitset* result = Bitset_new(bitset->size);
+  memcpy(result->words, bitset->words, sizeof(uint64_t) * bitset->num_words);
+
+  return result;
+}
+
+// Destructor
+
+void Bitset_free(Bitset* bitset) {
+  Mem_free(bitset);
+}
+
+// Accessors
+
+size_t Bitset_size(Bitset* bitset) {
+  return bitset->size;
+}
+
+int Bitset_test(Bitset* bitset, size_t index) {
+  Bitset_check_bounds(bitset, index);
+  return (bitset->words[index / BITSET_WORD_BITS] >> (index % BITSET_WORD_BITS)) & 1;
+}
+
+size_t Bitset_count(Bitset* bitset) {
+  size_t count = 0;
+  for(size_t i = 0; i < bitset->num_words; ++i) {
+    count += (size_t) __builtin_popcountll(bitset->words[i]);
+  }
+
+  return count;
+}
+
+int Bitset_empty(Bitset* bitset) {
+  for(size_t i = 0; i < bitset->num_words; ++i) {
+    if(bitset->words[i] != 0) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+size_t Bitset_next_set(Bitset* bitset, size_t from) {
+  if(from >= bitset->size) {
+    return (size_t) -1;
+  }
+
+  size_t word_index = from / BITSET_WORD_BITS;
+  // discarding the bits before from in the first word
+  uint64_t word = bitset->words[word_index] & (~(uint64_t) 0 << (from % BITSET_WORD_BITS));
+
+  while(word == 0) {
+    word_index += 1;
+    if(word_index >= bitset->num_words) {
+      return (size_t) -1;
+    }
+    word = bitset->words[word_index];
+  }
+
+  return word_index * BITSET_WORD_BITS + (size_t) __builtin_ctzll(word);
+}
+
+// Setters
+
+void Bitset_set(Bitset* bitset, size_t index) {
+  Bitset_check_bounds(bitset, index);
+  bitset->words[index / BITSET_WORD_BITS] |= (uint64_t) 1 << (index % BITSET_WORD_BITS);
+}
+
+void Bitset_clear(Bitset* bitset, size_t index) {
+  Bitset_check_bounds(bitset, index);
+  bitset->words[index / BITSET_WORD_BITS] &= ~((uint64_t) 1 << (index % BITSET_WORD_BITS));
+}
+
+void Bitset_set_all(Bitset* bitset) {
+  memset(bitset->words, 0xff, sizeof(uint64_t) * bitset->num_words);
+
+  size_t trailing_bits = bitset->size % BITSET_WORD_BITS;
+  if(trailing_bits != 0) {
+    bitset->words[bitset->num_words - 1] = ((uint64_t) 1 << trailing_bits) - 1;
+  }
+}
+
+void Bitset_clear_all(Bitset* bitset) {
+  memset(bitset->words, 0, sizeof(uint64_t) * bitset->num_words);
+}
+
+// Bulk operations. The loops are kept trivial so that the compiler can vectorize them.
+
+void Bitset_and(Bitset* dst, Bitset* src) {
+  Bitset_check_sizes(dst, src);
+  for(size_t i = 0; i < dst->num_words; ++i) {
+    dst->words[i] &= src->words[i];
+  }
+}
+
+void Bitset_or(Bitset* dst, Bitset* src) {
+  Bitset_check_sizes(dst, src);
+  for(size_t i = 0; i < dst->num_words; ++i) {
+    dst->words[i] |= src->words[i];
+  }
+}
+
+void Bitset_andnot(Bitset* dst, Bitset* src) {
+  Bitset_check_sizes(dst, src);
+  for(size_t i = 0; i < dst->num_words; ++i) {
+    dst->words[i] &= ~src->words[i];
+  }
+}
+
+void Bitset_xor(Bitset* dst, Bitset* src) {
+  Bitset_check_sizes(dst, src);
+  for(size_t i = 0; i < dst->num_words; ++i) {
+    dst->words[i] ^= src->words[i];
+  }
+}
+
+// Iterator
+
+static BitsetIterator* BitsetIterator_new(Bitset* bitset) {
+  BitsetIterator* iterator = (BitsetIterator*) Mem_alloc(sizeof(BitsetIterator));
+  iterator->bitset = bitset;
+  iterator->current = Bitset_next_set(bitset, 0);
+
+  return iterator;
+}
+
+static void BitsetIterator_free(BitsetIterator* iterator) {
+  Mem_free(iterator);
+}
+
+static void BitsetIterator_next(BitsetIterator* iterator) {
+  if(iterator->current < iterator->bitset->size) {
+    iterator->current = Bitset_next_set(iterator->bitset, iterator->current + 1);
+  }
+}
+
+static void* BitsetIterator_get(BitsetIterator* iterator) {
+  return &iterator->current;
+}
+
+static int BitsetIterator_end(BitsetIterator* iterator) {
+  return iterator->current >= iterator->bitset->size;
+}
+
+static void BitsetIterator_to_begin(BitsetIterator* iterator) {
+  iterator->current = Bitset_next_set(iterator->bitset, 0);
+}
+
+static int BitsetIterator_same(BitsetIterator* lhs, BitsetIterator* rhs) {
+  return lhs->bitset == rhs->bitset && lhs->current == rhs->current;
+}
+
+Iterator Bitset_it(Bitset* bitset) {
+  return Iterator_make(
+    bitset,
+    (void* (*)(void*))        BitsetIterator_new,
+    (void  (*)(void*))        BitsetIterator_next,
+    (void* (*)(void*))        BitsetIterator_get,
+    (int   (*)(void*))        BitsetIterator_end,
+    (void  (*)(void*))        BitsetIterator_to_begin,
+    (int   (*)(void*, void*)) BitsetIterator_same,
+    (void  (*)(void*))        BitsetIterator_free
+  );
+}
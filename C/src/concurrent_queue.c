@@ -0,0 +1,402 @@
+#include "concurrent_queue.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sched.h>
+#include <pthread.h>
+#include "mem.h"
+
+#define CACHE_LINE_SIZE 64
+
+// Number of failed attempts after which waiting functions start yielding the processor
+#define CONCURRENT_QUEUE_SPINS 64
+// Number of yields after which waiting functions park on the condition variable
+#define CONCURRENT_QUEUE_YIELDS 64
+
+// Each cell stores a sequence number. Given the position pos (a monotonically increasing
+// counter) which maps to the cell pos & mask:
+//  - sequence == pos means that the cell is empty and ready to be written by the producer
+//    that claims pos;
+//  - sequence == pos + 1 means that the cell has been written and it is ready to be read
+//    by the consumer that claims pos;
+// after reading the cell the consumer sets sequence to pos + capacity, i.e., the position
+// at which the cell will be written next.
+typedef struct {
+  _Atomic size_t sequence;
+  void* data;
+} ConcurrentQueueCell;
+
+// enqueue_pos and dequeue_pos are written by different threads, the padding keeps them
+// (and the read-mostly fields) on different cache lines. Threads that waited too long park on
+// cond: waiters counts them, so that the threads making progress take the mutex only when
+// someone needs to be woken up.
+struct _ConcurrentQueue {
+  ConcurrentQueueCell* buffer;
+  size_t mask;
+  _Atomic int closed;
+  _Atomic size_t waiters;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  char padding0[CACHE_LINE_SIZE];
+
+  _Atomic size_t enqueue_pos;
+  char padding1[CACHE_LINE_SIZE - sizeof(size_t)];
+
+  _Atomic size_t dequeue_pos;
+  char padding2[CACHE_LINE_SIZE - sizeof(size_t)];
+};
+
+static size_t next_power_of_two(size_t n) {
+  size_t result = 2;
+  while(result < n) {
+    result <<= 1;
+  }
+
+  return result;
+}
+
+// Wakes up the parked threads (if any) after an operation changed the state of the queue
+static void ConcurrentQueue_notify(ConcurrentQueue* queue) {
+  atomic_thread_fence(memory_order_seq_cst);
+  if(atomic_load_explicit(&queue->waiters, memory_order_relaxed) == 0) {
+    return;
+  }
+
+  pthread_mutex_lock(&queue->mutex);
+  pthread_cond_broadcast(&queue->cond);
+  pthread_mutex_unlock(&queue->mutex);
+}
+
+// Outcomes of the attempts made by ConcurrentQueue_wait: an attempt that completes the
+// operation returns ATTEMPT_DONE, one that completes only part of it (e.g., it enqueues only
+// some of the objects of a batch) returns ATTEMPT_PROGRESS.
+#define ATTEMPT_FAILED 0
+#define ATTEMPT_DONE 1
+#define ATTEMPT_PROGRESS 2
+
+// Calls try_operation until it returns ATTEMPT_DONE: spinning first, then yielding the
+// processor and finally parking on the condition variable until another thread makes progress
+// on the queue. try_operation must not wake up the parked threads, this is done after each
+// attempt that made progress.
+static void ConcurrentQueue_wait(ConcurrentQueue* queue, int (^try_operation)(void)) {
+  for(unsigned int attempts = 0; attempts < CONCURRENT_QUEUE_SPINS + CONCURRENT_QUEUE_YIELDS; ++attempts) {
+    int outcome = try_operation();
+    if(outcome != ATTEMPT_FAILED) {
+      ConcurrentQueue_notify(queue);
+    }
+
+    if(outcome == ATTEMPT_DONE) {
+      return;
+    }
+
+    if(attempts >= CONCURRENT_QUEUE_SPINS) {
+      sched_yield();
+    }
+  }
+
+  pthread_mutex_lock(&queue->mutex);
+  atomic_fetch_add(&queue->waiters, 1);
+  // either the next attempt sees the progress made by another thread, or that thread sees
+  // waiters > 0 (see ConcurrentQueue_notify) and signals cond after we started waiting on it
+  atomic_thread_fence(memory_order_seq_cst);
+  int outcome;
+  while((outcome = try_operation()) != ATTEMPT_DONE) {
+    if(outcome == ATTEMPT_PROGRESS) {
+      // the other parked threads may be waiting for this progress, retry before waiting
+      pthread_cond_broadcast(&queue->cond);
+    } else {
+      pthread_cond_wait(&queue->cond, &queue->mutex);
+    }
+  }
+  atomic_fetch_sub(&queue->waiters, 1);
+  pthread_mutex_unlock(&queue->mutex);
+
+  ConcurrentQueue_notify(queue);
+}
+
+ConcurrentQueue* ConcurrentQueue_new(size_t capacity) {
+  ConcurrentQueue* queue = (ConcurrentQueue*) Mem_alloc(sizeof(struct _ConcurrentQueue));
+  capacity = next_power_of_two(capacity);
+
+  queue->buffer = (ConcurrentQueueCell*) Mem_alloc(sizeof(ConcurrentQueueCell) * capacity);
+  queue->mask = capacity - 1;
+  for(size_t i = 0; i < capacity; ++i) {
+    atomic_init(&queue->buffer[i].sequence, i);
+    queue->buffer[i].data = NULL;
+  }
+
+  atomic_init(&queue->closed, 0);
+  atomic_init(&queue->waiters, 0);
+  pthread_mutex_init(&queue->mutex, NULL);
+  pthread_cond_init(&queue->cond, NULL);
+  atomic_init(&queue->enqueue_pos, 0);
+  atomic_init(&queue->dequeue_pos, 0);
+
+  return queue;
+}
+
+void ConcurrentQueue_free(ConcurrentQueue* queue) {
+  pthread_mutex_destroy(&queue->mutex);
+  pthread_cond_destroy(&queue->cond);
+  Mem_free(queue->buffer);
+  Mem_free(queue);
+}
+
+size_t ConcurrentQueue_capacity(ConcurrentQueue* queue) {
+  return queue->mask + 1;
+}
+
+size_t ConcurrentQueue_size(ConcurrentQueue* queue) {
+  size_t dequeue_pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+  size_t enqueue_pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+
+  if(enqueue_pos < dequeue_pos) {
+    return 0;
+  }
+
+  return enqueue_pos - dequeue_pos;
+}
+
+// The following functions do not wake up the parked threads, the public ones do it on success
+// (ConcurrentQueue_wait calls them holding the mutex).
+
+static int ConcurrentQueue_try_enqueue_one(ConcurrentQueue* queue, void* elem) {
+  size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+
+  for(;;) {
+    ConcurrentQueueCell* cell = &queue->buffer[pos & queue->mask];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+
+    if(diff == 0) {
+      if(atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+        cell->data = elem;
+        atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+        return 1;
+      }
+      // pos has been updated by the failed compare and swap
+    } else if(diff < 0) {
+      // the cell still holds an object from the previous lap: the queue is full
+      return 0;
+    } else {
+      pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    }
+  }
+}
+
+static int ConcurrentQueue_try_dequeue_one(ConcurrentQueue* queue, void** result) {
+  size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+
+  for(;;) {
+    ConcurrentQueueCell* cell = &queue->buffer[pos & queue->mask];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t) sequence - (intptr_t) (pos + 1);
+
+    if(diff == 0) {
+      if(atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+        *result = cell->data;
+        atomic_store_explicit(&cell->sequence, pos + queue->mask + 1, memory_order_release);
+        return 1;
+      }
+    } else if(diff < 0) {
+      // the cell has not been written yet: the queue is empty
+      return 0;
+    } else {
+      pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    }
+  }
+}
+
+int ConcurrentQueue_try_enqueue(ConcurrentQueue* queue, void* elem) {
+  if(!ConcurrentQueue_try_enqueue_one(queue, elem)) {
+    return 0;
+  }
+
+  ConcurrentQueue_notify(queue);
+  return 1;
+}
+
+int ConcurrentQueue_try_dequeue(ConcurrentQueue* queue, void** result) {
+  if(!ConcurrentQueue_try_dequeue_one(queue, result)) {
+    return 0;
+  }
+
+  ConcurrentQueue_notify(queue);
+  return 1;
+}
+
+void ConcurrentQueue_enqueue(ConcurrentQueue* queue, void* elem) {
+  if(ConcurrentQueue_try_enqueue(queue, elem)) {
+    return;
+  }
+
+  ConcurrentQueue_wait(queue, ^{
+    return ConcurrentQueue_try_enqueue_one(queue, elem) ? ATTEMPT_DONE : ATTEMPT_FAILED;
+  });
+}
+
+int ConcurrentQueue_dequeue(ConcurrentQueue* queue, void** result) {
+  if(ConcurrentQueue_try_dequeue(queue, result)) {
+    return 1;
+  }
+
+  __block int dequeued = 0;
+  ConcurrentQueue_wait(queue, ^{
+    dequeued = ConcurrentQueue_try_dequeue_one(queue, result);
+    return dequeued || ConcurrentQueue_closed(queue) ? ATTEMPT_DONE : ATTEMPT_FAILED;
+  });
+
+  if(!dequeued) {
+    // an object may have been enqueued right before closing the queue
+    return ConcurrentQueue_try_dequeue(queue, result);
+  }
+
+  return 1;
+}
+
+// Waits for the cell to reach the given sequence. The batch functions call it on cells
+// that have been claimed by the thread that will update them (see below), so it never waits
+// for long.
+static void ConcurrentQueueCell_wait(ConcurrentQueueCell* cell, size_t sequence) {
+  while(atomic_load_explicit(&cell->sequence, memory_order_acquire) != sequence) {
+    sched_yield();
+  }
+}
+
+// The batch functions claim count consecutive positions with a single compare and swap, after
+// checking that the cell at the last position is ready. Positions are claimed in order: if the
+// last cell has been released by the consumer of the previous lap, the consumers of the previous
+// lap have claimed the preceding cells too (they can be still reading them). Similarly, if the
+// last cell has been written, the producers of the preceding cells have claimed them. When the
+// last cell is not ready, shorter ranges are tried.
+
+static size_t ConcurrentQueue_try_enqueue_range(ConcurrentQueue* queue, void** elems, size_t count) {
+  size_t capacity = queue->mask + 1;
+  size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+  size_t free_cells = capacity - ConcurrentQueue_size(queue);
+  count = count < free_cells ? count : free_cells;
+
+  while(count > 0) {
+    ConcurrentQueueCell* last = &queue->buffer[(pos + count - 1) & queue->mask];
+    size_t sequence = atomic_load_explicit(&last->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t) sequence - (intptr_t) (pos + count - 1);
+
+    if(diff == 0) {
+      if(atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + count, memory_order_relaxed, memory_order_relaxed)) {
+        for(size_t i = 0; i < count; ++i) {
+          ConcurrentQueueCell* cell = &queue->buffer[(pos + i) & queue->mask];
+          ConcurrentQueueCell_wait(cell, pos + i);
+          cell->data = elems[i];
+          atomic_store_explicit(&cell->sequence, pos + i + 1, memory_order_release);
+        }
+
+        return count;
+      }
+    } else if(diff < 0) {
+      count /= 2;
+    } else {
+      pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    }
+  }
+
+  return 0;
+}
+
+static size_t ConcurrentQueue_try_dequeue_range(ConcurrentQueue* queue, void** result, size_t max_count) {
+  size_t capacity = queue->mask + 1;
+  size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+  size_t available = ConcurrentQueue_size(queue);
+  size_t count = max_count < available ? max_count : available;
+  count = count < capacity ? count : capacity;
+
+  while(count > 0) {
+    ConcurrentQueueCell* last = &queue->buffer[(pos + count - 1) & queue->mask];
+    size_t sequence = atomic_load_explicit(&last->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t) sequence - (intptr_t) (pos + count);
+
+    if(diff == 0) {
+      if(atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + count, memory_order_relaxed, memory_order_relaxed)) {
+        for(size_t i = 0; i < count; ++i) {
+          ConcurrentQueueCell* cell = &queue->buffer[(pos + i) & queue->mask];
+          ConcurrentQueueCell_wait(cell, pos + i + 1);
+          result[i] = cell->data;
+          atomic_store_explicit(&cell->sequence, pos + i + capacity, memory_order_release);
+        }
+
+        return count;
+      }
+    } else if(diff < 0) {
+      count /= 2;
+    } else {
+      pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    }
+  }
+
+  return 0;
+}
+
+size_t ConcurrentQueue_try_enqueue_many(ConcurrentQueue* queue, void** elems, size_t count) {
+  size_t enqueued = ConcurrentQueue_try_enqueue_range(queue, elems, count);
+  if(enqueued > 0) {
+    ConcurrentQueue_notify(queue);
+  }
+
+  return enqueued;
+}
+
+size_t ConcurrentQueue_try_dequeue_many(ConcurrentQueue* queue, void** result, size_t max_count) {
+  size_t dequeued = ConcurrentQueue_try_dequeue_range(queue, result, max_count);
+  if(dequeued > 0) {
+    ConcurrentQueue_notify(queue);
+  }
+
+  return dequeued;
+}
+
+void ConcurrentQueue_enqueue_many(ConcurrentQueue* queue, void** elems, size_t count) {
+  __block size_t enqueued = ConcurrentQueue_try_enqueue_many(queue, elems, count);
+  if(enqueued == count) {
+    return;
+  }
+
+  ConcurrentQueue_wait(queue, ^{
+    size_t progress = ConcurrentQueue_try_enqueue_range(queue, elems + enqueued, count - enqueued);
+    enqueued += progress;
+    if(enqueued == count) {
+      return ATTEMPT_DONE;
+    }
+
+    return progress > 0 ? ATTEMPT_PROGRESS : ATTEMPT_FAILED;
+  });
+}
+
+size_t ConcurrentQueue_dequeue_many(ConcurrentQueue* queue, void** result, size_t max_count) {
+  if(max_count == 0) {
+    return 0;
+  }
+
+  __block size_t dequeued = ConcurrentQueue_try_dequeue_many(queue, result, max_count);
+  if(dequeued > 0) {
+    return dequeued;
+  }
+
+  ConcurrentQueue_wait(queue, ^{
+    dequeued = ConcurrentQueue_try_dequeue_range(queue, result, max_count);
+    return dequeued > 0 || ConcurrentQueue_closed(queue) ? ATTEMPT_DONE : ATTEMPT_FAILED;
+  });
+
+  if(dequeued == 0) {
+    // objects may have been enqueued right before closing the queue
+    return ConcurrentQueue_try_dequeue_many(queue, result, max_count);
+  }
+
+  return dequeued;
+}
+
+void ConcurrentQueue_close(ConcurrentQueue* queue) {
+  atomic_store_explicit(&queue->closed, 1, memory_order_release);
+  ConcurrentQueue_notify(queue);
+}
+
+int ConcurrentQueue_closed(ConcurrentQueue* queue) {
+  return atomic_load_explicit(&queue->closed, memory_order_acquire);
+}
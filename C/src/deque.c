@@ -0,0 +1,373 @@
+#include "deque.h"
+#include <string.h>
+#include "errors.h"
+#include "mem.h"
+#include "macros.h"
+
+// Elements are stored in a ring buffer whose capacity is always a power of
+// two, so that wrapping an index around the buffer is a bitwise and.
+// The element at index i is stored in carray[(head + i) & (capacity - 1)].
+struct _Deque {
+  void** carray;
+  size_t capacity;
+  size_t head;
+  size_t size;
+};
+
+struct _DequeIterator {
+  Deque* deque;
+  size_t current_index;
+};
+
+static size_t next_power_of_two(size_t n) {
+  size_t result = 1;
+  while(result < n) {
+    result <<= 1;
+  }
+
+  return result;
+}
+
+static size_t Deque_slot(Deque* deque, size_t index) {
+  return (deque->head + index) & (deque->capacity - 1);
+}
+
+// Doubles the capacity of the deque unrolling the ring so that the
+// first element ends up at position 0 of the new buffer.
+static void Deque_realloc(Deque* deque) {
+  size_t new_capacity = deque->capacity * 2;
+  void** new_carray = (void**) Mem_alloc(sizeof(void*) * new_capacity);
+
+  size_t first_chunk = deque->capacity - deque->head;
+  if(first_chunk > deque->size) {
+    first_chunk = deque->size;
+  }
+
+  memcpy(new_carray, deque->carray + deque->head, sizeof(void*) * first_chunk);
+  memcpy(new_carray + first_chunk, deque->carray, sizeof(void*) * (deque->size - first_chunk));
+
+  Mem_free(deque->carray);
+  deque->carray = new_carray;
+  deque->capacity = new_capacity;
+  deque->head = 0;
+}
+
+static void Deque_check_bounds(Deque* deque, size_t index) {
+  if(index >= deque->size) {
+    Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Index %ld is out of bounds (0,%ld)", index, deque->size));
+  }
+}
+
+// Constructor
+Deque* Deque_new(size_t capacity) {
+  Deque* deque = (Deque*) Mem_alloc(sizeof(struct _Deque));
+  deque->capacity = next_power_of_two(capacity);
+  deque->carray = (void**) Mem_alloc(sizeof(void*) * deque->capacity);
+  deque->head = 0;
+  deque->size = 0;
+
+  return deque;
+}
+
+// Destructor
+void Deque_free(Deque* deque) {
+  if(deque) {
+    Mem_free(deque->carray);
+    Mem_free(deque);
+  }
+}
+
+// Accessors
+
+size_t Deque_size(Deque* deque) {
+  return deque->size;
+}
+
+int Deque_empty(Deque* deque) {
+  return deque->size == 0;
+}
+
+size_t Deque_capacity(Deque* deque) {
+  return deque->capacity;
+}
+
+void* Deque_at(Deque* deque, size_t index) {
+  Deque_check_bounds(deque, index);
+  return deque->carray[Deque_slot(deque, index)];
+}
+
+void* Deque_front(Deque* deque) {
+  if(deque->size == 0) {
+    return NULL;
+  }
+
+  return deque->carray[deque->head];
+}
+
+void* Deque_back(Deque* deque) {
+  if(deque->size == 0) {
+    return NULL;
+  }
+
+  return deque->carray[Deque_slot(deque, deque->size - 1)];
+}
+
+// Setters
+
+void* Deque_set(Deque* deque, size_t index, void* elem) {
+  Deque_check_bounds(deque, index);
+  deque->carray[Deque_slot(deque, index)] = elem;
+  return elem;
+}
+
+void Deque_push_front(Deque* deque, void* elem) {
+  if(deque->size >= deque->capacity) {
+    Deque_realloc(deque);
+  }
+
+  deque->head = (deque->head - 1) & (deque->capacity - 1);
+  deque->carray[deque->head] = elem;
+  deque->size += 1;
+}
+
+void Deque_push_back(Deque* deque, void* elem) {
+  if(deque->size >= deque->capacity) {
+    Deque_realloc(deque);
+  }
+
+  deque->carray[Deque_slot(deque, deque->size)] = elem;
+  deque->size += 1;
+}
+
+void* Deque_pop_front(Deque* deque) {
+  if(deque->size == 0) {
+    return NULL;
+  }
+
+  void* result = deque->carray[deque->head];
+  deque->head = (deque->head + 1) & (deque->capacity - 1);
+  deque->size -= 1;
+
+  return result;
+}
+
+void* Deque_pop_back(Deque* deque) {
+  if(deque->size == 0) {
+    return NULL;
+  }
+
+  deque->size -= 1;
+  return deque->carray[Deque_slot(deque, deque->size)];
+}
+
+void Deque_push_back_many(Deque* deque, void** elems, size_t count) {
+  while(deque->size + count > deque->capacity) {
+    Deque_realloc(deque);
+  }
+
+  size_t tail = Deque_slot(deque, deque->size);
+  size_t first_chunk = deque->capacity - tail;
+  if(first_chunk > count) {
+    first_chunk = count;
+  }
+
+  memcpy(deque->carray + tail, elems, sizeof(void*) * first_chunk);
+  memcpy(deque->carray, elems + first_chunk, sizeof(void*) * (count - first_chunk));
+  deque->size += count;
+}
+
+size_t Deque_pop_front_many(Deque* deque, void** result, size_t max_count) {
+  size_t count = max_count < deque->size ? max_count : deque->size;
+
+  size_t first_chunk = deque->capacity - deque->head;
+  if(first_chunk > count) {
+    first_chunk = count;
+  }
+
+  memcpy(result, deque->carray + deque->head, sizeof(void*) * first_chunk);
+  memcpy(result + first_chunk, deque->carray, sizeof(void*) * (count - first_chunk));
+
+  deque->head = (deque->head + count) & (deque->capacity - 1);
+  deque->size -= count;
+
+  return count;
+}
+
+void Deque_insert(Deque* deque, size_t index, void* elem) {
+  if(index > deque->size) {
+    Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Index %ld is out of bounds (0,%ld)", index, deque->size));
+  }
+
+  if(deque->size >= deque->capacity) {
+    Deque_realloc(deque);
+  }
+
+  if(index < deque->size / 2) {
+    // shifting the elements before index one position towards the front
+    deque->head = (deque->head - 1) & (deque->capacity - 1);
+    for(size_t i = 0; i < index; ++i) {
+      deque->carray[Deque_slot(deque, i)] = deque->carray[Deque_slot(deque, i + 1)];
+    }
+  } else {
+    // shifting the elements after index one position towards the back
+    for(size_t i = deque->size; i > index; --i) {
+      deque->carray[Deque_slot(deque, i)] = deque->carray[Deque_slot(deque, i - 1)];
+    }
+  }
+
+  deque->carray[Deque_slot(deque, index)] = elem;
+  deque->size += 1;
+}
+
+void Deque_remove(Deque* deque, size_t index) {
+  Deque_check_bounds(deque, index);
+
+  if(index < deque->size / 2) {
+    for(size_t i = index; i > 0; --i) {
+      deque->carray[Deque_slot(deque, i)] = deque->carray[Deque_slot(deque, i - 1)];
+    }
+    deque->head = (deque->head + 1) & (deque->capacity - 1);
+  } else {
+    for(size_t i = index; i + 1 < deque->size; ++i) {
+      deque->carray[Deque_slot(deque, i)] = deque->carray[Deque_slot(deque, i + 1)];
+    }
+  }
+
+  deque->size -= 1;
+}
+
+// Iterator
+
+DequeIterator* DequeIterator_new(Deque* deque) {
+  DequeIterator* iterator = (DequeIterator*) Mem_alloc(sizeof(struct _DequeIterator));
+  iterator->deque = deque;
+  iterator->current_index = 0;
+
+  return iterator;
+}
+
+void DequeIterator_free(DequeIterator* iterator) {
+  Mem_free(iterator);
+}
+
+size_t DequeIterator_size(DequeIterator* it) {
+  return Deque_size(it->deque);
+}
+
+void DequeIterator_next(DequeIterator* it) {
+  if(!DequeIterator_end(it)) {
+    it->current_index += 1;
+  }
+}
+
+void DequeIterator_prev(DequeIterator* it) {
+  if(!DequeIterator_end(it)) {
+    it->current_index -= 1;
+  }
+}
+
+void DequeIterator_move_to(DequeIterator* it, size_t new_position) {
+  it->current_index = new_position;
+}
+
+void DequeIterator_to_begin(DequeIterator* it) {
+  it->current_index = 0;
+}
+
+void DequeIterator_to_end(DequeIterator* it) {
+  it->current_index = Deque_size(it->deque) - 1;
+}
+
+int DequeIterator_end(DequeIterator* it) {
+  return it->current_index >= it->deque->size || it->current_index == (size_t) -1;
+}
+
+void* DequeIterator_get(DequeIterator* it) {
+  return Deque_at(it->deque, it->current_index);
+}
+
+void DequeIterator_set(DequeIterator* it, void* value) {
+  Deque_set(it->deque, it->current_index, value);
+}
+
+int DequeIterator_same(DequeIterator* it1, DequeIterator* it2) {
+  return it1->deque == it2->deque && it1->current_index == it2->current_index;
+}
+
+size_t DequeIterator_index(DequeIterator* it) {
+  return it->current_index;
+}
+
+size_t DequeIterator_next_span(DequeIterator* it, ArrayView* span) {
+  if(DequeIterator_end(it)) {
+    return 0;
+  }
+
+  Deque* deque = it->deque;
+  size_t slot = Deque_slot(deque, it->current_index);
+  size_t size = deque->size - it->current_index;
+  if(size > deque->capacity - slot) {
+    size = deque->capacity - slot;
+  }
+
+  *span = ArrayView_make(deque->carray + slot, size);
+  it->current_index += size;
+
+  return size;
+}
+
+static void* DequeIterator_alloc_obj(DequeIterator* UNUSED(it)) {
+  return NULL;
+}
+
+static void* DequeIterator_copy_obj(DequeIterator* it, void* UNUSED(to_mem)) {
+  return DequeIterator_get(it);
+}
+
+static void DequeIterator_free_obj(void* UNUSED(obj)) {
+  return;
+}
+
+Iterator Deque_it(Deque* deque) {
+  Iterator iterator = Iterator_make(
+    deque,
+    (void* (*)(void*)) DequeIterator_new,
+    (void  (*)(void*)) DequeIterator_next,
+    (void* (*)(void*)) DequeIterator_get,
+    (int   (*)(void*)) DequeIterator_end,
+    (void  (*)(void*)) DequeIterator_to_begin,
+    (int   (*)(void*, void*)) DequeIterator_same,
+    (void  (*)(void*)) DequeIterator_free
+  );
+
+  iterator = BidirectionalIterator_make(
+    iterator,
+    (void (*)(void*)) DequeIterator_prev,
+    (void (*)(void*)) DequeIterator_to_end
+  );
+
+  iterator = RandomAccessIterator_make(
+    iterator,
+    (void (*)(void*, size_t)) DequeIterator_move_to,
+    (size_t (*)(void*)) DequeIterator_size
+  );
+
+  iterator = MutableIterator_make(
+    iterator,
+    (void (*)(void*, void*)) DequeIterator_set
+  );
+
+  iterator = CloningIterator_make(
+    iterator,
+    (void* (*)(void*)) DequeIterator_alloc_obj,
+    (void* (*)(void*, void*)) DequeIterator_copy_obj,
+    (void  (*)(void*)) DequeIterator_free_obj
+  );
+
+  iterator = SpanIterator_make(
+    iterator,
+    (size_t (*)(void*, ArrayView*)) DequeIterator_next_span
+  );
+
+  return iterator;
+}
@@ -7,7 +7,7 @@ void* DictionaryIterator_key_get(DictionaryIterator* it) {
 }
 
 Iterator Dictionary_it(Dictionary* dictionary) {
- return Iterator_make(
+ Iterator result = Iterator_make(
    dictionary,
    (void* (*)(void*)) DictionaryIterator_new,
    (void  (*)(void*))  DictionaryIterator_next,
@@ -17,10 +17,12 @@ Iterator Dictionary_it(Dictionary* dictionary) {
    (int   (*)(void*, void*)) DictionaryIterator_same,
    (void  (*)(void*))  DictionaryIterator_free
  );
+
+ return SplittableIterator_make(result, (void* (*)(void*)) DictionaryIterator_split);
 }
 
 Iterator Dictionary_key_it(Dictionary* dictionary) {
-  return Iterator_make(
+  Iterator result = Iterator_make(
     dictionary,
     (void* (*)(void*)) DictionaryIterator_new,
     (void  (*)(void*))  DictionaryIterator_next,
@@ -30,6 +32,8 @@ Iterator Dictionary_key_it(Dictionary* dictionary) {
     (int   (*)(void*, void*)) DictionaryIterator_same,
     (void  (*)(void*))  DictionaryIterator_free
   );
+
+  return SplittableIterator_make(result, (void* (*)(void*)) DictionaryIterator_split);
 }
 
 
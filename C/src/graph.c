@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #include "graph.h"
 #include "dictionary.h"
@@ -36,9 +37,12 @@ typedef struct {
   void* info;
 } AdjInfo;
 
+// Iterators returned by Graph_edges visit the sources in [start_source_index, end_source_index),
+// end_source_index is SIZE_MAX (i.e., all the vertices) unless the iterator has been split.
 struct _EdgeIterator {
   Graph* graph;
   size_t start_source_index;
+  size_t end_source_index;
   size_t source_index;
   size_t adj_index;
   int advance_source_index;
@@ -54,10 +58,14 @@ struct _VertexIterator {
 // AdjList implementation
 // --------------------------------------------------------------------------------
 
+// Most vertices in road-like graphs have a handful of neighbours. Adjacency lists
+// store up to this many edges inline, without a separate allocation.
+#define ADJ_LIST_INLINE_CAPACITY 6
+
 static AdjList* AdjList_new(void* source) {
   AdjList* result = (AdjList*) Mem_alloc(sizeof(AdjList));
   result->source = source;
-  result->list = Array_new(10);
+  result->list = Array_new_small(ADJ_LIST_INLINE_CAPACITY);
 
   return result;
 }
@@ -206,6 +214,7 @@ EdgeIterator* Graph_adjacents(Graph* graph, void* vertex) {
   EdgeIterator* it = (EdgeIterator*) Mem_alloc(sizeof(struct _EdgeIterator));
   it->graph = graph;
   it->start_source_index = *index;
+  it->end_source_index = SIZE_MAX;
   it->source_index = *index;
   it->adj_index = 0;
   it->advance_source_index = 0;
@@ -218,14 +227,20 @@ VertexIterator* Graph_vertices(Graph* graph) {
   return it;
 }
 
-static size_t Graph_first_vertex_with_adjacents(Graph* graph, size_t vertex_index) {
+// Returns the index of the first vertex having adjacents in [vertex_index, end_index),
+// a value not smaller than end_index if there is none.
+static size_t Graph_first_vertex_with_adjacents(Graph* graph, size_t vertex_index, size_t end_index) {
   size_t graph_size = Array_size(graph->adj_lists);
-  if(vertex_index >= graph_size) {
+  if(end_index > graph_size) {
+    end_index = graph_size;
+  }
+
+  if(vertex_index >= end_index) {
     return vertex_index;
   }
 
   AdjList* adj_list = Array_at(graph->adj_lists, vertex_index);
-  while(Array_size(adj_list->list) == 0 && ++vertex_index < graph_size) {
+  while(Array_size(adj_list->list) == 0 && ++vertex_index < end_index) {
     adj_list = Array_at(graph->adj_lists, vertex_index);
   }
 
@@ -236,8 +251,9 @@ EdgeIterator* Graph_edges(Graph* graph) {
   EdgeIterator* it = (EdgeIterator*) Mem_alloc(sizeof(struct _EdgeIterator));
 
   it->graph = graph;
-  it->source_index = Graph_first_vertex_with_adjacents(graph, 0);
+  it->source_index = Graph_first_vertex_with_adjacents(graph, 0, SIZE_MAX);
   it->start_source_index = it->source_index;
+  it->end_source_index = SIZE_MAX;
   it->adj_index = 0;
   it->advance_source_index = 1;
   return it;
@@ -252,7 +268,7 @@ void EdgeIterator_free(EdgeIterator* it) {
 }
 
 int EdgeIterator_end(EdgeIterator* it) {
-  return it->source_index >= Array_size(it->graph->adj_lists);
+  return it->source_index >= Array_size(it->graph->adj_lists) || it->source_index >= it->end_source_index;
 }
 
 void EdgeIterator_next(EdgeIterator* it) {
@@ -274,7 +290,7 @@ void EdgeIterator_next(EdgeIterator* it) {
   }
 
   it->adj_index = 0;
-  it->source_index = Graph_first_vertex_with_adjacents(it->graph, it->source_index + 1);
+  it->source_index = Graph_first_vertex_with_adjacents(it->graph, it->source_index + 1, it->end_source_index);
 }
 
 
@@ -293,6 +309,32 @@ void EdgeIterator_to_begin(EdgeIterator* it) {
   it->adj_index = 0;
 }
 
+EdgeIterator* EdgeIterator_split(EdgeIterator* it) {
+  size_t end_index = Array_size(it->graph->adj_lists);
+  if(it->end_source_index < end_index) {
+    end_index = it->end_source_index;
+  }
+
+  if(!it->advance_source_index || it->source_index + 1 >= end_index) {
+    return NULL;
+  }
+
+  // the current source stays with it, the second half of the following ones is handed off
+  size_t split_index = it->source_index + 1 + (end_index - it->source_index - 1) / 2;
+
+  EdgeIterator* result = (EdgeIterator*) Mem_alloc(sizeof(struct _EdgeIterator));
+  result->graph = it->graph;
+  result->source_index = Graph_first_vertex_with_adjacents(it->graph, split_index, end_index);
+  result->start_source_index = result->source_index;
+  result->end_source_index = end_index;
+  result->adj_index = 0;
+  result->advance_source_index = 1;
+
+  it->end_source_index = split_index;
+
+  return result;
+}
+
 int  EdgeIterator_same(EdgeIterator* it1, EdgeIterator* it2) {
   return
     it1->graph           ==  it2->graph &&
@@ -348,7 +390,7 @@ Iterator Vertex_it(Graph* graph) {
 
 
 Iterator Edge_it(Graph* graph) {
-  return Iterator_make(
+  Iterator result = Iterator_make(
     graph,
     (void* (*)(void*)) Graph_edges,
     (void (*)(void*))  EdgeIterator_next,
@@ -358,6 +400,8 @@ Iterator Edge_it(Graph* graph) {
     (int  (*)(void*, void*)) EdgeIterator_same,
     (void (*)(void*))  EdgeIterator_free
   );
+
+  return SplittableIterator_make(result, (void* (*)(void*)) EdgeIterator_split);
 }
 
 static void* AdjacentsEdgeIt_new(EdgeIterator* it) {
@@ -0,0 +1,105 @@
+#include "group_aggregate.h"
+#include <Block.h>
+
+#include "iterator_functions.h"
+#include "mem.h"
+
+// Number of slots of the table of recent keys (a power of two): 512 slots of 32 bytes fit in
+// the L1 cache
+#define GROUP_AGGREGATE_CACHE_BITS 9
+#define GROUP_AGGREGATE_CACHE_SIZE (1ul << GROUP_AGGREGATE_CACHE_BITS)
+
+typedef struct {
+  void* key;
+  void* aggregate;
+  size_t hash;
+  int used;
+} GroupAggregatorSlot;
+
+// While a key occupies a slot of the table, its aggregate is the one in the slot: the one in the
+// dictionary (if any) is outdated until the slot is written back.
+struct _GroupAggregator {
+  Dictionary* groups;
+  KIComparator compare;
+  KIHash hash;
+  void* (^key_fn)(void* elem);
+  void* (^init_fn)(void* key);
+  void* (^accumulate_fn)(void* aggregate, void* elem);
+  GroupAggregatorSlot slots[GROUP_AGGREGATE_CACHE_SIZE];
+};
+
+// Hash functions of keys often leave the low bits poorly mixed (e.g., Key_int_hash), the slot is
+// taken from the high bits of the hash multiplied by a large odd constant.
+static size_t GroupAggregator_slot(size_t hash) {
+  return (size_t) (((unsigned long long) hash * 0x9E3779B97F4A7C15ull) >> (64 - GROUP_AGGREGATE_CACHE_BITS));
+}
+
+// Constructor
+
+GroupAggregator* GroupAggregator_new(Dictionary* groups, void* (^key_fn)(void* elem), void* (^init_fn)(void* key), void* (^accumulate_fn)(void* aggregate, void* elem)) {
+  GroupAggregator* aggregator = (GroupAggregator*) Mem_calloc(1, sizeof(GroupAggregator));
+  aggregator->groups = groups;
+  aggregator->compare = KeyInfo_comparator(Dictionary_key_info(groups));
+  aggregator->hash = KeyInfo_hash(Dictionary_key_info(groups));
+  aggregator->key_fn = Block_copy(key_fn);
+  aggregator->init_fn = Block_copy(init_fn);
+  aggregator->accumulate_fn = Block_copy(accumulate_fn);
+
+  return aggregator;
+}
+
+// Destructor
+
+void GroupAggregator_free(GroupAggregator* aggregator) {
+  for(size_t i = 0; i < GROUP_AGGREGATE_CACHE_SIZE; ++i) {
+    GroupAggregatorSlot* slot = &aggregator->slots[i];
+    if(slot->used) {
+      Dictionary_set(aggregator->groups, slot->key, slot->aggregate);
+    }
+  }
+
+  Block_release(aggregator->key_fn);
+  Block_release(aggregator->init_fn);
+  Block_release(aggregator->accumulate_fn);
+  Mem_free(aggregator);
+}
+
+// Aggregation
+
+void GroupAggregator_add(GroupAggregator* aggregator, void* elem) {
+  void* key = aggregator->key_fn(elem);
+  size_t hash = aggregator->hash(key);
+  GroupAggregatorSlot* slot = &aggregator->slots[GroupAggregator_slot(hash)];
+
+  if(slot->used && slot->hash == hash && aggregator->compare(slot->key, key) == 0) {
+    slot->aggregate = aggregator->accumulate_fn(slot->aggregate, elem);
+    return;
+  }
+
+  if(slot->used) {
+    Dictionary_set(aggregator->groups, slot->key, slot->aggregate);
+  }
+
+  void* aggregate;
+  if(!Dictionary_get(aggregator->groups, key, &aggregate)) {
+    aggregate = aggregator->init_fn(key);
+  }
+
+  slot->key = key;
+  slot->hash = hash;
+  slot->used = 1;
+  slot->aggregate = aggregator->accumulate_fn(aggregate, elem);
+}
+
+Dictionary* group_aggregate(Iterator it, void* (^key_fn)(void* elem), KeyInfo* key_info, void* (^init_fn)(void* key), void* (^accumulate_fn)(void* aggregate, void* elem)) {
+  Dictionary* groups = Dictionary_new(key_info);
+  GroupAggregator* aggregator = GroupAggregator_new(groups, key_fn, init_fn, accumulate_fn);
+
+  for_each(it, ^(void* elem) {
+    GroupAggregator_add(aggregator, elem);
+  });
+
+  GroupAggregator_free(aggregator);
+
+  return groups;
+}
@@ -0,0 +1,247 @@
+#include "hash_join.h"
+#include <string.h>
+
+#include "iterator_functions.h"
+#include "mem.h"
+
+// Number of build entries in each partition of radix_hash_join: the entries (24 bytes each) and
+// the bucket offsets of a partition take about 128KB, which fit in the L2 cache
+#define HASH_JOIN_PARTITION_SIZE 4096
+
+// Partitions are made in a single pass, with more partitions the scatter would keep missing the
+// TLB
+#define HASH_JOIN_MAX_PARTITION_BITS 12
+
+typedef struct {
+  size_t hash;
+  void* key;
+  void* elem;
+} HashJoinEntry;
+
+// The entries of bucket b are entries[offsets[b], offsets[b + 1]). Buckets are indexed by the
+// low bits of the (mixed) hashes, partitions by the high ones.
+struct _HashJoinTable {
+  HashJoinEntry* entries;
+  size_t* offsets;
+  size_t size;
+  size_t mask;
+  KIComparator compare;
+  KIHash hash;
+};
+
+// Hash functions of keys often leave some bits poorly mixed (e.g., Key_int_hash), the final
+// step of splitmix64 spreads every bit of hash to all the bits of the result
+static size_t HashJoin_mix(size_t hash) {
+  unsigned long long mixed = hash;
+  mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+  mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+
+  return (size_t) (mixed ^ (mixed >> 31));
+}
+
+static size_t HashJoin_num_buckets(size_t size) {
+  size_t num_buckets = 1;
+  while(num_buckets < size) {
+    num_buckets *= 2;
+  }
+
+  return num_buckets;
+}
+
+// Returns the entries of the elements returned by it (and stores their number in size)
+static HashJoinEntry* HashJoin_collect(Iterator it, KIHash hash, void* (^key_fn)(void* elem), size_t* size) {
+  __block size_t capacity = 1024;
+  __block size_t count = 0;
+  __block HashJoinEntry* entries = (HashJoinEntry*) Mem_alloc(sizeof(HashJoinEntry) * capacity);
+
+  for_each(it, ^(void* elem) {
+    if(count == capacity) {
+      capacity *= 2;
+      entries = (HashJoinEntry*) Mem_realloc(entries, sizeof(HashJoinEntry) * capacity);
+    }
+
+    void* key = key_fn(elem);
+    entries[count++] = (HashJoinEntry) { HashJoin_mix(hash(key)), key, elem };
+  });
+
+  *size = count;
+  return entries;
+}
+
+// Indexes the given entries storing them in table->entries and the bucket boundaries in
+// table->offsets, both large enough for size entries
+static void HashJoinTable_index(HashJoinTable* table, HashJoinEntry* entries, size_t size) {
+  size_t num_buckets = HashJoin_num_buckets(size);
+  table->size = size;
+  table->mask = num_buckets - 1;
+
+  // counting sort of the entries by bucket, offsets[b + 1] counts the entries of bucket b
+  memset(table->offsets, 0, sizeof(size_t) * (num_buckets + 1));
+  for(size_t i = 0; i < size; ++i) {
+    table->offsets[(entries[i].hash & table->mask) + 1] += 1;
+  }
+
+  for(size_t b = 0; b < num_buckets; ++b) {
+    table->offsets[b + 1] += table->offsets[b];
+  }
+
+  // offsets[b] is used as the next free position of bucket b, then restored
+  for(size_t i = 0; i < size; ++i) {
+    table->entries[table->offsets[entries[i].hash & table->mask]++] = entries[i];
+  }
+
+  memmove(table->offsets + 1, table->offsets, sizeof(size_t) * num_buckets);
+  table->offsets[0] = 0;
+}
+
+// Constructor
+
+HashJoinTable* HashJoinTable_new(Iterator it, KeyInfo* key_info, void* (^key_fn)(void* elem)) {
+  HashJoinTable* table = (HashJoinTable*) Mem_alloc(sizeof(HashJoinTable));
+  table->compare = KeyInfo_comparator(key_info);
+  table->hash = KeyInfo_hash(key_info);
+
+  size_t size;
+  HashJoinEntry* entries = HashJoin_collect(it, table->hash, key_fn, &size);
+  table->entries = (HashJoinEntry*) Mem_alloc(sizeof(HashJoinEntry) * (size > 0 ? size : 1));
+  table->offsets = (size_t*) Mem_alloc(sizeof(size_t) * (HashJoin_num_buckets(size) + 1));
+  HashJoinTable_index(table, entries, size);
+  Mem_free(entries);
+
+  return table;
+}
+
+// Destructor
+
+void HashJoinTable_free(HashJoinTable* table) {
+  Mem_free(table->entries);
+  Mem_free(table->offsets);
+  Mem_free(table);
+}
+
+// Accessors
+
+size_t HashJoinTable_size(HashJoinTable* table) {
+  return table->size;
+}
+
+// Lookups
+
+// Looks up a key whose mixed hash has already been computed
+static size_t HashJoinTable_probe_hash(HashJoinTable* table, size_t hash, const void* key, void* probe_elem, void (^callback)(void* build_elem, void* probe_elem)) {
+  size_t bucket = hash & table->mask;
+  size_t found = 0;
+
+  for(size_t i = table->offsets[bucket]; i < table->offsets[bucket + 1]; ++i) {
+    HashJoinEntry* entry = &table->entries[i];
+    if(entry->hash == hash && table->compare(entry->key, key) == 0) {
+      callback(entry->elem, probe_elem);
+      found += 1;
+    }
+  }
+
+  return found;
+}
+
+size_t HashJoinTable_probe(HashJoinTable* table, const void* key, void* probe_elem, void (^callback)(void* build_elem, void* probe_elem)) {
+  return HashJoinTable_probe_hash(table, HashJoin_mix(table->hash(key)), key, probe_elem, callback);
+}
+
+// Joins
+
+void hash_join(Iterator build, Iterator probe, KeyInfo* key_info, void* (^build_key_fn)(void* elem), void* (^probe_key_fn)(void* elem), void (^callback)(void* build_elem, void* probe_elem)) {
+  if(is_random_access_iterator(build) && is_random_access_iterator(probe) && count(build) > count(probe)) {
+    hash_join(probe, build, key_info, probe_key_fn, build_key_fn, ^(void* probe_elem, void* build_elem) {
+      callback(build_elem, probe_elem);
+    });
+    return;
+  }
+
+  HashJoinTable* table = HashJoinTable_new(build, key_info, build_key_fn);
+
+  for_each(probe, ^(void* elem) {
+    HashJoinTable_probe(table, probe_key_fn(elem), elem, callback);
+  });
+
+  HashJoinTable_free(table);
+}
+
+// Returns the entries sorted by partition (the high bits of their hashes) and stores the
+// boundaries of the partitions in offsets (num_partitions + 1 positions)
+static HashJoinEntry* HashJoin_partition(HashJoinEntry* entries, size_t size, unsigned bits, size_t* offsets) {
+  size_t num_partitions = (size_t) 1 << bits;
+  unsigned shift = (unsigned) (sizeof(size_t) * 8) - bits;
+  HashJoinEntry* partitioned = (HashJoinEntry*) Mem_alloc(sizeof(HashJoinEntry) * (size > 0 ? size : 1));
+
+  memset(offsets, 0, sizeof(size_t) * (num_partitions + 1));
+  for(size_t i = 0; i < size; ++i) {
+    offsets[(entries[i].hash >> shift) + 1] += 1;
+  }
+
+  for(size_t p = 0; p < num_partitions; ++p) {
+    offsets[p + 1] += offsets[p];
+  }
+
+  size_t* next = (size_t*) Mem_alloc(sizeof(size_t) * num_partitions);
+  memcpy(next, offsets, sizeof(size_t) * num_partitions);
+  for(size_t i = 0; i < size; ++i) {
+    partitioned[next[entries[i].hash >> shift]++] = entries[i];
+  }
+
+  Mem_free(next);
+  return partitioned;
+}
+
+void radix_hash_join(Iterator build, Iterator probe, KeyInfo* key_info, void* (^build_key_fn)(void* elem), void* (^probe_key_fn)(void* elem), void (^callback)(void* build_elem, void* probe_elem)) {
+  HashJoinTable table;
+  table.compare = KeyInfo_comparator(key_info);
+  table.hash = KeyInfo_hash(key_info);
+
+  size_t build_size, probe_size;
+  HashJoinEntry* build_entries = HashJoin_collect(build, table.hash, build_key_fn, &build_size);
+  HashJoinEntry* probe_entries = HashJoin_collect(probe, table.hash, probe_key_fn, &probe_size);
+
+  // at least one bit, so that the partitions use the high bits of the hashes (the shift by the
+  // size of size_t in HashJoin_partition would be undefined)
+  unsigned bits = 1;
+  while(bits < HASH_JOIN_MAX_PARTITION_BITS && (build_size >> bits) > HASH_JOIN_PARTITION_SIZE) {
+    bits += 1;
+  }
+  size_t num_partitions = (size_t) 1 << bits;
+
+  size_t* build_offsets = (size_t*) Mem_alloc(sizeof(size_t) * (num_partitions + 1));
+  size_t* probe_offsets = (size_t*) Mem_alloc(sizeof(size_t) * (num_partitions + 1));
+  HashJoinEntry* build_partitions = HashJoin_partition(build_entries, build_size, bits, build_offsets);
+  HashJoinEntry* probe_partitions = HashJoin_partition(probe_entries, probe_size, bits, probe_offsets);
+  Mem_free(build_entries);
+  Mem_free(probe_entries);
+
+  size_t max_partition_size = 0;
+  for(size_t p = 0; p < num_partitions; ++p) {
+    size_t partition_size = build_offsets[p + 1] - build_offsets[p];
+    max_partition_size = partition_size > max_partition_size ? partition_size : max_partition_size;
+  }
+
+  // the same buffers are used by the tables of all the partitions
+  table.entries = (HashJoinEntry*) Mem_alloc(sizeof(HashJoinEntry) * (max_partition_size > 0 ? max_partition_size : 1));
+  table.offsets = (size_t*) Mem_alloc(sizeof(size_t) * (HashJoin_num_buckets(max_partition_size) + 1));
+
+  for(size_t p = 0; p < num_partitions; ++p) {
+    if(build_offsets[p] == build_offsets[p + 1] || probe_offsets[p] == probe_offsets[p + 1]) {
+      continue;
+    }
+
+    HashJoinTable_index(&table, build_partitions + build_offsets[p], build_offsets[p + 1] - build_offsets[p]);
+    for(size_t i = probe_offsets[p]; i < probe_offsets[p + 1]; ++i) {
+      HashJoinEntry* entry = &probe_partitions[i];
+      HashJoinTable_probe_hash(&table, entry->hash, entry->key, entry->elem, callback);
+    }
+  }
+
+  Mem_free(table.entries);
+  Mem_free(table.offsets);
+  Mem_free(build_offsets);
+  Mem_free(probe_offsets);
+  Mem_free(build_partitions);
+  Mem_free(probe_partitions);
+}
@@ -20,8 +20,12 @@ struct _Dictionary {
   KeyInfo* keyInfo;
 };
 
+// The iterator visits the buckets in [start_index, end_index). The range is the whole table
+// unless the iterator has been split.
 struct _DictionaryIterator {
   Dictionary* dictionary;
+  size_t start_index;
+  size_t end_index;
   size_t cur_index;
   ListIterator* cur_list_element;
 };
@@ -47,11 +51,13 @@ static void KeyValue_free(KeyValue* kv) {
  * DictionaryIterator implementation
  *  -------------------------- */
 
-DictionaryIterator* DictionaryIterator_new(Dictionary* dictionary) {
+static DictionaryIterator* DictionaryIterator_new_range(Dictionary* dictionary, size_t start_index, size_t end_index) {
   DictionaryIterator* it = (DictionaryIterator*) Mem_alloc(sizeof(struct _DictionaryIterator));
   it->dictionary = dictionary;
-  it->cur_index = 0;
-  it->cur_list_element = ListIterator_new(it->dictionary->table[0]);
+  it->start_index = start_index;
+  it->end_index = end_index;
+  it->cur_index = start_index;
+  it->cur_list_element = ListIterator_new(it->dictionary->table[start_index]);
   if(ListIterator_end(it->cur_list_element)) {
     DictionaryIterator_next(it);
   }
@@ -59,6 +65,10 @@ DictionaryIterator* DictionaryIterator_new(Dictionary* dictionary) {
   return it;
 }
 
+DictionaryIterator* DictionaryIterator_new(Dictionary* dictionary) {
+  return DictionaryIterator_new_range(dictionary, 0, dictionary->capacity);
+}
+
 void DictionaryIterator_free(DictionaryIterator* it) {
   ListIterator_free(it->cur_list_element);
   Mem_free(it);
@@ -80,7 +90,7 @@ void DictionaryIterator_next(DictionaryIterator* it) {
     }
   }
 
-  while(it->cur_index < it->dictionary->capacity - 1 && ListIterator_end(it->cur_list_element)) {
+  while(it->cur_index < it->end_index - 1 && ListIterator_end(it->cur_list_element)) {
     it->cur_index += 1;
     ListIterator_free(it->cur_list_element);
     it->cur_list_element = ListIterator_new(it->dictionary->table[it->cur_index]);
@@ -88,18 +98,32 @@ void DictionaryIterator_next(DictionaryIterator* it) {
 }
 
 void DictionaryIterator_to_begin(DictionaryIterator* it) {
-  it->cur_index = 0;
-  
+  it->cur_index = it->start_index;
+
   if(it->cur_list_element!=NULL) {
     ListIterator_free(it->cur_list_element);
   }
 
-  it->cur_list_element = ListIterator_new(it->dictionary->table[0]);
+  it->cur_list_element = ListIterator_new(it->dictionary->table[it->start_index]);
   if(ListIterator_end(it->cur_list_element)) {
     DictionaryIterator_next(it);
   }
 }
 
+// Hands off the second half of the buckets following the current one.
+DictionaryIterator* DictionaryIterator_split(DictionaryIterator* it) {
+  size_t num_remaining = it->end_index - it->cur_index - 1;
+  if(num_remaining == 0) {
+    return NULL;
+  }
+
+  size_t split_index = it->cur_index + 1 + num_remaining / 2;
+  DictionaryIterator* result = DictionaryIterator_new_range(it->dictionary, split_index, it->end_index);
+  it->end_index = split_index;
+
+  return result;
+}
+
 int DictionaryIterator_same(DictionaryIterator* it1, DictionaryIterator* it2) {
   return
     it1->dictionary == it2->dictionary &&
@@ -9,6 +9,8 @@
 #include "list.h"
 #include "macros.h"
 #include "array.h"
+#include "array_view.h"
+#include "quick_sort.h"
 
 Iterator Iterator_make(
   void* container,
@@ -47,6 +49,17 @@ Iterator Iterator_make(
   it.copy_obj = NULL;
   it.free_obj = NULL;
 
+  // batch and span
+  it.next_batch = NULL;
+  it.next_span = NULL;
+
+  // splittable
+  it.split = NULL;
+
+  // inline
+  it.init_iterator = NULL;
+  it.deinit_iterator = NULL;
+
   return it;
 }
 
@@ -95,6 +108,60 @@ Iterator CloningIterator_make(
   return iterator;
 }
 
+Iterator BatchIterator_make(
+  Iterator iterator,
+  size_t (*next_batch)(void*, void**, size_t)
+) {
+  iterator.next_batch = next_batch;
+
+  return iterator;
+}
+
+Iterator SpanIterator_make(
+  Iterator iterator,
+  size_t (*next_span)(void*, ArrayView*)
+) {
+  iterator.next_span = next_span;
+
+  return iterator;
+}
+
+Iterator SplittableIterator_make(
+  Iterator iterator,
+  void* (*split)(void*)
+) {
+  iterator.split = split;
+
+  return iterator;
+}
+
+Iterator InlineIterator_make(
+  Iterator iterator,
+  void* (*init_iterator)(void*, void*),
+  void  (*deinit_iterator)(void*)
+) {
+  iterator.init_iterator = init_iterator;
+  iterator.deinit_iterator = deinit_iterator;
+
+  return iterator;
+}
+
+void* Iterator_new_instance(Iterator it, IteratorStorage* storage) {
+  if(it.init_iterator != NULL) {
+    return it.init_iterator(it.container, storage);
+  }
+
+  return it.new_iterator(it.container);
+}
+
+void Iterator_free_instance(Iterator it, void* iterator) {
+  if(it.init_iterator == NULL) {
+    it.free(iterator);
+  } else if(it.deinit_iterator != NULL) {
+    it.deinit_iterator(iterator);
+  }
+}
+
 int is_bidirectional_iterator(Iterator it) {
   return !(it.to_begin==NULL || it.to_end==NULL || it.prev==NULL);
 }
@@ -108,6 +175,18 @@ int is_mutable_iterator(Iterator it) {
 int is_cloning_iterator(Iterator it) {
   return !(it.alloc_obj == NULL || it.copy_obj == NULL || it.free_obj == NULL);
 }
+int is_batch_iterator(Iterator it) {
+  return !(it.next_batch == NULL);
+}
+int is_span_iterator(Iterator it) {
+  return !(it.next_span == NULL);
+}
+int is_splittable_iterator(Iterator it) {
+  return !(it.split == NULL);
+}
+int is_inline_iterator(Iterator it) {
+  return !(it.init_iterator == NULL);
+}
 
 void require_bidirectional_iterator(Iterator it) {
   if(!is_bidirectional_iterator(it)) {
@@ -133,18 +212,53 @@ void require_cloning_iterator(Iterator it) {
   }
 }
 
+void require_splittable_iterator(Iterator it) {
+  if(!is_splittable_iterator(it)) {
+    Error_raise(Error_new(ERROR_ITERATOR_MISUSE, "The given iterator is not a splittable iterator as required"));
+  }
+}
+
+
+// Number of elements requested to batch iterators by the iteration functions
+#define ITERATOR_BATCH_SIZE 64
 
 void for_each(Iterator it, void (^callback)(void*)) {
-  void* iterator = it.new_iterator(it.container);
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
   it.to_begin(iterator);
 
-  while(!it.end(iterator)) {
-    void* elem = it.get(iterator);
-    callback(elem);
-    it.next(iterator);
+  if(it.next_span != NULL) {
+    ArrayView span;
+    while(it.next_span(iterator, &span) != 0) {
+      if(span.by_value) {
+        unsigned char* span_end = span.carray + span.size * span.elem_size;
+        for(unsigned char* elem = span.carray; elem < span_end; elem += span.elem_size) {
+          callback(elem);
+        }
+      } else {
+        void** elems = (void**) (void*) span.carray;
+        for(size_t i = 0; i < span.size; ++i) {
+          callback(elems[i]);
+        }
+      }
+    }
+  } else if(it.next_batch != NULL) {
+    void* batch[ITERATOR_BATCH_SIZE];
+    size_t batch_size;
+    while((batch_size = it.next_batch(iterator, batch, ITERATOR_BATCH_SIZE)) != 0) {
+      for(size_t i = 0; i < batch_size; ++i) {
+        callback(batch[i]);
+      }
+    }
+  } else {
+    while(!it.end(iterator)) {
+      void* elem = it.get(iterator);
+      callback(elem);
+      it.next(iterator);
+    }
   }
 
-  it.free(iterator);
+  Iterator_free_instance(it, iterator);
 }
 
 Iterator reverse(Iterator it) {
@@ -154,6 +268,13 @@ Iterator reverse(Iterator it) {
   result.to_end = it.to_begin;
   result.to_begin = it.to_end;
 
+  // batches and spans are returned in forward order
+  result.next_batch = NULL;
+  result.next_span = NULL;
+
+  // parts are only defined for forward iteration
+  result.split = NULL;
+
   return result;
 }
 
@@ -165,7 +286,8 @@ Iterator reverse(Iterator it) {
 // }
 
 void for_each_with_index(Iterator it, void(^callback)(void*, size_t)) {
-  void* iterator = it.new_iterator(it.container);
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
   size_t index = 0;
 
   while(!it.end(iterator)) {
@@ -174,35 +296,84 @@ void for_each_with_index(Iterator it, void(^callback)(void*, size_t)) {
     it.next(iterator);
   }
 
-  it.free(iterator);
+  Iterator_free_instance(it, iterator);
 }
 
 static void for_each_with_iterator(Iterator it, void(^callback)(void*)) {
-  void* iterator = it.new_iterator(it.container);
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
 
   while(!it.end(iterator)) {
     callback(iterator);
     it.next(iterator);
   }
 
-  it.free(iterator);
+  Iterator_free_instance(it, iterator);
 }
 
 
+// Returns 1 and stores in result the first element of span satisfying condition, returns 0 if
+// there is none (the element found may be NULL)
+static int find_first_in_span__(ArrayView* span, int(^condition)(void* elem), void** result) {
+  if(span->by_value) {
+    unsigned char* span_end = span->carray + span->size * span->elem_size;
+    for(unsigned char* elem = span->carray; elem < span_end; elem += span->elem_size) {
+      if(condition(elem)) {
+        *result = elem;
+        return 1;
+      }
+    }
+  } else {
+    void** elems = (void**) (void*) span->carray;
+    for(size_t i = 0; i < span->size; ++i) {
+      if(condition(elems[i])) {
+        *result = elems[i];
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
 void* find_first(Iterator it, int(^condition)(void* elem)) {
-  void* iterator = it.new_iterator(it.container);
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
   it.to_begin(iterator);
+  void* result = NULL;
+  int found = 0;
+
+  if(it.next_span != NULL) {
+    ArrayView span;
+    while(!found && it.next_span(iterator, &span) != 0) {
+      found = find_first_in_span__(&span, condition, &result);
+    }
+
+    Iterator_free_instance(it, iterator);
+    return result;
+  }
+
+  if(it.next_batch != NULL) {
+    void* batch[ITERATOR_BATCH_SIZE];
+    size_t batch_size;
+    while(!found && (batch_size = it.next_batch(iterator, batch, ITERATOR_BATCH_SIZE)) != 0) {
+      ArrayView span = ArrayView_make(batch, batch_size);
+      found = find_first_in_span__(&span, condition, &result);
+    }
+
+    Iterator_free_instance(it, iterator);
+    return result;
+  }
 
   while(!it.end(iterator) && condition(it.get(iterator)) == 0) {
     it.next(iterator);
   }
-  void* result = NULL;
 
   if(!it.end(iterator)) {
     result = it.get(iterator);
   }
 
-  it.free(iterator);
+  Iterator_free_instance(it, iterator);
   return result;
 }
 
@@ -211,16 +382,41 @@ void* find_last(Iterator it, int(^condition)(void* elem)) {
   return find_first(reverse(it), condition);
 }
 
+// Returns the element at the given index, reading it directly from span when it holds all the
+// elements of the container
+static void* binsearch_at__(Iterator* it, void* iterator, ArrayView* span, size_t index) {
+  if(span->size > 0) {
+    if(span->by_value) {
+      return span->carray + index * span->elem_size;
+    }
+    return ((void**) (void*) span->carray)[index];
+  }
+
+  it->move_to(iterator, index);
+  return it->get(iterator);
+}
+
 static size_t binsearch_approx_(Iterator it, const void* elem, int* last_comparison, int (^compare)(const void* lhs, const void* rhs)) {
   require_random_access_iterator(it);
 
-  void* iterator = it.new_iterator(it.container);
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
   size_t left = 0;
   size_t right = it.size(iterator) - 1;
   size_t current_index = (left + right) / 2;
 
-  it.move_to(iterator, current_index);
-  int comparison = compare(elem, it.get(iterator));
+  // containers storing all their elements in a single span (e.g., Array, ArrayAlt) are
+  // searched without calling move_to and get at each step
+  ArrayView span;
+  span.size = 0;
+  if(it.next_span != NULL) {
+    it.to_begin(iterator);
+    if(it.next_span(iterator, &span) != right + 1) {
+      span.size = 0;
+    }
+  }
+
+  int comparison = compare(elem, binsearch_at__(&it, iterator, &span, current_index));
 
   while(left < right && comparison != 0) {
     if(comparison < 0) {
@@ -234,12 +430,10 @@ static size_t binsearch_approx_(Iterator it, const void* elem, int* last_compari
     }
 
     current_index = (left + right) / 2;
-
-    it.move_to(iterator, current_index);
-    comparison = compare(elem, it.get(iterator));
+    comparison = compare(elem, binsearch_at__(&it, iterator, &span, current_index));
   }
 
-  it.free(iterator);
+  Iterator_free_instance(it, iterator);
 
   if(last_comparison != NULL) {
     *last_comparison = comparison;
@@ -264,7 +458,8 @@ size_t binsearch(Iterator it, const void *elem, KIBlkComparator compare) {
 }
 
 Array *map(Iterator it, void * (^mapping_function)(void *)) {
-  Array* result = Array_new(10);
+  Array* result = Array_new_small(10);
+
   for_each(it, ^(void* obj) {
     void* elem = mapping_function(obj);
     Array_add(result, elem);
@@ -274,7 +469,7 @@ Array *map(Iterator it, void * (^mapping_function)(void *)) {
 }
 
 Array* filter(Iterator it, int (^keep)(void*)) {
-  Array* result = Array_new(10);
+  Array* result = Array_new_small(10);
   for_each(it, ^(void* elem) {
     if(keep(elem)) {
       Array_add(result, elem);
@@ -284,17 +479,25 @@ Array* filter(Iterator it, int (^keep)(void*)) {
   return result;
 }
 
+void* reduce(Iterator it, void* initial_value, void* (^combine)(void* accumulator, void* elem)) {
+  __block void* accumulator = initial_value;
+  for_each(it, ^(void* elem) {
+    accumulator = combine(accumulator, elem);
+  });
+
+  return accumulator;
+}
+
 void* first(Iterator it) {
-  void* iterator = it.new_iterator(it.container);
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
   void* result = NULL;
 
-  if(it.end(iterator)) {
-    return NULL;
+  if(!it.end(iterator)) {
+    result = it.get(iterator);
   }
 
-  result = it.get(iterator);
-
-  it.free(iterator);
+  Iterator_free_instance(it, iterator);
   return result;
 }
 
@@ -308,8 +511,10 @@ void reverse_contents(Iterator it) {
   require_bidirectional_iterator(it);
   require_mutable_iterator(it);
 
-  void* fw_iterator = it.new_iterator(it.container);
-  void* bw_iterator = it.new_iterator(it.container);
+  IteratorStorage fw_storage;
+  void* fw_iterator = Iterator_new_instance(it, &fw_storage);
+  IteratorStorage bw_storage;
+  void* bw_iterator = Iterator_new_instance(it, &bw_storage);
 
   it.to_end(bw_iterator);
   int stop = it.same(fw_iterator, bw_iterator);
@@ -333,13 +538,14 @@ void reverse_contents(Iterator it) {
   }
 
   it.free_obj(tmp);
-  it.free(fw_iterator);
-  it.free(bw_iterator);
+  Iterator_free_instance(it, fw_iterator);
+  Iterator_free_instance(it, bw_iterator);
 }
 
 void replace(Iterator it, void* (^callback)(void*)) {
   require_mutable_iterator(it);
-  void* iterator = it.new_iterator(it.container);
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
 
   while(!it.end(iterator)) {
     void* elem = it.get(iterator);
@@ -349,11 +555,12 @@ void replace(Iterator it, void* (^callback)(void*)) {
     it.next(iterator);
   }
 
-  it.free(iterator);
+  Iterator_free_instance(it, iterator);
 }
 
 void* last(Iterator it) {
-  void* iterator = it.new_iterator(it.container);
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
   void* result = NULL;
 
   if(it.to_end != NULL) {
@@ -366,7 +573,7 @@ void* last(Iterator it) {
     }
   }
 
-  it.free(iterator);
+  Iterator_free_instance(it, iterator);
   return result;
 }
 
@@ -463,7 +670,8 @@ static void sort__default(Iterator it, int (^compare)(const void*, const void*))
   require_cloning_iterator(it);
   require_random_access_iterator(it);
 
-  void* iterator = it.new_iterator(it.container);
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
   size_t count = it.size(iterator);
   void* tmp_mem[2];
   tmp_mem[0] = it.alloc_obj(iterator);
@@ -473,7 +681,7 @@ static void sort__default(Iterator it, int (^compare)(const void*, const void*))
 
   it.free_obj(tmp_mem[0]);
   it.free_obj(tmp_mem[1]);
-  it.free(iterator);
+  Iterator_free_instance(it, iterator);
 }
 
 // end qsort implementation
@@ -482,7 +690,8 @@ static void sort__no_random_access(Iterator it, int (^compare)(const void*, cons
   require_mutable_iterator(it);
   require_cloning_iterator(it);
 
-  void* iterator = it.new_iterator(it.container);
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
 
   Array* array = Array_new(1000);
   for_each_with_iterator(it, ^(void* cloning_iterator) {
@@ -504,18 +713,43 @@ static void sort__no_random_access(Iterator it, int (^compare)(const void*, cons
     it.free_obj(obj);
   });
 
-  it.free(iterator);
+  Iterator_free_instance(it, iterator);
   Array_free(array);
 }
 
 
 size_t count(Iterator it) {
   if(it.size != NULL) {
-    void* iterator = it.new_iterator(it.container);
+    IteratorStorage storage;
+    void* iterator = Iterator_new_instance(it, &storage);
     size_t result = it.size(iterator);
-    it.free(iterator);
+    Iterator_free_instance(it, iterator);
     return result;
   }
+
+  if(it.next_span != NULL || it.next_batch != NULL) {
+    IteratorStorage storage;
+    void* iterator = Iterator_new_instance(it, &storage);
+    it.to_begin(iterator);
+    size_t result = 0;
+    size_t run_size;
+
+    if(it.next_span != NULL) {
+      ArrayView span;
+      while((run_size = it.next_span(iterator, &span)) != 0) {
+        result += run_size;
+      }
+    } else {
+      void* batch[ITERATOR_BATCH_SIZE];
+      while((run_size = it.next_batch(iterator, batch, ITERATOR_BATCH_SIZE)) != 0) {
+        result += run_size;
+      }
+    }
+
+    Iterator_free_instance(it, iterator);
+    return result;
+  }
+
   __block size_t result = 0;
 
   for_each(it, ^( UNUSED(void* obj) ){
@@ -536,9 +770,231 @@ void sort(Iterator it, KIBlkComparator compare) {
     return;
   }
 
+  if(is_array_view_iterator(it) && !((ArrayView*) it.container)->by_value) {
+    ArrayView* view = (ArrayView*) it.container;
+    quick_sort_wb((void**)(void*) view->carray, view->size, compare);
+    return;
+  }
+
   if(is_random_access_iterator(it)) {
     sort__default(it, compare);
   } else {
     sort__no_random_access(it, compare);
   }
 }
+
+// Selection (top_k, nth_element, partial_sort)
+
+static void swap_pointers__(void** array, size_t i, size_t j) {
+  void* tmp = array[i];
+  array[i] = array[j];
+  array[j] = tmp;
+}
+
+// Restores the max-heap property of array[0, size) moving down the element at position index
+static void sift_down__(void** array, size_t index, size_t size, int (^compare)(const void*, const void*)) {
+  size_t child;
+  while((child = 2 * index + 1) < size) {
+    if(child + 1 < size && compare(array[child + 1], array[child]) > 0) {
+      child += 1;
+    }
+
+    if(compare(array[child], array[index]) <= 0) {
+      return;
+    }
+
+    swap_pointers__(array, index, child);
+    index = child;
+  }
+}
+
+// Moves the element of rank n to array[n] keeping the n smallest elements in a max-heap of n+1
+// elements. It takes O(count log n) time: introselect falls back to it when quickselect keeps
+// choosing bad pivots.
+static void heap_select__(void** array, size_t count, size_t n, int (^compare)(const void*, const void*)) {
+  for(size_t i = (n + 1) / 2; i > 0; --i) {
+    sift_down__(array, i - 1, n + 1, compare);
+  }
+
+  for(size_t i = n + 1; i < count; ++i) {
+    if(compare(array[i], array[0]) < 0) {
+      swap_pointers__(array, 0, i);
+      sift_down__(array, 0, n + 1, compare);
+    }
+  }
+
+  swap_pointers__(array, 0, n);
+}
+
+static size_t median_of_three__(void** array, size_t a, size_t b, size_t c, int (^compare)(const void*, const void*)) {
+  if(compare(array[a], array[b]) < 0) {
+    if(compare(array[b], array[c]) < 0) {
+      return b;
+    }
+    return compare(array[a], array[c]) < 0 ? c : a;
+  }
+
+  if(compare(array[a], array[c]) < 0) {
+    return a;
+  }
+  return compare(array[b], array[c]) < 0 ? c : b;
+}
+
+// Introselect: quickselect with median of three pivots and three way partitions (so that
+// repeated elements end the search early). After 2 log2(count) partitions it switches to
+// heap_select__, which bounds the running time to O(count log count).
+static void nth_element__(void** array, size_t count, size_t n, int (^compare)(const void*, const void*)) {
+  size_t left = 0;
+  size_t right = count - 1;
+  size_t depth = 0;
+  for(size_t size = count; size > 1; size /= 2) {
+    depth += 2;
+  }
+
+  while(right > left) {
+    if(depth == 0) {
+      heap_select__(array + left, right - left + 1, n - left, compare);
+      return;
+    }
+    depth -= 1;
+
+    void* pivot = array[median_of_three__(array, left, left + (right - left) / 2, right, compare)];
+
+    // [left, lt) < pivot, [lt, i) == pivot, [i, gt) to be processed, [gt, right] > pivot
+    size_t lt = left;
+    size_t i = left;
+    size_t gt = right + 1;
+    while(i < gt) {
+      int comparison = compare(array[i], pivot);
+      if(comparison < 0) {
+        swap_pointers__(array, lt++, i++);
+      } else if(comparison > 0) {
+        swap_pointers__(array, i, --gt);
+      } else {
+        i += 1;
+      }
+    }
+
+    if(n < lt) {
+      right = lt - 1;
+    } else if(n >= gt) {
+      left = gt;
+    } else {
+      return;
+    }
+  }
+}
+
+// Calls body on the elements iterated by it stored in a C array of pointers. Arrays and views
+// of pointers are rearranged in place. For other containers, body works on copies of the
+// elements (made by copy_obj), which are then stored back in iteration order.
+static void with_pointers__(Iterator it, void (^body)(void** array, size_t count)) {
+  if(is_array_iterator(it)) {
+    Array* array = (Array*) it.container;
+    body((void**) Array_carray(array), Array_size(array));
+    return;
+  }
+
+  if(is_array_view_iterator(it) && !((ArrayView*) it.container)->by_value) {
+    ArrayView* view = (ArrayView*) it.container;
+    body((void**)(void*) view->carray, view->size);
+    return;
+  }
+
+  require_mutable_iterator(it);
+  require_cloning_iterator(it);
+
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
+
+  Array* copies = Array_new(1000);
+  for_each_with_iterator(it, ^(void* cloning_iterator) {
+    void* new_obj = it.alloc_obj(cloning_iterator);
+    new_obj = it.copy_obj(cloning_iterator, new_obj);
+    Array_add(copies, new_obj);
+  });
+
+  body((void**) Array_carray(copies), Array_size(copies));
+
+  it.to_begin(iterator);
+  for_each(Array_it(copies), ^(void* obj) {
+    it.set(iterator, obj);
+    it.next(iterator);
+  });
+
+  for_each(Array_it(copies), ^(void* obj) {
+    it.free_obj(obj);
+  });
+
+  Iterator_free_instance(it, iterator);
+  Array_free(copies);
+}
+
+void nth_element(Iterator it, size_t n, KIBlkComparator compare) {
+  with_pointers__(it, ^(void** array, size_t count) {
+    if(n >= count) {
+      Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Index %ld is out of bounds (0,%ld)", n, count));
+    }
+
+    nth_element__(array, count, n, compare);
+  });
+}
+
+void partial_sort(Iterator it, size_t k, KIBlkComparator compare) {
+  with_pointers__(it, ^(void** array, size_t count) {
+    size_t sorted = k < count ? k : count;
+    if(sorted == 0) {
+      return;
+    }
+
+    if(sorted < count) {
+      nth_element__(array, count, sorted - 1, compare);
+    }
+    quick_sort_wb(array, sorted, compare);
+  });
+}
+
+// Keeps the k smallest elements seen so far in a max-heap, so that each element is compared
+// with the largest of them. Elements entering the heap are copied if copy is not NULL, copies
+// leaving it are freed. The heap grows as elements are read, since k may be much larger than
+// the number of elements.
+static Array* top_k__(Iterator it, size_t k, KIBlkComparator compare, void* (^copy)(void* elem)) {
+  Array* result = Array_new(k > 0 && k < 16 ? k : 16);
+
+  if(k > 0) {
+    for_each(it, ^(void* elem) {
+      size_t size = Array_size(result);
+      if(size < k) {
+        Array_add(result, copy != NULL ? copy(elem) : elem);
+
+        // the heap is built once it is full
+        void** heap = (void**) Array_carray(result);
+        for(size_t i = size + 1 == k ? k / 2 : 0; i > 0; --i) {
+          sift_down__(heap, i - 1, k, compare);
+        }
+        return;
+      }
+
+      void** heap = (void**) Array_carray(result);
+      if(compare(elem, heap[0]) < 0) {
+        if(copy != NULL) {
+          Mem_free(heap[0]);
+        }
+        heap[0] = copy != NULL ? copy(elem) : elem;
+        sift_down__(heap, 0, k, compare);
+      }
+    });
+  }
+
+  quick_sort_wb((void**) Array_carray(result), Array_size(result), compare);
+
+  return result;
+}
+
+Array* top_k(Iterator it, size_t k, KIBlkComparator compare) {
+  return top_k__(it, k, compare, NULL);
+}
+
+Array* top_k_copy(Iterator it, size_t k, KIBlkComparator compare, void* (^copy)(void* elem)) {
+  return top_k__(it, k, compare, copy);
+}
@@ -0,0 +1,779 @@
+#include "iterator_adapters.h"
+#include <Block.h>
+#include <string.h>
+
+#include "errors.h"
+#include "mem.h"
+
+// Each adapter is implemented by a pair of structures: the container of the returned
+// Iterator (named *Info) storing the adapter parameters, and the iterator instance
+// (named *Iterator) storing the state of the iteration. Freeing the instance releases
+// the container as well as the instances of the source iterators (see the ownership
+// rules in iterator_adapters.h).
+
+static Iterator Adapter_make(
+  void* info,
+  void* (*new_iterator)(void*),
+  void  (*next)(void*),
+  void* (*get)(void*),
+  int   (*end)(void*),
+  void  (*to_begin)(void*),
+  int   (*same)(void*, void*),
+  void  (*free)(void*)) {
+  return Iterator_make(info, new_iterator, next, get, end, to_begin, same, free);
+}
+
+// --------------------------------------------------------------------------------
+// map_it
+// --------------------------------------------------------------------------------
+
+typedef struct {
+  Iterator source;
+  void* (^mapping)(void*);
+} MapInfo;
+
+typedef struct {
+  MapInfo* info;
+  void* source_it;
+  void* value;
+  int computed;
+} MapIterator;
+
+static MapIterator* MapIterator_new(MapInfo* info) {
+  MapIterator* it = (MapIterator*) Mem_alloc(sizeof(MapIterator));
+  it->info = info;
+  it->source_it = info->source.new_iterator(info->source.container);
+  it->value = NULL;
+  it->computed = 0;
+
+  return it;
+}
+
+static void MapIterator_next(MapIterator* it) {
+  it->info->source.next(it->source_it);
+  it->computed = 0;
+}
+
+static void* MapIterator_get(MapIterator* it) {
+  if(!it->computed) {
+    it->value = it->info->mapping(it->info->source.get(it->source_it));
+    it->computed = 1;
+  }
+
+  return it->value;
+}
+
+static int MapIterator_end(MapIterator* it) {
+  return it->info->source.end(it->source_it);
+}
+
+static void MapIterator_to_begin(MapIterator* it) {
+  it->info->source.to_begin(it->source_it);
+  it->computed = 0;
+}
+
+static int MapIterator_same(MapIterator* it1, MapIterator* it2) {
+  return it1->info == it2->info && it1->info->source.same(it1->source_it, it2->source_it);
+}
+
+static void MapIterator_free(MapIterator* it) {
+  it->info->source.free(it->source_it);
+  Block_release(it->info->mapping);
+  Mem_free(it->info);
+  Mem_free(it);
+}
+
+Iterator map_it(Iterator source, void* (^mapping)(void*)) {
+  MapInfo* info = (MapInfo*) Mem_alloc(sizeof(MapInfo));
+  info->source = source;
+  info->mapping = Block_copy(mapping);
+
+  return Adapter_make(
+    info,
+    (void* (*)(void*))        MapIterator_new,
+    (void  (*)(void*))        MapIterator_next,
+    (void* (*)(void*))        MapIterator_get,
+    (int   (*)(void*))        MapIterator_end,
+    (void  (*)(void*))        MapIterator_to_begin,
+    (int   (*)(void*, void*)) MapIterator_same,
+    (void  (*)(void*))        MapIterator_free
+  );
+}
+
+// --------------------------------------------------------------------------------
+// filter_it
+// --------------------------------------------------------------------------------
+
+typedef struct {
+  Iterator source;
+  int (^keep)(void*);
+} FilterInfo;
+
+typedef struct {
+  FilterInfo* info;
+  void* source_it;
+} FilterIterator;
+
+// Moves the source iterator to the first element to be kept starting from the current one
+static void FilterIterator_skip(FilterIterator* it) {
+  Iterator* source = &it->info->source;
+  while(!source->end(it->source_it) && !it->info->keep(source->get(it->source_it))) {
+    source->next(it->source_it);
+  }
+}
+
+static FilterIterator* FilterIterator_new(FilterInfo* info) {
+  FilterIterator* it = (FilterIterator*) Mem_alloc(sizeof(FilterIterator));
+  it->info = info;
+  it->source_it = info->source.new_iterator(info->source.container);
+  FilterIterator_skip(it);
+
+  return it;
+}
+
+static void FilterIterator_next(FilterIterator* it) {
+  it->info->source.next(it->source_it);
+  FilterIterator_skip(it);
+}
+
+static void* FilterIterator_get(FilterIterator* it) {
+  return it->info->source.get(it->source_it);
+}
+
+static int FilterIterator_end(FilterIterator* it) {
+  return it->info->source.end(it->source_it);
+}
+
+static void FilterIterator_to_begin(FilterIterator* it) {
+  it->info->source.to_begin(it->source_it);
+  FilterIterator_skip(it);
+}
+
+static int FilterIterator_same(FilterIterator* it1, FilterIterator* it2) {
+  return it1->info == it2->info && it1->info->source.same(it1->source_it, it2->source_it);
+}
+
+static void FilterIterator_free(FilterIterator* it) {
+  it->info->source.free(it->source_it);
+  Block_release(it->info->keep);
+  Mem_free(it->info);
+  Mem_free(it);
+}
+
+Iterator filter_it(Iterator source, int (^keep)(void*)) {
+  FilterInfo* info = (FilterInfo*) Mem_alloc(sizeof(FilterInfo));
+  info->source = source;
+  info->keep = Block_copy(keep);
+
+  return Adapter_make(
+    info,
+    (void* (*)(void*))        FilterIterator_new,
+    (void  (*)(void*))        FilterIterator_next,
+    (void* (*)(void*))        FilterIterator_get,
+    (int   (*)(void*))        FilterIterator_end,
+    (void  (*)(void*))        FilterIterator_to_begin,
+    (int   (*)(void*, void*)) FilterIterator_same,
+    (void  (*)(void*))        FilterIterator_free
+  );
+}
+
+// --------------------------------------------------------------------------------
+// take_it, skip_it
+// --------------------------------------------------------------------------------
+
+typedef struct {
+  Iterator source;
+  size_t n;
+} CountInfo;
+
+typedef struct {
+  CountInfo* info;
+  void* source_it;
+  size_t position;
+} CountIterator;
+
+static CountInfo* CountInfo_new(Iterator source, size_t n) {
+  CountInfo* info = (CountInfo*) Mem_alloc(sizeof(CountInfo));
+  info->source = source;
+  info->n = n;
+
+  return info;
+}
+
+static CountIterator* CountIterator_new(CountInfo* info) {
+  CountIterator* it = (CountIterator*) Mem_alloc(sizeof(CountIterator));
+  it->info = info;
+  it->source_it = info->source.new_iterator(info->source.container);
+  it->position = 0;
+
+  return it;
+}
+
+static void CountIterator_next(CountIterator* it) {
+  it->info->source.next(it->source_it);
+  it->position += 1;
+}
+
+static void* CountIterator_get(CountIterator* it) {
+  return it->info->source.get(it->source_it);
+}
+
+static int CountIterator_same(CountIterator* it1, CountIterator* it2) {
+  return it1->info == it2->info && it1->position == it2->position;
+}
+
+static void CountIterator_free(CountIterator* it) {
+  it->info->source.free(it->source_it);
+  Mem_free(it->info);
+  Mem_free(it);
+}
+
+static int TakeIterator_end(CountIterator* it) {
+  return it->position >= it->info->n || it->info->source.end(it->source_it);
+}
+
+static void TakeIterator_to_begin(CountIterator* it) {
+  it->info->source.to_begin(it->source_it);
+  it->position = 0;
+}
+
+Iterator take_it(Iterator source, size_t n) {
+  return Adapter_make(
+    CountInfo_new(source, n),
+    (void* (*)(void*))        CountIterator_new,
+    (void  (*)(void*))        CountIterator_next,
+    (void* (*)(void*))        CountIterator_get,
+    (int   (*)(void*))        TakeIterator_end,
+    (void  (*)(void*))        TakeIterator_to_begin,
+    (int   (*)(void*, void*)) CountIterator_same,
+    (void  (*)(void*))        CountIterator_free
+  );
+}
+
+static void SkipIterator_skip(CountIterator* it) {
+  while(it->position < it->info->n && !it->info->source.end(it->source_it)) {
+    CountIterator_next(it);
+  }
+}
+
+static CountIterator* SkipIterator_new(CountInfo* info) {
+  CountIterator* it = CountIterator_new(info);
+  SkipIterator_skip(it);
+
+  return it;
+}
+
+static int SkipIterator_end(CountIterator* it) {
+  return it->info->source.end(it->source_it);
+}
+
+static void SkipIterator_to_begin(CountIterator* it) {
+  it->info->source.to_begin(it->source_it);
+  it->position = 0;
+  SkipIterator_skip(it);
+}
+
+Iterator skip_it(Iterator source, size_t n) {
+  return Adapter_make(
+    CountInfo_new(source, n),
+    (void* (*)(void*))        SkipIterator_new,
+    (void  (*)(void*))        CountIterator_next,
+    (void* (*)(void*))        CountIterator_get,
+    (int   (*)(void*))        SkipIterator_end,
+    (void  (*)(void*))        SkipIterator_to_begin,
+    (int   (*)(void*, void*)) CountIterator_same,
+    (void  (*)(void*))        CountIterator_free
+  );
+}
+
+// --------------------------------------------------------------------------------
+// enumerate_it
+// --------------------------------------------------------------------------------
+
+typedef struct {
+  CountInfo* info;
+  void* source_it;
+  Enumerated current;
+} EnumerateIterator;
+
+static EnumerateIterator* EnumerateIterator_new(CountInfo* info) {
+  EnumerateIterator* it = (EnumerateIterator*) Mem_alloc(sizeof(EnumerateIterator));
+  it->info = info;
+  it->source_it = info->source.new_iterator(info->source.container);
+  it->current.index = 0;
+
+  return it;
+}
+
+static void EnumerateIterator_next(EnumerateIterator* it) {
+  it->info->source.next(it->source_it);
+  it->current.index += 1;
+}
+
+static void* EnumerateIterator_get(EnumerateIterator* it) {
+  it->current.elem = it->info->source.get(it->source_it);
+  return &it->current;
+}
+
+static int EnumerateIterator_end(EnumerateIterator* it) {
+  return it->info->source.end(it->source_it);
+}
+
+static void EnumerateIterator_to_begin(EnumerateIterator* it) {
+  it->info->source.to_begin(it->source_it);
+  it->current.index = 0;
+}
+
+static int EnumerateIterator_same(EnumerateIterator* it1, EnumerateIterator* it2) {
+  return it1->info == it2->info && it1->current.index == it2->current.index;
+}
+
+static void EnumerateIterator_free(EnumerateIterator* it) {
+  it->info->source.free(it->source_it);
+  Mem_free(it->info);
+  Mem_free(it);
+}
+
+Iterator enumerate_it(Iterator source) {
+  return Adapter_make(
+    CountInfo_new(source, 0),
+    (void* (*)(void*))        EnumerateIterator_new,
+    (void  (*)(void*))        EnumerateIterator_next,
+    (void* (*)(void*))        EnumerateIterator_get,
+    (int   (*)(void*))        EnumerateIterator_end,
+    (void  (*)(void*))        EnumerateIterator_to_begin,
+    (int   (*)(void*, void*)) EnumerateIterator_same,
+    (void  (*)(void*))        EnumerateIterator_free
+  );
+}
+
+// --------------------------------------------------------------------------------
+// zip_it, chain_it
+// --------------------------------------------------------------------------------
+
+typedef struct {
+  Iterator first;
+  Iterator second;
+} PairInfo;
+
+typedef struct {
+  PairInfo* info;
+  void* first_it;
+  void* second_it;
+  ZipPair current;
+} PairIterator;
+
+static PairInfo* PairInfo_new(Iterator first, Iterator second) {
+  PairInfo* info = (PairInfo*) Mem_alloc(sizeof(PairInfo));
+  info->first = first;
+  info->second = second;
+
+  return info;
+}
+
+static PairIterator* PairIterator_new(PairInfo* info) {
+  PairIterator* it = (PairIterator*) Mem_alloc(sizeof(PairIterator));
+  it->info = info;
+  it->first_it = info->first.new_iterator(info->first.container);
+  it->second_it = info->second.new_iterator(info->second.container);
+
+  return it;
+}
+
+static void PairIterator_to_begin(PairIterator* it) {
+  it->info->first.to_begin(it->first_it);
+  it->info->second.to_begin(it->second_it);
+}
+
+static int PairIterator_same(PairIterator* it1, PairIterator* it2) {
+  return it1->info == it2->info &&
+    it1->info->first.same(it1->first_it, it2->first_it) &&
+    it1->info->second.same(it1->second_it, it2->second_it);
+}
+
+static void PairIterator_free(PairIterator* it) {
+  it->info->first.free(it->first_it);
+  it->info->second.free(it->second_it);
+  Mem_free(it->info);
+  Mem_free(it);
+}
+
+static void ZipIterator_next(PairIterator* it) {
+  it->info->first.next(it->first_it);
+  it->info->second.next(it->second_it);
+}
+
+static void* ZipIterator_get(PairIterator* it) {
+  it->current.first = it->info->first.get(it->first_it);
+  it->current.second = it->info->second.get(it->second_it);
+  return &it->current;
+}
+
+static int ZipIterator_end(PairIterator* it) {
+  return it->info->first.end(it->first_it) || it->info->second.end(it->second_it);
+}
+
+Iterator zip_it(Iterator first, Iterator second) {
+  return Adapter_make(
+    PairInfo_new(first, second),
+    (void* (*)(void*))        PairIterator_new,
+    (void  (*)(void*))        ZipIterator_next,
+    (void* (*)(void*))        ZipIterator_get,
+    (int   (*)(void*))        ZipIterator_end,
+    (void  (*)(void*))        PairIterator_to_begin,
+    (int   (*)(void*, void*)) PairIterator_same,
+    (void  (*)(void*))        PairIterator_free
+  );
+}
+
+static void ChainIterator_next(PairIterator* it) {
+  if(!it->info->first.end(it->first_it)) {
+    it->info->first.next(it->first_it);
+  } else {
+    it->info->second.next(it->second_it);
+  }
+}
+
+static void* ChainIterator_get(PairIterator* it) {
+  if(!it->info->first.end(it->first_it)) {
+    return it->info->first.get(it->first_it);
+  }
+
+  return it->info->second.get(it->second_it);
+}
+
+static int ChainIterator_end(PairIterator* it) {
+  return it->info->first.end(it->first_it) && it->info->second.end(it->second_it);
+}
+
+Iterator chain_it(Iterator first, Iterator second) {
+  return Adapter_make(
+    PairInfo_new(first, second),
+    (void* (*)(void*))        PairIterator_new,
+    (void  (*)(void*))        ChainIterator_next,
+    (void* (*)(void*))        ChainIterator_get,
+    (int   (*)(void*))        ChainIterator_end,
+    (void  (*)(void*))        PairIterator_to_begin,
+    (int   (*)(void*, void*)) PairIterator_same,
+    (void  (*)(void*))        PairIterator_free
+  );
+}
+
+// --------------------------------------------------------------------------------
+// chunk_it, window_it
+// --------------------------------------------------------------------------------
+
+typedef struct {
+  CountInfo* info;
+  void* source_it;
+  // chunks: the current chunk is buffer[0, count)
+  // windows: the current window is buffer[start, start + size), buffer holds 2 * size elements
+  void** buffer;
+  size_t start;
+  size_t count;
+  ArrayView view;
+} BufferIterator;
+
+static CountInfo* BufferInfo_new(Iterator source, size_t size) {
+  if(size == 0) {
+    Error_raise(Error_new(ERROR_GENERIC, "Chunks and windows need to hold at least one element"));
+  }
+
+  return CountInfo_new(source, size);
+}
+
+static BufferIterator* BufferIterator_alloc(CountInfo* info, size_t buffer_size) {
+  BufferIterator* it = (BufferIterator*) Mem_alloc(sizeof(BufferIterator));
+  it->info = info;
+  it->source_it = info->source.new_iterator(info->source.container);
+  it->buffer = (void**) Mem_alloc(sizeof(void*) * buffer_size);
+  it->start = 0;
+  it->count = 0;
+
+  return it;
+}
+
+// Moves up to max_count elements from the source into buffer, returns the number of moved elements
+static size_t BufferIterator_fill(BufferIterator* it, void** buffer, size_t max_count) {
+  Iterator* source = &it->info->source;
+  size_t count = 0;
+
+  while(count < max_count && !source->end(it->source_it)) {
+    buffer[count++] = source->get(it->source_it);
+    source->next(it->source_it);
+  }
+
+  return count;
+}
+
+static void* BufferIterator_get(BufferIterator* it) {
+  it->view = ArrayView_make(it->buffer + it->start, it->count);
+  return &it->view;
+}
+
+static int BufferIterator_end(BufferIterator* it) {
+  return it->count == 0;
+}
+
+static int BufferIterator_same(BufferIterator* it1, BufferIterator* it2) {
+  return it1->info == it2->info && it1->info->source.same(it1->source_it, it2->source_it) && it1->count == it2->count;
+}
+
+static void BufferIterator_free(BufferIterator* it) {
+  it->info->source.free(it->source_it);
+  Mem_free(it->buffer);
+  Mem_free(it->info);
+  Mem_free(it);
+}
+
+static void ChunkIterator_next(BufferIterator* it) {
+  it->count = BufferIterator_fill(it, it->buffer, it->info->n);
+}
+
+static BufferIterator* ChunkIterator_new(CountInfo* info) {
+  BufferIterator* it = BufferIterator_alloc(info, info->n);
+  ChunkIterator_next(it);
+
+  return it;
+}
+
+static void ChunkIterator_to_begin(BufferIterator* it) {
+  it->info->source.to_begin(it->source_it);
+  ChunkIterator_next(it);
+}
+
+Iterator chunk_it(Iterator source, size_t size) {
+  return Adapter_make(
+    BufferInfo_new(source, size),
+    (void* (*)(void*))        ChunkIterator_new,
+    (void  (*)(void*))        ChunkIterator_next,
+    (void* (*)(void*))        BufferIterator_get,
+    (int   (*)(void*))        BufferIterator_end,
+    (void  (*)(void*))        ChunkIterator_to_begin,
+    (int   (*)(void*, void*)) BufferIterator_same,
+    (void  (*)(void*))        BufferIterator_free
+  );
+}
+
+// Fills the first window (the iterator ends if the source has less than size elements)
+static void WindowIterator_fill(BufferIterator* it) {
+  size_t size = it->info->n;
+  it->start = 0;
+  it->count = BufferIterator_fill(it, it->buffer, size) == size ? size : 0;
+}
+
+static BufferIterator* WindowIterator_new(CountInfo* info) {
+  BufferIterator* it = BufferIterator_alloc(info, 2 * info->n);
+  WindowIterator_fill(it);
+
+  return it;
+}
+
+// Slides the window by one element. Elements are appended after the window until the
+// buffer is full, then the window is moved back to the beginning of the buffer, so that
+// each element is copied O(1) times (amortized).
+static void WindowIterator_next(BufferIterator* it) {
+  Iterator* source = &it->info->source;
+  size_t size = it->info->n;
+
+  if(source->end(it->source_it)) {
+    it->count = 0;
+    return;
+  }
+
+  void* elem = source->get(it->source_it);
+  source->next(it->source_it);
+
+  if(it->start + size == 2 * size) {
+    memmove(it->buffer, it->buffer + it->start + 1, sizeof(void*) * (size - 1));
+    it->start = 0;
+    it->buffer[size - 1] = elem;
+  } else {
+    it->buffer[it->start + size] = elem;
+    it->start += 1;
+  }
+}
+
+static void WindowIterator_to_begin(BufferIterator* it) {
+  it->info->source.to_begin(it->source_it);
+  WindowIterator_fill(it);
+}
+
+Iterator window_it(Iterator source, size_t size) {
+  return Adapter_make(
+    BufferInfo_new(source, size),
+    (void* (*)(void*))        WindowIterator_new,
+    (void  (*)(void*))        WindowIterator_next,
+    (void* (*)(void*))        BufferIterator_get,
+    (int   (*)(void*))        BufferIterator_end,
+    (void  (*)(void*))        WindowIterator_to_begin,
+    (int   (*)(void*, void*)) BufferIterator_same,
+    (void  (*)(void*))        BufferIterator_free
+  );
+}
+
+// --------------------------------------------------------------------------------
+// merge_it
+// --------------------------------------------------------------------------------
+
+typedef struct {
+  Iterator* sources;
+  size_t k;
+  KIBlkComparator compare;
+} MergeInfo;
+
+typedef struct {
+  void* iterator;
+  // element returned by get, fetched once each time the source moves
+  void* head;
+  int ended;
+} MergeSource;
+
+// Loser tree over the k sources: the leaf of source i is node k + i, internal node n (in
+// [1, k)) stores the source that lost the match played at n and node 0 stores the overall
+// winner, i.e., the source whose head is returned by get.
+typedef struct {
+  MergeInfo* info;
+  MergeSource* sources;
+  size_t* losers;
+  size_t position;
+} MergeIterator;
+
+static void MergeIterator_fetch(MergeIterator* it, size_t source) {
+  Iterator* source_it = &it->info->sources[source];
+  MergeSource* merge_source = &it->sources[source];
+
+  merge_source->ended = source_it->end(merge_source->iterator);
+  merge_source->head = merge_source->ended ? NULL : source_it->get(merge_source->iterator);
+}
+
+// Returns 1 if source a wins against source b: ended sources lose against any other source,
+// ties are won by the first source so that the merge is stable
+static int MergeIterator_beats(MergeIterator* it, size_t a, size_t b) {
+  MergeSource* source_a = &it->sources[a];
+  MergeSource* source_b = &it->sources[b];
+
+  if(source_a->ended || source_b->ended) {
+    return !source_a->ended;
+  }
+
+  int comparison = it->info->compare(source_a->head, source_b->head);
+  return comparison < 0 || (comparison == 0 && a < b);
+}
+
+// Plays all the matches bottom up, winners[n] is the winner of the match played at node n
+static void MergeIterator_build(MergeIterator* it) {
+  size_t k = it->info->k;
+  size_t* winners = (size_t*) Mem_alloc(sizeof(size_t) * 2 * k);
+
+  for(size_t source = 0; source < k; ++source) {
+    MergeIterator_fetch(it, source);
+    winners[k + source] = source;
+  }
+
+  for(size_t node = k - 1; node > 0; --node) {
+    size_t left = winners[2 * node];
+    size_t right = winners[2 * node + 1];
+    int left_wins = MergeIterator_beats(it, left, right);
+
+    winners[node] = left_wins ? left : right;
+    it->losers[node] = left_wins ? right : left;
+  }
+
+  it->losers[0] = winners[1];
+  it->position = 0;
+  Mem_free(winners);
+}
+
+static MergeIterator* MergeIterator_new(MergeInfo* info) {
+  MergeIterator* it = (MergeIterator*) Mem_alloc(sizeof(MergeIterator));
+  it->info = info;
+  it->sources = (MergeSource*) Mem_alloc(sizeof(MergeSource) * (info->k > 0 ? info->k : 1));
+  it->losers = (size_t*) Mem_alloc(sizeof(size_t) * (info->k > 0 ? info->k : 1));
+
+  for(size_t source = 0; source < info->k; ++source) {
+    it->sources[source].iterator = info->sources[source].new_iterator(info->sources[source].container);
+  }
+
+  if(info->k > 0) {
+    MergeIterator_build(it);
+  }
+
+  return it;
+}
+
+// Moves the winner to its next element and replays its matches from its leaf up to the root
+static void MergeIterator_next(MergeIterator* it) {
+  size_t k = it->info->k;
+  size_t winner = it->losers[0];
+
+  it->info->sources[winner].next(it->sources[winner].iterator);
+  MergeIterator_fetch(it, winner);
+
+  for(size_t node = (k + winner) / 2; node > 0; node /= 2) {
+    if(MergeIterator_beats(it, it->losers[node], winner)) {
+      size_t loser = winner;
+      winner = it->losers[node];
+      it->losers[node] = loser;
+    }
+  }
+
+  it->losers[0] = winner;
+  it->position += 1;
+}
+
+static void* MergeIterator_get(MergeIterator* it) {
+  return it->sources[it->losers[0]].head;
+}
+
+static int MergeIterator_end(MergeIterator* it) {
+  return it->info->k == 0 || it->sources[it->losers[0]].ended;
+}
+
+static void MergeIterator_to_begin(MergeIterator* it) {
+  for(size_t source = 0; source < it->info->k; ++source) {
+    it->info->sources[source].to_begin(it->sources[source].iterator);
+  }
+
+  if(it->info->k > 0) {
+    MergeIterator_build(it);
+  }
+}
+
+static int MergeIterator_same(MergeIterator* it1, MergeIterator* it2) {
+  return it1->info == it2->info && it1->position == it2->position;
+}
+
+static void MergeIterator_free(MergeIterator* it) {
+  for(size_t source = 0; source < it->info->k; ++source) {
+    it->info->sources[source].free(it->sources[source].iterator);
+  }
+
+  Block_release(it->info->compare);
+  Mem_free(it->info->sources);
+  Mem_free(it->info);
+  Mem_free(it->sources);
+  Mem_free(it->losers);
+  Mem_free(it);
+}
+
+Iterator merge_it(Iterator* inputs, size_t k, KIBlkComparator compare) {
+  MergeInfo* info = (MergeInfo*) Mem_alloc(sizeof(MergeInfo));
+  info->sources = (Iterator*) Mem_alloc(sizeof(Iterator) * (k > 0 ? k : 1));
+  if(k > 0) {
+    memcpy(info->sources, inputs, sizeof(Iterator) * k);
+  }
+  info->k = k;
+  info->compare = Block_copy(compare);
+
+  return Adapter_make(
+    info,
+    (void* (*)(void*))        MergeIterator_new,
+    (void  (*)(void*))        MergeIterator_next,
+    (void* (*)(void*))        MergeIterator_get,
+    (int   (*)(void*))        MergeIterator_end,
+    (void  (*)(void*))        MergeIterator_to_begin,
+    (int   (*)(void*, void*)) MergeIterator_same,
+    (void  (*)(void*))        MergeIterator_free
+  );
+}
@@ -0,0 +1,401 @@
+#include "iterator_instrumentation.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "array.h"
+#include "array_view.h"
+#include "iterator_functions.h"
+#include "mem.h"
+#include "ansi_colors.h"
+
+#define MAX_KEY 256
+
+// Statistics of a label, times are in ticks of Instrumentation_ticks
+typedef struct {
+  char* label;
+  size_t instances;
+  size_t next_calls;
+  size_t get_calls;
+  size_t other_calls;
+  size_t elements;
+  unsigned long long inside_ticks;
+  unsigned long long lifetime_ticks;
+} InstrumentationEntry;
+
+// Container of the instrumented iterators, owned by the registry
+typedef struct {
+  Iterator source;
+  InstrumentationEntry* entry;
+} InstrumentInfo;
+
+typedef struct {
+  InstrumentInfo* info;
+  void* source_it;
+  size_t next_calls;
+  size_t get_calls;
+  size_t other_calls;
+  size_t elements;
+  unsigned long long inside_ticks;
+  unsigned long long created;
+} InstrumentIterator;
+
+// The registry: entries and infos are NULL until the first iterator is instrumented. The
+// duration of a tick is measured comparing the ticks elapsed since then with clock_gettime.
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Array* registry_entries = NULL;
+static Array* registry_infos = NULL;
+static unsigned long long registry_start_ticks;
+static struct timespec registry_start_time;
+
+static unsigned long long Instrumentation_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long long) now.tv_sec * 1000000000ull + (unsigned long long) now.tv_nsec;
+#endif
+}
+
+// Returns the duration of a tick in seconds
+static double Instrumentation_tick_seconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  unsigned long long ticks = Instrumentation_ticks() - registry_start_ticks;
+  double seconds = (double) (now.tv_sec - registry_start_time.tv_sec) + (double) (now.tv_nsec - registry_start_time.tv_nsec) / 1e9;
+
+  return ticks > 0 ? seconds / (double) ticks : 0.0;
+}
+
+// Returns the entry of the given label, adding it if needed. The registry must be locked.
+static InstrumentationEntry* Instrumentation_entry(const char* label) {
+  if(registry_entries == NULL) {
+    registry_entries = Array_new(16);
+    registry_infos = Array_new(16);
+    registry_start_ticks = Instrumentation_ticks();
+    clock_gettime(CLOCK_MONOTONIC, &registry_start_time);
+  }
+
+  InstrumentationEntry* entry = (InstrumentationEntry*) find_first(Array_it(registry_entries), ^int(void* elem) {
+    return strcmp(((InstrumentationEntry*) elem)->label, label) == 0;
+  });
+
+  if(entry == NULL) {
+    entry = (InstrumentationEntry*) Mem_calloc(1, sizeof(InstrumentationEntry));
+    entry->label = Mem_strdup(label);
+    Array_add(registry_entries, entry);
+  }
+
+  return entry;
+}
+
+// --------------------------------------------------------------------------------
+// Instrumented iterators
+// --------------------------------------------------------------------------------
+
+static InstrumentIterator* InstrumentIterator_wrap(InstrumentInfo* info, void* source_it, unsigned long long created) {
+  InstrumentIterator* it = (InstrumentIterator*) Mem_calloc(1, sizeof(InstrumentIterator));
+  it->info = info;
+  it->source_it = source_it;
+  it->created = created;
+
+  return it;
+}
+
+static InstrumentIterator* InstrumentIterator_new(InstrumentInfo* info) {
+  unsigned long long start = Instrumentation_ticks();
+  void* source_it = info->source.new_iterator(info->source.container);
+  InstrumentIterator* it = InstrumentIterator_wrap(info, source_it, start);
+  it->inside_ticks += Instrumentation_ticks() - start;
+
+  return it;
+}
+
+static void InstrumentIterator_next(InstrumentIterator* it) {
+  unsigned long long start = Instrumentation_ticks();
+  it->info->source.next(it->source_it);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->next_calls += 1;
+  it->elements += 1;
+}
+
+static void* InstrumentIterator_get(InstrumentIterator* it) {
+  unsigned long long start = Instrumentation_ticks();
+  void* elem = it->info->source.get(it->source_it);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->get_calls += 1;
+
+  return elem;
+}
+
+static int InstrumentIterator_end(InstrumentIterator* it) {
+  unsigned long long start = Instrumentation_ticks();
+  int end = it->info->source.end(it->source_it);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+
+  return end;
+}
+
+static void InstrumentIterator_to_begin(InstrumentIterator* it) {
+  unsigned long long start = Instrumentation_ticks();
+  it->info->source.to_begin(it->source_it);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+}
+
+static int InstrumentIterator_same(InstrumentIterator* it1, InstrumentIterator* it2) {
+  unsigned long long start = Instrumentation_ticks();
+  int same = it1->info->source.same(it1->source_it, it2->source_it);
+  it1->inside_ticks += Instrumentation_ticks() - start;
+  it1->other_calls += 1;
+
+  return same;
+}
+
+// Adds the counters of the instance to its entry in the registry
+static void InstrumentIterator_free(InstrumentIterator* it) {
+  unsigned long long start = Instrumentation_ticks();
+  it->info->source.free(it->source_it);
+  unsigned long long end = Instrumentation_ticks();
+  it->inside_ticks += end - start;
+
+  pthread_mutex_lock(&registry_mutex);
+  InstrumentationEntry* entry = it->info->entry;
+  entry->instances += 1;
+  entry->next_calls += it->next_calls;
+  entry->get_calls += it->get_calls;
+  entry->other_calls += it->other_calls + 1;
+  entry->elements += it->elements;
+  entry->inside_ticks += it->inside_ticks;
+  entry->lifetime_ticks += end - it->created;
+  pthread_mutex_unlock(&registry_mutex);
+
+  Mem_free(it);
+}
+
+static void InstrumentIterator_move_to(InstrumentIterator* it, size_t position) {
+  unsigned long long start = Instrumentation_ticks();
+  it->info->source.move_to(it->source_it, position);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+}
+
+static size_t InstrumentIterator_size(InstrumentIterator* it) {
+  unsigned long long start = Instrumentation_ticks();
+  size_t size = it->info->source.size(it->source_it);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+
+  return size;
+}
+
+static void InstrumentIterator_prev(InstrumentIterator* it) {
+  unsigned long long start = Instrumentation_ticks();
+  it->info->source.prev(it->source_it);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+}
+
+static void InstrumentIterator_to_end(InstrumentIterator* it) {
+  unsigned long long start = Instrumentation_ticks();
+  it->info->source.to_end(it->source_it);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+}
+
+static void InstrumentIterator_set(InstrumentIterator* it, void* elem) {
+  unsigned long long start = Instrumentation_ticks();
+  it->info->source.set(it->source_it, elem);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+}
+
+static void* InstrumentIterator_alloc_obj(InstrumentIterator* it) {
+  unsigned long long start = Instrumentation_ticks();
+  void* obj = it->info->source.alloc_obj(it->source_it);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+
+  return obj;
+}
+
+static void* InstrumentIterator_copy_obj(InstrumentIterator* it, void* to_mem) {
+  unsigned long long start = Instrumentation_ticks();
+  void* obj = it->info->source.copy_obj(it->source_it, to_mem);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+
+  return obj;
+}
+
+static size_t InstrumentIterator_next_batch(InstrumentIterator* it, void** out, size_t max) {
+  unsigned long long start = Instrumentation_ticks();
+  size_t batch_size = it->info->source.next_batch(it->source_it, out, max);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+  it->elements += batch_size;
+
+  return batch_size;
+}
+
+static size_t InstrumentIterator_next_span(InstrumentIterator* it, ArrayView* span) {
+  unsigned long long start = Instrumentation_ticks();
+  size_t span_size = it->info->source.next_span(it->source_it, span);
+  it->inside_ticks += Instrumentation_ticks() - start;
+  it->other_calls += 1;
+  it->elements += span_size;
+
+  return span_size;
+}
+
+static InstrumentIterator* InstrumentIterator_split(InstrumentIterator* it) {
+  unsigned long long start = Instrumentation_ticks();
+  void* source_part = it->info->source.split(it->source_it);
+  unsigned long long end = Instrumentation_ticks();
+  it->inside_ticks += end - start;
+  it->other_calls += 1;
+
+  return source_part != NULL ? InstrumentIterator_wrap(it->info, source_part, end) : NULL;
+}
+
+// Instrumented iterators provide the same traits of the source ones, except for inline instances
+Iterator instrument_it_ext(Iterator source, const char* label) {
+  InstrumentInfo* info = (InstrumentInfo*) Mem_alloc(sizeof(InstrumentInfo));
+  info->source = source;
+
+  pthread_mutex_lock(&registry_mutex);
+  info->entry = Instrumentation_entry(label);
+  Array_add(registry_infos, info);
+  pthread_mutex_unlock(&registry_mutex);
+
+  Iterator it = Iterator_make(
+    info,
+    (void* (*)(void*))        InstrumentIterator_new,
+    (void  (*)(void*))        InstrumentIterator_next,
+    (void* (*)(void*))        InstrumentIterator_get,
+    (int   (*)(void*))        InstrumentIterator_end,
+    (void  (*)(void*))        InstrumentIterator_to_begin,
+    (int   (*)(void*, void*)) InstrumentIterator_same,
+    (void  (*)(void*))        InstrumentIterator_free
+  );
+
+  if(is_random_access_iterator(source)) {
+    it = RandomAccessIterator_make(it, (void (*)(void*, size_t)) InstrumentIterator_move_to, (size_t (*)(void*)) InstrumentIterator_size);
+  }
+
+  if(is_bidirectional_iterator(source)) {
+    it = BidirectionalIterator_make(it, (void (*)(void*)) InstrumentIterator_prev, (void (*)(void*)) InstrumentIterator_to_end);
+  }
+
+  if(is_mutable_iterator(source)) {
+    it = MutableIterator_make(it, (void (*)(void*, void*)) InstrumentIterator_set);
+  }
+
+  if(is_cloning_iterator(source)) {
+    // objects are freed without going through an iterator instance
+    it = CloningIterator_make(it, (void* (*)(void*)) InstrumentIterator_alloc_obj, (void* (*)(void*, void*)) InstrumentIterator_copy_obj, source.free_obj);
+  }
+
+  if(is_batch_iterator(source)) {
+    it = BatchIterator_make(it, (size_t (*)(void*, void**, size_t)) InstrumentIterator_next_batch);
+  }
+
+  if(is_span_iterator(source)) {
+    it = SpanIterator_make(it, (size_t (*)(void*, ArrayView*)) InstrumentIterator_next_span);
+  }
+
+  if(is_splittable_iterator(source)) {
+    it = SplittableIterator_make(it, (void* (*)(void*)) InstrumentIterator_split);
+  }
+
+  return it;
+}
+
+// --------------------------------------------------------------------------------
+// Registry
+// --------------------------------------------------------------------------------
+
+static void Instrumentation_fill_stats(InstrumentationEntry* entry, double tick_seconds, IteratorStats* stats) {
+  stats->label = entry->label;
+  stats->instances = entry->instances;
+  stats->next_calls = entry->next_calls;
+  stats->get_calls = entry->get_calls;
+  stats->other_calls = entry->other_calls;
+  stats->elements = entry->elements;
+  stats->inside_seconds = (double) entry->inside_ticks * tick_seconds;
+  stats->lifetime_seconds = (double) entry->lifetime_ticks * tick_seconds;
+}
+
+// Calls callback on the statistics of each label, in the order labels have been registered
+static void Instrumentation_for_each(void (^callback)(IteratorStats* stats)) {
+  pthread_mutex_lock(&registry_mutex);
+  if(registry_entries != NULL) {
+    double tick_seconds = Instrumentation_tick_seconds();
+    for_each(Array_it(registry_entries), ^(void* elem) {
+      IteratorStats stats;
+      Instrumentation_fill_stats((InstrumentationEntry*) elem, tick_seconds, &stats);
+      callback(&stats);
+    });
+  }
+  pthread_mutex_unlock(&registry_mutex);
+}
+
+int Instrumentation_stats(const char* label, IteratorStats* stats) {
+  __block int found = 0;
+  Instrumentation_for_each(^(IteratorStats* label_stats) {
+    if(strcmp(label_stats->label, label) == 0) {
+      *stats = *label_stats;
+      found = 1;
+    }
+  });
+
+  return found;
+}
+
+void Instrumentation_print_report(void) {
+  printf(BWHT "%-20s %10s %12s %12s %12s %12s %12s %12s %12s\n" reset, "iterator", "instances", "next", "get", "other", "elements", "inside (s)", "outside (s)", "ns/element");
+  Instrumentation_for_each(^(IteratorStats* stats) {
+    double outside = stats->lifetime_seconds - stats->inside_seconds;
+    double per_element = stats->elements > 0 ? stats->inside_seconds * 1e9 / (double) stats->elements : 0.0;
+    printf("%-20s %10ld %12ld %12ld %12ld %12ld %12.4lf %12.4lf %12.1lf\n", stats->label, stats->instances, stats->next_calls, stats->get_calls, stats->other_calls, stats->elements, stats->inside_seconds, outside > 0.0 ? outside : 0.0, per_element);
+  });
+}
+
+void Instrumentation_save_report(PrintTime* pt) {
+  Instrumentation_for_each(^(IteratorStats* stats) {
+    char key[MAX_KEY];
+    snprintf(key, MAX_KEY, "%s.instances", stats->label);
+    PrintTime_add_data(pt, key, (double) stats->instances);
+    snprintf(key, MAX_KEY, "%s.next_calls", stats->label);
+    PrintTime_add_data(pt, key, (double) stats->next_calls);
+    snprintf(key, MAX_KEY, "%s.get_calls", stats->label);
+    PrintTime_add_data(pt, key, (double) stats->get_calls);
+    snprintf(key, MAX_KEY, "%s.other_calls", stats->label);
+    PrintTime_add_data(pt, key, (double) stats->other_calls);
+    snprintf(key, MAX_KEY, "%s.elements", stats->label);
+    PrintTime_add_data(pt, key, (double) stats->elements);
+    snprintf(key, MAX_KEY, "%s.inside_seconds", stats->label);
+    PrintTime_add_data(pt, key, stats->inside_seconds);
+    snprintf(key, MAX_KEY, "%s.lifetime_seconds", stats->label);
+    PrintTime_add_data(pt, key, stats->lifetime_seconds);
+  });
+}
+
+void Instrumentation_reset(void) {
+  pthread_mutex_lock(&registry_mutex);
+  if(registry_entries != NULL) {
+    for_each(Array_it(registry_entries), ^(void* elem) {
+      Mem_free(((InstrumentationEntry*) elem)->label);
+      Mem_free(elem);
+    });
+    free_contents(Array_it(registry_infos));
+    Array_free(registry_entries);
+    Array_free(registry_infos);
+    registry_entries = NULL;
+    registry_infos = NULL;
+  }
+  pthread_mutex_unlock(&registry_mutex);
+}
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <stdint.h>
 #include "keys.h"
 #include "list.h"
 #include "errors.h"
@@ -14,12 +15,38 @@ struct _ListNode {
   struct _ListNode* succ;
 };
 
+// Number of nodes stored in the list object itself.
+#define LIST_INLINE_NODES 2
+// Capacity of the first and of the largest slab of nodes.
+#define LIST_MIN_SLAB_NODES 8
+#define LIST_MAX_SLAB_NODES 1024
+
+// Nodes are allocated in slabs owned by the list. Slabs capacities double (up
+// to LIST_MAX_SLAB_NODES) so that both short lists (e.g., hash table buckets)
+// and long ones need few allocations.
+typedef struct _ListNodeSlab {
+  struct _ListNodeSlab* next;
+  size_t capacity;
+  size_t used;
+  ListNode nodes[];
+} ListNodeSlab;
+
 // Internal list implementation. It could be abstracted and moved into
 // a separate module (not done since currently used only in this module).
+//
+// Nodes are never released to the system allocator before List_free: deleted
+// nodes are pushed on the free_nodes list (linked through the succ field) and
+// recycled by subsequent insertions. The first LIST_INLINE_NODES nodes come
+// from inline_nodes, so that short lists cost a single allocation.
 struct _List {
   ListNode* head;
   ListNode* tail;
   size_t size;
+
+  ListNode* free_nodes;
+  ListNodeSlab* slabs;
+  size_t inline_used;
+  ListNode inline_nodes[LIST_INLINE_NODES];
 };
 
 struct _ListIterator {
@@ -38,10 +65,47 @@ List* List_new() {
   result->head = NULL;
   result->tail = NULL;
   result->size = 0l;
+  result->free_nodes = NULL;
+  result->slabs = NULL;
+  result->inline_used = 0;
 
   return result;
 }
 
+static ListNode* ListNode_alloc(List* list) {
+  if(list->free_nodes != NULL) {
+    ListNode* node = list->free_nodes;
+    list->free_nodes = node->succ;
+    return node;
+  }
+
+  if(list->inline_used < LIST_INLINE_NODES) {
+    return &list->inline_nodes[list->inline_used++];
+  }
+
+  if(list->slabs == NULL || list->slabs->used == list->slabs->capacity) {
+    size_t capacity = LIST_MIN_SLAB_NODES;
+    if(list->slabs != NULL && list->slabs->capacity < LIST_MAX_SLAB_NODES) {
+      capacity = list->slabs->capacity * 2;
+    } else if(list->slabs != NULL) {
+      capacity = LIST_MAX_SLAB_NODES;
+    }
+
+    ListNodeSlab* slab = (ListNodeSlab*) Mem_alloc(sizeof(ListNodeSlab) + sizeof(struct _ListNode) * capacity);
+    slab->next = list->slabs;
+    slab->capacity = capacity;
+    slab->used = 0;
+    list->slabs = slab;
+  }
+
+  return &list->slabs->nodes[list->slabs->used++];
+}
+
+static void ListNode_release(List* list, ListNode* node) {
+  node->succ = list->free_nodes;
+  list->free_nodes = node;
+}
+
 
 void* List_get_head(List* list) {
   return list->head->elem;
@@ -81,7 +145,7 @@ int List_empty(List* list) {
 // }
 
 void List_insert(List* list, void* elem) {
-  ListNode* new_node = (ListNode*) Mem_alloc(sizeof(struct _ListNode));
+  ListNode* new_node = ListNode_alloc(list);
   new_node->elem = elem;
   new_node->succ = list->head;
   new_node->pred = NULL;
@@ -98,7 +162,7 @@ void List_insert(List* list, void* elem) {
 }
 
 void List_append(List* list, void* elem) {
-  ListNode* new_node = (ListNode*) Mem_alloc(sizeof(struct _ListNode));
+  ListNode* new_node = ListNode_alloc(list);
   new_node->elem = elem;
   new_node->succ = NULL;
   new_node->pred = list->tail;
@@ -135,15 +199,22 @@ ListNode *List_prev(UNUSED(List* list), ListNode * node) {
   return node->pred;
 }
 
+// Unless user objects need to be freed, nodes are not visited: the cost is
+// proportional to the number of slabs.
 void List_free(List* list, void (*elem_free)(void*)) {
-  ListNode* current = list->head;
-  while(current!=NULL) {
-    ListNode* next = current->succ;
-    if(elem_free) {
+  if(elem_free) {
+    ListNode* current = list->head;
+    while(current!=NULL) {
       elem_free(current->elem);
+      current = current->succ;
     }
-    Mem_free(current);
-    current = next;
+  }
+
+  ListNodeSlab* slab = list->slabs;
+  while(slab != NULL) {
+    ListNodeSlab* next = slab->next;
+    Mem_free(slab);
+    slab = next;
   }
 
   Mem_free(list);
@@ -174,6 +245,187 @@ ListNode* List_find(List* list, int (*elem_selector)(const void*)) {
   });
 }
 
+/* --------------------------
+ * Sorting and merging
+ * -------------------------- */
+
+// Size of the pending runs stack of List_sort: the run at level i results from
+// merging 2^i runs, so that no list can fill the stack.
+#define LIST_SORT_MAX_LEVELS 64
+
+// Merges two null terminated chains of nodes linked through the succ field (pred
+// fields are ignored and fixed later by List_link_chain). On equal elements the
+// nodes of a come first.
+static ListNode* List_merge_chains(ListNode* a, ListNode* b, KIBlkComparator compare) {
+  ListNode head;
+  ListNode* tail = &head;
+
+  while(a != NULL && b != NULL) {
+    if(compare(b->elem, a->elem) < 0) {
+      tail->succ = b;
+      tail = b;
+      b = b->succ;
+    } else {
+      tail->succ = a;
+      tail = a;
+      a = a->succ;
+    }
+  }
+
+  tail->succ = a != NULL ? a : b;
+  return head.succ;
+}
+
+// Detaches the sorted run starting at node and returns it as a null terminated
+// chain; *rest is set to the first node following the run. Strictly decreasing
+// runs are reversed (requiring strictness keeps the sort stable).
+static ListNode* List_next_run(ListNode* node, ListNode** rest, KIBlkComparator compare) {
+  ListNode* next = node->succ;
+
+  if(next != NULL && compare(next->elem, node->elem) < 0) {
+    ListNode* run = node;
+    run->succ = NULL;
+
+    while(next != NULL && compare(next->elem, run->elem) < 0) {
+      ListNode* following = next->succ;
+      next->succ = run;
+      run = next;
+      next = following;
+    }
+
+    *rest = next;
+    return run;
+  }
+
+  ListNode* last = node;
+  while(last->succ != NULL && compare(last->succ->elem, last->elem) >= 0) {
+    last = last->succ;
+  }
+
+  *rest = last->succ;
+  last->succ = NULL;
+  return node;
+}
+
+static int ListNode_is_inline(List* list, ListNode* node) {
+  return list != NULL &&
+    (uintptr_t) node >= (uintptr_t) &list->inline_nodes[0] &&
+    (uintptr_t) node < (uintptr_t) &list->inline_nodes[LIST_INLINE_NODES];
+}
+
+// Links the null terminated chain of nodes at the end of list fixing the pred
+// fields. Nodes stored inline into from_a or from_b cannot change list: their
+// elements are moved into nodes owned by list.
+static void List_link_chain(List* list, ListNode* chain, List* from_a, List* from_b) {
+  ListNode* pred = list->tail;
+
+  while(chain != NULL) {
+    ListNode* node = chain;
+    chain = chain->succ;
+
+    if(ListNode_is_inline(from_a, node) || ListNode_is_inline(from_b, node)) {
+      ListNode* new_node = ListNode_alloc(list);
+      new_node->elem = node->elem;
+      node = new_node;
+    }
+
+    node->pred = pred;
+    if(pred != NULL) {
+      pred->succ = node;
+    } else {
+      list->head = node;
+    }
+    pred = node;
+  }
+
+  if(pred != NULL) {
+    pred->succ = NULL;
+  }
+  list->tail = pred;
+}
+
+// Empties list moving its slabs to owner (if different from list). Free nodes
+// are dropped: they are reclaimed when owner is freed.
+static void List_give_nodes(List* owner, List* list) {
+  list->head = NULL;
+  list->tail = NULL;
+  list->size = 0;
+
+  if(owner == list) {
+    return;
+  }
+
+  if(list->slabs != NULL) {
+    ListNodeSlab* last = list->slabs;
+    while(last->next != NULL) {
+      last = last->next;
+    }
+
+    // owner keeps allocating from its current slab
+    if(owner->slabs == NULL) {
+      owner->slabs = list->slabs;
+    } else {
+      last->next = owner->slabs->next;
+      owner->slabs->next = list->slabs;
+    }
+  }
+
+  list->free_nodes = NULL;
+  list->slabs = NULL;
+  list->inline_used = 0;
+}
+
+// Bottom-up natural merge sort: runs are merged as soon as two runs resulting
+// from the same number of merges are pending (as in a binary counter), so that
+// merged runs have similar lengths.
+void List_sort(List* list, KIBlkComparator compare) {
+  if(list->size < 2) {
+    return;
+  }
+
+  ListNode* pending[LIST_SORT_MAX_LEVELS] = { NULL };
+  ListNode* rest = list->head;
+
+  while(rest != NULL) {
+    ListNode* run = List_next_run(rest, &rest, compare);
+
+    size_t level = 0;
+    while(level < LIST_SORT_MAX_LEVELS - 1 && pending[level] != NULL) {
+      run = List_merge_chains(pending[level], run, compare);
+      pending[level] = NULL;
+      level += 1;
+    }
+
+    pending[level] = pending[level] == NULL ? run : List_merge_chains(pending[level], run, compare);
+  }
+
+  // higher levels hold runs coming earlier in the list
+  ListNode* result = NULL;
+  for(size_t level = 0; level < LIST_SORT_MAX_LEVELS; ++level) {
+    if(pending[level] != NULL) {
+      result = List_merge_chains(pending[level], result, compare);
+    }
+  }
+
+  list->head = NULL;
+  list->tail = NULL;
+  List_link_chain(list, result, NULL, NULL);
+}
+
+void List_merge(List* dest, List* a, List* b, KIBlkComparator compare) {
+  if(a == b) {
+    Error_raise( Error_new( ERROR_GENERIC, "Trying to merge a list with itself" ) );
+  }
+
+  ListNode* chain = List_merge_chains(a->head, b->head, compare);
+  size_t size = a->size + b->size;
+
+  List_give_nodes(dest, a);
+  List_give_nodes(dest, b);
+  List_link_chain(dest, chain, a == dest ? NULL : a, b == dest ? NULL : b);
+  dest->size += size;
+}
+
 void* ListNode_get(UNUSED(List* list), ListNode* node) {
   return node->elem;
 }
@@ -200,11 +452,15 @@ void List_delete_node(List* list, ListNode* node) {
     node->pred->succ = node->succ;
   }
 
-  Mem_free(node);
+  ListNode_release(list, node);
 
   list->size -= 1;
 }
 
+// Released nodes are reused by the following insertions, there is nothing to pack
+void List_compact(UNUSED(List* list)) {
+}
+
 
 ListIterator* ListIterator_new(List* list) {
   if(list == NULL) {
@@ -285,6 +541,22 @@ static void ListIterator_free_obj(UNUSED(void* obj)) {
   return;
 }
 
+static size_t ListIterator_next_batch(ListIterator* it, void** out, size_t max) {
+  if(it == NULL) {
+    return 0;
+  }
+
+  size_t count = 0;
+  ListNode* node = it->current;
+  while(count < max && node != NULL) {
+    out[count++] = node->elem;
+    node = node->succ;
+  }
+  it->current = node;
+
+  return count;
+}
+
 Iterator List_it(List* list) {
   Iterator iterator = Iterator_make(
     list,
@@ -312,5 +584,9 @@ Iterator List_it(List* list) {
     (void (*)(void*)) ListIterator_free_obj
   );
 
+  iterator = BatchIterator_make(iterator,
+    (size_t (*)(void*, void**, size_t)) ListIterator_next_batch
+  );
+
   return iterator;
 }
@@ -3,7 +3,8 @@
 #include "list.h"
 #include "errors.h"
 #include <assert.h>
-#include "array.h"
+#include "deque.h"
+#include "merge_sort.h"
 
 #include "mem.h"
 #include "macros.h"
@@ -13,19 +14,21 @@
 // This definition only serves for silencing the compiler. The definition
 // will not actually being used since the long ints will be used instead of ListNode pointers.
 //
-// In particular the ListNode for element at index n in the array will be defined to be the n+1
+// In particular the ListNode for element at index n in the deque will be defined to be the n+1
 // long int cast to ListNode*. In this way the value 0 is compatible with the NULL value used
 // to check if the ListNode is valid.
 struct _ListNode {
   int _;
 };
 
+// Elements are stored in a Deque so that both List_insert (front) and List_append (back)
+// are O(1) amortized operations.
 struct _List {
-  Array* array;
+  Deque* deque;
 };
 
 struct _ListIterator {
-  ArrayIterator* it;
+  DequeIterator* it;
 };
 
 
@@ -37,33 +40,33 @@ List* List_new() {
   assert(sizeof(size_t) == sizeof(ListNode*));
 
   List* result = Mem_alloc(sizeof(struct _List));
-  result->array = Array_new(10);
+  result->deque = Deque_new(16);
   return result;
 }
 
 
 void* List_get_head(List* list) {
-  return Array_at(list->array, 0);
+  return Deque_at(list->deque, 0);
 }
 
 size_t List_size(List* list) {
-  return Array_size(list->array);
+  return Deque_size(list->deque);
 }
 
 int List_empty(List* list) {
-  return Array_empty(list->array);
+  return Deque_empty(list->deque);
 }
 
 void List_insert(List* list, void* elem) {
-  Array_insert(list->array, 0, elem);
+  Deque_push_front(list->deque, elem);
 }
 
 void List_append(List* list, void* elem) {
-  Array_add(list->array, elem);
+  Deque_push_back(list->deque, elem);
 }
 
 ListNode* List_head(List* list) {
-  if(Array_size(list->array) == 0) {
+  if(Deque_size(list->deque) == 0) {
     return (ListNode*) 0;
   }
 
@@ -71,19 +74,19 @@ ListNode* List_head(List* list) {
 }
 
 ListNode* List_tail(List* list) {
-  size_t result = Array_size(list->array);
+  size_t result = Deque_size(list->deque);
   return (ListNode*) result;
 }
 
 
 void ListNode_set(List* list, ListNode* node, void* elem) {
   size_t index = (size_t)node - 1;
-  Array_set(list->array, index, elem);
+  Deque_set(list->deque, index, elem);
 }
 
 ListNode *List_next(List* list, ListNode * node) {
   size_t index = (size_t) node - 1;
-  if( index + 1 >= Array_size(list->array)  ) {
+  if( index + 1 >= Deque_size(list->deque)  ) {
     return NULL;
   }
 
@@ -100,18 +103,18 @@ ListNode *List_prev(UNUSED(List* list), ListNode * node) {
 
 void List_free(List* list, void (*elem_free)(void*)) {
   if(elem_free != NULL) {
-    for_each( Array_it(list->array), ^(void* elem) {
+    for_each( Deque_it(list->deque), ^(void* elem) {
       elem_free(elem);
     });
   }
 
-  Array_free(list->array);
+  Deque_free(list->deque);
   Mem_free(list);
 }
 
 ListNode* List_find_wb(List* list,  int (^elem_selector)(const void*)) {
   __block size_t index = 0;
-  void* result = find_first(Array_it(list->array), ^(void* elem) {
+  void* result = find_first(Deque_it(list->deque), ^(void* elem) {
     index += 1;
     return elem_selector(elem) == 0;
   });
@@ -127,15 +130,70 @@ ListNode* List_find(List* list, int (*elem_selector)(const void*)) {
   });
 }
 
+void List_sort(List* list, KIBlkComparator compare) {
+  size_t count = Deque_size(list->deque);
+  if(count < 2) {
+    return;
+  }
+
+  void** elems = (void**) Mem_alloc(sizeof(void*) * count);
+  Deque_pop_front_many(list->deque, elems, count);
+  merge_sort_wb(elems, count, compare);
+  Deque_push_back_many(list->deque, elems, count);
+
+  Mem_free(elems);
+}
+
+void List_merge(List* dest, List* a, List* b, KIBlkComparator compare) {
+  if(a == b) {
+    Error_raise( Error_new( ERROR_GENERIC, "Trying to merge a list with itself" ) );
+  }
+
+  size_t a_count = Deque_size(a->deque);
+  size_t b_count = Deque_size(b->deque);
+
+  // elements of a and b are moved into the first half of the buffer and merged into the second
+  void** elems = (void**) Mem_alloc(sizeof(void*) * (2 * (a_count + b_count) + 1));
+  void** a_elems = elems;
+  void** b_elems = elems + a_count;
+  void** result = elems + a_count + b_count;
+  Deque_pop_front_many(a->deque, a_elems, a_count);
+  Deque_pop_front_many(b->deque, b_elems, b_count);
+
+  size_t i = 0, j = 0, k = 0;
+  while(i < a_count && j < b_count) {
+    if(compare(b_elems[j], a_elems[i]) < 0) {
+      result[k++] = b_elems[j++];
+    } else {
+      result[k++] = a_elems[i++];
+    }
+  }
+
+  while(i < a_count) {
+    result[k++] = a_elems[i++];
+  }
+
+  while(j < b_count) {
+    result[k++] = b_elems[j++];
+  }
+
+  Deque_push_back_many(dest->deque, result, k);
+  Mem_free(elems);
+}
+
 void* ListNode_get(List* list, ListNode* node) {
   size_t index = (size_t) node - 1;
-  return Array_at(list->array, index);
+  return Deque_at(list->deque, index);
 }
 
 
 void List_delete_node(List* list, ListNode* node) {
   size_t index = (size_t) node - 1;
-  Array_remove(list->array, index);
+  Deque_remove(list->deque, index);
+}
+
+// The deque already stores the elements contiguously
+void List_compact(UNUSED(List* list)) {
 }
 
 
@@ -144,57 +202,57 @@ ListIterator* ListIterator_new(List* list) {
     return NULL;
   }
 
-  ListIterator* it = Mem_alloc(sizeof(ListIterator));
-  it->it = ArrayIterator_new(list->array);
+  ListIterator* it = Mem_alloc(sizeof(struct _ListIterator));
+  it->it = DequeIterator_new(list->deque);
   return it;
 }
 
 ListIterator* ListIterator_new_from_node(List* list, ListNode* node) {
   ListIterator* it = ListIterator_new(list);
-  ArrayIterator_move_to(it->it, (size_t) node - 1);
+  DequeIterator_move_to(it->it, (size_t) node - 1);
   return it;
 }
 
 void ListIterator_free(ListIterator* it) {
   if(it!=NULL) {
-    ArrayIterator_free(it->it);
+    DequeIterator_free(it->it);
     Mem_free(it);
   }
 }
 
 void* ListIterator_get(ListIterator* it) {
-  return ArrayIterator_get(it->it);
+  return DequeIterator_get(it->it);
 }
 
 void ListIterator_next(ListIterator* it) {
-  ArrayIterator_next(it->it);
+  DequeIterator_next(it->it);
 }
 
 void ListIterator_prev(ListIterator* it) {
-  ArrayIterator_prev(it->it);
+  DequeIterator_prev(it->it);
 }
 
 void ListIterator_to_begin(ListIterator *it) { 
-  ArrayIterator_to_begin(it->it); 
+  DequeIterator_to_begin(it->it); 
 }
 
 void ListIterator_to_end(ListIterator* it) {
-  ArrayIterator_to_end(it->it);
+  DequeIterator_to_end(it->it);
 }
 
 int ListIterator_end(ListIterator* it) {
   if(it == NULL) {
     return 1;
   }
-  return ArrayIterator_end(it->it);
+  return DequeIterator_end(it->it);
 }
 
 int ListIterator_same(ListIterator* it1, ListIterator* it2) {
-  return ArrayIterator_same(it1->it, it2->it);
+  return DequeIterator_same(it1->it, it2->it);
 }
 
 void ListIterator_set(ListIterator* it, void* obj) {
-  ArrayIterator_set(it->it, obj);
+  DequeIterator_set(it->it, obj);
 }
 
 static void* ListIterator_alloc_obj(ListIterator* UNUSED(it)) {
@@ -209,6 +267,14 @@ static void ListIterator_free_obj(UNUSED(void* obj)) {
   return;
 }
 
+static size_t ListIterator_next_span(ListIterator* it, ArrayView* span) {
+  if(it == NULL) {
+    return 0;
+  }
+
+  return DequeIterator_next_span(it->it, span);
+}
+
 Iterator List_it(List* list) {
   Iterator iterator = Iterator_make(
     list,
@@ -216,13 +282,13 @@ Iterator List_it(List* list) {
     (void (*)(void*))  ListIterator_next,
     (void* (*)(void*)) ListIterator_get,
     (int (*)(void*))   ListIterator_end,
+    (void (*)(void*))  ListIterator_to_begin,
     (int (*)(void*, void*)) ListIterator_same,
     (void (*)(void*))  ListIterator_free
   );
 
   iterator = BidirectionalIterator_make(iterator,
     (void  (*)(void*)) ListIterator_prev,
-    (void  (*)(void*)) ListIterator_to_begin,
     (void  (*)(void*)) ListIterator_to_end
   );
 
@@ -236,5 +302,9 @@ Iterator List_it(List* list) {
     (void (*)(void*)) ListIterator_free_obj
   );
 
+  iterator = SpanIterator_make(iterator,
+    (size_t (*)(void*, ArrayView*)) ListIterator_next_span
+  );
+
   return iterator;
 }
@@ -0,0 +1,536 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "keys.h"
+#include "list.h"
+#include "errors.h"
+#include <assert.h>
+
+#include "mem.h"
+#include "macros.h"
+#include "merge_sort.h"
+
+// Number of elements stored in each chunk of the list (at most 64, the number of
+// bits in ListChunk.occupied).
+#define LIST_CHUNK_CAPACITY 32
+
+struct _ListChunk;
+
+// Each slot of a chunk records the chunk it belongs to, so that ListNode pointers
+// (pointers to slots) can be used to navigate the list.
+struct _ListNode {
+  void* elem;
+  struct _ListChunk* chunk;
+};
+
+// Unrolled linked list: elements are stored in a doubly linked list of chunks, each
+// holding up to LIST_CHUNK_CAPACITY elements. Iterating the list visits contiguous
+// memory and costs one pointer chase every LIST_CHUNK_CAPACITY elements.
+//
+// Deleted elements leave a hole in their chunk (the occupied bit mask tells which slots
+// hold an element), holes at the two ends of the first and last chunks are reused by
+// List_insert and List_append respectively. Elements never move, so ListNode pointers stay
+// valid until their element is deleted: a chunk is released only when it becomes empty.
+// List_compact packs the elements into as few chunks as possible, it is the only operation
+// invalidating ListNode pointers.
+//
+// The last released chunk is kept as a spare one, so that alternating insertions and
+// deletions at a chunk boundary do not allocate memory.
+typedef struct _ListChunk {
+  struct _ListChunk* pred;
+  struct _ListChunk* succ;
+  // bit i is set iff nodes[i] holds an element
+  uint64_t occupied;
+  struct _ListNode nodes[LIST_CHUNK_CAPACITY];
+} ListChunk;
+
+struct _List {
+  ListChunk* head;
+  ListChunk* tail;
+  ListChunk* spare;
+  size_t size;
+};
+
+struct _ListIterator {
+  List* list;
+  ListNode* current;
+};
+
+
+/* --------------------------
+ * ListChunk implementation
+ * -------------------------- */
+
+static ListChunk* ListChunk_new(List* list) {
+  ListChunk* chunk = list->spare;
+  if(chunk != NULL) {
+    list->spare = NULL;
+  } else {
+    chunk = (ListChunk*) Mem_alloc(sizeof(ListChunk));
+  }
+
+  chunk->pred = NULL;
+  chunk->succ = NULL;
+  chunk->occupied = 0;
+
+  return chunk;
+}
+
+// Index of the first occupied slot in the given (non empty) mask
+static size_t ListChunk_first_index(uint64_t mask) {
+  return (size_t) __builtin_ctzll(mask);
+}
+
+// Index of the last occupied slot in the given (non empty) mask
+static size_t ListChunk_last_index(uint64_t mask) {
+  return 63 - (size_t) __builtin_clzll(mask);
+}
+
+static ListNode* ListChunk_store(ListChunk* chunk, size_t index, void* elem) {
+  chunk->occupied |= (uint64_t) 1 << index;
+  chunk->nodes[index].elem = elem;
+  chunk->nodes[index].chunk = chunk;
+
+  return &chunk->nodes[index];
+}
+
+static size_t ListNode_index(ListNode* node) {
+  return (size_t) (node - node->chunk->nodes);
+}
+
+/* --------------------------
+ * List* implementation
+ * -------------------------- */
+
+List* List_new() {
+  List* result = (List*) Mem_alloc(sizeof(struct _List));
+  result->head = NULL;
+  result->tail = NULL;
+  result->spare = NULL;
+  result->size = 0l;
+
+  return result;
+}
+
+
+void* List_get_head(List* list) {
+  return List_head(list)->elem;
+}
+
+size_t List_size(List* list) {
+  return list->size;
+}
+
+int List_empty(List* list) {
+  return list->size == 0;
+}
+
+void List_insert(List* list, void* elem) {
+  ListChunk* chunk = list->head;
+
+  if(chunk != NULL && ListChunk_first_index(chunk->occupied) > 0) {
+    ListChunk_store(chunk, ListChunk_first_index(chunk->occupied) - 1, elem);
+  } else {
+    // new chunks are filled from the end, so that further insertions fit in
+    ListChunk* new_chunk = ListChunk_new(list);
+    new_chunk->succ = chunk;
+    if(chunk != NULL) {
+      chunk->pred = new_chunk;
+    } else {
+      list->tail = new_chunk;
+    }
+    list->head = new_chunk;
+
+    ListChunk_store(new_chunk, LIST_CHUNK_CAPACITY - 1, elem);
+  }
+
+  list->size += 1;
+}
+
+void List_append(List* list, void* elem) {
+  ListChunk* chunk = list->tail;
+
+  if(chunk != NULL && ListChunk_last_index(chunk->occupied) + 1 < LIST_CHUNK_CAPACITY) {
+    ListChunk_store(chunk, ListChunk_last_index(chunk->occupied) + 1, elem);
+  } else {
+    ListChunk* new_chunk = ListChunk_new(list);
+    new_chunk->pred = chunk;
+    if(chunk != NULL) {
+      chunk->succ = new_chunk;
+    } else {
+      list->head = new_chunk;
+    }
+    list->tail = new_chunk;
+
+    ListChunk_store(new_chunk, 0, elem);
+  }
+
+  list->size += 1;
+}
+
+ListNode* List_head(List* list) {
+  if(list->head == NULL) {
+    return NULL;
+  }
+
+  return &list->head->nodes[ListChunk_first_index(list->head->occupied)];
+}
+
+ListNode* List_tail(List* list) {
+  if(list->tail == NULL) {
+    return NULL;
+  }
+
+  return &list->tail->nodes[ListChunk_last_index(list->tail->occupied)];
+}
+
+void ListNode_set(UNUSED(List* list), ListNode* node, void* elem) {
+  node->elem = elem;
+}
+
+ListNode *List_next(UNUSED(List* list), ListNode * node) {
+  ListChunk* chunk = node->chunk;
+  // slots following the node one
+  uint64_t mask = chunk->occupied & (((uint64_t) -1 << ListNode_index(node)) << 1);
+
+  if(mask != 0) {
+    return &chunk->nodes[ListChunk_first_index(mask)];
+  }
+
+  if(chunk->succ == NULL) {
+    return NULL;
+  }
+
+  return &chunk->succ->nodes[ListChunk_first_index(chunk->succ->occupied)];
+}
+
+ListNode *List_prev(UNUSED(List* list), ListNode * node) {
+  ListChunk* chunk = node->chunk;
+  // slots preceding the node one
+  uint64_t mask = chunk->occupied & (((uint64_t) 1 << ListNode_index(node)) - 1);
+
+  if(mask != 0) {
+    return &chunk->nodes[ListChunk_last_index(mask)];
+  }
+
+  if(chunk->pred == NULL) {
+    return NULL;
+  }
+
+  return &chunk->pred->nodes[ListChunk_last_index(chunk->pred->occupied)];
+}
+
+void List_free(List* list, void (*elem_free)(void*)) {
+  ListChunk* chunk = list->head;
+  while(chunk != NULL) {
+    ListChunk* next = chunk->succ;
+    if(elem_free) {
+      uint64_t mask = chunk->occupied;
+      while(mask != 0) {
+        elem_free(chunk->nodes[ListChunk_first_index(mask)].elem);
+        mask &= mask - 1;
+      }
+    }
+    Mem_free(chunk);
+    chunk = next;
+  }
+
+  if(list->spare != NULL) {
+    Mem_free(list->spare);
+  }
+
+  Mem_free(list);
+}
+
+ListNode *List_find_wb(List *list, int (^elem_selector)(const void *)) {
+  for(ListChunk* chunk = list->head; chunk != NULL; chunk = chunk->succ) {
+    uint64_t mask = chunk->occupied;
+    while(mask != 0) {
+      ListNode* node = &chunk->nodes[ListChunk_first_index(mask)];
+      if(elem_selector(node->elem) == 0) {
+        return node;
+      }
+      mask &= mask - 1;
+    }
+  }
+
+  return NULL;
+}
+
+ListNode* List_find(List* list, int (*elem_selector)(const void*)) {
+  return List_find_wb(list, ^int(const void* elem) {
+      return elem_selector(elem);
+  });
+}
+
+// Elements are sorted into an array and then stored back in list order: ListNode
+// pointers keep their positions (and not their elements).
+void List_sort(List* list, KIBlkComparator compare) {
+  if(list->size < 2) {
+    return;
+  }
+
+  void** elems = (void**) Mem_alloc(sizeof(void*) * list->size);
+  size_t count = 0;
+  for(ListNode* node = List_head(list); node != NULL; node = List_next(list, node)) {
+    elems[count++] = node->elem;
+  }
+
+  merge_sort_wb(elems, count, compare);
+
+  count = 0;
+  for(ListNode* node = List_head(list); node != NULL; node = List_next(list, node)) {
+    node->elem = elems[count++];
+  }
+
+  Mem_free(elems);
+}
+
+// Frees all chunks leaving list empty
+static void List_clear(List* list) {
+  ListChunk* chunk = list->head;
+  while(chunk != NULL) {
+    ListChunk* next = chunk->succ;
+    Mem_free(chunk);
+    chunk = next;
+  }
+
+  list->head = NULL;
+  list->tail = NULL;
+  list->size = 0;
+}
+
+void List_merge(List* dest, List* a, List* b, KIBlkComparator compare) {
+  if(a == b) {
+    Error_raise( Error_new( ERROR_GENERIC, "Trying to merge a list with itself" ) );
+  }
+
+  size_t count = a->size + b->size;
+  void** elems = (void**) Mem_alloc(sizeof(void*) * (count + 1));
+  size_t k = 0;
+  ListNode* a_node = List_head(a);
+  ListNode* b_node = List_head(b);
+
+  while(a_node != NULL && b_node != NULL) {
+    if(compare(b_node->elem, a_node->elem) < 0) {
+      elems[k++] = b_node->elem;
+      b_node = List_next(b, b_node);
+    } else {
+      elems[k++] = a_node->elem;
+      a_node = List_next(a, a_node);
+    }
+  }
+
+  for(; a_node != NULL; a_node = List_next(a, a_node)) {
+    elems[k++] = a_node->elem;
+  }
+
+  for(; b_node != NULL; b_node = List_next(b, b_node)) {
+    elems[k++] = b_node->elem;
+  }
+
+  List_clear(a);
+  List_clear(b);
+
+  for(k = 0; k < count; ++k) {
+    List_append(dest, elems[k]);
+  }
+
+  Mem_free(elems);
+}
+
+void* ListNode_get(UNUSED(List* list), ListNode* node) {
+  return node->elem;
+}
+
+
+// Unlinks the given chunk from the list, keeping it as the spare chunk if there is none
+static void List_release_chunk(List* list, ListChunk* chunk) {
+  if(chunk->pred != NULL) {
+    chunk->pred->succ = chunk->succ;
+  } else {
+    list->head = chunk->succ;
+  }
+
+  if(chunk->succ != NULL) {
+    chunk->succ->pred = chunk->pred;
+  } else {
+    list->tail = chunk->pred;
+  }
+
+  if(list->spare == NULL) {
+    list->spare = chunk;
+  } else {
+    Mem_free(chunk);
+  }
+}
+
+void List_delete_node(List* list, ListNode* node) {
+  if(list->size == 0) {
+    Error_raise( Error_new( ERROR_GENERIC, "Trying to delete from an empty list" ) );
+  }
+
+  ListChunk* chunk = node->chunk;
+  size_t index = ListNode_index(node);
+  chunk->occupied &= ~((uint64_t) 1 << index);
+  list->size -= 1;
+
+  if(chunk->occupied == 0) {
+    List_release_chunk(list, chunk);
+  }
+}
+
+// Moves each element to the first free slot (in list order) starting from the first slot of
+// the head chunk. An element never moves after its current slot, so the elements are moved in
+// place visiting them in order.
+void List_compact(List* list) {
+  if(list->size == 0) {
+    return;
+  }
+
+  ListChunk* target = list->head;
+  size_t target_index = 0;
+  for(ListChunk* chunk = list->head; chunk != NULL; chunk = chunk->succ) {
+    uint64_t mask = chunk->occupied;
+    while(mask != 0) {
+      if(target_index == LIST_CHUNK_CAPACITY) {
+        target->occupied = ((uint64_t) 1 << LIST_CHUNK_CAPACITY) - 1;
+        target = target->succ;
+        target_index = 0;
+      }
+
+      target->nodes[target_index].elem = chunk->nodes[ListChunk_first_index(mask)].elem;
+      target->nodes[target_index].chunk = target;
+      target_index += 1;
+      mask &= mask - 1;
+    }
+  }
+
+  target->occupied = ((uint64_t) 1 << target_index) - 1;
+  while(target->succ != NULL) {
+    List_release_chunk(list, target->succ);
+  }
+}
+
+
+ListIterator* ListIterator_new(List* list) {
+  if(list == NULL) {
+    return NULL;
+  }
+
+  ListIterator* result = (ListIterator*) Mem_alloc(sizeof(struct _ListIterator));
+  result->list = list;
+  result->current = List_head(list);
+  return result;
+}
+
+ListIterator* ListIterator_new_from_node(List* list, ListNode* node) {
+  if(node == NULL) {
+    return NULL;
+  }
+
+  ListIterator* result = (ListIterator*) Mem_alloc(sizeof(struct _ListIterator));
+  result->list = list;
+  result->current = node;
+  return result;
+}
+
+void ListIterator_free(ListIterator* it) {
+  if(it!=NULL) {
+    Mem_free(it);
+  }
+}
+
+void* ListIterator_get(ListIterator* it) {
+  return it->current->elem;
+}
+
+void ListIterator_next(ListIterator* it) {
+  it->current = List_next(it->list, it->current);
+}
+
+void ListIterator_prev(ListIterator* it) {
+  it->current = List_prev(it->list, it->current);
+}
+
+void ListIterator_to_begin(ListIterator* it) {
+  it->current = List_head(it->list);
+}
+
+void ListIterator_to_end(ListIterator *it) {
+  it->current = List_tail(it->list);
+}
+
+int ListIterator_end(ListIterator* it) {
+  return it==NULL || it->current == NULL;
+}
+
+int ListIterator_same(ListIterator* it1, ListIterator* it2) {
+  return  it1->current == it2->current &&
+          it1->list == it2->list;
+}
+
+void ListIterator_set(ListIterator* it, void* obj) {
+  it->current->elem = obj;
+}
+
+static void* ListIterator_alloc_obj(ListIterator* UNUSED(it)) {
+  return NULL;
+}
+
+static void* ListIterator_copy_obj(ListIterator* it, void* UNUSED(to_mem)) {
+  return ListIterator_get(it);
+}
+
+static void ListIterator_free_obj(UNUSED(void* obj)) {
+  return;
+}
+
+static size_t ListIterator_next_batch(ListIterator* it, void** out, size_t max) {
+  if(it == NULL) {
+    return 0;
+  }
+
+  size_t count = 0;
+  ListNode* node = it->current;
+  while(count < max && node != NULL) {
+    out[count++] = node->elem;
+    node = List_next(it->list, node);
+  }
+  it->current = node;
+
+  return count;
+}
+
+Iterator List_it(List* list) {
+  Iterator iterator = Iterator_make(
+    list,
+    (void* (*)(void*)) ListIterator_new,
+    (void (*)(void*))  ListIterator_next,
+    (void* (*)(void*)) ListIterator_get,
+    (int (*)(void*))   ListIterator_end,
+    (void  (*)(void*)) ListIterator_to_begin,
+    (int (*)(void*, void*)) ListIterator_same,
+    (void (*)(void*))  ListIterator_free
+  );
+
+  iterator = BidirectionalIterator_make(iterator,
+    (void  (*)(void*)) ListIterator_prev,
+    (void  (*)(void*)) ListIterator_to_end
+  );
+
+  iterator = MutableIterator_make(iterator,
+    (void (*)(void*, void*)) ListIterator_set
+  );
+
+  iterator = CloningIterator_make(iterator,
+    (void*(*)(void*)) ListIterator_alloc_obj,
+    (void* (*)(void*, void*)) ListIterator_copy_obj,
+    (void (*)(void*)) ListIterator_free_obj
+  );
+
+  iterator = BatchIterator_make(iterator,
+    (size_t (*)(void*, void**, size_t)) ListIterator_next_batch
+  );
+
+  return iterator;
+}
@@ -4,7 +4,7 @@
 
 #include "mem.h"
 
-static void merge(void** array, size_t start, size_t mid, size_t end, KIComparator compare) {
+static void merge(void** array, size_t start, size_t mid, size_t end, KIBlkComparator compare) {
   void** buf = (void**) Mem_alloc(sizeof(const void*)*(end-start+1));
   size_t i = start;
   size_t j = mid+1;
@@ -64,7 +64,7 @@ static void merge_g(void* array, size_t start, size_t mid, size_t end, size_t si
   Mem_free(buf);
 }
 
-static void merge_sort_(void** array, size_t start, size_t end, KIComparator compare) {
+static void merge_sort_(void** array, size_t start, size_t end, KIBlkComparator compare) {
   if(start >= end)
     return;
 
@@ -94,9 +94,15 @@ void merge_sort_g(void* array, size_t count, size_t size, KIComparator compare)
   merge_sort_g_(array, 0, count-1, size, compare);
 }
 
-void merge_sort(void** array, size_t count, KIComparator compare) {
+void merge_sort_wb(void** array, size_t count, KIBlkComparator compare) {
   if(count == 0) {
     return;
   }
   merge_sort_(array, 0, count-1, compare);
 }
+
+void merge_sort(void** array, size_t count, KIComparator fun) {
+  merge_sort_wb(array, count, ^(const void* lhs, const void* rhs) {
+    return fun(lhs, rhs);
+  });
+}
@@ -0,0 +1,663 @@
+#include "numeric_reductions.h"
+
+#include "array_view.h"
+#include "errors.h"
+
+// The kernels are selected at compile time: AVX2 (e.g., -mavx2), SSE2 (always available on
+// x86-64) or scalar loops. Prefix sums use SSE2 in both SIMD cases, since the shifts across
+// 128-bit lanes they need are not available in AVX2. All loads and stores are unaligned.
+#if !defined(NUMERIC_REDUCTIONS_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define NUMERIC_AVX2
+#elif !defined(NUMERIC_REDUCTIONS_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define NUMERIC_SSE2
+#endif
+
+// Integer sums wrap around on overflow instead of being undefined
+static int64_t numeric_add_int64(int64_t lhs, int64_t rhs) {
+  return (int64_t) ((uint64_t) lhs + (uint64_t) rhs);
+}
+
+static double numeric_add_double(double lhs, double rhs) {
+  return lhs + rhs;
+}
+
+// int32_t kernels
+
+int64_t sum_int32(const int32_t* values, size_t n) {
+  size_t i = 0;
+  int64_t result = 0;
+
+#if defined(NUMERIC_AVX2)
+  __m256i acc = _mm256_setzero_si256();
+  for(; i + 8 <= n; i += 8) {
+    acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i_u*) (values + i))));
+    acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i_u*) (values + i + 4))));
+  }
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i_u*) lanes, acc);
+  for(size_t k = 0; k < 4; ++k) {
+    result = numeric_add_int64(result, lanes[k]);
+  }
+#elif defined(NUMERIC_SSE2)
+  // sign extension to 64 bits: each value is interleaved with its sign bits
+  __m128i acc = _mm_setzero_si128();
+  for(; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128((const __m128i_u*) (values + i));
+    __m128i sign = _mm_srai_epi32(v, 31);
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+    acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+  }
+  int64_t lanes[2];
+  _mm_storeu_si128((__m128i_u*) lanes, acc);
+  result = numeric_add_int64(lanes[0], lanes[1]);
+#endif
+
+  for(; i < n; ++i) {
+    result = numeric_add_int64(result, values[i]);
+  }
+
+  return result;
+}
+
+static void extremes_int32(const int32_t* values, size_t n, int32_t* min, int32_t* max) {
+  if(n == 0) {
+    Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot compute the minimum or maximum of no values"));
+  }
+
+  size_t i = 0;
+  int32_t lo = values[0];
+  int32_t hi = values[0];
+
+#if defined(NUMERIC_AVX2)
+  __m256i lo_acc = _mm256_set1_epi32(values[0]);
+  __m256i hi_acc = lo_acc;
+  for(; i + 8 <= n; i += 8) {
+    __m256i v = _mm256_loadu_si256((const __m256i_u*) (values + i));
+    lo_acc = _mm256_min_epi32(lo_acc, v);
+    hi_acc = _mm256_max_epi32(hi_acc, v);
+  }
+  int32_t lo_lanes[8];
+  int32_t hi_lanes[8];
+  _mm256_storeu_si256((__m256i_u*) lo_lanes, lo_acc);
+  _mm256_storeu_si256((__m256i_u*) hi_lanes, hi_acc);
+  for(size_t k = 0; k < 8; ++k) {
+    lo = lo_lanes[k] < lo ? lo_lanes[k] : lo;
+    hi = hi_lanes[k] > hi ? hi_lanes[k] : hi;
+  }
+#elif defined(NUMERIC_SSE2)
+  // SSE2 has no 32-bit min and max: they are emulated by selecting through comparison masks
+  __m128i lo_acc = _mm_set1_epi32(values[0]);
+  __m128i hi_acc = lo_acc;
+  for(; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128((const __m128i_u*) (values + i));
+    __m128i lo_mask = _mm_cmplt_epi32(v, lo_acc);
+    __m128i hi_mask = _mm_cmpgt_epi32(v, hi_acc);
+    lo_acc = _mm_or_si128(_mm_and_si128(lo_mask, v), _mm_andnot_si128(lo_mask, lo_acc));
+    hi_acc = _mm_or_si128(_mm_and_si128(hi_mask, v), _mm_andnot_si128(hi_mask, hi_acc));
+  }
+  int32_t lo_lanes[4];
+  int32_t hi_lanes[4];
+  _mm_storeu_si128((__m128i_u*) lo_lanes, lo_acc);
+  _mm_storeu_si128((__m128i_u*) hi_lanes, hi_acc);
+  for(size_t k = 0; k < 4; ++k) {
+    lo = lo_lanes[k] < lo ? lo_lanes[k] : lo;
+    hi = hi_lanes[k] > hi ? hi_lanes[k] : hi;
+  }
+#endif
+
+  for(; i < n; ++i) {
+    lo = values[i] < lo ? values[i] : lo;
+    hi = values[i] > hi ? values[i] : hi;
+  }
+
+  *min = lo;
+  *max = hi;
+}
+
+static void prefix_sum_from_int32(const int32_t* values, int32_t* result, size_t n, int32_t initial) {
+  size_t i = 0;
+  uint32_t running = (uint32_t) initial;
+
+#if defined(NUMERIC_AVX2) || defined(NUMERIC_SSE2)
+  // log-step scan of 4 values, then the running total (broadcast in carry) is added
+  __m128i carry = _mm_set1_epi32(initial);
+  for(; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i_u*) (values + i));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi32(x, carry);
+    _mm_storeu_si128((__m128i_u*) (result + i), x);
+    carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+  if(i > 0) {
+    running = (uint32_t) result[i - 1];
+  }
+#endif
+
+  for(; i < n; ++i) {
+    running += (uint32_t) values[i];
+    result[i] = (int32_t) running;
+  }
+}
+
+// int64_t kernels
+
+int64_t sum_int64(const int64_t* values, size_t n) {
+  size_t i = 0;
+  int64_t result = 0;
+
+#if defined(NUMERIC_AVX2)
+  __m256i acc0 = _mm256_setzero_si256();
+  __m256i acc1 = _mm256_setzero_si256();
+  for(; i + 8 <= n; i += 8) {
+    acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256((const __m256i_u*) (values + i)));
+    acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256((const __m256i_u*) (values + i + 4)));
+  }
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i_u*) lanes, _mm256_add_epi64(acc0, acc1));
+  for(size_t k = 0; k < 4; ++k) {
+    result = numeric_add_int64(result, lanes[k]);
+  }
+#elif defined(NUMERIC_SSE2)
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  for(; i + 4 <= n; i += 4) {
+    acc0 = _mm_add_epi64(acc0, _mm_loadu_si128((const __m128i_u*) (values + i)));
+    acc1 = _mm_add_epi64(acc1, _mm_loadu_si128((const __m128i_u*) (values + i + 2)));
+  }
+  int64_t lanes[2];
+  _mm_storeu_si128((__m128i_u*) lanes, _mm_add_epi64(acc0, acc1));
+  result = numeric_add_int64(lanes[0], lanes[1]);
+#endif
+
+  for(; i < n; ++i) {
+    result = numeric_add_int64(result, values[i]);
+  }
+
+  return result;
+}
+
+// SSE2 lacks 64-bit comparisons: the scalar loop is used unless AVX2 is available
+static void extremes_int64(const int64_t* values, size_t n, int64_t* min, int64_t* max) {
+  if(n == 0) {
+    Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot compute the minimum or maximum of no values"));
+  }
+
+  size_t i = 0;
+  int64_t lo = values[0];
+  int64_t hi = values[0];
+
+#if defined(NUMERIC_AVX2)
+  __m256i lo_acc = _mm256_set1_epi64x(values[0]);
+  __m256i hi_acc = lo_acc;
+  for(; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i_u*) (values + i));
+    lo_acc = _mm256_blendv_epi8(lo_acc, v, _mm256_cmpgt_epi64(lo_acc, v));
+    hi_acc = _mm256_blendv_epi8(hi_acc, v, _mm256_cmpgt_epi64(v, hi_acc));
+  }
+  int64_t lo_lanes[4];
+  int64_t hi_lanes[4];
+  _mm256_storeu_si256((__m256i_u*) lo_lanes, lo_acc);
+  _mm256_storeu_si256((__m256i_u*) hi_lanes, hi_acc);
+  for(size_t k = 0; k < 4; ++k) {
+    lo = lo_lanes[k] < lo ? lo_lanes[k] : lo;
+    hi = hi_lanes[k] > hi ? hi_lanes[k] : hi;
+  }
+#endif
+
+  for(; i < n; ++i) {
+    lo = values[i] < lo ? values[i] : lo;
+    hi = values[i] > hi ? values[i] : hi;
+  }
+
+  *min = lo;
+  *max = hi;
+}
+
+static void prefix_sum_from_int64(const int64_t* values, int64_t* result, size_t n, int64_t initial) {
+  size_t i = 0;
+  uint64_t running = (uint64_t) initial;
+
+#if defined(NUMERIC_AVX2) || defined(NUMERIC_SSE2)
+  __m128i carry = _mm_set1_epi64x(initial);
+  for(; i + 2 <= n; i += 2) {
+    __m128i x = _mm_loadu_si128((const __m128i_u*) (values + i));
+    x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi64(x, carry);
+    _mm_storeu_si128((__m128i_u*) (result + i), x);
+    carry = _mm_unpackhi_epi64(x, x);
+  }
+  if(i > 0) {
+    running = (uint64_t) result[i - 1];
+  }
+#endif
+
+  for(; i < n; ++i) {
+    running += (uint64_t) values[i];
+    result[i] = (int64_t) running;
+  }
+}
+
+// float kernels
+
+double sum_float(const float* values, size_t n) {
+  size_t i = 0;
+  double result = 0;
+
+  // values are converted to double before being added, as the scalar loop does
+#if defined(NUMERIC_AVX2)
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  for(; i + 8 <= n; i += 8) {
+    acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm_loadu_ps(values + i)));
+    acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm_loadu_ps(values + i + 4)));
+  }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+  result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(NUMERIC_SSE2)
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  for(; i + 4 <= n; i += 4) {
+    __m128 v = _mm_loadu_ps(values + i);
+    acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(v));
+    acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+  result = lanes[0] + lanes[1];
+#endif
+
+  for(; i < n; ++i) {
+    result += (double) values[i];
+  }
+
+  return result;
+}
+
+static void extremes_float(const float* values, size_t n, float* min, float* max) {
+  if(n == 0) {
+    Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot compute the minimum or maximum of no values"));
+  }
+
+  size_t i = 0;
+  float lo = values[0];
+  float hi = values[0];
+
+#if defined(NUMERIC_AVX2)
+  __m256 lo_acc = _mm256_set1_ps(values[0]);
+  __m256 hi_acc = lo_acc;
+  for(; i + 8 <= n; i += 8) {
+    __m256 v = _mm256_loadu_ps(values + i);
+    lo_acc = _mm256_min_ps(lo_acc, v);
+    hi_acc = _mm256_max_ps(hi_acc, v);
+  }
+  float lo_lanes[8];
+  float hi_lanes[8];
+  _mm256_storeu_ps(lo_lanes, lo_acc);
+  _mm256_storeu_ps(hi_lanes, hi_acc);
+  for(size_t k = 0; k < 8; ++k) {
+    lo = lo_lanes[k] < lo ? lo_lanes[k] : lo;
+    hi = hi_lanes[k] > hi ? hi_lanes[k] : hi;
+  }
+#elif defined(NUMERIC_SSE2)
+  __m128 lo_acc = _mm_set1_ps(values[0]);
+  __m128 hi_acc = lo_acc;
+  for(; i + 4 <= n; i += 4) {
+    __m128 v = _mm_loadu_ps(values + i);
+    lo_acc = _mm_min_ps(lo_acc, v);
+    hi_acc = _mm_max_ps(hi_acc, v);
+  }
+  float lo_lanes[4];
+  float hi_lanes[4];
+  _mm_storeu_ps(lo_lanes, lo_acc);
+  _mm_storeu_ps(hi_lanes, hi_acc);
+  for(size_t k = 0; k < 4; ++k) {
+    lo = lo_lanes[k] < lo ? lo_lanes[k] : lo;
+    hi = hi_lanes[k] > hi ? hi_lanes[k] : hi;
+  }
+#endif
+
+  for(; i < n; ++i) {
+    lo = values[i] < lo ? values[i] : lo;
+    hi = values[i] > hi ? values[i] : hi;
+  }
+
+  *min = lo;
+  *max = hi;
+}
+
+static void prefix_sum_from_float(const float* values, float* result, size_t n, float initial) {
+  size_t i = 0;
+  float running = initial;
+
+#if defined(NUMERIC_AVX2) || defined(NUMERIC_SSE2)
+  __m128 carry = _mm_set1_ps(initial);
+  for(; i + 4 <= n; i += 4) {
+    __m128 x = _mm_loadu_ps(values + i);
+    x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+    x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+    x = _mm_add_ps(x, carry);
+    _mm_storeu_ps(result + i, x);
+    carry = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+  if(i > 0) {
+    running = result[i - 1];
+  }
+#endif
+
+  for(; i < n; ++i) {
+    running += values[i];
+    result[i] = running;
+  }
+}
+
+// double kernels
+
+double sum_double(const double* values, size_t n) {
+  size_t i = 0;
+  double result = 0;
+
+#if defined(NUMERIC_AVX2)
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  for(; i + 8 <= n; i += 8) {
+    acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(values + i));
+    acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(values + i + 4));
+  }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+  result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(NUMERIC_SSE2)
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  for(; i + 4 <= n; i += 4) {
+    acc0 = _mm_add_pd(acc0, _mm_loadu_pd(values + i));
+    acc1 = _mm_add_pd(acc1, _mm_loadu_pd(values + i + 2));
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+  result = lanes[0] + lanes[1];
+#endif
+
+  for(; i < n; ++i) {
+    result += values[i];
+  }
+
+  return result;
+}
+
+static void extremes_double(const double* values, size_t n, double* min, double* max) {
+  if(n == 0) {
+    Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot compute the minimum or maximum of no values"));
+  }
+
+  size_t i = 0;
+  double lo = values[0];
+  double hi = values[0];
+
+#if defined(NUMERIC_AVX2)
+  __m256d lo_acc = _mm256_set1_pd(values[0]);
+  __m256d hi_acc = lo_acc;
+  for(; i + 4 <= n; i += 4) {
+    __m256d v = _mm256_loadu_pd(values + i);
+    lo_acc = _mm256_min_pd(lo_acc, v);
+    hi_acc = _mm256_max_pd(hi_acc, v);
+  }
+  double lo_lanes[4];
+  double hi_lanes[4];
+  _mm256_storeu_pd(lo_lanes, lo_acc);
+  _mm256_storeu_pd(hi_lanes, hi_acc);
+  for(size_t k = 0; k < 4; ++k) {
+    lo = lo_lanes[k] < lo ? lo_lanes[k] : lo;
+    hi = hi_lanes[k] > hi ? hi_lanes[k] : hi;
+  }
+#elif defined(NUMERIC_SSE2)
+  __m128d lo_acc = _mm_set1_pd(values[0]);
+  __m128d hi_acc = lo_acc;
+  for(; i + 2 <= n; i += 2) {
+    __m128d v = _mm_loadu_pd(values + i);
+    lo_acc = _mm_min_pd(lo_acc, v);
+    hi_acc = _mm_max_pd(hi_acc, v);
+  }
+  double lo_lanes[2];
+  double hi_lanes[2];
+  _mm_storeu_pd(lo_lanes, lo_acc);
+  _mm_storeu_pd(hi_lanes, hi_acc);
+  for(size_t k = 0; k < 2; ++k) {
+    lo = lo_lanes[k] < lo ? lo_lanes[k] : lo;
+    hi = hi_lanes[k] > hi ? hi_lanes[k] : hi;
+  }
+#endif
+
+  for(; i < n; ++i) {
+    lo = values[i] < lo ? values[i] : lo;
+    hi = values[i] > hi ? values[i] : hi;
+  }
+
+  *min = lo;
+  *max = hi;
+}
+
+static void prefix_sum_from_double(const double* values, double* result, size_t n, double initial) {
+  size_t i = 0;
+  double running = initial;
+
+#if defined(NUMERIC_AVX2) || defined(NUMERIC_SSE2)
+  __m128d carry = _mm_set1_pd(initial);
+  for(; i + 2 <= n; i += 2) {
+    __m128d x = _mm_loadu_pd(values + i);
+    x = _mm_add_pd(x, _mm_castsi128_pd(_mm_slli_si128(_mm_castpd_si128(x), 8)));
+    x = _mm_add_pd(x, carry);
+    _mm_storeu_pd(result + i, x);
+    carry = _mm_unpackhi_pd(x, x);
+  }
+  if(i > 0) {
+    running = result[i - 1];
+  }
+#endif
+
+  for(; i < n; ++i) {
+    running += values[i];
+    result[i] = running;
+  }
+}
+
+// Functions shared by all types
+
+static void numeric_check_histogram(double min, double max, size_t num_bins) {
+  if(num_bins == 0 || !(max > min)) {
+    Error_raise(Error_new(ERROR_GENERIC, "A histogram requires at least one bin and max > min"));
+  }
+}
+
+// Calls kernel on each span of the given iterator, whose elements need to be stored by value
+// in elem_size bytes
+static void numeric_for_each_span(Iterator it, size_t elem_size, void (^kernel)(const void* values, size_t n)) {
+  if(!is_span_iterator(it)) {
+    Error_raise(Error_new(ERROR_ITERATOR_MISUSE, "The given iterator is not a span iterator as required"));
+  }
+
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
+  it.to_begin(iterator);
+
+  ArrayView span;
+  while(it.next_span(iterator, &span) != 0) {
+    if(!span.by_value || span.elem_size != elem_size) {
+      Iterator_free_instance(it, iterator);
+      Error_raise(Error_new(ERROR_ITERATOR_MISUSE, "The given iterator does not return elements of %ld bytes by value", elem_size));
+    }
+    kernel(span.carray, span.size);
+  }
+
+  Iterator_free_instance(it, iterator);
+}
+
+// Defines the functions built on top of the sum, extremes and prefix_sum_from kernels of the
+// given type. The argmin (argmax) of an array is the first index whose value is not greater
+// (not smaller) than the minimum (maximum), which avoids comparing floating point values for
+// equality.
+#define NUMERIC_FUNCTIONS(T, type, sum_type, add)                                                          \
+  type min_##T(const type* values, size_t n) {                                                              \
+    type min, max;                                                                                          \
+    extremes_##T(values, n, &min, &max);                                                                    \
+    return min;                                                                                             \
+  }                                                                                                         \
+                                                                                                            \
+  type max_##T(const type* values, size_t n) {                                                              \
+    type min, max;                                                                                          \
+    extremes_##T(values, n, &min, &max);                                                                    \
+    return max;                                                                                             \
+  }                                                                                                         \
+                                                                                                            \
+  size_t argmin_##T(const type* values, size_t n) {                                                         \
+    type min = min_##T(values, n);                                                                          \
+    size_t i = 0;                                                                                           \
+    while(values[i] > min) {                                                                                \
+      ++i;                                                                                                  \
+    }                                                                                                       \
+    return i;                                                                                               \
+  }                                                                                                         \
+                                                                                                            \
+  size_t argmax_##T(const type* values, size_t n) {                                                         \
+    type max = max_##T(values, n);                                                                          \
+    size_t i = 0;                                                                                           \
+    while(values[i] < max) {                                                                                \
+      ++i;                                                                                                  \
+    }                                                                                                       \
+    return i;                                                                                               \
+  }                                                                                                         \
+                                                                                                            \
+  double mean_##T(const type* values, size_t n) {                                                           \
+    if(n == 0) {                                                                                            \
+      Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot compute the mean of no values"));             \
+    }                                                                                                       \
+    sum_type sum = sum_##T(values, n);                                                                      \
+    return (double) sum / (double) n;                                                                       \
+  }                                                                                                         \
+                                                                                                            \
+  void histogram_##T(const type* values, size_t n, type min, type max, size_t* bins, size_t num_bins) {     \
+    numeric_check_histogram((double) min, (double) max, num_bins);                                          \
+    double scale = (double) num_bins / ((double) max - (double) min);                                       \
+    for(size_t i = 0; i < n; ++i) {                                                                         \
+      if(values[i] < min || values[i] > max) {                                                              \
+        continue;                                                                                           \
+      }                                                                                                     \
+      size_t bin = (size_t) (((double) values[i] - (double) min) * scale);                                  \
+      bins[bin < num_bins ? bin : num_bins - 1] += 1;                                                       \
+    }                                                                                                       \
+  }                                                                                                         \
+                                                                                                            \
+  void prefix_sum_##T(const type* values, type* result, size_t n) {                                         \
+    prefix_sum_from_##T(values, result, n, 0);                                                              \
+  }                                                                                                         \
+                                                                                                            \
+  sum_type iterator_sum_##T(Iterator it) {                                                                  \
+    __block sum_type result = 0;                                                                            \
+    numeric_for_each_span(it, sizeof(type), ^(const void* values, size_t n) {                               \
+      result = add(result, sum_##T((const type*) values, n));                                               \
+    });                                                                                                     \
+    return result;                                                                                          \
+  }                                                                                                         \
+                                                                                                            \
+  type iterator_min_##T(Iterator it) {                                                                      \
+    __block type result = 0;                                                                                \
+    __block size_t count = 0;                                                                               \
+    numeric_for_each_span(it, sizeof(type), ^(const void* values, size_t n) {                               \
+      type span_min = min_##T((const type*) values, n);                                                     \
+      result = count == 0 || span_min < result ? span_min : result;                                         \
+      count += n;                                                                                           \
+    });                                                                                                     \
+    if(count == 0) {                                                                                        \
+      Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot compute the minimum or maximum of no values")); \
+    }                                                                                                       \
+    return result;                                                                                          \
+  }                                                                                                         \
+                                                                                                            \
+  type iterator_max_##T(Iterator it) {                                                                      \
+    __block type result = 0;                                                                                \
+    __block size_t count = 0;                                                                               \
+    numeric_for_each_span(it, sizeof(type), ^(const void* values, size_t n) {                               \
+      type span_max = max_##T((const type*) values, n);                                                     \
+      result = count == 0 || span_max > result ? span_max : result;                                         \
+      count += n;                                                                                           \
+    });                                                                                                     \
+    if(count == 0) {                                                                                        \
+      Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot compute the minimum or maximum of no values")); \
+    }                                                                                                       \
+    return result;                                                                                          \
+  }                                                                                                         \
+                                                                                                            \
+  size_t iterator_argmin_##T(Iterator it) {                                                                 \
+    __block type min = 0;                                                                                   \
+    __block size_t result = 0;                                                                              \
+    __block size_t count = 0;                                                                               \
+    numeric_for_each_span(it, sizeof(type), ^(const void* values, size_t n) {                               \
+      size_t index = argmin_##T((const type*) values, n);                                                   \
+      if(count == 0 || ((const type*) values)[index] < min) {                                               \
+        min = ((const type*) values)[index];                                                                \
+        result = count + index;                                                                             \
+      }                                                                                                     \
+      count += n;                                                                                           \
+    });                                                                                                     \
+    if(count == 0) {                                                                                        \
+      Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot compute the minimum or maximum of no values")); \
+    }                                                                                                       \
+    return result;                                                                                          \
+  }                                                                                                         \
+                                                                                                            \
+  size_t iterator_argmax_##T(Iterator it) {                                                                 \
+    __block type max = 0;                                                                                   \
+    __block size_t result = 0;                                                                              \
+    __block size_t count = 0;                                                                               \
+    numeric_for_each_span(it, sizeof(type), ^(const void* values, size_t n) {                               \
+      size_t index = argmax_##T((const type*) values, n);                                                   \
+      if(count == 0 || ((const type*) values)[index] > max) {                                               \
+        max = ((const type*) values)[index];                                                                \
+        result = count + index;                                                                             \
+      }                                                                                                     \
+      count += n;                                                                                           \
+    });                                                                                                     \
+    if(count == 0) {                                                                                        \
+      Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot compute the minimum or maximum of no values")); \
+    }                                                                                                       \
+    return result;                                                                                          \
+  }                                                                                                         \
+                                                                                                            \
+  double iterator_mean_##T(Iterator it) {                                                                   \
+    __block sum_type sum = 0;                                                                               \
+    __block size_t count = 0;                                                                               \
+    numeric_for_each_span(it, sizeof(type), ^(const void* values, size_t n) {                               \
+      sum = add(sum, sum_##T((const type*) values, n));                                                     \
+      count += n;                                                                                           \
+    });                                                                                                     \
+    if(count == 0) {                                                                                        \
+      Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot compute the mean of no values"));             \
+    }                                                                                                       \
+    return (double) sum / (double) count;                                                                   \
+  }                                                                                                         \
+                                                                                                            \
+  void iterator_histogram_##T(Iterator it, type min, type max, size_t* bins, size_t num_bins) {             \
+    numeric_check_histogram((double) min, (double) max, num_bins);                                          \
+    numeric_for_each_span(it, sizeof(type), ^(const void* values, size_t n) {                               \
+      histogram_##T((const type*) values, n, min, max, bins, num_bins);                                     \
+    });                                                                                                     \
+  }                                                                                                         \
+                                                                                                            \
+  void iterator_prefix_sum_##T(Iterator it, type* result) {                                                 \
+    __block type* span_result = result;                                                                     \
+    __block type running = 0;                                                                               \
+    numeric_for_each_span(it, sizeof(type), ^(const void* values, size_t n) {                               \
+      prefix_sum_from_##T((const type*) values, span_result, n, running);                                   \
+      span_result += n;                                                                                     \
+      running = span_result[-1];                                                                            \
+    });                                                                                                     \
+  }
+
+NUMERIC_FUNCTIONS(int32, int32_t, int64_t, numeric_add_int64)
+NUMERIC_FUNCTIONS(int64, int64_t, int64_t, numeric_add_int64)
+NUMERIC_FUNCTIONS(float, float, double, numeric_add_double)
+NUMERIC_FUNCTIONS(double, double, double, numeric_add_double)
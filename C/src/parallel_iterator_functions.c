@@ -0,0 +1,332 @@
+#include "parallel_iterator_functions.h"
+#include <string.h>
+#include <stdatomic.h>
+
+#include "iterator_functions.h"
+#include "array_view.h"
+#include "mem.h"
+#include "macros.h"
+
+// Number of ranges (or parts of splittable iterators) per worker when grain is not given
+#define PAR_PARTS_PER_WORKER 8
+
+// Returns the number of elements in each range (see parallel_for for the default choice)
+static size_t par_grain(TaskPool* pool, size_t n, size_t grain) {
+  if(grain == 0) {
+    grain = n / (TaskPool_num_workers(pool) * PAR_PARTS_PER_WORKER);
+  }
+
+  return grain > 0 ? grain : 1;
+}
+
+static size_t par_num_chunks(size_t n, size_t grain) {
+  return (n + grain - 1) / grain;
+}
+
+// Partitions [0, n) into chunks of grain consecutive elements (the last one may be smaller)
+// and calls body on each of them concurrently. Differently from parallel_for, the partition
+// does not depend on the scheduling, so that body can store per-chunk results to be combined
+// in order.
+static void par_chunks(TaskPool* pool, size_t n, size_t grain, void (^body)(size_t chunk, size_t from, size_t to)) {
+  parallel_for(pool, par_num_chunks(n, grain), 0, ^(size_t chunk_from, size_t chunk_to) {
+    for(size_t chunk = chunk_from; chunk < chunk_to; ++chunk) {
+      size_t from = chunk * grain;
+      size_t to = n - from > grain ? from + grain : n;
+      body(chunk, from, to);
+    }
+  });
+}
+
+static void* span_at(ArrayView* span, size_t index) {
+  if(span->by_value) {
+    return span->carray + index * span->elem_size;
+  }
+
+  return ((void**) (void*) span->carray)[index];
+}
+
+// Calls callback on the elements [from, to) of the container (and on their indices) using a
+// new iterator instance. Spans are used if the iterator provides them.
+static void par_range_for_each(Iterator it, size_t from, size_t to, void (^callback)(void* elem, size_t index)) {
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
+  it.move_to(iterator, from);
+  size_t index = from;
+
+  if(it.next_span != NULL) {
+    ArrayView span;
+    while(index < to && it.next_span(iterator, &span) != 0) {
+      size_t span_size = span.size < to - index ? span.size : to - index;
+      for(size_t i = 0; i < span_size; ++i) {
+        callback(span_at(&span, i), index++);
+      }
+    }
+  } else {
+    for(; index < to; ++index) {
+      callback(it.get(iterator), index);
+      it.next(iterator);
+    }
+  }
+
+  Iterator_free_instance(it, iterator);
+}
+
+// Splits the given instance into (at most) num_parts parts and calls process_part on each of
+// them concurrently. Half of the parts are handed off at each split, to be further split by
+// the task processing them. Each part is freed after it has been processed.
+static void par_split(TaskGroup* group, Iterator it, void* iterator, size_t num_parts, void (^process_part)(void* iterator)) {
+  void* part;
+  while(num_parts > 1 && (part = it.split(iterator)) != NULL) {
+    size_t part_num_parts = num_parts / 2;
+    num_parts -= part_num_parts;
+
+    TaskGroup_spawn(group, ^{
+      par_split(group, it, part, part_num_parts, process_part);
+    });
+  }
+
+  process_part(iterator);
+  it.free(iterator);
+}
+
+static void par_split_for_each(TaskPool* pool, Iterator it, void (^process_part)(void* iterator)) {
+  TaskGroup* group = TaskGroup_new(pool);
+
+  par_split(group, it, it.new_iterator(it.container), TaskPool_num_workers(pool) * PAR_PARTS_PER_WORKER, process_part);
+  TaskGroup_wait(group);
+
+  TaskGroup_free(group);
+}
+
+// Iterators that are splittable, but not random access, are processed by par_split_for_each
+static int par_use_split(Iterator it) {
+  return !is_random_access_iterator(it) && is_splittable_iterator(it);
+}
+
+// In the following functions, the iterator instance created to get the size of the container
+// is freed only after all the ranges have been processed: this keeps alive the containers of
+// the iterators that free them together with their last instance (e.g., CArray_it).
+
+void par_for_each(TaskPool* pool, Iterator it, size_t grain, void (^callback)(void* elem)) {
+  if(par_use_split(it)) {
+    par_split_for_each(pool, it, ^(void* iterator) {
+      for(; !it.end(iterator); it.next(iterator)) {
+        callback(it.get(iterator));
+      }
+    });
+    return;
+  }
+
+  require_random_access_iterator(it);
+
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
+  size_t n = it.size(iterator);
+
+  parallel_for(pool, n, par_grain(pool, n, grain), ^(size_t from, size_t to) {
+    par_range_for_each(it, from, to, ^(void* elem, UNUSED(size_t index)) {
+      callback(elem);
+    });
+  });
+
+  Iterator_free_instance(it, iterator);
+}
+
+Array* par_map(TaskPool* pool, Iterator it, size_t grain, void* (^mapping_function)(void* elem)) {
+  require_random_access_iterator(it);
+
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
+  size_t n = it.size(iterator);
+
+  Array* result = Array_new(n > 0 ? n : 1);
+  Array_set_size(result, n);
+  void** carray = (void**) Array_carray(result);
+
+  parallel_for(pool, n, par_grain(pool, n, grain), ^(size_t from, size_t to) {
+    par_range_for_each(it, from, to, ^(void* elem, size_t index) {
+      carray[index] = mapping_function(elem);
+    });
+  });
+
+  Iterator_free_instance(it, iterator);
+  return result;
+}
+
+Array* par_filter(TaskPool* pool, Iterator it, size_t grain, int (^keep)(void* elem)) {
+  require_random_access_iterator(it);
+
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
+  size_t n = it.size(iterator);
+  grain = par_grain(pool, n, grain);
+
+  // each chunk collects its elements, chunks are then concatenated in order
+  size_t num_chunks = par_num_chunks(n, grain);
+  Array** kept = (Array**) Mem_alloc(sizeof(Array*) * (num_chunks + 1));
+  size_t* offsets = (size_t*) Mem_alloc(sizeof(size_t) * (num_chunks + 1));
+
+  par_chunks(pool, n, grain, ^(size_t chunk, size_t from, size_t to) {
+    Array* chunk_kept = Array_new_small(16);
+    par_range_for_each(it, from, to, ^(void* elem, UNUSED(size_t index)) {
+      if(keep(elem)) {
+        Array_add(chunk_kept, elem);
+      }
+    });
+    kept[chunk] = chunk_kept;
+  });
+
+  offsets[0] = 0;
+  for(size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    offsets[chunk + 1] = offsets[chunk] + Array_size(kept[chunk]);
+  }
+
+  Array* result = Array_new(offsets[num_chunks] > 0 ? offsets[num_chunks] : 1);
+  Array_set_size(result, offsets[num_chunks]);
+  void** carray = (void**) Array_carray(result);
+
+  parallel_for(pool, num_chunks, 0, ^(size_t chunk_from, size_t chunk_to) {
+    for(size_t chunk = chunk_from; chunk < chunk_to; ++chunk) {
+      memcpy(carray + offsets[chunk], Array_carray(kept[chunk]), sizeof(void*) * Array_size(kept[chunk]));
+      Array_free(kept[chunk]);
+    }
+  });
+
+  Mem_free(kept);
+  Mem_free(offsets);
+  Iterator_free_instance(it, iterator);
+
+  return result;
+}
+
+void* par_reduce(TaskPool* pool, Iterator it, size_t grain, void* identity, void* (^combine)(void* lhs, void* rhs)) {
+  require_random_access_iterator(it);
+
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
+  size_t n = it.size(iterator);
+  grain = par_grain(pool, n, grain);
+
+  size_t num_chunks = par_num_chunks(n, grain);
+  void** partials = (void**) Mem_alloc(sizeof(void*) * (num_chunks + 1));
+
+  par_chunks(pool, n, grain, ^(size_t chunk, size_t from, size_t to) {
+    __block void* accumulator = identity;
+    par_range_for_each(it, from, to, ^(void* elem, UNUSED(size_t index)) {
+      accumulator = combine(accumulator, elem);
+    });
+    partials[chunk] = accumulator;
+  });
+
+  void* result = identity;
+  for(size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    result = combine(result, partials[chunk]);
+  }
+
+  Mem_free(partials);
+  Iterator_free_instance(it, iterator);
+
+  return result;
+}
+
+size_t par_count(TaskPool* pool, Iterator it, size_t grain, int (^condition)(void* elem)) {
+  if(par_use_split(it)) {
+    _Atomic size_t total;
+    atomic_init(&total, 0);
+    _Atomic size_t* total_ptr = &total;
+
+    par_split_for_each(pool, it, ^(void* iterator) {
+      size_t part_count = 0;
+      for(; !it.end(iterator); it.next(iterator)) {
+        part_count += condition(it.get(iterator)) ? 1 : 0;
+      }
+      atomic_fetch_add(total_ptr, part_count);
+    });
+
+    return atomic_load(&total);
+  }
+
+  require_random_access_iterator(it);
+
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
+  size_t n = it.size(iterator);
+  grain = par_grain(pool, n, grain);
+
+  size_t num_chunks = par_num_chunks(n, grain);
+  size_t* counts = (size_t*) Mem_alloc(sizeof(size_t) * (num_chunks + 1));
+
+  par_chunks(pool, n, grain, ^(size_t chunk, size_t from, size_t to) {
+    __block size_t chunk_count = 0;
+    par_range_for_each(it, from, to, ^(void* elem, UNUSED(size_t index)) {
+      chunk_count += condition(elem) ? 1 : 0;
+    });
+    counts[chunk] = chunk_count;
+  });
+
+  size_t result = 0;
+  for(size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    result += counts[chunk];
+  }
+
+  Mem_free(counts);
+  Iterator_free_instance(it, iterator);
+
+  return result;
+}
+
+Dictionary* par_group_aggregate(TaskPool* pool, Iterator it, size_t grain, void* (^key_fn)(void* elem), KeyInfo* key_info, void* (^init_fn)(void* key), void* (^accumulate_fn)(void* aggregate, void* elem), void* (^merge_fn)(void* aggregate, void* partial)) {
+  require_random_access_iterator(it);
+
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
+  size_t n = it.size(iterator);
+  if(grain == 0) {
+    size_t num_workers = TaskPool_num_workers(pool);
+    grain = (n + num_workers - 1) / num_workers;
+  }
+  grain = grain > 0 ? grain : 1;
+
+  size_t num_chunks = par_num_chunks(n, grain);
+  Dictionary** partials = (Dictionary**) Mem_alloc(sizeof(Dictionary*) * (num_chunks + 1));
+
+  par_chunks(pool, n, grain, ^(size_t chunk, size_t from, size_t to) {
+    Dictionary* partial = Dictionary_new(key_info);
+    GroupAggregator* aggregator = GroupAggregator_new(partial, key_fn, init_fn, accumulate_fn);
+    par_range_for_each(it, from, to, ^(void* elem, UNUSED(size_t index)) {
+      GroupAggregator_add(aggregator, elem);
+    });
+    GroupAggregator_free(aggregator);
+    partials[chunk] = partial;
+  });
+
+  // the partial dictionaries are merged into the first one
+  Dictionary* result = num_chunks > 0 ? partials[0] : Dictionary_new(key_info);
+  for(size_t chunk = 1; chunk < num_chunks; ++chunk) {
+    for_each(Dictionary_it(partials[chunk]), ^(void* elem) {
+      KeyValue* kv = (KeyValue*) elem;
+      void* aggregate;
+      if(Dictionary_get(result, kv->key, &aggregate)) {
+        Dictionary_set(result, kv->key, merge_fn(aggregate, kv->value));
+      } else {
+        Dictionary_set(result, kv->key, kv->value);
+      }
+    });
+    Dictionary_free(partials[chunk]);
+  }
+
+  Mem_free(partials);
+  Iterator_free_instance(it, iterator);
+
+  return result;
+}
+
+void par_hash_join(TaskPool* pool, Iterator build, Iterator probe, size_t grain, KeyInfo* key_info, void* (^build_key_fn)(void* elem), void* (^probe_key_fn)(void* elem), void (^callback)(void* build_elem, void* probe_elem)) {
+  HashJoinTable* table = HashJoinTable_new(build, key_info, build_key_fn);
+
+  par_for_each(pool, probe, grain, ^(void* elem) {
+    HashJoinTable_probe(table, probe_key_fn(elem), elem, callback);
+  });
+
+  HashJoinTable_free(table);
+}
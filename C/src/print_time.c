@@ -106,10 +106,12 @@ double PrintTime_print(PrintTime* pt, char* label, void(^fun)(void)) {
 
  printf("%s\n", String_head_line(buf, label, '=', MAX_BUF));
 
- clock_t start = clock();
+ // wall clock time: clock() would sum the cpu time of all threads
+ struct timespec start, end;
+ clock_gettime(CLOCK_MONOTONIC, &start);
  fun();
- clock_t end = clock();
- result = ((double)end-start) / CLOCKS_PER_SEC;
+ clock_gettime(CLOCK_MONOTONIC, &end);
+ result = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
 
  printf(BWHT "%s\n" reset, String_line_with_termsize(buf, '-', MAX_BUF));
  printf(BWHT "time:" BRED "%10.2lf" reset " secs\n" , result);
@@ -121,6 +123,11 @@ double PrintTime_print(PrintTime* pt, char* label, void(^fun)(void)) {
  return result;
 }
 
+void PrintTime_add_data(PrintTime* pt, const char* label, double value) {
+  KeyValue kv = { .key = Mem_strdup(label), .value = DoubleContainer_new(value) };
+  ArrayAlt_add(pt->data, &kv);
+}
+
 void PrintTime_save(PrintTime* pt) {
 
   pt->file = fopen(pt->file_name, "a");
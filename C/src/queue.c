@@ -1,33 +1,47 @@
 #include "queue.h"
+#include "deque.h"
+#include "mem.h"
+
+struct _Queue {
+  Deque* deque;
+};
 
 
 Queue* Queue_new() {
-  return List_new();
+  Queue* result = (Queue*) Mem_alloc(sizeof(struct _Queue));
+  result->deque = Deque_new(16);
+  return result;
 }
 
 void Queue_free(Queue* queue) {
-  List_free(queue, 0);
+  Deque_free(queue->deque);
+  Mem_free(queue);
 }
 
 void Queue_enqueue(Queue* queue, void* elem) {
-  List_insert(queue, elem);
+  Deque_push_back(queue->deque, elem);
 }
 
 void* Queue_dequeue(Queue* queue) {
-  ListNode* node = List_tail(queue);
-  void* elem = ListNode_get(queue, node);
-  List_delete_node(queue, node);
-  return elem;
+  return Deque_pop_front(queue->deque);
+}
+
+void Queue_enqueue_many(Queue* queue, void** elems, size_t count) {
+  Deque_push_back_many(queue->deque, elems, count);
+}
+
+size_t Queue_dequeue_many(Queue* queue, void** result, size_t max_count) {
+  return Deque_pop_front_many(queue->deque, result, max_count);
 }
 
 void* Queue_front(Queue* queue) {
-  return ListNode_get( queue, List_tail(queue) );
+  return Deque_front(queue->deque);
 }
 
 size_t Queue_size(Queue* queue) {
-  return List_size(queue);
+  return Deque_size(queue->deque);
 }
 
 int Queue_empty(Queue* queue) {
-  return List_empty(queue);
+  return Deque_empty(queue->deque);
 }
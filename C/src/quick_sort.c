@@ -1,7 +1,11 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include "quick_sort.h"
 #include "array_g.h"
+#include "mem.h"
 
 void partition_3_way(void** array, size_t start, size_t end, size_t pivot_pos, size_t* p1, size_t* p2,int (^compare)(const void*, const void*) );
 void quick_sort_3_way(void** array, size_t start, size_t end, int (^compare)(const void*, const void*));
@@ -235,3 +239,270 @@ void quick_sort_g(void* array, size_t count, size_t size, KIComparator fun) {
   }
   quick_sort_3_way_g(array, 0, count-1, size, fun);
 }
+
+// --------------------------------------------------------------------------------
+// Parallel quick sort
+// --------------------------------------------------------------------------------
+
+// Ranges up to this size are sorted by the task that partitioned them, larger ones are spawned
+#define PAR_QUICK_SORT_TASK_CUTOFF 4096
+// Ranges up to this size are sorted by insertion sort
+#define PAR_QUICK_SORT_INSERTION_CUTOFF 16
+// Ranges smaller than this are never partitioned in parallel
+#define PAR_QUICK_SORT_PARALLEL_PARTITION_MIN ((size_t) 1 << 16)
+// Number of blocks per worker in a parallel partition
+#define PAR_QUICK_SORT_BLOCKS_PER_WORKER 4
+// Pivots up to this size are copied on the stack
+#define PAR_QUICK_SORT_PIVOT_BYTES 64
+
+enum { PAR_LESS, PAR_EQUAL, PAR_GREATER };
+
+// The elements are handled as size bytes each (pointer arrays have size == sizeof(void*)) and
+// compared by passing pointers to them. The ranges at least parallel_partition_min elements
+// long are partitioned out of place: buffer and classes have a slot for each element of the
+// array, ranges being sorted concurrently use disjoint slots.
+typedef struct {
+  TaskPool* pool;
+  TaskGroup* group;
+  unsigned char* array;
+  size_t size;
+  int (^compare)(const void* lhs, const void* rhs);
+  size_t parallel_partition_min;
+  unsigned char* buffer;
+  unsigned char* classes;
+} ParQuickSort;
+
+static void* par_at(ParQuickSort* qs, size_t pos) {
+  return qs->array + pos * qs->size;
+}
+
+// swap_g is not used since it is not thread safe
+static void par_swap(ParQuickSort* qs, size_t pos1, size_t pos2) {
+  if(qs->size == sizeof(void*)) {
+    swap((void**) par_at(qs, pos1), (void**) par_at(qs, pos2));
+    return;
+  }
+
+  unsigned char* e1 = (unsigned char*) par_at(qs, pos1);
+  unsigned char* e2 = (unsigned char*) par_at(qs, pos2);
+  for(size_t i = 0; i < qs->size; ++i) {
+    unsigned char tmp = e1[i];
+    e1[i] = e2[i];
+    e2[i] = tmp;
+  }
+}
+
+static void par_copy(void* dst, const void* src, size_t size) {
+  if(size == sizeof(void*)) {
+    *(void**) dst = *(void* const*) src;
+  } else {
+    memcpy(dst, src, size);
+  }
+}
+
+// Copies into pivot the median of three random elements of [start, end). Each task draws the
+// positions from its own state (drand48 is not thread safe).
+static void par_choose_pivot(ParQuickSort* qs, size_t start, size_t end, unsigned short seed[3], void* pivot) {
+  double n = (double) (end - start);
+  void* e1 = par_at(qs, start + (size_t) (erand48(seed) * n));
+  void* e2 = par_at(qs, start + (size_t) (erand48(seed) * n));
+  void* e3 = par_at(qs, start + (size_t) (erand48(seed) * n));
+
+  if(qs->compare(e1, e2) > 0) {
+    void* tmp = e1;
+    e1 = e2;
+    e2 = tmp;
+  }
+
+  if(qs->compare(e2, e3) > 0) {
+    e2 = qs->compare(e1, e3) > 0 ? e1 : e3;
+  }
+
+  memcpy(pivot, e2, qs->size);
+}
+
+// Partitions [start, end) in place: after the call [start, *lt) contains the elements less than
+// the pivot, [*lt, *gt) the ones equal to it and [*gt, end) the larger ones.
+static void par_partition(ParQuickSort* qs, size_t start, size_t end, const void* pivot, size_t* lt, size_t* gt) {
+  size_t less = start;
+  size_t i = start;
+  size_t greater = end;
+
+  while(i < greater) {
+    int comparison = qs->compare(par_at(qs, i), pivot);
+    if(comparison < 0) {
+      par_swap(qs, less++, i++);
+    } else if(comparison > 0) {
+      par_swap(qs, i, --greater);
+    } else {
+      ++i;
+    }
+  }
+
+  *lt = less;
+  *gt = greater;
+}
+
+// As par_partition, but the range is split in blocks processed concurrently. Each block
+// classifies its elements and counts the classes, the prefix sums of the counts give each block
+// the positions of its elements in the buffer, which is then copied back into the array.
+static void par_block_partition(ParQuickSort* qs, size_t start, size_t end, const void* pivot, size_t* lt, size_t* gt) {
+  size_t n = end - start;
+  size_t num_blocks = TaskPool_num_workers(qs->pool) * PAR_QUICK_SORT_BLOCKS_PER_WORKER;
+  size_t block_size = (n + num_blocks - 1) / num_blocks;
+  num_blocks = (n + block_size - 1) / block_size;
+
+  // offsets[3 * block + class] is first the number of elements of the class in the block,
+  // then the position of the first of them in the buffer
+  size_t* offsets = (size_t*) Mem_alloc(sizeof(size_t) * 3 * num_blocks);
+
+  parallel_for(qs->pool, num_blocks, 1, ^(size_t block_from, size_t block_to) {
+    for(size_t block = block_from; block < block_to; ++block) {
+      size_t from = start + block * block_size;
+      size_t to = end - from > block_size ? from + block_size : end;
+      size_t counts[3] = { 0, 0, 0 };
+
+      for(size_t i = from; i < to; ++i) {
+        int comparison = qs->compare(par_at(qs, i), pivot);
+        unsigned char class = comparison < 0 ? PAR_LESS : (comparison > 0 ? PAR_GREATER : PAR_EQUAL);
+        qs->classes[i] = class;
+        counts[class] += 1;
+      }
+
+      memcpy(offsets + 3 * block, counts, sizeof(counts));
+    }
+  });
+
+  size_t position = start;
+  for(size_t class = PAR_LESS; class <= PAR_GREATER; ++class) {
+    for(size_t block = 0; block < num_blocks; ++block) {
+      size_t count = offsets[3 * block + class];
+      offsets[3 * block + class] = position;
+      position += count;
+    }
+
+    if(class == PAR_LESS) {
+      *lt = position;
+    } else if(class == PAR_EQUAL) {
+      *gt = position;
+    }
+  }
+
+  parallel_for(qs->pool, num_blocks, 1, ^(size_t block_from, size_t block_to) {
+    for(size_t block = block_from; block < block_to; ++block) {
+      size_t from = start + block * block_size;
+      size_t to = end - from > block_size ? from + block_size : end;
+      size_t next[3];
+      memcpy(next, offsets + 3 * block, sizeof(next));
+
+      for(size_t i = from; i < to; ++i) {
+        par_copy(qs->buffer + next[qs->classes[i]]++ * qs->size, par_at(qs, i), qs->size);
+      }
+    }
+  });
+
+  parallel_for(qs->pool, n, 0, ^(size_t from, size_t to) {
+    memcpy(par_at(qs, start + from), qs->buffer + (start + from) * qs->size, (to - from) * qs->size);
+  });
+
+  Mem_free(offsets);
+}
+
+static void par_insertion_sort(ParQuickSort* qs, size_t start, size_t end) {
+  for(size_t i = start + 1; i < end; ++i) {
+    for(size_t j = i; j > start && qs->compare(par_at(qs, j - 1), par_at(qs, j)) > 0; --j) {
+      par_swap(qs, j - 1, j);
+    }
+  }
+}
+
+static void par_sort_range(ParQuickSort* qs, size_t start, size_t end);
+
+// Sorts [start, end) in the calling task if the range is small, spawns a new task otherwise
+static void par_sort_or_spawn(ParQuickSort* qs, size_t start, size_t end) {
+  if(end - start <= PAR_QUICK_SORT_TASK_CUTOFF) {
+    par_sort_range(qs, start, end);
+    return;
+  }
+
+  TaskGroup_spawn(qs->group, ^{
+    par_sort_range(qs, start, end);
+  });
+}
+
+// Partitions [start, end) until what is left is small enough for insertion sort. At each step
+// the smaller side is handed off and the larger one is kept, so that the recursion depth is
+// logarithmic.
+static void par_sort_range(ParQuickSort* qs, size_t start, size_t end) {
+  unsigned short seed[3] = { (unsigned short) start, (unsigned short) end, (unsigned short) (start >> 16) };
+  _Alignas(max_align_t) unsigned char inline_pivot[PAR_QUICK_SORT_PIVOT_BYTES];
+  void* pivot = qs->size <= PAR_QUICK_SORT_PIVOT_BYTES ? inline_pivot : Mem_alloc(qs->size);
+
+  while(end - start > PAR_QUICK_SORT_INSERTION_CUTOFF) {
+    size_t lt, gt;
+    par_choose_pivot(qs, start, end, seed, pivot);
+
+    if(end - start >= qs->parallel_partition_min) {
+      par_block_partition(qs, start, end, pivot, &lt, &gt);
+    } else {
+      par_partition(qs, start, end, pivot, &lt, &gt);
+    }
+
+    if(lt - start < end - gt) {
+      par_sort_or_spawn(qs, start, lt);
+      start = gt;
+    } else {
+      par_sort_or_spawn(qs, gt, end);
+      end = lt;
+    }
+  }
+
+  par_insertion_sort(qs, start, end);
+
+  if(pivot != inline_pivot) {
+    Mem_free(pivot);
+  }
+}
+
+static void par_quick_sort_ext(TaskPool* pool, void* array, size_t count, size_t size, int (^compare)(const void*, const void*)) {
+  if(count <= 1) {
+    return;
+  }
+
+  ParQuickSort qs = { pool, TaskGroup_new(pool), (unsigned char*) array, size, compare, SIZE_MAX, NULL, NULL };
+
+  // the top levels are partitioned in parallel, until there are enough ranges for the workers
+  size_t num_workers = TaskPool_num_workers(pool);
+  if(num_workers > 1 && count >= PAR_QUICK_SORT_PARALLEL_PARTITION_MIN) {
+    qs.parallel_partition_min = count / num_workers > PAR_QUICK_SORT_PARALLEL_PARTITION_MIN ? count / num_workers : PAR_QUICK_SORT_PARALLEL_PARTITION_MIN;
+    qs.buffer = (unsigned char*) Mem_alloc(count * size);
+    qs.classes = (unsigned char*) Mem_alloc(count);
+  }
+
+  par_sort_range(&qs, 0, count);
+  TaskGroup_wait(qs.group);
+
+  TaskGroup_free(qs.group);
+  if(qs.buffer != NULL) {
+    Mem_free(qs.buffer);
+    Mem_free(qs.classes);
+  }
+}
+
+void par_quick_sort_wb(TaskPool* pool, void** array, size_t count, KIBlkComparator compare) {
+  par_quick_sort_ext(pool, array, count, sizeof(void*), ^(const void* lhs, const void* rhs) {
+    return compare(*(void* const*) lhs, *(void* const*) rhs);
+  });
+}
+
+void par_quick_sort(TaskPool* pool, void** array, size_t count, KIComparator fun) {
+  par_quick_sort_ext(pool, array, count, sizeof(void*), ^(const void* lhs, const void* rhs) {
+    return fun(*(void* const*) lhs, *(void* const*) rhs);
+  });
+}
+
+void par_quick_sort_g(TaskPool* pool, void* array, size_t count, size_t size, KIComparator fun) {
+  par_quick_sort_ext(pool, array, count, size, ^(const void* lhs, const void* rhs) {
+    return fun(lhs, rhs);
+  });
+}
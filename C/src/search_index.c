@@ -0,0 +1,165 @@
+#include "search_index.h"
+#include <string.h>
+#include <Block.h>
+
+#include "iterator_functions.h"
+#include "array_view.h"
+#include "errors.h"
+#include "mem.h"
+
+// The elements prefetched at each step are the 16 descendants of the current slot this many
+// levels below it, which are stored contiguously
+#define SEARCH_INDEX_PREFETCH_LEVELS 4
+
+// Slots [1, size] store the nodes of a complete binary search tree breadth first: the children
+// of slot k are slots 2k and 2k+1 (slot 0 is unused). Keys are either the elements themselves
+// (by_value) or pointers to them, elem_size bytes each.
+struct _SearchIndex {
+  size_t size;
+  unsigned char* keys;
+  size_t elem_size;
+  int by_value;
+  // positions[k] is the position in the container of the element in slot k
+  size_t* positions;
+  KIBlkComparator compare;
+};
+
+static const void* SearchIndex_key(SearchIndex* index, size_t slot) {
+  if(index->by_value) {
+    return index->keys + slot * index->elem_size;
+  }
+
+  return ((void**) (void*) index->keys)[slot];
+}
+
+// Copies the elements (or the pointers to them) into a new C array, in iteration order
+static unsigned char* SearchIndex_collect(SearchIndex* index, Iterator it) {
+  if(!is_span_iterator(it)) {
+    void** sorted = (void**) Mem_alloc(sizeof(void*) * (index->size + 1));
+    __block size_t position = 0;
+    for_each(it, ^(void* elem) {
+      sorted[position++] = elem;
+    });
+
+    return (unsigned char*) sorted;
+  }
+
+  unsigned char* sorted = NULL;
+  size_t position = 0;
+  IteratorStorage storage;
+  void* iterator = Iterator_new_instance(it, &storage);
+  it.to_begin(iterator);
+
+  ArrayView span;
+  while(it.next_span(iterator, &span) != 0) {
+    size_t elem_size = span.by_value ? span.elem_size : sizeof(void*);
+    if(sorted == NULL) {
+      index->by_value = span.by_value;
+      index->elem_size = elem_size;
+      sorted = (unsigned char*) Mem_alloc(elem_size * (index->size + 1));
+    }
+
+    if(span.by_value != index->by_value || elem_size != index->elem_size || position + span.size > index->size) {
+      Iterator_free_instance(it, iterator);
+      Error_raise(Error_new(ERROR_ITERATOR_MISUSE, "The spans of the given iterator do not store elements of the same kind"));
+    }
+
+    memcpy(sorted + position * elem_size, span.carray, span.size * elem_size);
+    position += span.size;
+  }
+
+  Iterator_free_instance(it, iterator);
+
+  return sorted != NULL ? sorted : (unsigned char*) Mem_alloc(index->elem_size);
+}
+
+// Fills the subtree rooted at slot with the sorted elements starting at the given position (an
+// in-order visit), returns the position of the first element not used
+static size_t SearchIndex_fill(SearchIndex* index, unsigned char* sorted, size_t position, size_t slot) {
+  if(slot > index->size) {
+    return position;
+  }
+
+  position = SearchIndex_fill(index, sorted, position, 2 * slot);
+  memcpy(index->keys + slot * index->elem_size, sorted + position * index->elem_size, index->elem_size);
+  index->positions[slot] = position;
+
+  return SearchIndex_fill(index, sorted, position + 1, 2 * slot + 1);
+}
+
+// Constructor
+
+SearchIndex* SearchIndex_new(Iterator it, KIBlkComparator compare) {
+  SearchIndex* index = (SearchIndex*) Mem_alloc(sizeof(SearchIndex));
+  index->size = count(it);
+  index->elem_size = sizeof(void*);
+  index->by_value = 0;
+  index->compare = Block_copy(compare);
+
+  unsigned char* sorted = SearchIndex_collect(index, it);
+  index->keys = (unsigned char*) Mem_alloc(index->elem_size * (index->size + 1));
+  index->positions = (size_t*) Mem_alloc(sizeof(size_t) * (index->size + 1));
+  SearchIndex_fill(index, sorted, 0, 1);
+  Mem_free(sorted);
+
+  return index;
+}
+
+// Destructor
+
+void SearchIndex_free(SearchIndex* index) {
+  Block_release(index->compare);
+  Mem_free(index->keys);
+  Mem_free(index->positions);
+  Mem_free(index);
+}
+
+// Accessors
+
+size_t SearchIndex_size(SearchIndex* index) {
+  return index->size;
+}
+
+// Searches
+
+// Returns the slot of the first element not smaller than elem, or 0 if all elements are smaller.
+// Each step appends the result of the comparison to the bits of slot (1 going right), so that
+// the answer is the last slot where the search went left: the trailing ones (the right turns
+// taken after it) and the zero preceding them are shifted out.
+static size_t SearchIndex_lower_bound_slot(SearchIndex* index, const void* elem) {
+  size_t slot = 1;
+
+  while(slot <= index->size) {
+    size_t ahead = slot << SEARCH_INDEX_PREFETCH_LEVELS;
+    __builtin_prefetch(index->keys + (ahead <= index->size ? ahead : slot) * index->elem_size);
+    slot = 2 * slot + (size_t) (index->compare(elem, SearchIndex_key(index, slot)) > 0);
+  }
+
+  return slot >> (__builtin_ctzl(~slot) + 1);
+}
+
+size_t SearchIndex_search(SearchIndex* index, const void* elem) {
+  size_t slot = SearchIndex_lower_bound_slot(index, elem);
+
+  if(slot == 0 || index->compare(elem, SearchIndex_key(index, slot)) != 0) {
+    return (size_t) -1;
+  }
+
+  return index->positions[slot];
+}
+
+size_t SearchIndex_lower_bound(SearchIndex* index, const void* elem) {
+  size_t slot = SearchIndex_lower_bound_slot(index, elem);
+
+  return slot != 0 ? index->positions[slot] : index->size;
+}
+
+size_t SearchIndex_search_approx(SearchIndex* index, const void* elem) {
+  if(index->size == 0) {
+    Error_raise(Error_new(ERROR_INDEX_OUT_OF_BOUND, "Cannot search an empty index"));
+  }
+
+  size_t slot = SearchIndex_lower_bound_slot(index, elem);
+
+  return slot != 0 ? index->positions[slot] : index->size - 1;
+}
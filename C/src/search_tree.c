@@ -1,5 +1,6 @@
 #include "dictionary.h"
 #include "stack.h"
+#include "array.h"
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -17,8 +18,15 @@ struct _Dictionary  {
   size_t size;
 };
 
+// The stack holds the roots of the subtrees still to be visited, current is the node the
+// iterator points to (its subtrees are already on the stack). start holds the roots of the
+// subtrees of the iterator's part and handed_off the roots of the subtrees given to other
+// instances by split (NULL until the first split); to_begin restarts from start skipping them.
 struct _DictionaryIterator {
   Stack* stack;
+  Node* current;
+  Array* start;
+  Array* handed_off;
 };
 
 #define MAX_STACK_SIZE 1024
@@ -27,45 +35,106 @@ struct _DictionaryIterator {
  *DictionaryIterator* implementation
  * -------------------------- */
 
+static void DictionaryIterator_push(DictionaryIterator* it, Node* node) {
+  if(node == NULL) {
+    return;
+  }
+
+  if(it->handed_off != NULL) {
+    for(size_t i = 0; i < Array_size(it->handed_off); ++i) {
+      if(Array_at(it->handed_off, i) == node) {
+        return;
+      }
+    }
+  }
+
+  Stack_push(it->stack, node);
+}
+
 void DictionaryIterator_next(DictionaryIterator* it) {
   if(Stack_empty(it->stack)) {
+    it->current = NULL;
     return;
   }
 
   Node* cur = Stack_pop(it->stack);
-  if(cur->left != NULL) {
-    Stack_push(it->stack, cur->left);
+  DictionaryIterator_push(it, cur->left);
+  DictionaryIterator_push(it, cur->right);
+
+  it->current = cur;
+}
+
+void DictionaryIterator_to_begin(DictionaryIterator* it) {
+  while(!Stack_empty(it->stack)) {
+    Stack_pop(it->stack);
   }
 
-  if(cur->right != NULL) {
-    Stack_push(it->stack, cur->right);
+  for(size_t i = 0; i < Array_size(it->start); ++i) {
+    DictionaryIterator_push(it, Array_at(it->start, i));
   }
+  DictionaryIterator_next(it);
 }
+
 DictionaryIterator* DictionaryIterator_new(Dictionary* dictionary) {
  DictionaryIterator* it = (DictionaryIterator*) Mem_alloc(sizeof(struct _DictionaryIterator));
   it->stack = Stack_new(MAX_STACK_SIZE);
+  it->current = NULL;
+  it->start = Array_new_small(1);
+  it->handed_off = NULL;
 
   if(!Dictionary_empty(dictionary)) {
-    Stack_push(it->stack, dictionary->root);
+    Array_add(it->start, dictionary->root);
   }
+  DictionaryIterator_to_begin(it);
+
   return it;
 }
 
 void DictionaryIterator_free(DictionaryIterator* it) {
   Stack_free(it->stack);
+  Array_free(it->start);
+  if(it->handed_off != NULL) {
+    Array_free(it->handed_off);
+  }
   Mem_free(it);
 }
 
 int DictionaryIterator_end(DictionaryIterator* it) {
-  return Stack_empty(it->stack);
+  return it->current == NULL;
 }
 
 KeyValue* DictionaryIterator_get(DictionaryIterator* it) {
-  return &((Node*)Stack_top(it->stack))->kv;
+  return &it->current->kv;
 }
 
 int DictionaryIterator_same(DictionaryIterator* it1, DictionaryIterator* it2) {
-  return Stack_same(it1->stack, it2->stack);
+  return it1->current == it2->current && Stack_same(it1->stack, it2->stack);
+}
+
+// Hands off half of the subtrees still to be visited. The new instance inherits the subtrees
+// handed off so far: after a to_begin its subtrees may contain them.
+DictionaryIterator* DictionaryIterator_split(DictionaryIterator* it) {
+  size_t num_subtrees = Stack_size(it->stack);
+  if(num_subtrees == 0) {
+    return NULL;
+  }
+
+  DictionaryIterator* result = (DictionaryIterator*) Mem_alloc(sizeof(struct _DictionaryIterator));
+  result->stack = Stack_new(MAX_STACK_SIZE);
+  result->start = Array_new_small((num_subtrees + 1) / 2);
+  result->handed_off = it->handed_off != NULL ? Array_dup(it->handed_off) : NULL;
+  if(it->handed_off == NULL) {
+    it->handed_off = Array_new_small(4);
+  }
+
+  for(size_t i = 0; i < (num_subtrees + 1) / 2; ++i) {
+    Node* subtree = Stack_pop(it->stack);
+    Array_add(result->start, subtree);
+    Array_add(it->handed_off, subtree);
+  }
+  DictionaryIterator_to_begin(result);
+
+  return result;
 }
 
 
@@ -42,9 +42,14 @@ int Stack_empty(Stack* stack) {
   return Array_empty(stack->array);
 }
 
+size_t Stack_size(Stack* stack) {
+  return Array_size(stack->array);
+}
+
 Stack* Stack_new(size_t capacity) {
   Stack* result = (Stack*) Mem_alloc(sizeof(struct _Stack));
-  result->array = Array_new(capacity);
+  // the first capacity elements share the allocation of the array header
+  result->array = Array_new_small(capacity);
   return result;
 }
 
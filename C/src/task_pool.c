@@ -0,0 +1,502 @@
+#include "task_pool.h"
+#include <Block.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "concurrent_queue.h"
+#include "errors.h"
+#include "mem.h"
+
+#define CACHE_LINE_SIZE 64
+
+// Initial capacity of the workers deques (they grow as needed)
+#define TASK_DEQUE_INITIAL_CAPACITY 256
+
+// Capacity of the queue holding the tasks spawned by threads outside the pool
+#define TASK_POOL_QUEUE_CAPACITY 4096
+
+// Number of failed attempts to find a task after which a thread parks
+#define TASK_POOL_SPINS 16
+
+// Number of ranges per worker parallel_for aims at when grain is not given
+#define PARALLEL_FOR_RANGES_PER_WORKER 8
+
+typedef struct _Task Task;
+
+struct _Task {
+  void (*run)(Task* task);
+  TaskGroup* group;
+
+  // task spawned by TaskGroup_spawn
+  void (^block)(void);
+
+  // range of a parallel_for
+  void (^body)(size_t, size_t);
+  size_t from;
+  size_t to;
+  size_t grain;
+};
+
+struct _TaskGroup {
+  TaskPool* pool;
+  _Atomic size_t pending;
+};
+
+// Buffers of the Chase-Lev deques. Buffers replaced when the deque grows may still be
+// read by concurrent thieves, they are kept (linked through previous) until the deque
+// is freed.
+typedef struct _TaskArray {
+  struct _TaskArray* previous;
+  size_t mask;
+  _Atomic(Task*) tasks[];
+} TaskArray;
+
+// Chase-Lev work-stealing deque as described in "Correct and Efficient Work-Stealing
+// for Weak Memory Models" (N. M. Le et al.). The owner pushes and takes at the bottom,
+// thieves steal at the top. top and bottom are kept on different cache lines.
+typedef struct {
+  _Atomic long top;
+  char padding0[CACHE_LINE_SIZE - sizeof(long)];
+
+  _Atomic long bottom;
+  _Atomic(TaskArray*) array;
+  char padding1[CACHE_LINE_SIZE - sizeof(long) - sizeof(TaskArray*)];
+} TaskDeque;
+
+typedef struct {
+  TaskPool* pool;
+  TaskDeque deque;
+  pthread_t thread;
+  // state of the generator used to choose the victims of steals
+  uint32_t seed;
+} TaskWorker;
+
+struct _TaskPool {
+  TaskWorker* workers;
+  size_t num_workers;
+  ConcurrentQueue* queue;
+  struct _TaskGroup group;
+
+  // Parking: epoch is incremented whenever something a parked thread may be waiting
+  // for happens (new tasks, groups completion, shutdown). A thread reads epoch before
+  // looking for work and parks only if epoch did not change in the meanwhile.
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  _Atomic size_t sleeping;
+  _Atomic uint64_t epoch;
+  _Atomic int shutdown;
+};
+
+// Worker run by the current thread (NULL if the thread does not belong to any pool)
+static _Thread_local TaskWorker* current_worker = NULL;
+
+
+/* --------------------------
+ * TaskDeque implementation
+ * -------------------------- */
+
+static TaskArray* TaskArray_new(size_t capacity, TaskArray* previous) {
+  TaskArray* array = (TaskArray*) Mem_alloc(sizeof(TaskArray) + sizeof(_Atomic(Task*)) * capacity);
+  array->previous = previous;
+  array->mask = capacity - 1;
+
+  return array;
+}
+
+static void TaskDeque_init(TaskDeque* deque) {
+  atomic_init(&deque->top, 0);
+  atomic_init(&deque->bottom, 0);
+  atomic_init(&deque->array, TaskArray_new(TASK_DEQUE_INITIAL_CAPACITY, NULL));
+}
+
+static void TaskDeque_destroy(TaskDeque* deque) {
+  TaskArray* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+  while(array != NULL) {
+    TaskArray* previous = array->previous;
+    Mem_free(array);
+    array = previous;
+  }
+}
+
+static TaskArray* TaskDeque_grow(TaskDeque* deque, TaskArray* array, long top, long bottom) {
+  TaskArray* new_array = TaskArray_new(2 * (array->mask + 1), array);
+  for(long i = top; i < bottom; ++i) {
+    Task* task = atomic_load_explicit(&array->tasks[(size_t) i & array->mask], memory_order_relaxed);
+    atomic_store_explicit(&new_array->tasks[(size_t) i & new_array->mask], task, memory_order_relaxed);
+  }
+
+  atomic_store_explicit(&deque->array, new_array, memory_order_release);
+  return new_array;
+}
+
+// Owner only
+static void TaskDeque_push(TaskDeque* deque, Task* task) {
+  long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+  long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+  TaskArray* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+
+  if((size_t) (bottom - top) > array->mask) {
+    array = TaskDeque_grow(deque, array, top, bottom);
+  }
+
+  atomic_store_explicit(&array->tasks[(size_t) bottom & array->mask], task, memory_order_relaxed);
+  // publishes the task to thieves (they load bottom with acquire semantics)
+  atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+}
+
+// Owner only: returns the most recently pushed task, NULL if the deque is empty
+static Task* TaskDeque_take(TaskDeque* deque) {
+  long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+  TaskArray* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+  atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+  if(top > bottom) {
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return NULL;
+  }
+
+  Task* task = atomic_load_explicit(&array->tasks[(size_t) bottom & array->mask], memory_order_relaxed);
+  if(top == bottom) {
+    // last task: races with thieves
+    if(!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+      task = NULL;
+    }
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+  }
+
+  return task;
+}
+
+// Any thread: returns the least recently pushed task, NULL if the deque is empty or if
+// the steal lost a race with another thread
+static Task* TaskDeque_steal(TaskDeque* deque) {
+  long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+  if(top >= bottom) {
+    return NULL;
+  }
+
+  TaskArray* array = atomic_load_explicit(&deque->array, memory_order_acquire);
+  Task* task = atomic_load_explicit(&array->tasks[(size_t) top & array->mask], memory_order_relaxed);
+  if(!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+    return NULL;
+  }
+
+  return task;
+}
+
+
+/* --------------------------
+ * Scheduling
+ * -------------------------- */
+
+static void TaskPool_notify(TaskPool* pool, int all) {
+  atomic_fetch_add(&pool->epoch, 1);
+  if(atomic_load(&pool->sleeping) == 0) {
+    return;
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+  if(all) {
+    pthread_cond_broadcast(&pool->cond);
+  } else {
+    pthread_cond_signal(&pool->cond);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+static void TaskPool_push(TaskPool* pool, Task* task) {
+  TaskWorker* worker = current_worker;
+  if(worker != NULL && worker->pool == pool) {
+    TaskDeque_push(&worker->deque, task);
+  } else {
+    ConcurrentQueue_enqueue(pool->queue, task);
+  }
+
+  TaskPool_notify(pool, 0);
+}
+
+static uint32_t TaskWorker_random(TaskWorker* worker) {
+  // xorshift32
+  uint32_t x = worker->seed;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  worker->seed = x;
+
+  return x;
+}
+
+// Looks for a task in the deque of the given worker (if any), in the pool queue and then
+// in the deques of the other workers.
+static Task* TaskPool_find_task(TaskPool* pool, TaskWorker* worker) {
+  Task* task = NULL;
+  if(worker != NULL) {
+    task = TaskDeque_take(&worker->deque);
+    if(task != NULL) {
+      return task;
+    }
+  }
+
+  void* queued;
+  if(ConcurrentQueue_try_dequeue(pool->queue, &queued)) {
+    return (Task*) queued;
+  }
+
+  size_t start = worker != NULL ? TaskWorker_random(worker) % pool->num_workers : 0;
+  for(size_t i = 0; i < pool->num_workers; ++i) {
+    TaskWorker* victim = &pool->workers[(start + i) % pool->num_workers];
+    if(victim != worker) {
+      task = TaskDeque_steal(&victim->deque);
+      if(task != NULL) {
+        return task;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+static void TaskPool_run(TaskPool* pool, Task* task) {
+  TaskGroup* group = task->group;
+  task->run(task);
+  Mem_free(task);
+
+  if(atomic_fetch_sub_explicit(&group->pending, 1, memory_order_acq_rel) == 1) {
+    // threads waiting for the group may be parked
+    TaskPool_notify(pool, 1);
+  }
+}
+
+static int TaskPool_should_stop(TaskPool* pool, TaskGroup* group) {
+  if(group != NULL) {
+    return atomic_load_explicit(&group->pending, memory_order_acquire) == 0;
+  }
+
+  return atomic_load(&pool->shutdown);
+}
+
+// Parks the calling thread unless the pool epoch changed since it has been read
+static void TaskPool_park(TaskPool* pool, TaskGroup* group, uint64_t epoch) {
+  pthread_mutex_lock(&pool->mutex);
+  atomic_fetch_add(&pool->sleeping, 1);
+
+  if(atomic_load(&pool->epoch) == epoch && !TaskPool_should_stop(pool, group)) {
+    pthread_cond_wait(&pool->cond, &pool->mutex);
+  }
+
+  atomic_fetch_sub(&pool->sleeping, 1);
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+// Runs tasks until all tasks of group completed or, if group is NULL, until the pool
+// is shut down.
+static void TaskPool_work(TaskPool* pool, TaskWorker* worker, TaskGroup* group) {
+  unsigned int attempts = 0;
+
+  while(!TaskPool_should_stop(pool, group)) {
+    uint64_t epoch = atomic_load(&pool->epoch);
+    Task* task = TaskPool_find_task(pool, worker);
+
+    if(task != NULL) {
+      TaskPool_run(pool, task);
+      attempts = 0;
+    } else if(++attempts < TASK_POOL_SPINS) {
+      sched_yield();
+    } else {
+      TaskPool_park(pool, group, epoch);
+      attempts = 0;
+    }
+  }
+}
+
+static void* TaskWorker_main(void* arg) {
+  TaskWorker* worker = (TaskWorker*) arg;
+  current_worker = worker;
+  TaskPool_work(worker->pool, worker, NULL);
+
+  return NULL;
+}
+
+static Task* Task_new(TaskGroup* group, void (*run)(Task*)) {
+  Task* task = (Task*) Mem_alloc(sizeof(Task));
+  task->run = run;
+  task->group = group;
+  task->block = NULL;
+  task->body = NULL;
+
+  atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+  return task;
+}
+
+
+/* --------------------------
+ * TaskPool implementation
+ * -------------------------- */
+
+static void TaskGroup_init(TaskGroup* group, TaskPool* pool) {
+  group->pool = pool;
+  atomic_init(&group->pending, 0);
+}
+
+TaskPool* TaskPool_new(size_t num_workers) {
+  if(num_workers == 0) {
+    long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    num_workers = num_processors > 0 ? (size_t) num_processors : 1;
+  }
+
+  TaskPool* pool = (TaskPool*) Mem_alloc(sizeof(struct _TaskPool));
+  pool->num_workers = num_workers;
+  pool->queue = ConcurrentQueue_new(TASK_POOL_QUEUE_CAPACITY);
+  TaskGroup_init(&pool->group, pool);
+
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->cond, NULL);
+  atomic_init(&pool->sleeping, 0);
+  atomic_init(&pool->epoch, 0);
+  atomic_init(&pool->shutdown, 0);
+
+  pool->workers = (TaskWorker*) Mem_alloc(sizeof(TaskWorker) * num_workers);
+  for(size_t i = 0; i < num_workers; ++i) {
+    pool->workers[i].pool = pool;
+    pool->workers[i].seed = (uint32_t) (2654435761u * (i + 1));
+    TaskDeque_init(&pool->workers[i].deque);
+  }
+
+  // workers are started once all deques are ready to be stolen from
+  for(size_t i = 0; i < num_workers; ++i) {
+    if(pthread_create(&pool->workers[i].thread, NULL, TaskWorker_main, &pool->workers[i]) != 0) {
+      Error_raise(Error_new(ERROR_GENERIC, "Cannot create the TaskPool worker threads"));
+    }
+  }
+
+  return pool;
+}
+
+void TaskPool_free(TaskPool* pool) {
+  TaskPool_wait(pool);
+
+  atomic_store(&pool->shutdown, 1);
+  TaskPool_notify(pool, 1);
+
+  for(size_t i = 0; i < pool->num_workers; ++i) {
+    pthread_join(pool->workers[i].thread, NULL);
+    TaskDeque_destroy(&pool->workers[i].deque);
+  }
+
+  pthread_cond_destroy(&pool->cond);
+  pthread_mutex_destroy(&pool->mutex);
+  ConcurrentQueue_free(pool->queue);
+  Mem_free(pool->workers);
+  Mem_free(pool);
+}
+
+size_t TaskPool_num_workers(TaskPool* pool) {
+  return pool->num_workers;
+}
+
+void TaskPool_spawn(TaskPool* pool, void (^task)(void)) {
+  TaskGroup_spawn(&pool->group, task);
+}
+
+void TaskPool_wait(TaskPool* pool) {
+  TaskGroup_wait(&pool->group);
+}
+
+
+/* --------------------------
+ * TaskGroup implementation
+ * -------------------------- */
+
+TaskGroup* TaskGroup_new(TaskPool* pool) {
+  TaskGroup* group = (TaskGroup*) Mem_alloc(sizeof(struct _TaskGroup));
+  TaskGroup_init(group, pool);
+
+  return group;
+}
+
+void TaskGroup_free(TaskGroup* group) {
+  Mem_free(group);
+}
+
+static void Task_run_block(Task* task) {
+  task->block();
+  Block_release(task->block);
+}
+
+void TaskGroup_spawn(TaskGroup* group, void (^block)(void)) {
+  Task* task = Task_new(group, Task_run_block);
+  task->block = Block_copy(block);
+
+  TaskPool_push(group->pool, task);
+}
+
+void TaskGroup_wait(TaskGroup* group) {
+  TaskWorker* worker = current_worker;
+  if(worker != NULL && worker->pool != group->pool) {
+    worker = NULL;
+  }
+
+  TaskPool_work(group->pool, worker, group);
+
+  // the wake up that let this thread return may have been meant for a new task
+  if(atomic_load(&group->pool->sleeping) > 0) {
+    TaskPool_notify(group->pool, 0);
+  }
+}
+
+
+/* --------------------------
+ * parallel_for implementation
+ * -------------------------- */
+
+static void Task_run_range(Task* task);
+
+// Spawns the upper halves of [from, to) until the range is not larger than grain,
+// then processes what remains
+static void parallel_for_range(TaskGroup* group, void (^body)(size_t, size_t), size_t from, size_t to, size_t grain) {
+  while(to - from > grain) {
+    size_t middle = from + (to - from) / 2;
+
+    Task* task = Task_new(group, Task_run_range);
+    task->body = body;
+    task->from = middle;
+    task->to = to;
+    task->grain = grain;
+    TaskPool_push(group->pool, task);
+
+    to = middle;
+  }
+
+  body(from, to);
+}
+
+static void Task_run_range(Task* task) {
+  parallel_for_range(task->group, task->body, task->from, task->to, task->grain);
+}
+
+void parallel_for(TaskPool* pool, size_t n, size_t grain, void (^body)(size_t from, size_t to)) {
+  if(n == 0) {
+    return;
+  }
+
+  if(grain == 0) {
+    grain = n / (pool->num_workers * PARALLEL_FOR_RANGES_PER_WORKER);
+    if(grain == 0) {
+      grain = 1;
+    }
+  }
+
+  // body needs not to be copied: it is not used after parallel_for returns
+  struct _TaskGroup group;
+  TaskGroup_init(&group, pool);
+
+  parallel_for_range(&group, body, 0, n, grain);
+  TaskGroup_wait(&group);
+}
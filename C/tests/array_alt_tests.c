@@ -304,6 +304,53 @@ static void test_array_alt_add_records() {
   ArrayAlt_free(array);
 }
 
+static void test_array_alt_mmap_add_and_reopen() {
+  char path[] = "/tmp/array_alt_tests_XXXXXX";
+  close(mkstemp(path));
+
+  ArrayAlt* array = ArrayAlt_new_mmap(path, sizeof(int), 2);
+  assert_true(ArrayAlt_mapped(array));
+  ArrayAlt_advise(array, ARRAY_ALT_ADVICE_SEQUENTIAL);
+
+  for(int i=0; i<100; ++i) {
+    ArrayAlt_add(array, from_int(99 - i));
+  }
+
+  assert_equal(100l, ArrayAlt_size(array));
+  ArrayAlt_sort(array, compare_ints);
+  ArrayAlt_free(array);
+
+  array = ArrayAlt_open_mmap(path);
+  assert_true(ArrayAlt_mapped(array));
+  assert_equal(100l, ArrayAlt_size(array));
+  assert_equal((long) sizeof(int), ArrayAlt_elem_size(array));
+
+  for_each_with_index( ArrayAlt_it(array),  ^(void* elem, size_t index) {
+    assert_equal( (unsigned long) to_int(elem), index);
+  });
+
+  ArrayAlt_free(array);
+  unlink(path);
+}
+
+static void test_array_alt_mmap_dup_is_heap_backed() {
+  char path[] = "/tmp/array_alt_tests_XXXXXX";
+  close(mkstemp(path));
+
+  ArrayAlt* array = ArrayAlt_new_mmap(path, sizeof(int), 10);
+  ArrayAlt_add(array, from_int(1));
+  ArrayAlt_add(array, from_int(2));
+
+  ArrayAlt* dup = ArrayAlt_dup(array);
+  assert_false(ArrayAlt_mapped(dup));
+  assert_equal(2l, ArrayAlt_size(dup));
+  assert_equal32(2, to_int(ArrayAlt_at(dup, 1)));
+
+  ArrayAlt_free(dup);
+  ArrayAlt_free(array);
+  unlink(path);
+}
+
 
 int main() {
   start_tests("array");
@@ -327,6 +374,8 @@ int main() {
   test(test_array_alt_dup);
 
   test(test_array_alt_add_records);
+  test(test_array_alt_mmap_add_and_reopen);
+  test(test_array_alt_mmap_dup_is_heap_backed);
 
   end_tests();
 
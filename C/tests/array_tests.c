@@ -385,6 +385,41 @@ static void test_array_add_records() {
   free_fixtures(array);
 }
 
+static void test_array_small_spills_to_heap() {
+  Array* array = Array_new_small(4);
+  assert_equal(4l, Array_capacity(array));
+
+  void* inline_carray = Array_carray(array);
+  for(int i = 0; i < 4; ++i) {
+    Array_add(array, from_int(i));
+  }
+  assert_pointers_equal(inline_carray, Array_carray(array));
+
+  for(int i = 4; i < 20; ++i) {
+    Array_add(array, from_int(i));
+  }
+  assert_true(Array_carray(array) != inline_carray);
+  assert_equal(20l, Array_size(array));
+
+  for_each_with_index(Array_it(array), ^(void* elem, size_t index) {
+    assert_equal((long) to_int(elem), (long) index);
+  });
+
+  free_fixtures(array);
+}
+
+static void test_array_small_empty() {
+  Array* array = Array_new_small(0);
+  Array_add(array, from_int(1));
+  Array_insert(array, 0, from_int(0));
+
+  assert_equal(2l, Array_size(array));
+  assert_equal(0l, (long) to_int(Array_at(array, 0)));
+  assert_equal(1l, (long) to_int(Array_at(array, 1)));
+
+  free_fixtures(array);
+}
+
 
 int main() {
   start_tests("array");
@@ -409,6 +444,8 @@ int main() {
   test(test_array_foreach_reverse);
   test(test_array_foreach_with_index);
   test(test_array_dup);
+  test(test_array_small_spills_to_heap);
+  test(test_array_small_empty);
 
   test(test_array_add_records);
 
@@ -0,0 +1,114 @@
+#include "unit_testing.h"
+#include "array.h"
+#include "array_alt.h"
+#include "array_view.h"
+#include "errors.h"
+#include "iterator_functions.h"
+
+static Array* build_fixtures() {
+  Array* array = Array_new(10);
+  long values[] = { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+  for(size_t i = 0; i < 10; ++i) {
+    Array_add(array, (void*) values[i]);
+  }
+
+  return array;
+}
+
+static int compare_longs(const void* lhs, const void* rhs) {
+  long l = (long) lhs;
+  long r = (long) rhs;
+  return (l > r) - (l < r);
+}
+
+static void test_array_slice_at_and_set() {
+  Array* array = build_fixtures();
+  ArrayView view = Array_slice(array, 2, 5);
+
+  assert_equal(3l, ArrayView_size(&view));
+  assert_pointers_equal((void*) 7l, ArrayView_at(&view, 0));
+  assert_pointers_equal((void*) 5l, ArrayView_at(&view, 2));
+
+  ArrayView_set(&view, 1, (void*) 42l);
+  assert_pointers_equal((void*) 42l, Array_at(array, 3));
+
+  assert_exits_with_code(ArrayView_at(&view, 3), ERROR_INDEX_OUT_OF_BOUND);
+  assert_exits_with_code(Array_slice(array, 5, 11), ERROR_INDEX_OUT_OF_BOUND);
+  assert_exits_with_code(Array_slice(array, 6, 5), ERROR_INDEX_OUT_OF_BOUND);
+
+  Array_free(array);
+}
+
+static void test_array_slice_sort_in_place() {
+  Array* array = build_fixtures();
+  ArrayView view = Array_slice(array, 3, 8);
+
+  sort(ArrayView_it(&view), ^(const void* lhs, const void* rhs) {
+    return compare_longs(lhs, rhs);
+  });
+
+  long expected_array[] = { 9, 8, 7, 2, 3, 4, 5, 6, 1, 0 };
+  long* expected = expected_array;
+  for_each_with_index(Array_it(array), ^(void* elem, size_t index) {
+    assert_pointers_equal((void*) expected[index], elem);
+  });
+
+  size_t index = binsearch(ArrayView_it(&view), (void*) 5l, ^(const void* lhs, const void* rhs) {
+    return compare_longs(lhs, rhs);
+  });
+  assert_equal(3l, index);
+
+  Array_free(array);
+}
+
+static void test_array_slice_reverse_contents() {
+  Array* array = build_fixtures();
+  ArrayView view = Array_slice(array, 0, 4);
+  ArrayView inner = ArrayView_slice(&view, 1, 3);
+
+  reverse_contents(ArrayView_it(&inner));
+
+  long expected_array[] = { 9, 7, 8, 6, 5, 4, 3, 2, 1, 0 };
+  long* expected = expected_array;
+  for_each_with_index(Array_it(array), ^(void* elem, size_t index) {
+    assert_pointers_equal((void*) expected[index], elem);
+  });
+
+  Array_free(array);
+}
+
+static void test_array_alt_slice() {
+  ArrayAlt* array = ArrayAlt_new(10, sizeof(int));
+  for(int i = 9; i >= 0; --i) {
+    ArrayAlt_add(array, &i);
+  }
+
+  ArrayView view = ArrayAlt_slice(array, 5, 10);
+  assert_equal(5l, ArrayView_size(&view));
+  assert_equal32(4, *(int*) ArrayView_at(&view, 0));
+
+  sort(ArrayView_it(&view), ^(const void* lhs, const void* rhs) {
+    return *(const int*) lhs - *(const int*) rhs;
+  });
+
+  for(size_t i = 0; i < 5; ++i) {
+    assert_equal32(9 - (int) i, *(int*) ArrayAlt_at(array, i));
+    assert_equal32((int) i, *(int*) ArrayAlt_at(array, i + 5));
+  }
+
+  int value = 42;
+  ArrayView_set(&view, 0, &value);
+  assert_equal32(42, *(int*) ArrayAlt_at(array, 5));
+
+  ArrayAlt_free(array);
+}
+
+int main() {
+  start_tests("ArrayView");
+  test(test_array_slice_at_and_set);
+  test(test_array_slice_sort_in_place);
+  test(test_array_slice_reverse_contents);
+  test(test_array_alt_slice);
+  end_tests();
+  return 0;
+}
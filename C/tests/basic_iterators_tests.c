@@ -32,6 +32,35 @@ static void test_file_iterator() {
   Array_free(array_with_fcontents);
 }
 
+// Small buffers make the records span two or more buffers, the last one has no delimiter
+static void test_file_async_iterator() {
+  char fname_template[] = "/tmp/basic_iterators_tempfile.XXXXXX";
+  int fd = mkstemp(fname_template);
+  FILE* file = fdopen(fd, "w");
+  fprintf(file, "test\nof\n\nasync file iterator\n with a long record spanning buffers\nlast");
+  fclose(file);
+
+  Array* expected = map(TextFile_it(fname_template, '\n'), ^(void* obj) {
+    return (void*) Mem_strdup((const char*) obj);
+  });
+  assert_equal(6l, (long) Array_size(expected));
+
+  size_t buffer_sizes[] = { 1, 3, 7, 4096, 0 };
+  for(size_t i = 0; i < 5; ++i) {
+    __block size_t num_records = 0;
+    for_each_with_index(TextFileAsync_it(fname_template, '\n', buffer_sizes[i]), ^(void* obj, size_t index) {
+      assert_string_equal((const char*) Array_at(expected, index), (const char*) obj);
+      num_records++;
+    });
+
+    assert_equal(6l, (long) num_records);
+  }
+
+  free_contents(Array_it(expected));
+  Array_free(expected);
+  remove(fname_template);
+}
+
 static void test_char_iterator_reverse() {
   char* string = Mem_strdup("boon");
   char* reversed = "noob";
@@ -137,6 +166,7 @@ int main() {
 
   test(test_int_iterator);
   test(test_file_iterator);
+  test(test_file_async_iterator);
   test(test_char_iterator_reverse);
   test(test_char_iterator_sort);
   test(test_carray_iterator);
@@ -0,0 +1,127 @@
+#include "unit_testing.h"
+#include "bitset.h"
+#include "errors.h"
+#include "basic_iterators.h"
+#include "iterator_functions.h"
+
+static void test_bitset_set_test_clear() {
+  Bitset* bitset = Bitset_new(130);
+  assert_equal(130l, Bitset_size(bitset));
+  assert_true(Bitset_empty(bitset));
+
+  Bitset_set(bitset, 0);
+  Bitset_set(bitset, 63);
+  Bitset_set(bitset, 64);
+  Bitset_set(bitset, 129);
+
+  assert_true(Bitset_test(bitset, 0));
+  assert_true(Bitset_test(bitset, 63));
+  assert_true(Bitset_test(bitset, 64));
+  assert_true(Bitset_test(bitset, 129));
+  assert_false(Bitset_test(bitset, 1));
+  assert_false(Bitset_test(bitset, 128));
+  assert_equal(4l, Bitset_count(bitset));
+
+  Bitset_clear(bitset, 63);
+  assert_false(Bitset_test(bitset, 63));
+  assert_equal(3l, Bitset_count(bitset));
+
+  assert_exits_with_code(Bitset_set(bitset, 130), ERROR_INDEX_OUT_OF_BOUND);
+
+  Bitset_free(bitset);
+}
+
+static void test_bitset_set_all_and_clear_all() {
+  Bitset* bitset = Bitset_new(70);
+  Bitset_set_all(bitset);
+  assert_equal(70l, Bitset_count(bitset));
+  assert_equal(69l, Bitset_next_set(bitset, 69));
+  assert_equal((long) -1, (long) Bitset_next_set(bitset, 70));
+
+  Bitset_clear_all(bitset);
+  assert_true(Bitset_empty(bitset));
+
+  Bitset_free(bitset);
+}
+
+static void test_bitset_next_set() {
+  Bitset* bitset = Bitset_new(300);
+  Bitset_set(bitset, 5);
+  Bitset_set(bitset, 200);
+
+  assert_equal(5l, Bitset_next_set(bitset, 0));
+  assert_equal(5l, Bitset_next_set(bitset, 5));
+  assert_equal(200l, Bitset_next_set(bitset, 6));
+  assert_equal((long) -1, (long) Bitset_next_set(bitset, 201));
+
+  Bitset_free(bitset);
+}
+
+static void test_bitset_bulk_operations() {
+  Bitset* lhs = Bitset_new(100);
+  Bitset* rhs = Bitset_new(100);
+  for(size_t i = 0; i < 100; i += 2) {
+    Bitset_set(lhs, i);
+  }
+  for(size_t i = 0; i < 100; i += 3) {
+    Bitset_set(rhs, i);
+  }
+
+  Bitset* result = Bitset_dup(lhs);
+  Bitset_and(result, rhs);
+  assert_equal(17l, Bitset_count(result)); // multiples of 6 in [0,99]
+  Bitset_free(result);
+
+  result = Bitset_dup(lhs);
+  Bitset_or(result, rhs);
+  assert_equal(67l, Bitset_count(result)); // 50 + 34 - 17
+  Bitset_free(result);
+
+  result = Bitset_dup(lhs);
+  Bitset_andnot(result, rhs);
+  assert_equal(33l, Bitset_count(result)); // 50 - 17
+  Bitset_free(result);
+
+  result = Bitset_dup(lhs);
+  Bitset_xor(result, rhs);
+  assert_equal(50l, Bitset_count(result)); // 67 - 17
+  Bitset_free(result);
+
+  Bitset* other = Bitset_new(10);
+  assert_exits_with_code(Bitset_or(lhs, other), ERROR_GENERIC);
+  Bitset_free(other);
+
+  Bitset_free(lhs);
+  Bitset_free(rhs);
+}
+
+static void test_bitset_iterator() {
+  Bitset* bitset = Bitset_new(1000);
+  Bitset_set(bitset, 1);
+  Bitset_set(bitset, 64);
+  Bitset_set(bitset, 999);
+
+  assert_equal(3l, count(Bitset_it(bitset)));
+
+  size_t expected_array[] = { 1, 64, 999 };
+  size_t* expected = expected_array;
+  for_each_with_index(Bitset_it(bitset), ^(void* obj, size_t index) {
+    assert_equal(expected[index], UNUM(obj));
+  });
+
+  Bitset_clear_all(bitset);
+  assert_equal(0l, count(Bitset_it(bitset)));
+
+  Bitset_free(bitset);
+}
+
+int main() {
+  start_tests("Bitset");
+  test(test_bitset_set_test_clear);
+  test(test_bitset_set_all_and_clear_all);
+  test(test_bitset_next_set);
+  test(test_bitset_bulk_operations);
+  test(test_bitset_iterator);
+  end_tests();
+  return 0;
+}
@@ -0,0 +1,229 @@
+#include <pthread.h>
+#include <unistd.h>
+
+#include "unit_testing.h"
+#include "concurrent_queue.h"
+#include "mem.h"
+
+#define PRODUCED_PER_THREAD 100000l
+#define NUM_THREADS 4
+
+static void test_concurrent_queue_try_operations() {
+  ConcurrentQueue* queue = ConcurrentQueue_new(3);
+  assert_equal(4l, ConcurrentQueue_capacity(queue));
+
+  void* result = NULL;
+  assert_false(ConcurrentQueue_try_dequeue(queue, &result));
+
+  for(long i = 0; i < 4; ++i) {
+    assert_true(ConcurrentQueue_try_enqueue(queue, (void*) i));
+  }
+  assert_false(ConcurrentQueue_try_enqueue(queue, (void*) 4l));
+  assert_equal(4l, ConcurrentQueue_size(queue));
+
+  for(long i = 0; i < 4; ++i) {
+    assert_true(ConcurrentQueue_try_dequeue(queue, &result));
+    assert_pointers_equal((void*) i, result);
+  }
+  assert_equal(0l, ConcurrentQueue_size(queue));
+
+  ConcurrentQueue_free(queue);
+}
+
+static void test_concurrent_queue_batch_operations() {
+  ConcurrentQueue* queue = ConcurrentQueue_new(4);
+  void* elems[] = { "a", "b", "c", "d", "e", "f" };
+  void* result[6];
+
+  assert_equal(4l, ConcurrentQueue_try_enqueue_many(queue, elems, 6));
+  assert_equal(3l, ConcurrentQueue_try_dequeue_many(queue, result, 3));
+  assert_string_equal("a", (char*) result[0]);
+  assert_string_equal("c", (char*) result[2]);
+
+  // wrapping around the ring
+  ConcurrentQueue_enqueue_many(queue, elems + 4, 2);
+  assert_equal(3l, ConcurrentQueue_dequeue_many(queue, result, 6));
+  assert_string_equal("d", (char*) result[0]);
+  assert_string_equal("f", (char*) result[2]);
+
+  ConcurrentQueue_free(queue);
+}
+
+static void test_concurrent_queue_close() {
+  ConcurrentQueue* queue = ConcurrentQueue_new(4);
+  void* result = NULL;
+
+  ConcurrentQueue_enqueue(queue, "a");
+  ConcurrentQueue_close(queue);
+  assert_true(ConcurrentQueue_closed(queue));
+
+  assert_true(ConcurrentQueue_dequeue(queue, &result));
+  assert_string_equal("a", (char*) result);
+  assert_false(ConcurrentQueue_dequeue(queue, &result));
+
+  ConcurrentQueue_free(queue);
+}
+
+typedef struct {
+  ConcurrentQueue* queue;
+  long id;
+  long sum;
+} ThreadInfo;
+
+static void* producer(void* arg) {
+  ThreadInfo* info = (ThreadInfo*) arg;
+  for(long i = 1; i <= PRODUCED_PER_THREAD; ++i) {
+    ConcurrentQueue_enqueue(info->queue, (void*) (info->id * PRODUCED_PER_THREAD + i));
+  }
+
+  return NULL;
+}
+
+// Enqueues the same objects as producer, in batches of 8
+static void* batch_producer(void* arg) {
+  ThreadInfo* info = (ThreadInfo*) arg;
+  void* batch[8];
+
+  for(long i = 1; i <= PRODUCED_PER_THREAD; i += 8) {
+    size_t count = 0;
+    for(long j = i; j < i + 8 && j <= PRODUCED_PER_THREAD; ++j) {
+      batch[count++] = (void*) (info->id * PRODUCED_PER_THREAD + j);
+    }
+    ConcurrentQueue_enqueue_many(info->queue, batch, count);
+  }
+
+  return NULL;
+}
+
+static void* consumer(void* arg) {
+  ThreadInfo* info = (ThreadInfo*) arg;
+  void* result[16];
+  size_t count;
+
+  while((count = ConcurrentQueue_dequeue_many(info->queue, result, 16)) > 0) {
+    for(size_t i = 0; i < count; ++i) {
+      info->sum += (long) result[i];
+    }
+  }
+
+  return NULL;
+}
+
+static void check_multiple_producers_and_consumers(void* (*produce)(void*)) {
+  ConcurrentQueue* queue = ConcurrentQueue_new(64);
+  pthread_t producers[NUM_THREADS];
+  pthread_t consumers[NUM_THREADS];
+  ThreadInfo producers_info[NUM_THREADS];
+  ThreadInfo consumers_info[NUM_THREADS];
+
+  for(long i = 0; i < NUM_THREADS; ++i) {
+    producers_info[i] = (ThreadInfo) { queue, i, 0 };
+    consumers_info[i] = (ThreadInfo) { queue, i, 0 };
+    pthread_create(&producers[i], NULL, produce, &producers_info[i]);
+    pthread_create(&consumers[i], NULL, consumer, &consumers_info[i]);
+  }
+
+  for(long i = 0; i < NUM_THREADS; ++i) {
+    pthread_join(producers[i], NULL);
+  }
+  ConcurrentQueue_close(queue);
+
+  long sum = 0;
+  for(long i = 0; i < NUM_THREADS; ++i) {
+    pthread_join(consumers[i], NULL);
+    sum += consumers_info[i].sum;
+  }
+
+  // each producer enqueues id * P + 1 ... id * P + P
+  long expected = 0;
+  for(long id = 0; id < NUM_THREADS; ++id) {
+    expected += id * PRODUCED_PER_THREAD * PRODUCED_PER_THREAD + PRODUCED_PER_THREAD * (PRODUCED_PER_THREAD + 1) / 2;
+  }
+
+  assert_equal(expected, sum);
+  ConcurrentQueue_free(queue);
+}
+
+static void test_concurrent_queue_multiple_producers_and_consumers() {
+  check_multiple_producers_and_consumers(producer);
+}
+
+static void test_concurrent_queue_multiple_batch_producers_and_consumers() {
+  check_multiple_producers_and_consumers(batch_producer);
+}
+
+static void* dequeue_one(void* arg) {
+  ThreadInfo* info = (ThreadInfo*) arg;
+  void* result = NULL;
+
+  if(ConcurrentQueue_dequeue(info->queue, &result)) {
+    info->sum = (long) result;
+  } else {
+    info->sum = -1;
+  }
+
+  return NULL;
+}
+
+// The consumers wait long enough to park on the condition variable, they need to be woken up
+// by the producer and by close
+static void test_concurrent_queue_parked_consumers() {
+  ConcurrentQueue* queue = ConcurrentQueue_new(4);
+  ThreadInfo info = { queue, 0, 0 };
+  pthread_t thread;
+
+  pthread_create(&thread, NULL, dequeue_one, &info);
+  usleep(100000);
+  ConcurrentQueue_enqueue(queue, (void*) 42l);
+  pthread_join(thread, NULL);
+  assert_equal(42l, info.sum);
+
+  pthread_create(&thread, NULL, dequeue_one, &info);
+  usleep(100000);
+  ConcurrentQueue_close(queue);
+  pthread_join(thread, NULL);
+  assert_equal(-1l, info.sum);
+
+  ConcurrentQueue_free(queue);
+}
+
+// Starts consuming only after the producer parked on the condition variable
+static void* delayed_consumer(void* arg) {
+  usleep(100000);
+  return consumer(arg);
+}
+
+// The batch is much larger than the queue: the parked producer and the consumer (which drains
+// the queue and parks in turn) must wake up each other every time a part of it is enqueued
+static void test_concurrent_queue_parked_batch_producer() {
+  ConcurrentQueue* queue = ConcurrentQueue_new(4);
+  ThreadInfo info = { queue, 0, 0 };
+  pthread_t thread;
+  void** batch = (void**) Mem_alloc(sizeof(void*) * PRODUCED_PER_THREAD);
+
+  for(long i = 0; i < PRODUCED_PER_THREAD; ++i) {
+    batch[i] = (void*) (i + 1);
+  }
+
+  pthread_create(&thread, NULL, delayed_consumer, &info);
+  ConcurrentQueue_enqueue_many(queue, batch, PRODUCED_PER_THREAD);
+  ConcurrentQueue_close(queue);
+  pthread_join(thread, NULL);
+  assert_equal(PRODUCED_PER_THREAD * (PRODUCED_PER_THREAD + 1) / 2, info.sum);
+
+  Mem_free(batch);
+  ConcurrentQueue_free(queue);
+}
+
+int main() {
+  start_tests("ConcurrentQueue");
+  test(test_concurrent_queue_try_operations);
+  test(test_concurrent_queue_batch_operations);
+  test(test_concurrent_queue_close);
+  test(test_concurrent_queue_multiple_producers_and_consumers);
+  test(test_concurrent_queue_multiple_batch_producers_and_consumers);
+  test(test_concurrent_queue_parked_consumers);
+  test(test_concurrent_queue_parked_batch_producer);
+  end_tests();
+  return 0;
+}
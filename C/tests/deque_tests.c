@@ -0,0 +1,112 @@
+#include "unit_testing.h"
+#include "deque.h"
+#include "iterator_functions.h"
+
+static void test_deque_push_and_pop() {
+  Deque* deque = Deque_new(4);
+  assert_true(Deque_empty(deque));
+  assert_pointers_equal(NULL, Deque_pop_front(deque));
+  assert_pointers_equal(NULL, Deque_pop_back(deque));
+
+  Deque_push_back(deque, "b");
+  Deque_push_front(deque, "a");
+  Deque_push_back(deque, "c");
+
+  assert_equal(3l, Deque_size(deque));
+  assert_string_equal("a", (char*) Deque_front(deque));
+  assert_string_equal("c", (char*) Deque_back(deque));
+
+  assert_string_equal("a", (char*) Deque_pop_front(deque));
+  assert_string_equal("c", (char*) Deque_pop_back(deque));
+  assert_string_equal("b", (char*) Deque_pop_front(deque));
+  assert_true(Deque_empty(deque));
+
+  Deque_free(deque);
+}
+
+static void test_deque_growth_keeps_order() {
+  Deque* deque = Deque_new(2);
+
+  // forces the ring to wrap around before each reallocation
+  for(long i = 0; i < 100; ++i) {
+    if(i % 2 == 0) {
+      Deque_push_front(deque, (void*) (-i));
+    } else {
+      Deque_push_back(deque, (void*) (i));
+    }
+  }
+
+  assert_equal(100l, Deque_size(deque));
+  assert_true(Deque_capacity(deque) >= 100);
+
+  long previous = -1000;
+  for(size_t i = 0; i < Deque_size(deque); ++i) {
+    void* elem = Deque_at(deque, i);
+    long current = (long) elem;
+    assert_true(previous < current);
+    previous = current;
+  }
+
+  Deque_free(deque);
+}
+
+static void test_deque_insert_and_remove() {
+  Deque* deque = Deque_new(4);
+  for(long i = 0; i < 10; ++i) {
+    Deque_push_back(deque, (void*) (i * 10));
+  }
+
+  Deque_insert(deque, 2, (void*) 15l);  // front half
+  Deque_insert(deque, 9, (void*) 75l);  // back half
+  Deque_insert(deque, 12, (void*) 95l); // at the end
+
+  long expected[] = { 0, 10, 15, 20, 30, 40, 50, 60, 70, 75, 80, 90, 95 };
+  assert_equal(13l, Deque_size(deque));
+  for(size_t i = 0; i < 13; ++i) {
+    assert_pointers_equal((void*) expected[i], Deque_at(deque, i));
+  }
+
+  Deque_remove(deque, 2);
+  Deque_remove(deque, 8);
+  Deque_remove(deque, 10);
+  Deque_remove(deque, 0);
+
+  long expected_after_remove[] = { 10, 20, 30, 40, 50, 60, 70, 80, 90 };
+  assert_equal(9l, Deque_size(deque));
+  for(size_t i = 0; i < 9; ++i) {
+    assert_pointers_equal((void*) expected_after_remove[i], Deque_at(deque, i));
+  }
+
+  Deque_free(deque);
+}
+
+static void test_deque_iterator() {
+  Deque* deque = Deque_new(4);
+  for(long i = 0; i < 10; ++i) {
+    Deque_push_front(deque, (void*) (i));
+  }
+
+  assert_equal(10l, count(Deque_it(deque)));
+  assert_pointers_equal((void*) 9l, first(Deque_it(deque)));
+  assert_pointers_equal((void*) 0l, last(Deque_it(deque)));
+
+  sort(Deque_it(deque), ^(const void* lhs, const void* rhs) {
+    return (int) ((long) lhs - (long) rhs);
+  });
+
+  for(size_t i = 0; i < 10; ++i) {
+    assert_pointers_equal((void*) i, Deque_at(deque, i));
+  }
+
+  Deque_free(deque);
+}
+
+int main() {
+  start_tests("Deque");
+  test(test_deque_push_and_pop);
+  test(test_deque_growth_keeps_order);
+  test(test_deque_insert_and_remove);
+  test(test_deque_iterator);
+  end_tests();
+  return 0;
+}
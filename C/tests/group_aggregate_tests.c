@@ -0,0 +1,162 @@
+#include "unit_testing.h"
+#include "group_aggregate.h"
+#include "iterator_functions.h"
+#include "array.h"
+#include "list.h"
+#include "keys.h"
+#include "macros.h"
+#include "mem.h"
+
+#define NUM_ELEMENTS 10000
+#define NUM_GROUPS 2000
+
+typedef struct {
+  char* name;
+  double value;
+} Measure;
+
+typedef struct {
+  long count;
+  double sum;
+} Average;
+
+static int groups[NUM_GROUPS];
+
+// Element i has value i and belongs to group i % NUM_GROUPS
+static Array* build_fixtures() {
+  Array* array = Array_new(NUM_ELEMENTS);
+  for(long i = 0; i < NUM_ELEMENTS; ++i) {
+    Array_add(array, (void*) i);
+  }
+
+  for(int i = 0; i < NUM_GROUPS; ++i) {
+    groups[i] = i;
+  }
+
+  return array;
+}
+
+// Counts are stored in the aggregate pointers. There are more groups than slots in the table of
+// recent keys, so that aggregates are written back to the dictionary and read again.
+static void test_count() {
+  Array* array = build_fixtures();
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+
+  Dictionary* counts = group_aggregate(Array_it(array), ^void*(void* elem) {
+    return &groups[(long) elem % NUM_GROUPS];
+  }, key_info, ^void*(UNUSED(void* key)) {
+    return (void*) 0l;
+  }, ^void*(void* count, UNUSED(void* elem)) {
+    return (void*) ((long) count + 1);
+  });
+
+  assert_equal((long) NUM_GROUPS, (long) Dictionary_size(counts));
+  for(int i = 0; i < NUM_GROUPS; ++i) {
+    void* count = NULL;
+    assert_true(Dictionary_get(counts, &i, &count));
+    assert_equal((long) NUM_ELEMENTS / NUM_GROUPS, (long) count);
+  }
+
+  Dictionary_free(counts);
+  KeyInfo_free(key_info);
+  Array_free(array);
+}
+
+// Averages of the values with the same name, aggregates are allocated by init_fn
+static void test_average() {
+  char* names[] = { "apple", "banana", "cherry" };
+  Measure measures[9];
+  List* list = List_new();
+  for(size_t i = 0; i < 9; ++i) {
+    measures[i].name = names[i % 3];
+    measures[i].value = (double) i;
+    List_append(list, &measures[i]);
+  }
+
+  KeyInfo* key_info = KeyInfo_new(Key_string_compare, Key_string_hash);
+  Dictionary* averages = group_aggregate(List_it(list), ^void*(void* elem) {
+    return ((Measure*) elem)->name;
+  }, key_info, ^void*(UNUSED(void* key)) {
+    return Mem_calloc(1, sizeof(Average));
+  }, ^void*(void* aggregate, void* elem) {
+    Average* average = (Average*) aggregate;
+    average->count += 1;
+    average->sum += ((Measure*) elem)->value;
+    return average;
+  });
+
+  assert_equal(3l, (long) Dictionary_size(averages));
+  for(size_t i = 0; i < 3; ++i) {
+    void* aggregate = NULL;
+    assert_true(Dictionary_get(averages, names[i], &aggregate));
+    Average* average = (Average*) aggregate;
+    assert_equal(3l, average->count);
+    assert_double_equal((double) i + 3.0, average->sum / (double) average->count, 0.0001);
+  }
+
+  for_each(Dictionary_it(averages), ^(void* elem) {
+    Mem_free(((KeyValue*) elem)->value);
+  });
+  Dictionary_free(averages);
+  KeyInfo_free(key_info);
+  List_free(list, NULL);
+}
+
+// Elements given to an aggregator are added to the aggregates already in the dictionary
+static void test_aggregator() {
+  build_fixtures();
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+  Dictionary* sums = Dictionary_new(key_info);
+  Dictionary_set(sums, &groups[1], (void*) 100l);
+
+  GroupAggregator* aggregator = GroupAggregator_new(sums, ^void*(void* elem) {
+    return &groups[(long) elem % 2];
+  }, ^void*(UNUSED(void* key)) {
+    return (void*) 0l;
+  }, ^void*(void* sum, void* elem) {
+    return (void*) ((long) sum + (long) elem);
+  });
+
+  for(long i = 0; i < 10; ++i) {
+    GroupAggregator_add(aggregator, (void*) i);
+  }
+  GroupAggregator_free(aggregator);
+
+  void* sum = NULL;
+  assert_true(Dictionary_get(sums, &groups[0], &sum));
+  assert_equal(20l, (long) sum);
+  assert_true(Dictionary_get(sums, &groups[1], &sum));
+  assert_equal(125l, (long) sum);
+
+  Dictionary_free(sums);
+  KeyInfo_free(key_info);
+}
+
+static void test_empty() {
+  Array* array = Array_new(1);
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+
+  Dictionary* counts = group_aggregate(Array_it(array), ^void*(void* elem) {
+    return elem;
+  }, key_info, ^void*(UNUSED(void* key)) {
+    return (void*) 0l;
+  }, ^void*(void* count, UNUSED(void* elem)) {
+    return (void*) ((long) count + 1);
+  });
+  assert_equal(0l, (long) Dictionary_size(counts));
+
+  Dictionary_free(counts);
+  KeyInfo_free(key_info);
+  Array_free(array);
+}
+
+int main() {
+  start_tests("group aggregate");
+  test(test_count);
+  test(test_average);
+  test(test_aggregator);
+  test(test_empty);
+  end_tests();
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+#include "unit_testing.h"
+#include <string.h>
+#include "hash_join.h"
+#include "iterator_functions.h"
+#include "basic_iterators.h"
+#include "array.h"
+#include "list.h"
+#include "keys.h"
+#include "macros.h"
+#include "mem.h"
+
+#define NUM_ELEMENTS 20000
+
+typedef struct {
+  int id;
+  int value;
+} Row;
+
+static Row* build_rows(size_t size, int num_ids) {
+  Row* rows = (Row*) Mem_alloc(sizeof(Row) * (size + 1));
+  for(size_t i = 0; i < size; ++i) {
+    rows[i].id = (int) ((i * 7919) % (size_t) num_ids);
+    rows[i].value = (int) i;
+  }
+
+  return rows;
+}
+
+static Array* rows_array(Row* rows, size_t size) {
+  Array* array = Array_new(size > 0 ? size : 1);
+  for(size_t i = 0; i < size; ++i) {
+    Array_add(array, &rows[i]);
+  }
+
+  return array;
+}
+
+static void* (^row_id)(void*) = ^void*(void* row) {
+  return &((Row*) row)->id;
+};
+
+// Number of pairs with the same id: the build side has num_build / num_ids rows per id (ids in
+// [0, num_ids)), the probe side one row per value in [0, 2 * num_ids)
+static void check_join(void (^join)(Iterator build, Iterator probe, void (^callback)(void* build_elem, void* probe_elem)), size_t num_build, int num_ids) {
+  Row* build_rows_ = build_rows(num_build, num_ids);
+  Row* probe_rows = build_rows((size_t) num_ids * 2, num_ids * 2);
+  Array* build = rows_array(build_rows_, num_build);
+  Array* probe = rows_array(probe_rows, (size_t) num_ids * 2);
+  int* matches = (int*) Mem_calloc((size_t) num_ids * 2, sizeof(int));
+
+  join(Array_it(build), Array_it(probe), ^(void* build_elem, void* probe_elem) {
+    Row* build_row = (Row*) build_elem;
+    Row* probe_row = (Row*) probe_elem;
+    assert_equal((long) build_row->id, (long) probe_row->id);
+    assert_true(build_row >= build_rows_ && build_row < build_rows_ + num_build);
+    matches[probe_row->id] += 1;
+  });
+
+  for(int id = 0; id < 2 * num_ids; ++id) {
+    assert_equal(id < num_ids ? (long) num_build / num_ids : 0l, (long) matches[id]);
+  }
+
+  Mem_free(matches);
+  Array_free(build);
+  Array_free(probe);
+  Mem_free(build_rows_);
+  Mem_free(probe_rows);
+}
+
+static void test_hash_join() {
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+  void (^join)(Iterator, Iterator, void (^)(void*, void*)) = ^(Iterator build, Iterator probe, void (^callback)(void*, void*)) {
+    hash_join(build, probe, key_info, row_id, row_id, callback);
+  };
+
+  check_join(join, NUM_ELEMENTS, NUM_ELEMENTS / 4);
+  // the probe side is smaller, the table is built on it
+  check_join(join, NUM_ELEMENTS, NUM_ELEMENTS / 100);
+  check_join(join, 0, 10);
+
+  KeyInfo_free(key_info);
+}
+
+static void test_radix_hash_join() {
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+  void (^join)(Iterator, Iterator, void (^)(void*, void*)) = ^(Iterator build, Iterator probe, void (^callback)(void*, void*)) {
+    radix_hash_join(build, probe, key_info, row_id, row_id, callback);
+  };
+
+  // several partitions
+  check_join(join, NUM_ELEMENTS * 2, NUM_ELEMENTS);
+  check_join(join, NUM_ELEMENTS, NUM_ELEMENTS / 100);
+  check_join(join, 0, 10);
+
+  KeyInfo_free(key_info);
+}
+
+// The probe side is read once, even if it does not provide random access, and the callbacks
+// are called in probe order
+static void test_hash_join_with_lists() {
+  char* words[] = { "apple", "banana", "cherry", "date" };
+  char** words_ptr = words;
+  Array* fruits = Array_new(4);
+  List* queries = List_new();
+  for(size_t i = 0; i < 4; ++i) {
+    Array_add(fruits, words[i]);
+  }
+  List_append(queries, "cherry");
+  List_append(queries, "kiwi");
+  List_append(queries, "apple");
+  List_append(queries, "cherry");
+
+  KeyInfo* key_info = KeyInfo_new(Key_string_compare, Key_string_hash);
+  char* expected[] = { "cherry", "apple", "cherry" };
+  char** expected_ptr = expected;
+  __block size_t num_matches = 0;
+
+  hash_join(Array_it(fruits), List_it(queries), key_info, ^void*(void* fruit) {
+    return fruit;
+  }, ^void*(void* query) {
+    return query;
+  }, ^(void* fruit, void* query) {
+    assert_equal(0l, (long) strcmp((char*) fruit, (char*) query));
+    assert_equal(0l, (long) strcmp(expected_ptr[num_matches], (char*) fruit));
+    num_matches += 1;
+  });
+  assert_equal(3l, (long) num_matches);
+
+  HashJoinTable* table = HashJoinTable_new(Array_it(fruits), key_info, ^void*(void* fruit) {
+    return fruit;
+  });
+  assert_equal(4l, (long) HashJoinTable_size(table));
+  assert_equal(1l, (long) HashJoinTable_probe(table, "date", NULL, ^(void* fruit, UNUSED(void* probe_elem)) {
+    assert_pointers_equal((void*) words_ptr[3], fruit);
+  }));
+  assert_equal(0l, (long) HashJoinTable_probe(table, "kiwi", NULL, ^(UNUSED(void* fruit), UNUSED(void* probe_elem)) {
+    assert_true(0);
+  }));
+  HashJoinTable_free(table);
+
+  KeyInfo_free(key_info);
+  List_free(queries, NULL);
+  Array_free(fruits);
+}
+
+int main() {
+  start_tests("hash join");
+  test(test_hash_join);
+  test(test_radix_hash_join);
+  test(test_hash_join_with_lists);
+  end_tests();
+
+  return 0;
+}
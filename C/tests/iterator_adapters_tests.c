@@ -0,0 +1,223 @@
+#include "unit_testing.h"
+#include "array.h"
+#include "array_view.h"
+#include "errors.h"
+#include "iterator_functions.h"
+#include "iterator_adapters.h"
+
+// Array containing the numbers 0, 1, ..., n-1 (stored as pointers)
+static Array* build_fixtures(size_t n) {
+  Array* array = Array_new(n > 0 ? n : 1);
+  for(size_t i = 0; i < n; ++i) {
+    Array_add(array, (void*) i);
+  }
+
+  return array;
+}
+
+// Stores the elements of it into a new Array (freeing the iterator)
+static Array* collect(Iterator it) {
+  return map(it, ^void*(void* elem) {
+    return elem;
+  });
+}
+
+static void test_map_and_filter() {
+  Array* array = build_fixtures(10);
+  __block long calls = 0;
+
+  Array* result = collect(map_it(filter_it(Array_it(array), ^int(void* elem) {
+      return (long) elem % 2 == 0;
+    }), ^void*(void* elem) {
+      calls += 1;
+      return (void*) ((long) elem * 10);
+    }));
+
+  assert_equal(5l, Array_size(result));
+  for(size_t i = 0; i < 5; ++i) {
+    assert_pointers_equal((void*) (i * 20), Array_at(result, i));
+  }
+  assert_equal(5l, calls);
+
+  Array_free(result);
+  Array_free(array);
+}
+
+static void test_filter_nothing_kept() {
+  Array* array = build_fixtures(10);
+
+  assert_equal(0l, count(filter_it(Array_it(array), ^int(void* elem) {
+    return (long) elem > 100;
+  })));
+
+  Array_free(array);
+}
+
+static void test_take_and_skip() {
+  Array* array = build_fixtures(10);
+
+  Array* result = collect(take_it(skip_it(Array_it(array), 3), 4));
+  assert_equal(4l, Array_size(result));
+  for(size_t i = 0; i < 4; ++i) {
+    assert_pointers_equal((void*) (i + 3), Array_at(result, i));
+  }
+  Array_free(result);
+
+  assert_equal(10l, count(take_it(Array_it(array), 20)));
+  assert_equal(0l, count(take_it(Array_it(array), 0)));
+  assert_equal(0l, count(skip_it(Array_it(array), 20)));
+
+  Array_free(array);
+}
+
+static void test_zip_and_enumerate() {
+  Array* array1 = build_fixtures(10);
+  Array* array2 = build_fixtures(5);
+  __block long num_pairs = 0;
+
+  for_each(zip_it(Array_it(array1), skip_it(Array_it(array2), 1)), ^(void* elem) {
+    ZipPair* pair = (ZipPair*) elem;
+    assert_equal((long) pair->first + 1, (long) pair->second);
+    num_pairs += 1;
+  });
+  assert_equal(4l, num_pairs);
+
+  __block size_t expected_index = 0;
+  for_each(enumerate_it(skip_it(Array_it(array1), 5)), ^(void* elem) {
+    Enumerated* enumerated = (Enumerated*) elem;
+    assert_equal((long) expected_index, (long) enumerated->index);
+    assert_equal((long) expected_index + 5, (long) enumerated->elem);
+    expected_index += 1;
+  });
+  assert_equal(5l, (long) expected_index);
+
+  Array_free(array1);
+  Array_free(array2);
+}
+
+static void test_chain() {
+  Array* array1 = build_fixtures(3);
+  Array* array2 = build_fixtures(0);
+  Array* array3 = build_fixtures(4);
+
+  Array* result = collect(chain_it(chain_it(Array_it(array1), Array_it(array2)), Array_it(array3)));
+  long expected[] = { 0, 1, 2, 0, 1, 2, 3 };
+  assert_equal(7l, Array_size(result));
+  for(size_t i = 0; i < 7; ++i) {
+    assert_pointers_equal((void*) expected[i], Array_at(result, i));
+  }
+
+  Array_free(result);
+  Array_free(array1);
+  Array_free(array2);
+  Array_free(array3);
+}
+
+static void test_chunk() {
+  Array* array = build_fixtures(10);
+  __block long num_chunks = 0;
+  __block long next_value = 0;
+
+  for_each(chunk_it(Array_it(array), 4), ^(void* elem) {
+    ArrayView* chunk = (ArrayView*) elem;
+    assert_equal(num_chunks < 2 ? 4l : 2l, (long) ArrayView_size(chunk));
+    for(size_t i = 0; i < ArrayView_size(chunk); ++i) {
+      assert_pointers_equal((void*) next_value++, ArrayView_at(chunk, i));
+    }
+    num_chunks += 1;
+  });
+  assert_equal(3l, num_chunks);
+
+  Array* empty = build_fixtures(0);
+  assert_equal(0l, count(chunk_it(Array_it(empty), 4)));
+  assert_exits_with_code(chunk_it(Array_it(array), 0), ERROR_GENERIC);
+
+  Array_free(empty);
+  Array_free(array);
+}
+
+static void test_window() {
+  Array* array = build_fixtures(10);
+  __block long num_windows = 0;
+
+  for_each(window_it(Array_it(array), 3), ^(void* elem) {
+    ArrayView* window = (ArrayView*) elem;
+    assert_equal(3l, (long) ArrayView_size(window));
+    for(size_t i = 0; i < 3; ++i) {
+      assert_pointers_equal((void*) (num_windows + (long) i), ArrayView_at(window, i));
+    }
+    num_windows += 1;
+  });
+  assert_equal(8l, num_windows);
+
+  assert_equal(10l, count(window_it(Array_it(array), 1)));
+  assert_equal(1l, count(window_it(Array_it(array), 10)));
+  assert_equal(0l, count(window_it(Array_it(array), 11)));
+  assert_exits_with_code(window_it(Array_it(array), 0), ERROR_GENERIC);
+
+  Array_free(array);
+}
+
+static void test_merge() {
+  Array* array = build_fixtures(100);
+  Array* empty = build_fixtures(0);
+  KIBlkComparator compare = ^(const void* lhs, const void* rhs) {
+    return ((long) lhs > (long) rhs) - ((long) lhs < (long) rhs);
+  };
+
+  // the numbers are split by their remainder modulo 3, merging the parts sorts them again
+  Iterator inputs[4];
+  for(long remainder = 0; remainder < 3; ++remainder) {
+    inputs[remainder] = filter_it(Array_it(array), ^int(void* elem) {
+      return (long) elem % 3 == remainder;
+    });
+  }
+  inputs[3] = Array_it(empty);
+
+  Array* result = collect(merge_it(inputs, 4, compare));
+  assert_equal(100l, Array_size(result));
+  for(size_t i = 0; i < 100; ++i) {
+    assert_pointers_equal((void*) i, Array_at(result, i));
+  }
+  Array_free(result);
+
+  // equal elements (same tens) are returned in the order of the inputs
+  Array* first = build_fixtures(0);
+  Array* second = build_fixtures(0);
+  Array_add(first, (void*) 10l);
+  Array_add(first, (void*) 20l);
+  Array_add(second, (void*) 11l);
+  Array_add(second, (void*) 21l);
+
+  Iterator pair[2] = { Array_it(second), Array_it(first) };
+  result = collect(merge_it(pair, 2, ^(const void* lhs, const void* rhs) {
+    return compare((void*) ((long) lhs / 10), (void*) ((long) rhs / 10));
+  }));
+  long expected[] = { 11, 10, 21, 20 };
+  for(size_t i = 0; i < 4; ++i) {
+    assert_pointers_equal((void*) expected[i], Array_at(result, i));
+  }
+  Array_free(result);
+
+  assert_equal(0l, count(merge_it(NULL, 0, compare)));
+
+  Array_free(first);
+  Array_free(second);
+  Array_free(empty);
+  Array_free(array);
+}
+
+int main() {
+  start_tests("iterator adapters");
+  test(test_map_and_filter);
+  test(test_filter_nothing_kept);
+  test(test_take_and_skip);
+  test(test_zip_and_enumerate);
+  test(test_chain);
+  test(test_chunk);
+  test(test_window);
+  test(test_merge);
+  end_tests();
+
+  return 0;
+}
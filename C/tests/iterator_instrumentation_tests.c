@@ -0,0 +1,127 @@
+// instrument_it is compiled in regardless of the flags in Makefile.vars
+#define ITERATOR_INSTRUMENTATION
+
+#include "unit_testing.h"
+#include "iterator_instrumentation.h"
+#include "iterator_functions.h"
+#include "iterator_adapters.h"
+#include "basic_iterators.h"
+#include "array.h"
+#include "list.h"
+#include "keys.h"
+#include "macros.h"
+#include "mem.h"
+
+#define NUM_ELEMENTS 1000
+
+static void test_counts() {
+  List* list = List_new();
+  for(long i = 0; i < NUM_ELEMENTS; ++i) {
+    List_append(list, (void*) i);
+  }
+
+  // for_each_with_index calls end, get and next on each element
+  __block long sum = 0;
+  for_each_with_index(instrument_it(List_it(list), "list"), ^(void* elem, UNUSED(size_t index)) {
+    sum += (long) elem;
+  });
+  assert_equal((long) NUM_ELEMENTS * (NUM_ELEMENTS - 1) / 2, sum);
+
+  IteratorStats stats;
+  assert_true(Instrumentation_stats("list", &stats));
+  assert_equal(1l, (long) stats.instances);
+  assert_equal((long) NUM_ELEMENTS, (long) stats.next_calls);
+  assert_equal((long) NUM_ELEMENTS, (long) stats.get_calls);
+  assert_equal((long) NUM_ELEMENTS, (long) stats.elements);
+  assert_true(stats.inside_seconds <= stats.lifetime_seconds);
+  assert_false(Instrumentation_stats("array", &stats));
+
+  // for_each reads batches of elements
+  for_each(instrument_it(List_it(list), "list"), ^(UNUSED(void* elem)) {});
+  assert_true(Instrumentation_stats("list", &stats));
+  assert_equal(2l, (long) stats.instances);
+  assert_equal((long) NUM_ELEMENTS, (long) stats.next_calls);
+  assert_equal(2l * NUM_ELEMENTS, (long) stats.elements);
+
+  Instrumentation_reset();
+  List_free(list, NULL);
+}
+
+// Instrumented iterators keep the traits of the source: for_each reads spans, sort and binsearch
+// use random access
+static void test_traits() {
+  Array* array = Array_new(NUM_ELEMENTS);
+  for(long i = 0; i < NUM_ELEMENTS; ++i) {
+    Array_add(array, (void*) (NUM_ELEMENTS - i - 1));
+  }
+
+  Iterator it = instrument_it(Array_it(array), "array");
+  assert_true(is_random_access_iterator(it));
+  assert_true(is_span_iterator(it));
+  assert_true(is_mutable_iterator(it));
+
+  KIBlkComparator compare = ^(const void* lhs, const void* rhs) {
+    return ((long) lhs > (long) rhs) - ((long) lhs < (long) rhs);
+  };
+  sort(it, compare);
+  assert_equal(123l, (long) binsearch(it, (void*) 123l, compare));
+
+  __block long count = 0;
+  for_each(it, ^(void* elem) {
+    assert_equal(count++, (long) elem);
+  });
+  assert_equal((long) NUM_ELEMENTS, count);
+
+  IteratorStats stats;
+  assert_true(Instrumentation_stats("array", &stats));
+  assert_true(stats.instances >= 3);
+  assert_true(stats.elements >= NUM_ELEMENTS);
+
+  Instrumentation_reset();
+  Array_free(array);
+}
+
+// Iterators instrumented with the same label add up, the stages of a pipeline are reported
+// separately
+static void test_labels() {
+  Array* array = Array_new(NUM_ELEMENTS);
+  for(long i = 0; i < NUM_ELEMENTS; ++i) {
+    Array_add(array, (void*) i);
+  }
+
+  for(size_t run = 0; run < 2; ++run) {
+    Iterator source = instrument_it(Array_it(array), "source");
+    Iterator even = instrument_it(filter_it(source, ^int(void* elem) {
+      return (long) elem % 2 == 0;
+    }), "even");
+
+    assert_equal((long) NUM_ELEMENTS / 2, (long) count(even));
+  }
+
+  IteratorStats stats;
+  assert_true(Instrumentation_stats("source", &stats));
+  assert_equal(2l, (long) stats.instances);
+  assert_equal(2l * NUM_ELEMENTS, (long) stats.elements);
+  assert_true(Instrumentation_stats("even", &stats));
+  assert_equal(2l, (long) stats.instances);
+  assert_equal((long) NUM_ELEMENTS, (long) stats.next_calls);
+
+  PrintTime* pt = PrintTime_new(NULL);
+  Instrumentation_print_report();
+  Instrumentation_save_report(pt);
+  PrintTime_free(pt);
+
+  Instrumentation_reset();
+  assert_false(Instrumentation_stats("source", &stats));
+  Array_free(array);
+}
+
+int main() {
+  start_tests("iterator instrumentation");
+  test(test_counts);
+  test(test_traits);
+  test(test_labels);
+  end_tests();
+
+  return 0;
+}
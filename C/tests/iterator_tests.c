@@ -5,7 +5,13 @@
 #include "double_container.h"
 #include "iterator_functions.h"
 #include "basic_iterators.h"
+#include "deque.h"
+#include "dictionary.h"
+#include "graph.h"
+#include "keys.h"
 #include "mem.h"
+#include "errors.h"
+#include <stdint.h>
 
 
 static int (^compare_dbl)(const void*, const void*) = ^(const void* lhs_obj, const void* rhs_obj) {
@@ -334,6 +340,365 @@ static void test_replace() {
   Mem_free(ch);
 }
 
+// Checks for_each, find_first, count, map and reduce on iterators over the numbers 0..99
+// (iterators are built by make_it since CArray_it iterators can be used only once)
+static void check_iteration_functions(Iterator (^make_it)(void), long (^value)(void*)) {
+  __block long expected = 0;
+  for_each(make_it(), ^(void* elem) {
+    assert_equal(expected++, value(elem));
+  });
+  assert_equal(100l, expected);
+
+  assert_equal(42l, value(find_first(make_it(), ^int(void* elem) { return value(elem) == 42; })));
+  assert_pointers_equal(NULL, find_first(make_it(), ^int(void* elem) { return value(elem) == 100; }));
+  assert_equal(100l, (long) count(make_it()));
+
+  // the search stops at the first match, even if it is the NULL pointer (element 0 of the
+  // pointer based iterators)
+  __block long visited = 0;
+  void* first = find_first(make_it(), ^int(void* elem) {
+    visited += 1;
+    return value(elem) % 90 == 0;
+  });
+  assert_equal(0l, value(first));
+  assert_equal(1l, visited);
+
+  Array* mapped = map(make_it(), ^void*(void* elem) { return (void*) (value(elem) * 2); });
+  assert_equal(100l, (long) Array_size(mapped));
+  assert_pointers_equal((void*) 198l, Array_at(mapped, 99));
+  Array_free(mapped);
+
+  void* sum = reduce(make_it(), (void*) 0l, ^void*(void* accumulator, void* elem) {
+    return (void*) ((long) accumulator + value(elem));
+  });
+  assert_equal(4950l, (long) sum);
+}
+
+static void test_spans_and_batches() {
+  long (^pointer_value)(void*) = ^long(void* elem) { return (long) elem; };
+  long (^int_value)(void*) = ^long(void* elem) { return *(int*) elem; };
+
+  Array* array = Array_new(100);
+  List* list = List_new();
+  Deque* deque = Deque_new(128);
+  int carray[100];
+  int* carray_ptr = carray;
+
+  // the deque wraps around its ring buffer, so that it is iterated using two spans
+  for(long i = 0; i < 100; ++i) {
+    Deque_push_back(deque, NULL);
+  }
+  for(long i = 0; i < 100; ++i) {
+    Deque_pop_front(deque);
+  }
+
+  for(long i = 0; i < 100; ++i) {
+    Array_add(array, (void*) i);
+    List_append(list, (void*) i);
+    Deque_push_back(deque, (void*) i);
+    carray[i] = (int) i;
+  }
+
+  assert_true(is_span_iterator(Array_it(array)));
+  assert_true(is_span_iterator(CArray_it(carray, 100, sizeof(int))));
+  assert_false(is_span_iterator(reverse(Array_it(array))));
+
+  check_iteration_functions(^{ return Array_it(array); }, pointer_value);
+  check_iteration_functions(^{ return List_it(list); }, pointer_value);
+  check_iteration_functions(^{ return Deque_it(deque); }, pointer_value);
+  check_iteration_functions(^{ return CArray_it(carray_ptr, 100, sizeof(int)); }, int_value);
+
+  // reversed iterators do not use spans
+  __block long expected = 99;
+  for_each(reverse(Deque_it(deque)), ^(void* elem) {
+    assert_equal(expected--, (long) elem);
+  });
+  assert_equal(-1l, expected);
+
+  Array_free(array);
+  List_free(list, NULL);
+  Deque_free(deque);
+}
+
+// Visits the current element of the given instance, then splits it as long as possible
+// visiting the parts recursively, and finally visits the elements it still has. Each part
+// is then visited a second time after moving it back to its beginning.
+static void visit_parts(Iterator it, void* iterator, void (^visit)(void* elem)) {
+  if(!it.end(iterator)) {
+    visit(it.get(iterator));
+    it.next(iterator);
+  }
+
+  void* part;
+  while((part = it.split(iterator)) != NULL) {
+    visit_parts(it, part, visit);
+  }
+
+  for(; !it.end(iterator); it.next(iterator)) {
+    visit(it.get(iterator));
+  }
+
+  for(it.to_begin(iterator); !it.end(iterator); it.next(iterator)) {
+    visit(it.get(iterator));
+  }
+
+  it.free(iterator);
+}
+
+// Checks that splitting visits each of the n elements exactly once and that to_begin
+// restarts each part from its own first element
+static void check_split(Iterator it, size_t n, size_t (^index)(void*)) {
+  assert_true(is_splittable_iterator(it));
+
+  int* visits = (int*) Mem_calloc(n, sizeof(int));
+  visit_parts(it, it.new_iterator(it.container), ^(void* elem) {
+    visits[index(elem)] += 1;
+  });
+
+  for(size_t i = 0; i < n; ++i) {
+    assert_equal(2l, (long) visits[i]);
+  }
+
+  Mem_free(visits);
+}
+
+static void test_split() {
+  int numbers[1000];
+  int* numbers_ptr = numbers;
+  for(int i = 0; i < 1000; ++i) {
+    numbers[i] = i;
+  }
+
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+  Dictionary* dictionary = Dictionary_new(key_info);
+  Graph* graph = Graph_new(key_info);
+  for(int i = 0; i < 1000; ++i) {
+    Dictionary_set(dictionary, &numbers[i], NULL);
+    Graph_add_vertex(graph, &numbers[i]);
+  }
+
+  // vertices with a multiple of 3 have no outgoing edges, the others have two
+  for(int i = 0; i < 1000; ++i) {
+    if(i % 3 != 0) {
+      Graph_add_edge(graph, &numbers[i], &numbers[(i + 1) % 1000], NULL);
+      Graph_add_edge(graph, &numbers[i], &numbers[(i * 7) % 1000], NULL);
+    }
+  }
+
+  check_split(Dictionary_key_it(dictionary), 1000, ^size_t(void* key) {
+    return (size_t) *(int*) key;
+  });
+
+  // edges are identified by their source and by whether the destination is the next vertex
+  check_split(Edge_it(graph), 2000, ^size_t(void* elem) {
+    EdgeInfo* edge = (EdgeInfo*) elem;
+    int source = *(int*) edge->source;
+    assert_true(source % 3 != 0);
+    return (size_t) (source * 2 + (edge->destination == &numbers_ptr[(source + 1) % 1000]));
+  });
+
+  // lines have different lengths and the last one is not terminated by the delimiter
+  char fname_template[] = "/tmp/iterator_tests_tempfile.XXXXXX";
+  FILE* file = fdopen(mkstemp(fname_template), "w");
+  for(int i = 0; i < 1000; ++i) {
+    fprintf(file, i < 999 ? "%d %.*s\n" : "%d %.*s", i, i % 13, "xxxxxxxxxxxxx");
+  }
+  fclose(file);
+
+  check_split(TextFile_it(fname_template, '\n'), 1000, ^size_t(void* line) {
+    return (size_t) atol((char*) line);
+  });
+  remove(fname_template);
+
+  Graph_free(graph);
+  Dictionary_free(dictionary);
+  KeyInfo_free(key_info);
+}
+
+static void test_inline_iterators() {
+  Array* array = Array_new(10);
+  List* list = List_new();
+  int carray[10];
+  for(long i = 0; i < 10; ++i) {
+    Array_add(array, (void*) i);
+    List_append(list, (void*) i);
+    carray[i] = (int) i;
+  }
+
+  Iterator inline_iterators[] = { Array_it(array), Number_it(10), CArray_it(carray, 10, sizeof(int)) };
+  for(size_t i = 0; i < 3; ++i) {
+    Iterator it = inline_iterators[i];
+    assert_true(is_inline_iterator(it));
+
+    // instances are placed in the given storage, as many as needed, heap allocated
+    // instances are still available (CArray_it frees its container with the last instance)
+    IteratorStorage storage1, storage2;
+    void* iterator1 = Iterator_new_instance(it, &storage1);
+    void* iterator2 = Iterator_new_instance(it, &storage2);
+    void* heap_iterator = it.new_iterator(it.container);
+    assert_pointers_equal((void*) &storage1, iterator1);
+    assert_pointers_equal((void*) &storage2, iterator2);
+
+    it.move_to(iterator2, 5);
+    assert_equal(10l, (long) it.size(iterator1));
+    assert_false(it.same(iterator1, iterator2));
+    assert_true(it.same(iterator1, heap_iterator));
+
+    Iterator_free_instance(it, iterator1);
+    Iterator_free_instance(it, iterator2);
+    it.free(heap_iterator);
+  }
+
+  IteratorStorage storage;
+  Iterator it = List_it(list);
+  assert_false(is_inline_iterator(it));
+  void* iterator = Iterator_new_instance(it, &storage);
+  assert_true(iterator != (void*) &storage);
+  assert_pointers_equal((void*) 0l, it.get(iterator));
+  Iterator_free_instance(it, iterator);
+
+  __block unsigned long sum = 0;
+  for_each(Number_it(10), ^(void* number) {
+    sum += UNUM(number);
+  });
+  assert_equal(45l, (long) sum);
+
+  Array_free(array);
+  List_free(list, NULL);
+}
+
+static int (^compare_longs)(const void*, const void*) = ^(const void* lhs, const void* rhs) {
+  return ((long) lhs > (long) rhs) - ((long) lhs < (long) rhs);
+};
+
+// 0..999 shuffled, with each value repeated twice
+static Array* build_shuffled_numbers() {
+  Array* array = Array_new(2000);
+  for(long i = 0; i < 2000; ++i) {
+    Array_add(array, (void*) ((i * 7919) % 1000));
+  }
+
+  return array;
+}
+
+static void test_top_k() {
+  Array* array = build_shuffled_numbers();
+
+  Array* smallest = top_k(Array_it(array), 10, compare_longs);
+  assert_equal(10l, (long) Array_size(smallest));
+  for_each_with_index(Array_it(smallest), ^(void* elem, size_t index) {
+    assert_equal((long) index / 2, (long) elem);
+  });
+  Array_free(smallest);
+
+  Array* largest = top_k(Array_it(array), 3, ^(const void* lhs, const void* rhs) {
+    return compare_longs(rhs, lhs);
+  });
+  long expected[] = { 999, 999, 998 };
+  long* expected_ptr = expected;
+  for_each_with_index(Array_it(largest), ^(void* elem, size_t index) {
+    assert_equal(expected_ptr[index], (long) elem);
+  });
+  Array_free(largest);
+
+  Array* all = top_k(Number_it(5), 10, compare_longs);
+  assert_equal(5l, (long) Array_size(all));
+  Array_free(all);
+
+  // the result is not allocated upfront for k elements
+  Array* huge_k = top_k(Array_it(array), SIZE_MAX / 16, compare_longs);
+  assert_equal((long) Array_size(array), (long) Array_size(huge_k));
+  Array_free(huge_k);
+
+  Array* none = top_k(Array_it(array), 0, compare_longs);
+  assert_equal(0l, (long) Array_size(none));
+  Array_free(none);
+
+  Array_free(array);
+}
+
+// TextFile_it reuses the memory of the lines it returns, the selected ones need to be copied
+static void test_top_k_copy() {
+  char fname_template[] = "/tmp/iterator_tests_tempfile.XXXXXX";
+  FILE* file = fdopen(mkstemp(fname_template), "w");
+  for(int i = 0; i < 1000; ++i) {
+    fprintf(file, "%03d\n", (i * 7919) % 1000);
+  }
+  fclose(file);
+
+  Array* lines = top_k_copy(TextFile_it(fname_template, '\n'), 5, ^(const void* lhs, const void* rhs) {
+    return Key_string_compare(rhs, lhs);
+  }, ^void*(void* line) {
+    return Mem_strdup((char*) line);
+  });
+  remove(fname_template);
+
+  const char* expected[] = { "999", "998", "997", "996", "995" };
+  assert_equal(5l, (long) Array_size(lines));
+  for(size_t i = 0; i < 5; ++i) {
+    assert_equal(0l, (long) strcmp(expected[i], (char*) Array_at(lines, i)));
+  }
+
+  free_contents(Array_it(lines));
+  Array_free(lines);
+}
+
+static void test_nth_element() {
+  Array* array = build_shuffled_numbers();
+  List* list = List_new();
+  for_each(Array_it(array), ^(void* elem) {
+    List_append(list, elem);
+  });
+
+  size_t positions[] = { 0, 1, 777, 1000, 1999 };
+  for(size_t i = 0; i < 5; ++i) {
+    size_t n = positions[i];
+    nth_element(Array_it(array), n, compare_longs);
+    nth_element(List_it(list), n, compare_longs);
+
+    void* nth_elem = Array_at(array, n);
+    long nth = (long) nth_elem;
+    assert_equal((long) n / 2, nth);
+    for_each_with_index(Array_it(array), ^(void* elem, size_t index) {
+      assert_true(index < n ? (long) elem <= nth : (long) elem >= nth);
+    });
+    for_each_with_index(List_it(list), ^(void* elem, size_t index) {
+      assert_true(index < n ? (long) elem <= nth : (long) elem >= nth);
+    });
+  }
+
+  assert_exits_with_code(nth_element(Array_it(array), 2000, compare_longs), ERROR_INDEX_OUT_OF_BOUND);
+
+  List_free(list, NULL);
+  Array_free(array);
+}
+
+static void test_partial_sort() {
+  Array* array = build_shuffled_numbers();
+  List* list = List_new();
+  for_each(Array_it(array), ^(void* elem) {
+    List_append(list, elem);
+  });
+
+  partial_sort(Array_it(array), 100, compare_longs);
+  partial_sort(List_it(list), 100, compare_longs);
+  for_each_with_index(Array_it(array), ^(void* elem, size_t index) {
+    assert_true(index < 100 ? (long) elem == (long) index / 2 : (long) elem >= 50);
+  });
+  for_each_with_index(List_it(list), ^(void* elem, size_t index) {
+    assert_true(index < 100 ? (long) elem == (long) index / 2 : (long) elem >= 50);
+  });
+
+  // a k larger than the number of elements sorts all of them
+  partial_sort(Array_it(array), 5000, compare_longs);
+  for_each_with_index(Array_it(array), ^(void* elem, size_t index) {
+    assert_equal((long) index / 2, (long) elem);
+  });
+
+  List_free(list, NULL);
+  Array_free(array);
+}
+
 int main() {
   start_tests("iterators");
   test(test_sort);
@@ -352,6 +717,13 @@ int main() {
   test(test_reverse);
   test(test_reverse_lists);
   test(test_replace);
+  test(test_spans_and_batches);
+  test(test_split);
+  test(test_inline_iterators);
+  test(test_top_k);
+  test(test_top_k_copy);
+  test(test_nth_element);
+  test(test_partial_sort);
   end_tests();
 
   return 0;
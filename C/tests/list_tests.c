@@ -122,6 +122,146 @@ static void test_list_foreach() {
   List_free(list, NULL);
 }
 
+static void test_list_many_insertions_and_deletions() {
+  List* list = List_new();
+
+  // deleted nodes are recycled by later insertions
+  for(long round = 0; round < 3; ++round) {
+    for(long i = 0; i < 1000; ++i) {
+      List_append(list, (void*) i);
+    }
+
+    for(long i = 0; i < 500; ++i) {
+      List_delete_node(list, List_head(list));
+    }
+  }
+
+  assert_equal(1500l, List_size(list));
+
+  long expected = 500;
+  ListIterator* it = ListIterator_new(list);
+  while(!ListIterator_end(it)) {
+    assert_pointers_equal((void*) expected, ListIterator_get(it));
+    expected = (expected + 1) % 1000;
+    ListIterator_next(it);
+  }
+  ListIterator_free(it);
+
+  List_free(list, NULL);
+}
+
+// Checks that the list holds 0, step, 2 * step, ... (size / step elements) in both directions
+static void check_list_multiples(List* list, long size, long step) {
+  assert_equal(size / step, (long) List_size(list));
+
+  long expected = 0;
+  for(ListNode* node = List_head(list); node != NULL; node = List_next(list, node)) {
+    assert_pointers_equal((void*) expected, ListNode_get(list, node));
+    expected += step;
+  }
+  assert_equal(size, expected);
+
+  expected = size - step;
+  for(ListNode* node = List_tail(list); node != NULL; node = List_prev(list, node)) {
+    assert_pointers_equal((void*) expected, ListNode_get(list, node));
+    expected -= step;
+  }
+}
+
+// Deletes nine elements out of ten from a list spanning many chunks of the unrolled
+// implementation, starting from the middle of the list, then packs the list
+static void test_list_delete_most_elements() {
+  List* list = List_new();
+  long size = 40 * 32;
+  for(long i = 0; i < size; ++i) {
+    List_append(list, (void*) i);
+  }
+
+  for(long k = 0; k < size; ++k) {
+    long target = (size / 2 + k) % size;
+    if(target % 10 == 0) {
+      continue;
+    }
+
+    ListNode* node = List_find_wb(list, ^(const void* elem) {
+      return (long) elem != target;
+    });
+    List_delete_node(list, node);
+  }
+  check_list_multiples(list, size, 10);
+
+  List_compact(list);
+  check_list_multiples(list, size, 10);
+
+  List_insert(list, (void*) -10l);
+  List_append(list, (void*) size);
+  assert_pointers_equal((void*) -10l, ListNode_get(list, List_head(list)));
+  assert_pointers_equal((void*) size, ListNode_get(list, List_tail(list)));
+  assert_equal(size / 10 + 2, (long) List_size(list));
+
+  List_free(list, NULL);
+}
+
+static int compare_first_char(const void* lhs, const void* rhs) {
+  return ((const char*) lhs)[0] - ((const char*) rhs)[0];
+}
+
+static void test_list_sort() {
+  List* list = build_fixtures();
+
+  List_sort(list, ^(const void* lhs, const void* rhs) {
+    return strcmp(lhs, rhs);
+  });
+
+  const char* expected[] = {"1", "11", "12", "21", "3", "4", "6", "81"};
+  ListNode* node = List_head(list);
+  for(size_t i = 0; i < 8; ++i) {
+    assert_string_equal(expected[i], (char*) ListNode_get(list, node));
+    node = List_next(list, node);
+  }
+  assert_true(node == NULL);
+  assert_string_equal("81", (char*) ListNode_get(list, List_tail(list)));
+
+  // the sort is stable: "1", "11" and "12" compare equal and keep their order
+  List_sort(list, ^(const void* lhs, const void* rhs) {
+    return compare_first_char(lhs, rhs);
+  });
+
+  assert_string_equal("1", (char*) ListNode_get(list, List_head(list)));
+  assert_string_equal("11", (char*) ListNode_get(list, List_next(list, List_head(list))));
+
+  List_free(list, NULL);
+}
+
+static void test_list_merge() {
+  List* lhs = List_new();
+  List* rhs = List_new();
+  for(long i = 0; i < 100; ++i) {
+    List_append(lhs, (void*) (2 * i));
+    List_append(rhs, (void*) (2 * i + 1));
+  }
+
+  List* dest = List_new();
+  List_merge(dest, lhs, rhs, ^(const void* a, const void* b) {
+    return (int) ((long) a - (long) b);
+  });
+
+  assert_equal(200l, List_size(dest));
+  assert_equal(0l, List_size(lhs));
+  assert_equal(0l, List_size(rhs));
+
+  long expected = 0;
+  for(ListNode* node = List_head(dest); node != NULL; node = List_next(dest, node)) {
+    assert_pointers_equal((void*) expected, ListNode_get(dest, node));
+    expected += 1;
+  }
+  assert_equal(200l, expected);
+
+  List_free(lhs, NULL);
+  List_free(rhs, NULL);
+  List_free(dest, NULL);
+}
+
 int main() {
   start_tests("lists");
   test(test_list_creation);
@@ -131,6 +271,10 @@ int main() {
   test(test_list_delete_node);
   test(test_list_free_with_delete_elem);
   test(test_list_foreach);
+  test(test_list_many_insertions_and_deletions);
+  test(test_list_delete_most_elements);
+  test(test_list_sort);
+  test(test_list_merge);
   // test(test_list_foreach_reverse);
   end_tests();
 
@@ -0,0 +1,214 @@
+#include <math.h>
+
+#include "unit_testing.h"
+#include "numeric_reductions.h"
+#include "basic_iterators.h"
+#include "array.h"
+#include "array_alt.h"
+#include "errors.h"
+#include "mem.h"
+
+// not a multiple of the SIMD widths, so that the scalar tails are exercised too
+#define NUM_ELEMENTS 1003
+
+// pseudo random values of both signs
+static int32_t int32_value(size_t i) {
+  return (int32_t) (uint32_t) (i * 2654435761u);
+}
+
+static void test_int32_reductions() {
+  int32_t* values = (int32_t*) Mem_alloc(sizeof(int32_t) * NUM_ELEMENTS);
+  int64_t sum = 0;
+  size_t argmin = 0;
+  size_t argmax = 0;
+
+  for(size_t i = 0; i < NUM_ELEMENTS; ++i) {
+    values[i] = int32_value(i);
+    sum += values[i];
+    argmin = values[i] < values[argmin] ? i : argmin;
+    argmax = values[i] > values[argmax] ? i : argmax;
+  }
+
+  for(size_t n = 1; n <= NUM_ELEMENTS; n += 97) {
+    int64_t partial_sum = 0;
+    for(size_t i = 0; i < n; ++i) {
+      partial_sum += values[i];
+    }
+    assert_equal(partial_sum, sum_int32(values, n));
+  }
+
+  assert_equal(sum, sum_int32(values, NUM_ELEMENTS));
+  assert_equal((long) values[argmin], (long) min_int32(values, NUM_ELEMENTS));
+  assert_equal((long) values[argmax], (long) max_int32(values, NUM_ELEMENTS));
+  assert_equal((long) argmin, (long) argmin_int32(values, NUM_ELEMENTS));
+  assert_equal((long) argmax, (long) argmax_int32(values, NUM_ELEMENTS));
+  assert_double_equal((double) sum / NUM_ELEMENTS, mean_int32(values, NUM_ELEMENTS), 1e-9);
+
+  assert_equal(sum, iterator_sum_int32(CArray_it(values, NUM_ELEMENTS, sizeof(int32_t))));
+  assert_equal((long) values[argmin], (long) iterator_min_int32(CArray_it(values, NUM_ELEMENTS, sizeof(int32_t))));
+  assert_equal((long) values[argmax], (long) iterator_max_int32(CArray_it(values, NUM_ELEMENTS, sizeof(int32_t))));
+  assert_equal((long) argmin, (long) iterator_argmin_int32(CArray_it(values, NUM_ELEMENTS, sizeof(int32_t))));
+  assert_equal((long) argmax, (long) iterator_argmax_int32(CArray_it(values, NUM_ELEMENTS, sizeof(int32_t))));
+
+  Mem_free(values);
+}
+
+static void test_int64_reductions() {
+  ArrayAlt* array = ArrayAlt_new(NUM_ELEMENTS, sizeof(int64_t));
+  int64_t sum = 0;
+  int64_t min = INT64_MAX;
+  int64_t max = INT64_MIN;
+
+  for(size_t i = 0; i < NUM_ELEMENTS; ++i) {
+    int64_t value = (int64_t) int32_value(i) * 4096 + (int64_t) i;
+    ArrayAlt_add(array, &value);
+    sum += value;
+    min = value < min ? value : min;
+    max = value > max ? value : max;
+  }
+
+  int64_t* values = (int64_t*) ArrayAlt_carray(array);
+  assert_equal(sum, sum_int64(values, NUM_ELEMENTS));
+  assert_equal(min, min_int64(values, NUM_ELEMENTS));
+  assert_equal(max, max_int64(values, NUM_ELEMENTS));
+  assert_equal(min, values[argmin_int64(values, NUM_ELEMENTS)]);
+  assert_equal(max, values[argmax_int64(values, NUM_ELEMENTS)]);
+
+  assert_equal(sum, iterator_sum_int64(ArrayAlt_it(array)));
+  assert_equal(min, iterator_min_int64(ArrayAlt_it(array)));
+  assert_equal(max, iterator_max_int64(ArrayAlt_it(array)));
+  assert_double_equal((double) sum / NUM_ELEMENTS, iterator_mean_int64(ArrayAlt_it(array)), 1e-6);
+
+  // sums wrap around on overflow
+  int64_t extremes[] = { INT64_MAX, 1, INT64_MAX, 1, INT64_MAX, 1 };
+  assert_equal((int64_t) ((uint64_t) INT64_MAX * 3 + 3), sum_int64(extremes, 6));
+
+  ArrayAlt_free(array);
+}
+
+static void test_floating_point_reductions() {
+  float* floats = (float*) Mem_alloc(sizeof(float) * NUM_ELEMENTS);
+  ArrayAlt* doubles = ArrayAlt_new(NUM_ELEMENTS, sizeof(double));
+
+  // the values are small multiples of 1/8, so that their sums are exact in any order
+  for(size_t i = 0; i < NUM_ELEMENTS; ++i) {
+    double value = (double) (int32_value(i) % 1000) / 8;
+    floats[i] = (float) value;
+    ArrayAlt_add(doubles, &value);
+  }
+  floats[517] = -1000;
+  floats[733] = 1000;
+  double* values = (double*) ArrayAlt_carray(doubles);
+  values[101] = -1000;
+  values[907] = 1000;
+
+  double sum = 0;
+  for(size_t i = 0; i < NUM_ELEMENTS; ++i) {
+    sum += values[i];
+  }
+
+  assert_double_equal(sum, sum_double(values, NUM_ELEMENTS), 1e-9);
+  assert_double_equal(sum, iterator_sum_double(ArrayAlt_it(doubles)), 1e-9);
+  assert_double_equal(sum / NUM_ELEMENTS, iterator_mean_double(ArrayAlt_it(doubles)), 1e-9);
+  assert_double_equal(-1000.0, min_double(values, NUM_ELEMENTS), 0);
+  assert_double_equal(1000.0, iterator_max_double(ArrayAlt_it(doubles)), 0);
+  assert_equal(101l, (long) argmin_double(values, NUM_ELEMENTS));
+  assert_equal(907l, (long) iterator_argmax_double(ArrayAlt_it(doubles)));
+
+  assert_double_equal(-1000.0, (double) min_float(floats, NUM_ELEMENTS), 0);
+  assert_double_equal(1000.0, (double) iterator_max_float(CArray_it(floats, NUM_ELEMENTS, sizeof(float))), 0);
+  assert_equal(517l, (long) iterator_argmin_float(CArray_it(floats, NUM_ELEMENTS, sizeof(float))));
+  assert_equal(733l, (long) argmax_float(floats, NUM_ELEMENTS));
+
+  // ties are resolved in favour of the first index
+  float ties[] = { 3, 1, 2, 1, 3, 1 };
+  assert_equal(1l, (long) argmin_float(ties, 6));
+  assert_equal(0l, (long) argmax_float(ties, 6));
+
+  Mem_free(floats);
+  ArrayAlt_free(doubles);
+}
+
+static void test_prefix_sums() {
+  int32_t* values = (int32_t*) Mem_alloc(sizeof(int32_t) * NUM_ELEMENTS);
+  int32_t* result = (int32_t*) Mem_alloc(sizeof(int32_t) * NUM_ELEMENTS);
+  double* doubles = (double*) Mem_alloc(sizeof(double) * NUM_ELEMENTS);
+  double* double_result = (double*) Mem_alloc(sizeof(double) * NUM_ELEMENTS);
+
+  for(size_t i = 0; i < NUM_ELEMENTS; ++i) {
+    values[i] = (int32_t) (i % 17) - 8;
+    doubles[i] = (double) i / 4;
+  }
+
+  prefix_sum_int32(values, result, NUM_ELEMENTS);
+  iterator_prefix_sum_double(CArray_it(doubles, NUM_ELEMENTS, sizeof(double)), double_result);
+
+  int32_t running = 0;
+  double double_running = 0;
+  for(size_t i = 0; i < NUM_ELEMENTS; ++i) {
+    running += values[i];
+    double_running += doubles[i];
+    assert_equal((long) running, (long) result[i]);
+    assert_double_equal(double_running, double_result[i], 1e-9);
+  }
+
+  // in place
+  prefix_sum_int32(values, values, NUM_ELEMENTS);
+  for(size_t i = 0; i < NUM_ELEMENTS; ++i) {
+    assert_equal((long) result[i], (long) values[i]);
+  }
+
+  Mem_free(values);
+  Mem_free(result);
+  Mem_free(doubles);
+  Mem_free(double_result);
+}
+
+static void test_histograms() {
+  int32_t values[] = { 0, 1, 9, 10, 25, 99, 100, -1, 101, 50 };
+  size_t bins[10] = { 0 };
+
+  histogram_int32(values, 10, 0, 100, bins, 10);
+  size_t expected[10] = { 3, 1, 1, 0, 0, 1, 0, 0, 0, 2 };
+  for(size_t i = 0; i < 10; ++i) {
+    assert_equal((long) expected[i], (long) bins[i]);
+  }
+
+  // counts are added to the given bins
+  iterator_histogram_int32(CArray_it(values, 10, sizeof(int32_t)), 0, 100, bins, 10);
+  assert_equal(6l, (long) bins[0]);
+  assert_equal(4l, (long) bins[9]);
+
+  assert_exits_with_code(histogram_int32(values, 10, 100, 100, bins, 10), ERROR_GENERIC);
+  assert_exits_with_code(histogram_int32(values, 10, 0, 100, bins, 0), ERROR_GENERIC);
+}
+
+static void test_errors() {
+  double values[] = { 1, 2, 3 };
+  Array* array = Array_new(4);
+  Array_add(array, values);
+
+  assert_exits_with_code(min_double(values, 0), ERROR_INDEX_OUT_OF_BOUND);
+  assert_exits_with_code(mean_double(values, 0), ERROR_INDEX_OUT_OF_BOUND);
+  assert_exits_with_code(iterator_argmax_double(CArray_it(values, 0, sizeof(double))), ERROR_INDEX_OUT_OF_BOUND);
+
+  // pointers are not numbers, the sizes of the elements need to match
+  assert_exits_with_code(iterator_sum_double(Array_it(array)), ERROR_ITERATOR_MISUSE);
+  assert_exits_with_code(iterator_sum_float(CArray_it(values, 3, sizeof(double))), ERROR_ITERATOR_MISUSE);
+  assert_exits_with_code(iterator_sum_int64(Number_it(3)), ERROR_ITERATOR_MISUSE);
+
+  Array_free(array);
+}
+
+int main() {
+  start_tests("numeric reductions");
+  test(test_int32_reductions);
+  test(test_int64_reductions);
+  test(test_floating_point_reductions);
+  test(test_prefix_sums);
+  test(test_histograms);
+  test(test_errors);
+  end_tests();
+
+  return 0;
+}
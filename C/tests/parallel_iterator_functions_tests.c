@@ -0,0 +1,272 @@
+#include "unit_testing.h"
+#include <stdatomic.h>
+#include "parallel_iterator_functions.h"
+#include "iterator_functions.h"
+#include "basic_iterators.h"
+#include "array_alt.h"
+#include "list.h"
+#include "dictionary.h"
+#include "keys.h"
+#include "errors.h"
+#include "macros.h"
+#include "mem.h"
+
+#define NUM_WORKERS 4
+#define NUM_ELEMENTS 10000
+
+static Array* build_fixtures() {
+  Array* array = Array_new(NUM_ELEMENTS);
+  for(long i = 0; i < NUM_ELEMENTS; ++i) {
+    Array_add(array, (void*) i);
+  }
+
+  return array;
+}
+
+static void test_par_for_each() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  ArrayAlt* visits = ArrayAlt_new(NUM_ELEMENTS, sizeof(int));
+  int zero = 0;
+  for(long i = 0; i < NUM_ELEMENTS; ++i) {
+    ArrayAlt_add(visits, &zero);
+  }
+
+  for(size_t grain = 0; grain < 1000; grain = grain * 10 + 1) {
+    par_for_each(pool, ArrayAlt_it(visits), grain, ^(void* elem) {
+      *(int*) elem += 1;
+    });
+  }
+
+  // each element is visited exactly once for each grain (0, 1, 11, 111)
+  for_each(ArrayAlt_it(visits), ^(void* elem) {
+    assert_equal(4l, (long) *(int*) elem);
+  });
+
+  ArrayAlt_free(visits);
+  TaskPool_free(pool);
+}
+
+static void test_par_map() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  Array* array = build_fixtures();
+
+  for(size_t grain = 0; grain < 1000; grain = grain * 10 + 1) {
+    Array* result = par_map(pool, Array_it(array), grain, ^void*(void* elem) {
+      return (void*) ((long) elem * 2);
+    });
+
+    assert_equal((long) NUM_ELEMENTS, (long) Array_size(result));
+    for(size_t i = 0; i < NUM_ELEMENTS; ++i) {
+      assert_pointers_equal((void*) (i * 2), Array_at(result, i));
+    }
+
+    Array_free(result);
+  }
+
+  Array* empty = Array_new(1);
+  Array* result = par_map(pool, Array_it(empty), 0, ^void*(void* elem) {
+    return elem;
+  });
+  assert_equal(0l, (long) Array_size(result));
+
+  Array_free(result);
+  Array_free(empty);
+  Array_free(array);
+  TaskPool_free(pool);
+}
+
+static void test_par_filter_preserves_order() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  Array* array = build_fixtures();
+
+  for(size_t grain = 0; grain < 1000; grain = grain * 10 + 1) {
+    Array* result = par_filter(pool, Array_it(array), grain, ^int(void* elem) {
+      return (long) elem % 3 == 0;
+    });
+
+    assert_equal((long) (NUM_ELEMENTS + 2) / 3, (long) Array_size(result));
+    for(size_t i = 0; i < Array_size(result); ++i) {
+      assert_pointers_equal((void*) (i * 3), Array_at(result, i));
+    }
+
+    Array_free(result);
+  }
+
+  Array_free(array);
+  TaskPool_free(pool);
+}
+
+static void test_par_reduce_and_count_over_numbers() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+
+  void* sum = par_reduce(pool, Number_it(NUM_ELEMENTS), 0, (void*) 0l, ^void*(void* lhs, void* rhs) {
+    return (void*) ((long) lhs + (long) rhs);
+  });
+  assert_equal((long) NUM_ELEMENTS * (NUM_ELEMENTS - 1) / 2, (long) sum);
+
+  // Number_it returns pointers to the numbers, the mapping dereferences them
+  Array* numbers = par_map(pool, Number_it(NUM_ELEMENTS), 7, ^void*(void* elem) {
+    return (void*) UNUM(elem);
+  });
+  assert_pointers_equal((void*) 1234l, Array_at(numbers, 1234));
+  Array_free(numbers);
+
+  size_t count = par_count(pool, Number_it(NUM_ELEMENTS), 13, ^int(void* elem) {
+    return UNUM(elem) % 2 == 0;
+  });
+  assert_equal((long) NUM_ELEMENTS / 2, (long) count);
+
+  TaskPool_free(pool);
+}
+
+static void test_par_reduce_is_ordered() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  Array* array = build_fixtures();
+
+  // keeps the last element: associative, not commutative
+  void* last_elem = par_reduce(pool, Array_it(array), 3, NULL, ^void*(void* lhs, void* rhs) {
+    return rhs != NULL ? rhs : lhs;
+  });
+  assert_pointers_equal((void*) (NUM_ELEMENTS - 1l), last_elem);
+
+  Array_free(array);
+  TaskPool_free(pool);
+}
+
+static void test_par_functions_over_splittable_iterators() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+  Dictionary* dictionary = Dictionary_new(key_info);
+  int* numbers = (int*) Mem_alloc(sizeof(int) * NUM_ELEMENTS);
+  int* visits = (int*) Mem_calloc(NUM_ELEMENTS, sizeof(int));
+
+  for(int i = 0; i < NUM_ELEMENTS; ++i) {
+    numbers[i] = i;
+    Dictionary_set(dictionary, &numbers[i], NULL);
+  }
+
+  par_for_each(pool, Dictionary_key_it(dictionary), 0, ^(void* key) {
+    visits[*(int*) key] += 1;
+  });
+  for(size_t i = 0; i < NUM_ELEMENTS; ++i) {
+    assert_equal(1l, (long) visits[i]);
+  }
+
+  size_t count = par_count(pool, Dictionary_key_it(dictionary), 0, ^int(void* key) {
+    return *(int*) key % 2 == 0;
+  });
+  assert_equal((long) NUM_ELEMENTS / 2, (long) count);
+
+  Dictionary_free(dictionary);
+  KeyInfo_free(key_info);
+  Mem_free(numbers);
+  Mem_free(visits);
+  TaskPool_free(pool);
+}
+
+// Sums the elements by their remainder modulo 100, for several grains (and so several partial
+// dictionaries to be merged)
+static void test_par_group_aggregate() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  Array* array = build_fixtures();
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+  int* remainders = (int*) Mem_alloc(sizeof(int) * 100);
+  for(int i = 0; i < 100; ++i) {
+    remainders[i] = i;
+  }
+
+  for(size_t grain = 0; grain < 1000; grain = grain * 10 + 1) {
+    Dictionary* sums = par_group_aggregate(pool, Array_it(array), grain, ^void*(void* elem) {
+      return &remainders[(long) elem % 100];
+    }, key_info, ^void*(UNUSED(void* key)) {
+      return (void*) 0l;
+    }, ^void*(void* sum, void* elem) {
+      return (void*) ((long) sum + (long) elem);
+    }, ^void*(void* sum, void* partial) {
+      return (void*) ((long) sum + (long) partial);
+    });
+
+    assert_equal(100l, (long) Dictionary_size(sums));
+    for(int i = 0; i < 100; ++i) {
+      void* sum = NULL;
+      assert_true(Dictionary_get(sums, &i, &sum));
+      // i + (i + 100) + ... + (i + NUM_ELEMENTS - 100)
+      long n = NUM_ELEMENTS / 100;
+      assert_equal(n * i + 100 * n * (n - 1) / 2, (long) sum);
+    }
+
+    Dictionary_free(sums);
+  }
+
+  Mem_free(remainders);
+  KeyInfo_free(key_info);
+  Array_free(array);
+  TaskPool_free(pool);
+}
+
+// Joins the numbers in [0, NUM_ELEMENTS) with their remainders modulo 100: each remainder
+// matches NUM_ELEMENTS / 100 numbers
+static void test_par_hash_join() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  Array* array = build_fixtures();
+  KeyInfo* key_info = KeyInfo_new(Key_int_compare, Key_int_hash);
+  int* remainders = (int*) Mem_alloc(sizeof(int) * 100);
+  Array* remainders_array = Array_new(100);
+  for(int i = 0; i < 100; ++i) {
+    remainders[i] = i;
+    Array_add(remainders_array, &remainders[i]);
+  }
+
+  _Atomic long matches[100];
+  for(size_t i = 0; i < 100; ++i) {
+    atomic_init(&matches[i], 0);
+  }
+  _Atomic long* matches_ptr = matches;
+
+  par_hash_join(pool, Array_it(remainders_array), Array_it(array), 0, key_info, ^void*(void* remainder) {
+    return remainder;
+  }, ^void*(void* elem) {
+    return &remainders[(long) elem % 100];
+  }, ^(void* remainder, void* elem) {
+    assert_equal((long) *(int*) remainder, (long) elem % 100);
+    atomic_fetch_add(&matches_ptr[*(int*) remainder], 1);
+  });
+
+  for(size_t i = 0; i < 100; ++i) {
+    assert_equal((long) NUM_ELEMENTS / 100, atomic_load(&matches[i]));
+  }
+
+  Array_free(remainders_array);
+  Mem_free(remainders);
+  KeyInfo_free(key_info);
+  Array_free(array);
+  TaskPool_free(pool);
+}
+
+static void test_par_functions_require_random_access() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  List* list = List_new();
+
+  assert_exits_with_code(par_count(pool, List_it(list), 0, ^int(void* elem) {
+    return elem != NULL;
+  }), ERROR_ITERATOR_MISUSE);
+
+  List_free(list, NULL);
+  TaskPool_free(pool);
+}
+
+int main() {
+  start_tests("parallel iterator functions");
+  test(test_par_for_each);
+  test(test_par_map);
+  test(test_par_filter_preserves_order);
+  test(test_par_reduce_and_count_over_numbers);
+  test(test_par_reduce_is_ordered);
+  test(test_par_functions_over_splittable_iterators);
+  test(test_par_group_aggregate);
+  test(test_par_hash_join);
+  test(test_par_functions_require_random_access);
+  end_tests();
+
+  return 0;
+}
@@ -21,9 +21,63 @@ static void test_enqueue_and_dequeue() {
   Queue_free(q);
 }
 
+static void test_dequeue_from_empty_queue() {
+  Queue* q = Queue_new();
+  assert_pointers_equal(NULL, Queue_front(q));
+  assert_pointers_equal(NULL, Queue_dequeue(q));
+  Queue_free(q);
+}
+
+static void test_enqueue_and_dequeue_many_elements() {
+  Queue* q = Queue_new();
+
+  // interleaving enqueues and dequeues to make the buffer wrap around
+  long next_out = 0;
+  for(long i = 0; i < 1000; ++i) {
+    Queue_enqueue(q, (void*) i);
+    if(i % 3 == 0) {
+      assert_pointers_equal((void*) next_out++, Queue_dequeue(q));
+    }
+  }
+
+  while(!Queue_empty(q)) {
+    assert_pointers_equal((void*) next_out, Queue_front(q));
+    assert_pointers_equal((void*) next_out++, Queue_dequeue(q));
+  }
+
+  assert_equal(1000l, next_out);
+  Queue_free(q);
+}
+
+static void test_enqueue_many_and_dequeue_many() {
+  Queue* q = Queue_new();
+  void* elems[] = { "a", "b", "c", "d", "e" };
+  void* result[5];
+
+  Queue_enqueue(q, "z");
+  Queue_enqueue_many(q, elems, 5);
+  assert_equal(6l, Queue_size(q));
+
+  assert_equal(2l, Queue_dequeue_many(q, result, 2));
+  assert_string_equal("z", (char*) result[0]);
+  assert_string_equal("a", (char*) result[1]);
+
+  assert_equal(4l, Queue_dequeue_many(q, result, 5));
+  assert_string_equal("b", (char*) result[0]);
+  assert_string_equal("e", (char*) result[3]);
+
+  assert_true(Queue_empty(q));
+  assert_equal(0l, Queue_dequeue_many(q, result, 5));
+
+  Queue_free(q);
+}
+
 int main() {
   start_tests("Queue");
   test(test_enqueue_and_dequeue);
+  test(test_dequeue_from_empty_queue);
+  test(test_enqueue_and_dequeue_many_elements);
+  test(test_enqueue_many_and_dequeue_many);
   end_tests();
   return 0;
 }
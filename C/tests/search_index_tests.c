@@ -0,0 +1,120 @@
+#include "unit_testing.h"
+#include "search_index.h"
+#include "iterator_functions.h"
+#include "array.h"
+#include "array_alt.h"
+#include "list.h"
+#include "keys.h"
+#include "errors.h"
+
+#define NUM_ELEMENTS 1000
+
+static int compare_longs(const void* lhs, const void* rhs) {
+  long lhs_value = (long) lhs;
+  long rhs_value = (long) rhs;
+
+  return (lhs_value > rhs_value) - (lhs_value < rhs_value);
+}
+
+// Searches all the values in [-1, 2 * NUM_ELEMENTS + 1) among the even numbers in
+// [0, 2 * NUM_ELEMENTS) comparing the results with binsearch
+static void test_search_by_value() {
+  ArrayAlt* array = ArrayAlt_new(NUM_ELEMENTS, sizeof(int));
+  for(int i = 0; i < NUM_ELEMENTS; ++i) {
+    int value = i * 2;
+    ArrayAlt_add(array, &value);
+  }
+
+  KIBlkComparator compare = ^(const void* lhs, const void* rhs) {
+    return Key_int_compare(lhs, rhs);
+  };
+  SearchIndex* index = SearchIndex_new(ArrayAlt_it(array), compare);
+  assert_equal((long) NUM_ELEMENTS, (long) SearchIndex_size(index));
+
+  for(int value = -1; value < 2 * NUM_ELEMENTS + 1; ++value) {
+    size_t expected = binsearch(ArrayAlt_it(array), &value, compare);
+    assert_equal((long) expected, (long) SearchIndex_search(index, &value));
+
+    size_t lower_bound = (size_t) (value < 0 ? 0 : (value + 1) / 2);
+    assert_equal((long) lower_bound, (long) SearchIndex_lower_bound(index, &value));
+  }
+
+  int too_large = 2 * NUM_ELEMENTS;
+  assert_equal((long) NUM_ELEMENTS - 1, (long) SearchIndex_search_approx(index, &too_large));
+
+  SearchIndex_free(index);
+  ArrayAlt_free(array);
+}
+
+static void test_search_by_reference() {
+  Array* array = Array_new(NUM_ELEMENTS);
+  for(long i = 0; i < NUM_ELEMENTS; ++i) {
+    Array_add(array, (void*) (i * 3));
+  }
+
+  SearchIndex* index = SearchIndex_new(Array_it(array), ^(const void* lhs, const void* rhs) {
+    return compare_longs(lhs, rhs);
+  });
+
+  for(long value = 0; value < 3 * (NUM_ELEMENTS - 1); ++value) {
+    size_t position = SearchIndex_search(index, (void*) value);
+    if(value % 3 == 0) {
+      assert_equal(value / 3, (long) position);
+    } else {
+      assert_equal(-1l, (long) position);
+      assert_equal(value / 3 + 1, (long) SearchIndex_search_approx(index, (void*) value));
+    }
+  }
+
+  SearchIndex_free(index);
+  Array_free(array);
+}
+
+// List_it returns no spans: the index stores the elements returned by get
+static void test_search_over_list() {
+  List* list = List_new();
+  char* words[] = { "apple", "banana", "cherry", "date", "elderberry", "fig", "grape" };
+  for(size_t i = 0; i < 7; ++i) {
+    List_append(list, words[i]);
+  }
+
+  SearchIndex* index = SearchIndex_new(List_it(list), ^(const void* lhs, const void* rhs) {
+    return Key_string_compare(lhs, rhs);
+  });
+
+  for(size_t i = 0; i < 7; ++i) {
+    assert_equal((long) i, (long) SearchIndex_search(index, words[i]));
+  }
+  assert_equal(-1l, (long) SearchIndex_search(index, "coconut"));
+  assert_equal(3l, (long) SearchIndex_lower_bound(index, "coconut"));
+  assert_equal(7l, (long) SearchIndex_lower_bound(index, "kiwi"));
+
+  SearchIndex_free(index);
+  List_free(list, NULL);
+}
+
+static void test_empty_index() {
+  Array* array = Array_new(1);
+  SearchIndex* index = SearchIndex_new(Array_it(array), ^(const void* lhs, const void* rhs) {
+    return Key_string_compare(lhs, rhs);
+  });
+
+  assert_equal(0l, (long) SearchIndex_size(index));
+  assert_equal(-1l, (long) SearchIndex_search(index, "apple"));
+  assert_equal(0l, (long) SearchIndex_lower_bound(index, "apple"));
+  assert_exits_with_code(SearchIndex_search_approx(index, "apple"), ERROR_INDEX_OUT_OF_BOUND);
+
+  SearchIndex_free(index);
+  Array_free(array);
+}
+
+int main() {
+  start_tests("search index");
+  test(test_search_by_value);
+  test(test_search_by_reference);
+  test(test_search_over_list);
+  test(test_empty_index);
+  end_tests();
+
+  return 0;
+}
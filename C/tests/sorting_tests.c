@@ -6,6 +6,7 @@
 #include "insertion_sort.h"
 #include "unit_testing.h"
 #include "array_g.h"
+#include "mem.h"
 #include <stdio.h>
 
 void partition_3_way(void** array, size_t start, size_t end, size_t pivot_pos, size_t* p1, size_t* p2,  int (^compare)(const void*, const void*));
@@ -130,6 +131,71 @@ static void test_quick_sort_full_array() {
   }
 }
 
+// Large enough for the top levels to be partitioned in parallel
+#define PAR_SORT_SIZE 200000
+
+static void test_par_quick_sort_empty_array() {
+  TaskPool* pool = TaskPool_new(4);
+  par_quick_sort(pool, (void**) NULL, 0, compare);
+  TaskPool_free(pool);
+
+  assert(TRUE); // suffices that the algorithm terminates
+}
+
+static void test_par_quick_sort_full_array() {
+  TaskPool* pool = TaskPool_new(4);
+  long* a = (long*) Mem_alloc(sizeof(long) * PAR_SORT_SIZE);
+  long* b = (long*) Mem_alloc(sizeof(long) * PAR_SORT_SIZE);
+  for(int i = 0; i < PAR_SORT_SIZE; ++i) {
+    a[i] = b[i] = rand() % 1000;
+  }
+
+  par_quick_sort(pool, (void**) a, PAR_SORT_SIZE, compare);
+  quick_sort((void**) b, PAR_SORT_SIZE, compare);
+
+  for(int i = 0; i < PAR_SORT_SIZE; ++i) {
+    assert(a[i] == b[i]);
+  }
+
+  Mem_free(a);
+  Mem_free(b);
+  TaskPool_free(pool);
+}
+
+static void test_par_quick_sort_wb_full_array() {
+  TaskPool* pool = TaskPool_new(4);
+  long* a = (long*) Mem_alloc(sizeof(long) * PAR_SORT_SIZE);
+  for(int i = 0; i < PAR_SORT_SIZE; ++i) {
+    a[i] = PAR_SORT_SIZE - i;
+  }
+
+  par_quick_sort_wb(pool, (void**) a, PAR_SORT_SIZE, compare_wb);
+
+  for(int i = 0; i < PAR_SORT_SIZE; ++i) {
+    assert(a[i] == i + 1);
+  }
+
+  Mem_free(a);
+  TaskPool_free(pool);
+}
+
+static void test_par_quick_sort_g_full_array() {
+  TaskPool* pool = TaskPool_new(4);
+  int* a = (int*) Mem_alloc(sizeof(int) * PAR_SORT_SIZE);
+  for(int i = 0; i < PAR_SORT_SIZE; ++i) {
+    a[i] = rand() % PAR_SORT_SIZE;
+  }
+
+  par_quick_sort_g(pool, a, PAR_SORT_SIZE, sizeof(int), compare_g);
+
+  for(int i = 0; i < PAR_SORT_SIZE - 1; ++i) {
+    assert(a[i] <= a[i+1]);
+  }
+
+  Mem_free(a);
+  TaskPool_free(pool);
+}
+
 static void test_quick_sort_g_full_array() {
   int a[] = { 85, 91, 49, 16, 31, 26, 96, 83, 60, 80 };
   quick_sort_g((void*) a, 10, sizeof(int), compare_g);
@@ -289,6 +355,13 @@ int main() {
   test(test_quick_sort_g_full_array);
   end_tests();
 
+  start_tests("par_quick_sort");
+  test(test_par_quick_sort_empty_array);
+  test(test_par_quick_sort_full_array);
+  test(test_par_quick_sort_wb_full_array);
+  test(test_par_quick_sort_g_full_array);
+  end_tests();
+
   start_tests("array_g");
   test(test_array_g_swap_at);
   test(test_array_g_swap);
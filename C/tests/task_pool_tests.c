@@ -0,0 +1,107 @@
+#include <stdatomic.h>
+
+#include "unit_testing.h"
+#include "task_pool.h"
+#include "mem.h"
+
+#define NUM_WORKERS 4
+
+static void test_task_pool_spawn() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  assert_equal((long) NUM_WORKERS, TaskPool_num_workers(pool));
+
+  _Atomic long count = 0;
+  _Atomic long* count_ptr = &count;
+
+  for(long i = 0; i < 1000; ++i) {
+    TaskPool_spawn(pool, ^{
+      atomic_fetch_add(count_ptr, i);
+    });
+  }
+
+  TaskPool_wait(pool);
+  assert_equal(999l * 1000l / 2, atomic_load(&count));
+
+  TaskPool_free(pool);
+}
+
+static void test_task_group_nested_spawn() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  TaskGroup* group = TaskGroup_new(pool);
+
+  _Atomic long count = 0;
+  _Atomic long* count_ptr = &count;
+
+  // tasks spawning tasks in the same group: TaskGroup_wait waits for all of them
+  for(long i = 0; i < 100; ++i) {
+    TaskGroup_spawn(group, ^{
+      for(long j = 0; j < 10; ++j) {
+        TaskGroup_spawn(group, ^{
+          atomic_fetch_add(count_ptr, 1);
+        });
+      }
+    });
+  }
+
+  TaskGroup_wait(group);
+  assert_equal(1000l, atomic_load(&count));
+
+  TaskGroup_free(group);
+  TaskPool_free(pool);
+}
+
+static void test_parallel_for() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  size_t n = 100000;
+  int* visits = (int*) Mem_calloc(n, sizeof(int));
+
+  for(size_t grain = 0; grain < 1000; grain = grain * 10 + 1) {
+    parallel_for(pool, n, grain, ^(size_t from, size_t to) {
+      for(size_t i = from; i < to; ++i) {
+        visits[i] += 1;
+      }
+    });
+  }
+
+  // each index is visited exactly once for each grain (0, 1, 11, 111)
+  for(size_t i = 0; i < n; ++i) {
+    assert_equal(4l, (long) visits[i]);
+  }
+
+  parallel_for(pool, 0, 0, ^(size_t from, size_t to) {
+    visits[from] = (int) to;
+  });
+  assert_equal(4l, (long) visits[0]);
+
+  Mem_free(visits);
+  TaskPool_free(pool);
+}
+
+static void test_parallel_for_nested() {
+  TaskPool* pool = TaskPool_new(NUM_WORKERS);
+  _Atomic long count = 0;
+  _Atomic long* count_ptr = &count;
+
+  // waiting workers run pending tasks, so that nested loops cannot exhaust the pool
+  parallel_for(pool, 64, 1, ^(size_t from, size_t to) {
+    for(size_t i = from; i < to; ++i) {
+      parallel_for(pool, 100, 10, ^(size_t inner_from, size_t inner_to) {
+        atomic_fetch_add(count_ptr, (long) (inner_to - inner_from));
+      });
+    }
+  });
+
+  assert_equal(6400l, atomic_load(&count));
+  TaskPool_free(pool);
+}
+
+int main() {
+  start_tests("task pool");
+  test(test_task_pool_spawn);
+  test(test_task_group_nested_spawn);
+  test(test_parallel_for);
+  test(test_parallel_for_nested);
+  end_tests();
+
+  return 0;
+}